@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -9,6 +9,7 @@
 #include "esp_err.h"
 #include "esp_check.h"
 #include "esp_cam_sensor_types.h"
+#include "esp_cam_sensor_regtab.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,6 +18,9 @@ extern "C" {
 /**
  * @brief Query the supported data types of extended control parameters.
  *
+ * @note ESP_CAM_SENSOR_GROUP_EXP_GAIN is reported by sensor drivers which can update exposure and gain
+ *       at the same frame, either by group hold registers or by a latch register of their own.
+ *
  * @param[in] dev Camera sensor device handle that created by `sensor_detect`.
  * @param[out] qdesc The pointer to hold the extended control parameters.
  * @return
@@ -43,6 +47,11 @@ esp_err_t esp_cam_sensor_get_para_value(esp_cam_sensor_device_t *dev, uint32_t i
 /**
  * @brief Set the value of the control parameter.
  *
+ * @note If the sensor driver describes group hold registers, ESP_CAM_SENSOR_GROUP_EXP_GAIN is
+ *       written between group hold begin and commit. Drivers without group hold registers either
+ *       latch exposure and gain by their own registers, such as os02n10, os04c10 and sti2250, or
+ *       reject ESP_CAM_SENSOR_GROUP_EXP_GAIN like any unsupported control.
+ *
  * @param[in] dev Camera sensor device handle that created by `sensor_detect`.
  * @param[in] id Camera sensor parameter ID.
  * @param[in] arg Camera sensor parameter setting data pointer.
@@ -123,6 +132,68 @@ esp_err_t esp_cam_sensor_get_format(esp_cam_sensor_device_t *dev, esp_cam_sensor
  */
 esp_err_t esp_cam_sensor_ioctl(esp_cam_sensor_device_t *dev, uint32_t cmd, void *arg);
 
+/**
+ * @brief Put the camera sensor into software standby.
+ *
+ * @note The sensor output stream is stopped, and the sensor keeps its register settings, so
+ *       setting the current format again when the sensor is in standby does not write the
+ *       format register table, and the next ESP_CAM_SENSOR_IOC_S_STREAM only writes the
+ *       stream-on register. Resetting the sensor makes it leave standby.
+ *
+ * @param[in] dev Camera sensor device handle that created by `sensor_detect`.
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments.
+ *      - ESP_ERR_NOT_SUPPORTED: The sensor driver does not support software standby.
+ */
+esp_err_t esp_cam_sensor_standby(esp_cam_sensor_device_t *dev);
+
+/**
+ * @brief Make the camera sensor leave software standby.
+ *
+ * @note No register is written, the output stream starts when ESP_CAM_SENSOR_IOC_S_STREAM is called.
+ *
+ * @param[in] dev Camera sensor device handle that created by `sensor_detect`.
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments.
+ *      - ESP_ERR_INVALID_STATE: The sensor is not in software standby.
+ */
+esp_err_t esp_cam_sensor_resume(esp_cam_sensor_device_t *dev);
+
+/**
+ * @brief Start recording a group of register writes which take effect at the same frame.
+ *
+ * @note Calls can be nested, only the outermost begin and commit write the group hold registers.
+ *       Group hold registers are written by the same SCCB functions as control registers, so
+ *       they keep their order with control registers when SCCB writes are deferred. If register
+ *       shadow is enabled, group hold registers must be volatile registers of the shadow.
+ *       A group belongs to the task which begins it, group hold begin of other tasks on the same
+ *       device blocks until the group is committed. Groups of different devices don't block each
+ *       other. Writes take effect group_hold->effect_delay frames after the frame in which the
+ *       group is committed.
+ *
+ * @param[in] dev Camera sensor device handle that created by `sensor_detect`.
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments.
+ *      - ESP_ERR_NOT_SUPPORTED: The sensor driver does not describe group hold registers.
+ *      - Others: An error occurred while writing data over the SCCB bus.
+ */
+esp_err_t esp_cam_sensor_group_hold_begin(esp_cam_sensor_device_t *dev);
+
+/**
+ * @brief Stop recording a group of register writes and launch the group.
+ *
+ * @param[in] dev Camera sensor device handle that created by `sensor_detect`.
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments.
+ *      - ESP_ERR_INVALID_STATE: No group is being recorded.
+ *      - Others: An error occurred while writing data over the SCCB bus.
+ */
+esp_err_t esp_cam_sensor_group_hold_commit(esp_cam_sensor_device_t *dev);
+
 /**
  * @brief Get the module name of the current camera device.
  *
@@ -132,6 +203,67 @@ esp_err_t esp_cam_sensor_ioctl(esp_cam_sensor_device_t *dev, uint32_t cmd, void
  */
 const char *esp_cam_sensor_get_name(esp_cam_sensor_device_t *dev);
 
+/**
+ * @brief Write a camera sensor register table.
+ *
+ * @note The table ends with an entry whose register address is reg_end. An entry whose register address
+ *       is reg_delay is a delay, and its value is the delay time in ms. Registers between two such entries
+ *       are written by one esp_sccb_transmit_burst call, so set ESP_SCCB_BURST_FLAG_AUTO_INC only if the
+ *       sensor supports register address auto-increment.
+ *
+ * @param[in] sccb_handle SCCB IO handle of the camera sensor.
+ * @param[in] regs Register table.
+ * @param[in] reg_end Register address which marks the end of the table.
+ * @param[in] reg_delay Register address which marks a delay entry.
+ * @param[in] flags SCCB burst flags, see ESP_SCCB_BURST_FLAG_*.
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments.
+ *      - Others: An error occurred while writing data over the SCCB bus.
+ */
+esp_err_t esp_cam_sensor_write_reg_table(esp_sccb_io_handle_t sccb_handle, const esp_sccb_reg_t *regs, uint16_t reg_end, uint16_t reg_delay, uint32_t flags);
+
+/**
+ * @brief Write a compact camera sensor register table.
+ *
+ * @note The table format is described in esp_cam_sensor_regtab.h. Registers between two delays are written
+ *       by esp_sccb_transmit_burst calls, so set ESP_SCCB_BURST_FLAG_AUTO_INC only if the sensor supports
+ *       register address auto-increment. ESP_SCCB_BURST_FLAG_ADDR_16BIT also selects the register address
+ *       width in the table.
+ *
+ * @param[in] sccb_handle SCCB IO handle of the camera sensor.
+ * @param[in] tab Compact register table.
+ * @param[in] flags SCCB burst flags, see ESP_SCCB_BURST_FLAG_*.
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments or invalid opcode in the table.
+ *      - Others: An error occurred while writing data over the SCCB bus.
+ */
+esp_err_t esp_cam_sensor_write_regtab(esp_sccb_io_handle_t sccb_handle, const uint8_t *tab, uint32_t flags);
+
+/**
+ * @brief Write the registers which differ between two compact camera sensor register tables.
+ *
+ * @note The sensor registers must be in the state which cur_tab leaves them in. The registers to write are
+ *       looked up in diffs, which "tools/gen_regtab.py --diff" generates at build time, see
+ *       esp_cam_sensor_regtab.h. Registers changed after cur_tab was written, like exposure and gain, are
+ *       not restored, so the caller has to write them again if tab should start from their table or reset values.
+ *
+ * @param[in] sccb_handle SCCB IO handle of the camera sensor.
+ * @param[in] diffs Diff tables of the sensor, ended by an entry whose diff_tab is NULL.
+ * @param[in] cur_tab Compact register table which has been written.
+ * @param[in] tab Compact register table to switch to.
+ * @param[in] flags SCCB burst flags, see ESP_SCCB_BURST_FLAG_*.
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments.
+ *      - ESP_ERR_NOT_SUPPORTED: There is no diff table from cur_tab to tab, nothing is written and
+ *                               tab should be written by esp_cam_sensor_write_regtab after reset.
+ *      - Others: An error occurred while writing data over the SCCB bus.
+ */
+esp_err_t esp_cam_sensor_write_regtab_diff(esp_sccb_io_handle_t sccb_handle, const esp_cam_sensor_regtab_diff_t *diffs,
+                                          const uint8_t *cur_tab, const uint8_t *tab, uint32_t flags);
+
 /**
  * @brief Delete camera device
  *
@@ -0,0 +1,50 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Compact camera sensor register table.
+ *
+ * The table is a byte stream of records, each record starts with one opcode byte:
+ *
+ * - ESP_CAM_SENSOR_REGTAB_RUN(n): write n (1 ~ ESP_CAM_SENSOR_REGTAB_RUN_MAX) registers at
+ *   consecutive addresses, followed by the start register address (2 bytes big-endian if the
+ *   table is written with ESP_SCCB_BURST_FLAG_ADDR_16BIT, otherwise 1 byte) and n values.
+ * - ESP_CAM_SENSOR_REGTAB_DELAY: delay, followed by 1 byte of delay time in ms.
+ * - ESP_CAM_SENSOR_REGTAB_END: end of the table.
+ *
+ * Tables are generated from the "xxx_reginfo_t" register table headers by
+ * "tools/gen_regtab.py" at build time, and written by esp_cam_sensor_write_regtab.
+ * Formats whose "regs" is a compact table set "regs_type" to ESP_CAM_SENSOR_REGS_COMPACT.
+ */
+
+#define ESP_CAM_SENSOR_REGTAB_RUN_MAX       128
+#define ESP_CAM_SENSOR_REGTAB_RUN(n)        ((n) - 1)
+#define ESP_CAM_SENSOR_REGTAB_DELAY         0x80
+#define ESP_CAM_SENSOR_REGTAB_END           0xff
+
+/**
+ * @brief Diff table from one compact register table to another
+ *
+ * Generated by "tools/gen_regtab.py --diff" for the pairs of tables which can be switched without
+ * reset, and written by esp_cam_sensor_write_regtab_diff.
+ */
+typedef struct {
+    const uint8_t *cur_tab;                 /*!< Compact register table which has been written */
+    const uint8_t *tab;                     /*!< Compact register table to switch to */
+    const uint8_t *diff_tab;                /*!< Compact register table of the registers which differ, NULL ends the list */
+} esp_cam_sensor_regtab_diff_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <sys/lock.h>
 #include "esp_sccb_intf.h"
 #include "driver/gpio.h"
 
@@ -338,6 +339,15 @@ typedef union _cam_sensor_isp_info {
     esp_cam_sensor_isp_info_v1_t isp_v1_info;
 } esp_cam_sensor_isp_info_t;
 
+/**
+ * @brief Encoding of camera sensor format register table
+ */
+typedef enum {
+    ESP_CAM_SENSOR_REGS_ARRAY = 0,  /*!< Array of register and value structures, like esp_sccb_reg_t, "regs_size" is the entry count */
+    ESP_CAM_SENSOR_REGS_COMPACT,    /*!< Compact register table described in esp_cam_sensor_regtab.h, "regs_size" is the byte count,
+                                         it doesn't include the register writes shared by all formats, so only the sensor driver can write it */
+} esp_cam_sensor_regs_type_t;
+
 /**
  * @brief Description of camera sensor output format
  */
@@ -351,6 +361,7 @@ typedef struct _cam_sensor_format_struct {
 
     const void *regs;                             /*!< Regs to enable this format */
     int regs_size;
+    esp_cam_sensor_regs_type_t regs_type;         /*!< Encoding of "regs", check it before accessing "regs" */
     uint8_t fps;                                  /*!< frames per second */
     const esp_cam_sensor_isp_info_t *isp_info;    /*!< For sensor without internal ISP, set NULL if the sensor‘s internal ISP used. */
     union {
@@ -381,6 +392,21 @@ typedef struct _cam_sensor_format_array {
 
 typedef struct _esp_cam_sensor_ops esp_cam_sensor_ops_t;
 
+/**
+ * @brief Description of the group hold registers of the camera sensor
+ *
+ * @note Registers written between the begin and commit sequences are latched by the sensor,
+ *       and take effect together at the same frame after the commit sequence is written.
+ */
+typedef struct {
+    const esp_sccb_reg_t *begin_regs;            /*!< Registers written to start recording a group */
+    uint8_t begin_num;                           /*!< Number of registers in begin_regs */
+    const esp_sccb_reg_t *commit_regs;           /*!< Registers written to stop recording and launch the group */
+    uint8_t commit_num;                          /*!< Number of registers in commit_regs */
+    uint8_t effect_delay;                        /*!< Number of frames from the frame in which the group is launched to the frame which it takes effect on */
+    uint32_t flags;                              /*!< SCCB burst flags of the registers, see ESP_SCCB_BURST_FLAG_* */
+} esp_cam_sensor_group_hold_t;
+
 /**
  * @brief Type of camera sensor device
  */
@@ -394,6 +420,10 @@ typedef struct {
     const esp_cam_sensor_format_t *cur_format;   /*!< Current format */
     esp_cam_sensor_id_t id;                      /*!< Sensor ID. */
     uint8_t stream_status;                       /*!< Status of the sensor output stream. */
+    uint8_t standby_status;                      /*!< 1 if the sensor is in software standby and keeps its register settings. */
+    const esp_cam_sensor_group_hold_t *group_hold; /*!< Group hold registers of the sensor, NULL if not supported. */
+    uint8_t group_hold_depth;                    /*!< Nesting depth of group hold begin calls. */
+    _lock_t group_hold_lock;                     /*!< Held from the outermost group hold begin to its commit. */
     const esp_cam_sensor_ops_t *ops;             /*!< Pointer to the camera sensor driver operation array. */
     void *priv;                                  /*!< Private data */
 } esp_cam_sensor_device_t;
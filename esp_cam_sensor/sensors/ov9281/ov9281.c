@@ -55,6 +55,25 @@ static const uint32_t s_ov9281_limited_gain_ = CONFIG_CAMERA_OV9281_ABSOLUTE_GAI
 static size_t s_ov9281_limited_gain_index;
 static const char *TAG = "ov9281";
 
+/* Exposure and gain written between begin and commit take effect at the same frame */
+static const esp_sccb_reg_t ov9281_group_hold_begin[] = {
+    {OV9281_REG_GROUP_HOLD_ADDR, OV9281_GROUP_HOLD_START},
+};
+
+static const esp_sccb_reg_t ov9281_group_hold_commit[] = {
+    {OV9281_REG_GROUP_HOLD_ADDR, OV9281_GROUP_HOLD_END},
+    {OV9281_REG_GROUP_HOLD_ADDR, OV9281_GROUP_HOLD_LAUNCH},
+};
+
+static const esp_cam_sensor_group_hold_t ov9281_group_hold = {
+    .begin_regs = ov9281_group_hold_begin,
+    .begin_num = ARRAY_SIZE(ov9281_group_hold_begin),
+    .commit_regs = ov9281_group_hold_commit,
+    .commit_num = ARRAY_SIZE(ov9281_group_hold_commit),
+    .effect_delay = 1,
+    .flags = ESP_SCCB_BURST_FLAG_ADDR_16BIT,
+};
+
 #define EXPOSURE_V4L2_UNIT_US                   100
 #define EXPOSURE_V4L2_TO_OV9281(v, sf)          \
     ((uint32_t)(((double)v) * EXPOSURE_V4L2_UNIT_US * 1000 / (((sf)->isp_info->isp_v1_info.tline_ns)) + 0.5))
@@ -363,7 +382,6 @@ static esp_err_t ov9281_set_para_value(esp_cam_sensor_device_t *dev, uint32_t id
     switch (id) {
     case ESP_CAM_SENSOR_EXPOSURE_VAL: {
         uint32_t u32_val = *(uint32_t *)arg;
-        // Todo, Add group hold if fast AEC need
         ret = ov9281_set_exp_val(dev, u32_val);
         break;
     }
@@ -670,6 +688,7 @@ esp_cam_sensor_device_t *ov9281_detect(esp_cam_sensor_config_t *config)
     dev->pwdn_pin = config->pwdn_pin;
     dev->sensor_port = config->sensor_port;
     dev->ops = &ov9281_ops;
+    dev->group_hold = &ov9281_group_hold;
     dev->cur_format = &ov9281_format_info[CONFIG_CAMERA_OV9281_MIPI_IF_FORMAT_INDEX_DEFAULT];
     // init para
     cam_ov9281->ov9281_para.exposure_val = dev->cur_format->isp_info->isp_v1_info.exp_def;
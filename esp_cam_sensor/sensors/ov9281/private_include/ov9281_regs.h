@@ -53,6 +53,7 @@ extern "C" {
 #define OV9281_MODE_STREAMING          0x01
 #define OV9281_GROUP_HOLD_START        0x00
 #define OV9281_GROUP_HOLD_END          0x10
+#define OV9281_GROUP_HOLD_LAUNCH       0xa0
 
 #if CONFIG_SOC_ISP_BLC_SUPPORTED
 #define OV9281_BLC_TARGET_DEFAULT      0x40
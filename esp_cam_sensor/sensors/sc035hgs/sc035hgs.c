@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -71,6 +71,24 @@ struct sc035hgs_cam {
 static const uint8_t s_sc035hgs_exp_min = 0x08;
 static const char *TAG = "sc035hgs";
 
+/* Exposure and gain written between begin and commit take effect at the same frame */
+static const esp_sccb_reg_t sc035hgs_group_hold_begin[] = {
+    {SC035HGS_REG_GROUP_HOLD, SC035HGS_GROUP_HOLD_START},
+};
+
+static const esp_sccb_reg_t sc035hgs_group_hold_commit[] = {
+    {SC035HGS_REG_GROUP_HOLD, SC035HGS_GROUP_HOLD_LUNCH},
+};
+
+static const esp_cam_sensor_group_hold_t sc035hgs_group_hold = {
+    .begin_regs = sc035hgs_group_hold_begin,
+    .begin_num = ARRAY_SIZE(sc035hgs_group_hold_begin),
+    .commit_regs = sc035hgs_group_hold_commit,
+    .commit_num = ARRAY_SIZE(sc035hgs_group_hold_commit),
+    .effect_delay = 1,
+    .flags = ESP_SCCB_BURST_FLAG_ADDR_16BIT,
+};
+
 // total gain = analog_gain x digital_gain x 1000(To avoid decimal points, the final abs_gain is multiplied by 1000.)
 static const uint32_t sc035hgs_total_gain_val_map[] = {
     //1x
@@ -923,6 +941,7 @@ esp_cam_sensor_device_t *sc035hgs_detect(esp_cam_sensor_config_t *config)
     dev->pwdn_pin = config->pwdn_pin;
     dev->sensor_port = config->sensor_port;
     dev->ops = &sc035hgs_ops;
+    dev->group_hold = &sc035hgs_group_hold;
     dev->priv = cam_sc035hgs;
 #if CONFIG_SOC_MIPI_CSI_SUPPORTED
     if (config->sensor_port == ESP_CAM_SENSOR_MIPI_CSI) {
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -61,6 +61,8 @@ struct sc202cs_cam {
 #endif
 #define delay_ms(ms)  vTaskDelay((ms > portTICK_PERIOD_MS ? ms/ portTICK_PERIOD_MS : 1))
 #define SC202CS_SUPPORT_NUM CONFIG_CAMERA_SC202CS_MAX_SUPPORT
+#define SC202CS_GROUP_HOLD_START        0x00
+#define SC202CS_GROUP_HOLD_END          0x30
 
 static const uint32_t s_limited_abs_gain = CONFIG_CAMERA_SC202CS_ABSOLUTE_GAIN_LIMIT;
 static const uint8_t s_sc202cs_exp_min = 0x08;
@@ -68,6 +70,24 @@ static const uint8_t s_sc202cs_exp_vts_offset = 0x06;
 static size_t s_limited_abs_gain_index;
 static const char *TAG = "sc202cs";
 
+/* Exposure and gain written between begin and commit take effect at the same frame */
+static const esp_sccb_reg_t sc202cs_group_hold_begin[] = {
+    {SC202CS_REG_GROUP_HOLD, SC202CS_GROUP_HOLD_START},
+};
+
+static const esp_sccb_reg_t sc202cs_group_hold_commit[] = {
+    {SC202CS_REG_GROUP_HOLD, SC202CS_GROUP_HOLD_END},
+};
+
+static const esp_cam_sensor_group_hold_t sc202cs_group_hold = {
+    .begin_regs = sc202cs_group_hold_begin,
+    .begin_num = ARRAY_SIZE(sc202cs_group_hold_begin),
+    .commit_regs = sc202cs_group_hold_commit,
+    .commit_num = ARRAY_SIZE(sc202cs_group_hold_commit),
+    .effect_delay = 1,
+    .flags = ESP_SCCB_BURST_FLAG_ADDR_16BIT,
+};
+
 #if CONFIG_CAMERA_SC202CS_ANA_GAIN_PRIORITY
 // total gain = analog_gain x digital_gain x 1000(To avoid decimal points, the final abs_gain is multiplied by 1000.)
 static const uint32_t sc202cs_abs_gain_val_map[] = {
@@ -1523,6 +1543,7 @@ esp_cam_sensor_device_t *sc202cs_detect(esp_cam_sensor_config_t *config)
     dev->pwdn_pin = config->pwdn_pin;
     dev->sensor_port = config->sensor_port;
     dev->ops = &sc202cs_ops;
+    dev->group_hold = &sc202cs_group_hold;
     dev->priv = cam_sc202cs;
     dev->cur_format = &sc202cs_format_info[get_sc202cs_actual_format_index()];
     for (size_t i = 0; i < ARRAY_SIZE(sc202cs_abs_gain_val_map); i++) {
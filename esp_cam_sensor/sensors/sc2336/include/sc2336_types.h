@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -7,18 +7,17 @@
 #pragma once
 
 #include <stdint.h>
+#include "esp_sccb_types.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /*
- * SC2336 camera sensor register type definition.
+ * SC2336 camera sensor register type definition, it is the same as SCCB
+ * register type so that register tables can be written by burst transmit.
  */
-typedef struct {
-    uint16_t reg;
-    uint8_t val;
-} sc2336_reginfo_t;
+typedef esp_sccb_reg_t sc2336_reginfo_t;
 
 #ifdef __cplusplus
 }
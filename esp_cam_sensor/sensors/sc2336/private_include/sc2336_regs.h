@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -48,6 +48,7 @@ extern "C" {
 
 #define SC2336_REG_FLIP_MIRROR             0x3221
 #define SC2336_REG_SLEEP_MODE              0x0100
+#define SC2336_REG_SOFT_RESET              0x0103
 
 #ifdef __cplusplus
 }
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -14,7 +14,13 @@
 
 #include "esp_cam_sensor.h"
 #include "esp_cam_sensor_detect.h"
+#if CONFIG_CAMERA_SC2336_COMPACT_REG_TABLE
+#include "sc2336_regtab.h"
+#define SC2336_REGS_TYPE ESP_CAM_SENSOR_REGS_COMPACT
+#else
 #include "sc2336_settings.h"
+#define SC2336_REGS_TYPE ESP_CAM_SENSOR_REGS_ARRAY
+#endif
 #include "sc2336.h"
 
 /*
@@ -40,6 +46,9 @@ typedef struct {
 
 struct sc2336_cam {
     sc2336_para_t sc2336_para;
+#if CONFIG_CAMERA_SC2336_SEAMLESS_FORMAT_SWITCH
+    const esp_cam_sensor_format_t *written_format; // format whose registers the sensor holds, NULL after reset
+#endif
 };
 
 #define SC2336_IO_MUX_LOCK(mux)
@@ -78,6 +87,31 @@ static size_t s_limited_gain_index;
 static const uint8_t s_sc2336_exp_min = 0x08;
 static const char *TAG = "sc2336";
 
+/* Exposure and gain written between begin and commit take effect at the same frame */
+static const esp_sccb_reg_t sc2336_group_hold_begin[] = {
+    {SC2336_REG_GROUP_HOLD, SC2336_GROUP_HOLD_START},
+};
+
+static const esp_sccb_reg_t sc2336_group_hold_commit[] = {
+    {SC2336_REG_GROUP_HOLD, SC2336_GROUP_HOLD_END},
+};
+
+static const esp_cam_sensor_group_hold_t sc2336_group_hold = {
+    .begin_regs = sc2336_group_hold_begin,
+    .begin_num = ARRAY_SIZE(sc2336_group_hold_begin),
+    .commit_regs = sc2336_group_hold_commit,
+    .commit_num = ARRAY_SIZE(sc2336_group_hold_commit),
+    .effect_delay = SC2336_GROUP_HOLD_DELAY_FRAMES,
+    .flags = ESP_SCCB_BURST_FLAG_ADDR_16BIT,
+};
+
+#if CONFIG_ESP_SCCB_ENABLE_REG_SHADOW
+/* Group hold register triggers a group write when it is written, so always write it */
+static const esp_sccb_reg_range_t sc2336_volatile_regs[] = {
+    {SC2336_REG_GROUP_HOLD, SC2336_REG_GROUP_HOLD},
+};
+#endif
+
 #if CONFIG_CAMERA_SC2336_ANA_GAIN_PRIORITY
 // total gain = analog_gain x digital_gain x 1000(To avoid decimal points, the final abs_gain is multiplied by 1000.)
 static const uint32_t sc2336_total_gain_val_map[] = {
@@ -1111,6 +1145,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 720,
         .regs = sc2336_mipi_2lane_24Minput_1280x720_raw10_30fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_1280x720_raw10_30fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 30,
         .isp_info = &sc2336_isp_info_mipi[0],
         .mipi_info = {
@@ -1131,6 +1166,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 720,
         .regs = sc2336_mipi_2lane_24Minput_1280x720_raw10_50fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_1280x720_raw10_50fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 50,
         .isp_info = &sc2336_isp_info_mipi[1],
         .mipi_info = {
@@ -1151,6 +1187,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 720,
         .regs = sc2336_mipi_2lane_24Minput_1280x720_raw10_60fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_1280x720_raw10_60fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 60,
         .isp_info = &sc2336_isp_info_mipi[2],
         .mipi_info = {
@@ -1171,6 +1208,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 1080,
         .regs = sc2336_mipi_1lane_24Minput_1920x1080_raw10_25fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_1lane_24Minput_1920x1080_raw10_25fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 25,
         .isp_info = &sc2336_isp_info_mipi[3],
         .mipi_info = {
@@ -1191,6 +1229,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 1080,
         .regs = sc2336_mipi_2lane_24Minput_1920x1080_raw10_25fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_1920x1080_raw10_25fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 25,
         .isp_info = &sc2336_isp_info_mipi[4],
         .mipi_info = {
@@ -1211,6 +1250,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 1080,
         .regs = sc2336_mipi_2lane_24Minput_1920x1080_raw10_30fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_1920x1080_raw10_30fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 30,
         .isp_info = &sc2336_isp_info_mipi[5],
         .mipi_info = {
@@ -1231,6 +1271,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 800,
         .regs = sc2336_mipi_2lane_24Minput_800x800_raw10_30fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_800x800_raw10_30fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 30,
         .isp_info = &sc2336_isp_info_mipi[6],
         .mipi_info = {
@@ -1251,6 +1292,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 480,
         .regs = sc2336_mipi_2lane_24Minput_640x480_raw10_50fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_640x480_raw10_50fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 50,
         .isp_info = &sc2336_isp_info_mipi[7],
         .mipi_info = {
@@ -1271,6 +1313,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 1080,
         .regs = sc2336_mipi_2lane_24Minput_1920x1080_raw8_30fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_1920x1080_raw8_30fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 30,
         .isp_info = &sc2336_isp_info_mipi[8],
         .mipi_info = {
@@ -1291,6 +1334,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 720,
         .regs = sc2336_mipi_2lane_24Minput_1280x720_raw8_30fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_1280x720_raw8_30fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 30,
         .isp_info = &sc2336_isp_info_mipi[9],
         .mipi_info = {
@@ -1311,6 +1355,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 800,
         .regs = sc2336_mipi_2lane_24Minput_800x800_raw8_30fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_800x800_raw8_30fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 30,
         .isp_info = &sc2336_isp_info_mipi[10],
         .mipi_info = {
@@ -1331,6 +1376,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_mipi[] = {
         .height = 600,
         .regs = sc2336_mipi_2lane_24Minput_1024x600_raw8_30fps,
         .regs_size = ARRAY_SIZE(sc2336_mipi_2lane_24Minput_1024x600_raw8_30fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 30,
         .isp_info = &sc2336_isp_info_mipi[11],
         .mipi_info = {
@@ -1422,6 +1468,7 @@ static const esp_cam_sensor_format_t sc2336_format_info_dvp[] = {
         .height = 720,
         .regs = sc2336_dvp_8bit_24Minput_1280x720_raw10_30fps,
         .regs_size = ARRAY_SIZE(sc2336_dvp_8bit_24Minput_1280x720_raw10_30fps),
+        .regs_type = SC2336_REGS_TYPE,
         .fps = 30,
         .isp_info = &sc2336_isp_info_dvp[0],
         .mipi_info = {0},
@@ -1459,34 +1506,47 @@ static esp_err_t sc2336_write(esp_sccb_io_handle_t sccb_handle, uint16_t reg, ui
 }
 
 /* write a array of registers  */
-static esp_err_t sc2336_write_array(esp_sccb_io_handle_t sccb_handle, sc2336_reginfo_t *regarray)
+#if CONFIG_CAMERA_SC2336_COMPACT_REG_TABLE
+static esp_err_t sc2336_write_array(esp_sccb_io_handle_t sccb_handle, const uint8_t *regarray)
 {
-    int i = 0;
-    esp_err_t ret = ESP_OK;
-    while ((ret == ESP_OK) && regarray[i].reg != SC2336_REG_END) {
-        if (regarray[i].reg != SC2336_REG_DELAY) {
-            ret = sc2336_write(sccb_handle, regarray[i].reg, regarray[i].val);
-        } else {
-            delay_ms(regarray[i].val);
-        }
-        i++;
-    }
-    return ret;
+    const uint32_t flags = ESP_SCCB_BURST_FLAG_ADDR_16BIT | ESP_SCCB_BURST_FLAG_AUTO_INC;
+
+    ESP_RETURN_ON_ERROR(esp_cam_sensor_write_regtab(sccb_handle, sc2336_common_regtab, flags), TAG, "failed to write common regs");
+    return esp_cam_sensor_write_regtab(sccb_handle, regarray, flags);
 }
+#else
+static esp_err_t sc2336_write_array(esp_sccb_io_handle_t sccb_handle, const sc2336_reginfo_t *regarray)
+{
+    return esp_cam_sensor_write_reg_table(sccb_handle, regarray, SC2336_REG_END, SC2336_REG_DELAY,
+                                          ESP_SCCB_BURST_FLAG_ADDR_16BIT | ESP_SCCB_BURST_FLAG_AUTO_INC);
+}
+#endif
 
-static esp_err_t sc2336_set_reg_bits(esp_sccb_io_handle_t sccb_handle, uint16_t reg, uint8_t offset, uint8_t length, uint8_t value)
+#if CONFIG_CAMERA_SC2336_SEAMLESS_FORMAT_SWITCH
+/* write the registers which differ between two arrays of registers, by the diff tables generated at build time */
+static esp_err_t sc2336_write_array_diff(esp_sccb_io_handle_t sccb_handle, const uint8_t *cur_regarray, const uint8_t *regarray)
 {
-    esp_err_t ret = ESP_OK;
-    uint8_t reg_data = 0;
+    const uint32_t flags = ESP_SCCB_BURST_FLAG_ADDR_16BIT | ESP_SCCB_BURST_FLAG_AUTO_INC;
 
-    ret = sc2336_read(sccb_handle, reg, &reg_data);
-    if (ret != ESP_OK) {
-        return ret;
-    }
+    return esp_cam_sensor_write_regtab_diff(sccb_handle, sc2336_regtab_diffs, cur_regarray, regarray, flags);
+}
+#endif
+
+/* sensor registers are back to reset values, so the next format must be written in full */
+static void sc2336_clear_written_format(esp_cam_sensor_device_t *dev)
+{
+#if CONFIG_CAMERA_SC2336_SEAMLESS_FORMAT_SWITCH
+    struct sc2336_cam *cam_sc2336 = (struct sc2336_cam *)dev->priv;
+
+    cam_sc2336->written_format = NULL;
+#endif
+}
+
+static esp_err_t sc2336_set_reg_bits(esp_sccb_io_handle_t sccb_handle, uint16_t reg, uint8_t offset, uint8_t length, uint8_t value)
+{
     uint8_t mask = ((1 << length) - 1) << offset;
-    value = (reg_data & ~mask) | ((value << offset) & mask);
-    ret = sc2336_write(sccb_handle, reg, value);
-    return ret;
+
+    return esp_sccb_update_reg_a16v8(sccb_handle, reg, mask, value << offset);
 }
 
 static esp_err_t sc2336_set_test_pattern(esp_cam_sensor_device_t *dev, int enable)
@@ -1501,14 +1561,21 @@ static esp_err_t sc2336_hw_reset(esp_cam_sensor_device_t *dev)
         delay_ms(10);
         gpio_set_level(dev->reset_pin, 1);
         delay_ms(10);
+#if CONFIG_ESP_SCCB_ENABLE_REG_SHADOW
+        esp_sccb_shadow_invalidate(dev->sccb_handle);
+#endif
+        sc2336_clear_written_format(dev);
+        dev->standby_status = 0;
     }
     return ESP_OK;
 }
 
 static esp_err_t sc2336_soft_reset(esp_cam_sensor_device_t *dev)
 {
-    esp_err_t ret = sc2336_set_reg_bits(dev->sccb_handle, 0x0103, 0, 1, 0x01);
+    esp_err_t ret = sc2336_set_reg_bits(dev->sccb_handle, SC2336_REG_SOFT_RESET, 0, 1, 0x01);
     delay_ms(5);
+    sc2336_clear_written_format(dev);
+    dev->standby_status = 0;
     return ret;
 }
 
@@ -1536,10 +1603,29 @@ static esp_err_t sc2336_set_stream(esp_cam_sensor_device_t *dev, int enable)
     ret = sc2336_write(dev->sccb_handle, SC2336_REG_SLEEP_MODE, enable ? 0x01 : 0x00);
 
     dev->stream_status = enable;
+    if (enable) {
+        dev->standby_status = 0;
+    }
     ESP_LOGD(TAG, "Stream=%d", enable);
     return ret;
 }
 
+static esp_err_t sc2336_set_standby(esp_cam_sensor_device_t *dev, int enable)
+{
+    esp_err_t ret = ESP_OK;
+
+    /* Sleep mode is the software standby of SC2336, all registers are kept */
+    if (enable) {
+        ret = sc2336_set_stream(dev, 0);
+    }
+
+    if (ret == ESP_OK) {
+        dev->standby_status = enable ? 1 : 0;
+    }
+    ESP_LOGD(TAG, "Standby=%d", enable);
+    return ret;
+}
+
 static esp_err_t sc2336_set_mirror(esp_cam_sensor_device_t *dev, int enable)
 {
     return sc2336_set_reg_bits(dev->sccb_handle, 0x3221, 1, 2,  enable ? 0x03 : 0x00);
@@ -1746,6 +1832,23 @@ static esp_err_t sc2336_query_support_capability(esp_cam_sensor_device_t *dev, e
     return 0;
 }
 
+#if CONFIG_CAMERA_SC2336_SEAMLESS_FORMAT_SWITCH
+/*
+ * Register tables don't contain exposure, gain, flip and mirror registers, so a diff write keeps
+ * their runtime values. Restore the defaults which the soft reset of a full write sets.
+ */
+static esp_err_t sc2336_reset_para(esp_cam_sensor_device_t *dev, const esp_cam_sensor_format_t *format)
+{
+    struct sc2336_cam *cam_sc2336 = (struct sc2336_cam *)dev->priv;
+
+    cam_sc2336->sc2336_para.exposure_max = format->isp_info->isp_v1_info.vts - SC2336_EXP_MAX_OFFSET;
+    ESP_RETURN_ON_ERROR(sc2336_set_exp_val(dev, format->isp_info->isp_v1_info.exp_def), TAG, "failed to reset exposure");
+    ESP_RETURN_ON_ERROR(sc2336_set_total_gain_val(dev, format->isp_info->isp_v1_info.gain_def), TAG, "failed to reset gain");
+    ESP_RETURN_ON_ERROR(sc2336_set_vflip(dev, 0), TAG, "failed to reset vflip");
+    return sc2336_set_mirror(dev, 0);
+}
+#endif
+
 static esp_err_t sc2336_set_format(esp_cam_sensor_device_t *dev, const esp_cam_sensor_format_t *format)
 {
     ESP_CAM_SENSOR_NULL_POINTER_CHECK(TAG, dev);
@@ -1766,7 +1869,40 @@ static esp_err_t sc2336_set_format(esp_cam_sensor_device_t *dev, const esp_cam_s
 #endif
     }
 
-    ret = sc2336_write_array(dev->sccb_handle, (sc2336_reginfo_t *)format->regs);
+    /* Registers of the current format are kept in standby, only the stream-on register is needed to resume */
+    if (dev->standby_status && dev->cur_format == format) {
+        ESP_LOGD(TAG, "Keep format regs in standby");
+        return ESP_OK;
+    }
+
+#if CONFIG_CAMERA_SC2336_SEAMLESS_FORMAT_SWITCH
+    const esp_cam_sensor_format_t *written_format = cam_sc2336->written_format;
+
+    /* The format is written in full if anything fails, so don't diff against registers in an unknown state */
+    cam_sc2336->written_format = NULL;
+    if (written_format && written_format != format) {
+        int stream_status = dev->stream_status;
+
+        if (stream_status) {
+            ESP_RETURN_ON_ERROR(sc2336_set_stream(dev, 0), TAG, "failed to stop stream");
+        }
+
+        ret = sc2336_write_array_diff(dev->sccb_handle, written_format->regs, format->regs);
+        if (ret == ESP_OK) {
+            ret = sc2336_reset_para(dev, format);
+        } else if (ret == ESP_ERR_NOT_SUPPORTED) {
+            ret = sc2336_write_array(dev->sccb_handle, format->regs);
+        }
+
+        if (ret == ESP_OK && stream_status) {
+            ret = sc2336_set_stream(dev, 1);
+        }
+    } else {
+        ret = sc2336_write_array(dev->sccb_handle, format->regs);
+    }
+#else
+    ret = sc2336_write_array(dev->sccb_handle, format->regs);
+#endif
 
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Set format regs fail");
@@ -1774,6 +1910,9 @@ static esp_err_t sc2336_set_format(esp_cam_sensor_device_t *dev, const esp_cam_s
     }
 
     dev->cur_format = format;
+#if CONFIG_CAMERA_SC2336_SEAMLESS_FORMAT_SWITCH
+    cam_sc2336->written_format = format;
+#endif
     // init para
     cam_sc2336->sc2336_para.exposure_val = dev->cur_format->isp_info->isp_v1_info.exp_def;
     cam_sc2336->sc2336_para.gain_index = dev->cur_format->isp_info->isp_v1_info.gain_def;
@@ -1817,6 +1956,9 @@ static esp_err_t sc2336_priv_ioctl(esp_cam_sensor_device_t *dev, uint32_t cmd, v
     case ESP_CAM_SENSOR_IOC_S_STREAM:
         ret = sc2336_set_stream(dev, *(int *)arg);
         break;
+    case ESP_CAM_SENSOR_IOC_S_SUSPEND:
+        ret = sc2336_set_standby(dev, *(int *)arg);
+        break;
     case ESP_CAM_SENSOR_IOC_S_TEST_PATTERN:
         ret = sc2336_set_test_pattern(dev, *(int *)arg);
         break;
@@ -1871,6 +2013,8 @@ static esp_err_t sc2336_power_on(esp_cam_sensor_device_t *dev)
         delay_ms(10);
     }
 
+    sc2336_clear_written_format(dev);
+
     return ret;
 }
 
@@ -1903,6 +2047,9 @@ static esp_err_t sc2336_delete(esp_cam_sensor_device_t *dev)
 {
     ESP_LOGD(TAG, "del sc2336 (%p)", dev);
     if (dev) {
+#if CONFIG_ESP_SCCB_ENABLE_REG_SHADOW
+        esp_sccb_shadow_disable(dev->sccb_handle);
+#endif
         if (dev->priv) {
             free(dev->priv);
             dev->priv = NULL;
@@ -1955,6 +2102,7 @@ esp_cam_sensor_device_t *sc2336_detect(esp_cam_sensor_config_t *config)
     dev->pwdn_pin = config->pwdn_pin;
     dev->sensor_port = config->sensor_port;
     dev->ops = &sc2336_ops;
+    dev->group_hold = &sc2336_group_hold;
     dev->priv = cam_sc2336;
     for (size_t i = 0; i < ARRAY_SIZE(sc2336_total_gain_val_map); i++) {
         if (sc2336_total_gain_val_map[i] > s_limited_gain) {
@@ -1987,6 +2135,18 @@ esp_cam_sensor_device_t *sc2336_detect(esp_cam_sensor_config_t *config)
     }
     ESP_LOGI(TAG, "Detected Camera sensor PID=0x%x", dev->id.pid);
 
+#if CONFIG_ESP_SCCB_ENABLE_REG_SHADOW
+    esp_sccb_shadow_config_t shadow_config = {
+        .volatile_ranges = sc2336_volatile_regs,
+        .volatile_range_num = ARRAY_SIZE(sc2336_volatile_regs),
+        .reset_reg = SC2336_REG_SOFT_RESET,
+        .reset_mask = 0x01,
+    };
+    if (esp_sccb_shadow_enable(dev->sccb_handle, &shadow_config) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to enable register shadow");
+    }
+#endif
+
     return dev;
 
 err_free_handler:
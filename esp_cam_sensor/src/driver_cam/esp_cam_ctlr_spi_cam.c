@@ -200,7 +200,18 @@ static void SPI_CAM_ISR_ATTR spi_cam_receive_done(esp_cam_ctlr_spi_cam_t *ctlr,
                         portYIELD_FROM_ISR(xTaskWoken);
                     }
                 } else {
+                    /* The frame is dropped, finish it with 0 size so that the buffer is put back */
+
+                    esp_cam_ctlr_trans_t trans = {
+                        .buffer = rx_buffer,
+                        .buflen = ctlr->fb_size_in_bytes,
+                        .received_size = 0,
+                    };
+
                     ESP_EARLY_LOGD(TAG, "failed to send frame received message");
+                    if (ctlr->cbs.on_trans_finished) {
+                        ctlr->cbs.on_trans_finished(&(ctlr->base), &trans, ctlr->cbs_user_data);
+                    }
                 }
             } else
 #endif /* CAM_CTLR_SPI_HAS_AUTO_DECODE */
@@ -629,6 +640,15 @@ static void spi_cam_task(void *arg)
                     }
                     ESP_LOGD(TAG, "frame decoded");
                 } else {
+                    /* The frame is dropped, finish it with 0 size so that the buffer is put back */
+
+                    esp_cam_ctlr_trans_t trans = {0};
+
+                    trans.buffer = rx_buffer;
+                    trans.buflen = ctlr->fb_size_in_bytes;
+                    if (ctlr->cbs.on_trans_finished) {
+                        ctlr->cbs.on_trans_finished(&(ctlr->base), &trans, ctlr->cbs_user_data);
+                    }
                     ESP_LOGD(TAG, "failed to decode frame");
                 }
             }
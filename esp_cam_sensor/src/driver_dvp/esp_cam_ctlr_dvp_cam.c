@@ -30,6 +30,9 @@
 #include "soc/gdma_struct.h"
 #include "soc/gpio_sig_map.h"
 #include "esp_private/gdma.h"
+#include "esp_cache.h"
+#include "esp_memory_utils.h"
+#include "esp_cam_ctlr_dvp_dma.h"
 
 #define LCD_CAM_PERIPH_NUM                  (1)
 
@@ -56,6 +59,12 @@
 
 #define DVP_CAM_BUS_IO_NUM                  (8)
 
+#if CONFIG_CAM_CTRL_DVP_ZERO_COPY && CONFIG_SPIRAM
+#define DVP_CAM_DMA_ACCESS_EXT_MEM          (true)
+#else
+#define DVP_CAM_DMA_ACCESS_EXT_MEM          (false)
+#endif
+
 #if CONFIG_CAM_CTRL_DVP_LOG_ENABLE
 /**
  * Use "printf" and "esp_rom_printf" to print log, this is faster than "ESP_LOG",
@@ -128,8 +137,15 @@ typedef struct dvp_cam_ctlr {
 
     size_t fb_size_in_bytes;                            /*!< DVP frame buffer size in bytes */
 
+    dma_descriptor_t *frame_desc;                       /*!< DVP frame buffer DMA description, DMA receives data into frame buffer directly */
+    size_t frame_desc_size;                             /*!< DVP frame buffer DMA description receive data size per node */
+    size_t frame_align_size;                            /*!< DVP frame buffer address and size align size */
+    volatile uint32_t frame_recv_cnt;                   /*!< DVP frame buffer received block count */
+
     struct {
         uint32_t pic_format_jpeg : 1;                   /*!< Input picture format is JPEG, if set this flag and "input_data_color_type" will be ignored */
+        uint32_t zero_copy : 1;                         /*!< DVP supports receiving data into frame buffer directly */
+        uint32_t frame_direct : 1;                      /*!< DVP receives data of current frame into frame buffer directly */
     };
 } dvp_cam_ctlr_t;
 
@@ -187,12 +203,13 @@ static esp_err_t dvp_dma_deinit(gdma_channel_handle_t gdma_chan)
  * @brief Initialize DVP DMA
  *
  * @param gdma_chan DVP DMA channel handle pointer
+ * @param ext_mem   DVP DMA can access external memory
  *
  * @return
  *      - ESP_OK on success
  *      - Others if failed
  */
-static esp_err_t dvp_dma_init(gdma_channel_handle_t *gdma_chan)
+static esp_err_t dvp_dma_init(gdma_channel_handle_t *gdma_chan, bool ext_mem)
 {
     esp_err_t ret = ESP_OK;
     gdma_channel_alloc_config_t rx_alloc_config = {0};
@@ -215,7 +232,7 @@ static esp_err_t dvp_dma_init(gdma_channel_handle_t *gdma_chan)
 
     gdma_transfer_config_t ability = {
         .max_data_burst_size = DVP_CAM_DMA_SRAM_TRANS_BURST_SIZE,
-        .access_ext_mem = false,
+        .access_ext_mem = ext_mem,
     };
     ESP_GOTO_ON_ERROR(gdma_config_transfer(*gdma_chan, &ability), fail0, TAG, "set trans ability failed");
 
@@ -337,43 +354,6 @@ static esp_err_t dvp_get_frame_size(const esp_cam_ctlr_dvp_config_t *config, siz
     return ret;
 }
 
-/**
- * @brief Config DVP DMA description list
- *
- * @param dma_desc  DVP DMA description pointer
- * @param desc_size DVP DMA description node max size
- * @param buffer    DVP receive buffer pointer
- * @param size      DMA buffer size
- * @param next      DVP DMA description next pointer of this list
- *
- * @return None
- */
-static void dvp_config_dma_desc(dma_descriptor_t *dma_desc, uint32_t desc_size, uint8_t *buffer, uint32_t size, dma_descriptor_t *next)
-{
-    int n = 0;
-
-    ESP_LOGD(TAG, "dma_desc=%p, desc_size=%d, buffer=%p, size=%d, next=%p", dma_desc, (int)desc_size, buffer, (int)size, next);
-
-    while (size) {
-        uint32_t dma_node_size = DVP_CAM_DOWN_ALIGN(MIN(size, desc_size), 4);
-
-        dma_desc[n].dw0.size = dma_node_size;
-        dma_desc[n].dw0.length = 0;
-        dma_desc[n].dw0.err_eof = 0;
-        dma_desc[n].dw0.suc_eof = 0;
-        dma_desc[n].dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
-        dma_desc[n].buffer = buffer;
-        dma_desc[n].next = &dma_desc[n + 1];
-
-        size -= dma_node_size;
-        buffer += dma_node_size;
-        n++;
-    }
-
-    dma_desc[n - 1].dw0.suc_eof = 1;
-    dma_desc[n - 1].next = next;
-}
-
 /**
  * @brief Get DMA valid size in DMA description list
  *
@@ -408,6 +388,127 @@ static uint32_t dvp_get_dma_valid_size(dvp_cam_ctlr_t *dvp, uint32_t next_dma_de
     return size;
 }
 
+/**
+ * @brief Check if DVP DMA can receive current frame into the frame buffer directly
+ *
+ * @param dvp   DVP device handle
+ * @param trans DVP transaction
+ *
+ * @return true if DMA can receive data into the frame buffer directly, or false if not
+ */
+static bool dvp_frame_direct_is_capable(dvp_cam_ctlr_t *dvp, const esp_cam_ctlr_trans_t *trans)
+{
+    const uint8_t *buffer = trans->buffer;
+
+    /* Every DMA block ends with CAM EOF at a multiple of the half size, so the frame must end at one too */
+
+    if (!dvp->zero_copy ||
+            (dvp->fb_size_in_bytes % dvp->dma_buffer_hsize) ||
+            !dvp_dma_buffer_is_capable(buffer, trans->buflen, dvp->fb_size_in_bytes, dvp->frame_align_size)) {
+        return false;
+    }
+
+#if CONFIG_SPIRAM
+    if (esp_ptr_external_ram(buffer)) {
+        return esp_ptr_dma_ext_capable(buffer);
+    }
+#endif
+
+    return esp_ptr_dma_capable(buffer);
+}
+
+#if CONFIG_CAM_CTRL_DVP_ZERO_COPY
+/**
+ * @brief Initialize DVP zero-copy mode, in which DMA receives data into the frame buffer directly.
+ *        If the alignment or memory is not satisfied, zero-copy mode is disabled and DVP only uses
+ *        bounce buffer.
+ *
+ * @param dvp DVP device handle
+ *
+ * @return None
+ */
+static void dvp_frame_direct_init(dvp_cam_ctlr_t *dvp)
+{
+    size_t int_align = 0;
+    size_t ext_align = 0;
+    size_t cache_align = 0;
+
+    if (gdma_get_alignment_constraints(dvp->dma_chan, &int_align, &ext_align) != ESP_OK) {
+        ESP_LOGW(TAG, "failed to get DMA alignment, zero-copy is disabled");
+        return;
+    }
+
+#if CONFIG_SPIRAM
+    if (esp_cache_get_alignment(MALLOC_CAP_SPIRAM, &cache_align) != ESP_OK) {
+        ESP_LOGW(TAG, "failed to get cache alignment, zero-copy is disabled");
+        return;
+    }
+#endif
+
+    /* Every block which ends with CAM EOF must start at an aligned address of frame buffer */
+
+    size_t align_size = MAX(MAX((size_t)4, int_align), MAX(ext_align, cache_align));
+    if (dvp->dma_buffer_hsize % align_size) {
+        ESP_LOGW(TAG, "DMA buffer half size %d is not %d bytes aligned, zero-copy is disabled", (int)dvp->dma_buffer_hsize, (int)align_size);
+        return;
+    }
+
+    size_t frame_desc_size = DVP_CAM_DOWN_ALIGN(DMA_DESCRIPTOR_BUFFER_MAX_SIZE, align_size);
+    size_t frame_desc_cnt = dvp->fb_size_in_bytes / dvp->dma_buffer_hsize * dvp_dma_desc_count(dvp->dma_buffer_hsize, frame_desc_size);
+
+    dvp->frame_desc = heap_caps_aligned_alloc(4, frame_desc_cnt * sizeof(dma_descriptor_t), MALLOC_CAP_DMA);
+    if (!dvp->frame_desc) {
+        ESP_LOGW(TAG, "no mem for CAM DVP frame buffer DMA description, zero-copy is disabled");
+        return;
+    }
+
+    dvp->frame_desc_size = frame_desc_size;
+    dvp->frame_align_size = align_size;
+    dvp->zero_copy = 1;
+}
+#endif
+
+/**
+ * @brief Invalidate cache of the frame buffer which DMA receives data into
+ *
+ * @param dvp    DVP device handle
+ * @param buffer DVP frame buffer pointer
+ *
+ * @return None
+ */
+static void dvp_frame_direct_sync(dvp_cam_ctlr_t *dvp, uint8_t *buffer)
+{
+#if CONFIG_SPIRAM
+    if (esp_ptr_external_ram(buffer)) {
+        esp_cache_msync(buffer, dvp->fb_size_in_bytes, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
+    }
+#endif
+}
+
+/**
+ * @brief Get DMA valid size of the frame which DMA has received into the frame buffer directly
+ *
+ * @param dvp DVP device handle
+ *
+ * @return DMA valid size if all data of the frame is received or 0 if failed
+ */
+static uint32_t dvp_get_frame_direct_valid_size(dvp_cam_ctlr_t *dvp)
+{
+    /**
+     * The same as bounce buffer mode, the EOF of the last block may be later
+     * than V-Sync end signal, so the last block is taken as received.
+     */
+
+    uint32_t size = (dvp->frame_recv_cnt + 1) * dvp->dma_buffer_hsize;
+
+    if (size < dvp->fb_size_in_bytes) {
+        DVP_CAM_ERROR("RX:%d-%d", (int)dvp->fb_size_in_bytes, (int)size);
+        return 0;
+    }
+
+    return dvp->fb_size_in_bytes;
+}
+
 /**
  * @brief DVP receive V-Sync interrupt interrupt callback function
  *
@@ -458,6 +559,13 @@ static IRAM_ATTR bool dvp_receive_isr(gdma_channel_handle_t dma_chan, gdma_event
     BaseType_t need_switch = pdFALSE;
     dvp_cam_ctlr_t *dvp = (dvp_cam_ctlr_t *)user_data;
 
+    /* Data is received into frame buffer directly, so only count blocks and do not wake up DVP task */
+
+    if (dvp->frame_direct) {
+        dvp->frame_recv_cnt++;
+        return false;
+    }
+
     event.type = DVP_CAM_EVENT_RECV_DATA;
     ret = xQueueSendFromISR(dvp->event_queue, &event, &need_switch);
     if (ret == pdPASS) {
@@ -489,6 +597,7 @@ static IRAM_ATTR bool dvp_receive_isr(gdma_channel_handle_t dma_chan, gdma_event
 static esp_err_t dvp_start_capturing(dvp_cam_ctlr_t *ctlr)
 {
     esp_err_t ret;
+    dma_descriptor_t *dma_desc = ctlr->dma_desc;
 
     ret = gdma_reset(ctlr->dma_chan);
     if (ret != ESP_OK) {
@@ -496,7 +605,18 @@ static esp_err_t dvp_start_capturing(dvp_cam_ctlr_t *ctlr)
         return ret;
     }
 
-    ret = gdma_start(ctlr->dma_chan, (intptr_t)ctlr->dma_desc);
+    /* Receive data into frame buffer directly if it is capable, otherwise use bounce buffer */
+
+    ctlr->frame_direct = dvp_frame_direct_is_capable(ctlr, &ctlr->trans);
+    if (ctlr->frame_direct) {
+        dvp_config_frame_dma_desc(ctlr->frame_desc, ctlr->frame_desc_size, ctlr->trans.buffer,
+                                  ctlr->fb_size_in_bytes, ctlr->dma_buffer_hsize);
+        dvp_frame_direct_sync(ctlr, ctlr->trans.buffer);
+        ctlr->frame_recv_cnt = 0;
+        dma_desc = ctlr->frame_desc;
+    }
+
+    ret = gdma_start(ctlr->dma_chan, (intptr_t)dma_desc);
     if (ret != ESP_OK) {
         ESP_EARLY_LOGE(TAG, "failed to start GDMA");
         return ret;
@@ -572,6 +692,7 @@ static esp_err_t dvp_cam_ctlr_del(esp_cam_ctlr_handle_t handle)
 
     /* Step 5: Free memory resource */
 
+    heap_caps_free(ctlr->frame_desc);
     heap_caps_free(ctlr->dma_desc);
     heap_caps_free(ctlr->dma_buffer);
     vQueueDelete(ctlr->event_queue);
@@ -696,7 +817,7 @@ static IRAM_ATTR void dvp_task(void *p)
 
         switch (event.type) {
         case DVP_CAM_EVENT_RECV_DATA: {
-            if (ctlr->dvp_fsm == DVP_CAM_FSM_RXING) {
+            if (ctlr->dvp_fsm == DVP_CAM_FSM_RXING && !ctlr->frame_direct) {
                 size_t frame_size = ctlr->dma_buffer_hsize;
 
                 /* Calculate received data size and check if frame left space is enough */
@@ -755,7 +876,12 @@ static IRAM_ATTR void dvp_task(void *p)
                     frame_size = trans->buflen - trans->received_size;
                 }
 
-                if ((trans->received_size + frame_size) <= trans->buflen) {
+                if (ctlr->frame_direct) {
+                    /* Data is in frame buffer already, so only check the size and sync cache */
+
+                    trans->received_size = dvp_get_frame_direct_valid_size(ctlr);
+                    dvp_frame_direct_sync(ctlr, trans->buffer);
+                } else if ((trans->received_size + frame_size) <= trans->buflen) {
                     /* Decode received data and update receive data */
 
                     memcpy(trans->buffer + trans->received_size, DVP_CAM_CUR_BUF(ctlr), frame_size);
@@ -771,37 +897,35 @@ static IRAM_ATTR void dvp_task(void *p)
                     }
                 } else {
                     DVP_CAM_ERROR("RX-SV OVF");
+                    trans->received_size = 0;
                 }
 
-                if (trans->received_size) {
-                    portENTER_CRITICAL(&ctlr->spinlock);
-                    /* Use spinlock to protect the critical section from concurrent ISR access */
+                /**
+                 * A broken frame is finished with 0 size, so that the user can count it as a
+                 * dropped frame and put the buffer back.
+                 */
 
-                    ctlr->cbs.on_trans_finished(&ctlr->base, trans, ctlr->cbs_user_data);
-                    portEXIT_CRITICAL(&ctlr->spinlock);
-
-                    trans->buffer = NULL;
-                    portENTER_CRITICAL(&ctlr->spinlock);
-                    /* Use spinlock to protect the critical section from concurrent ISR access */
+                portENTER_CRITICAL(&ctlr->spinlock);
+                /* Use spinlock to protect the critical section from concurrent ISR access */
 
-                    ctlr->cbs.on_get_new_trans(&(ctlr->base), trans, ctlr->cbs_user_data);
-                    portEXIT_CRITICAL(&ctlr->spinlock);
-                    if (trans->buffer && trans->buflen > 0) {
-                        trans->received_size = 0;
+                ctlr->cbs.on_trans_finished(&ctlr->base, trans, ctlr->cbs_user_data);
+                portEXIT_CRITICAL(&ctlr->spinlock);
 
-                        ctlr->dma_desc_index = 0;
-                        ctlr->dvp_fsm = DVP_CAM_FSM_RXING;
+                trans->buffer = NULL;
+                portENTER_CRITICAL(&ctlr->spinlock);
+                /* Use spinlock to protect the critical section from concurrent ISR access */
 
-                        dvp_start_capturing(ctlr);
-                    } else {
-                        ctlr->dvp_fsm = DVP_CAM_FSM_STARTED;
-                    }
-                } else {
+                ctlr->cbs.on_get_new_trans(&(ctlr->base), trans, ctlr->cbs_user_data);
+                portEXIT_CRITICAL(&ctlr->spinlock);
+                if (trans->buffer && trans->buflen > 0) {
                     trans->received_size = 0;
 
                     ctlr->dma_desc_index = 0;
                     ctlr->dvp_fsm = DVP_CAM_FSM_RXING;
+
                     dvp_start_capturing(ctlr);
+                } else {
+                    ctlr->dvp_fsm = DVP_CAM_FSM_STARTED;
                 }
 
                 gpio_intr_enable(ctlr->vsync_pin);
@@ -901,9 +1025,17 @@ esp_err_t esp_cam_new_dvp_ctlr_ext(const esp_cam_ctlr_dvp_config_t *config, esp_
     };
     cam_hal_init_ext(&ctlr->hal, &hal_config);
 
-    ESP_GOTO_ON_ERROR(dvp_dma_init(&ctlr->dma_chan), fail4, TAG, "failed to initialize CAM DVP DMA");
+    ESP_GOTO_ON_ERROR(dvp_dma_init(&ctlr->dma_chan, DVP_CAM_DMA_ACCESS_EXT_MEM && !config->pic_format_jpeg), fail4, TAG, "failed to initialize CAM DVP DMA");
     ESP_GOTO_ON_ERROR(gdma_get_channel_id(ctlr->dma_chan, &ctlr->dma_chan_id), fail5, TAG, "failed to get DMA channel ID");
 
+#if CONFIG_CAM_CTRL_DVP_ZERO_COPY
+    /* JPEG frame size is random value, so it is always received by bounce buffer */
+
+    if (!config->pic_format_jpeg) {
+        dvp_frame_direct_init(ctlr);
+    }
+#endif
+
     gdma_rx_event_callbacks_t cbs = {
         .on_recv_eof = dvp_receive_isr
     };
@@ -935,6 +1067,7 @@ esp_err_t esp_cam_new_dvp_ctlr_ext(const esp_cam_ctlr_dvp_config_t *config, esp_
 fail6:
     vQueueDelete(ctlr->event_queue);
 fail5:
+    heap_caps_free(ctlr->frame_desc);
     dvp_dma_deinit(ctlr->dma_chan);
 fail4:
     cam_hal_deinit(&ctlr->hal);
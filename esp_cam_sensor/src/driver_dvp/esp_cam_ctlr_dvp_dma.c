@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stddef.h>
+#include <sys/param.h>
+#include "esp_log.h"
+#include "esp_cam_ctlr_dvp_dma.h"
+
+#define DVP_CAM_DOWN_ALIGN(v, a)            ((v) & (~((a) - 1)))
+
+static const char *TAG = "dvp_dma";
+
+uint32_t dvp_dma_desc_count(uint32_t size, uint32_t desc_size)
+{
+    return (size + desc_size - 1) / desc_size;
+}
+
+void dvp_config_dma_desc(dma_descriptor_t *dma_desc, uint32_t desc_size, uint8_t *buffer, uint32_t size, dma_descriptor_t *next)
+{
+    int n = 0;
+
+    ESP_LOGD(TAG, "dma_desc=%p, desc_size=%d, buffer=%p, size=%d, next=%p", dma_desc, (int)desc_size, buffer, (int)size, next);
+
+    while (size) {
+        uint32_t dma_node_size = DVP_CAM_DOWN_ALIGN(MIN(size, desc_size), 4);
+
+        dma_desc[n].dw0.size = dma_node_size;
+        dma_desc[n].dw0.length = 0;
+        dma_desc[n].dw0.err_eof = 0;
+        dma_desc[n].dw0.suc_eof = 0;
+        dma_desc[n].dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+        dma_desc[n].buffer = buffer;
+        dma_desc[n].next = &dma_desc[n + 1];
+
+        size -= dma_node_size;
+        buffer += dma_node_size;
+        n++;
+    }
+
+    dma_desc[n - 1].dw0.suc_eof = 1;
+    dma_desc[n - 1].next = next;
+}
+
+uint32_t dvp_config_frame_dma_desc(dma_descriptor_t *dma_desc, uint32_t desc_size, uint8_t *buffer, uint32_t size, uint32_t block_size)
+{
+    uint32_t count = 0;
+    uint32_t block_cnt = dvp_dma_desc_count(block_size, desc_size);
+
+    for (uint32_t offset = 0; offset < size; offset += block_size) {
+        dma_descriptor_t *next = (offset + block_size) < size ? &dma_desc[count + block_cnt] : NULL;
+
+        dvp_config_dma_desc(&dma_desc[count], desc_size, buffer + offset, block_size, next);
+        count += block_cnt;
+    }
+
+    return count;
+}
+
+bool dvp_dma_buffer_is_capable(const uint8_t *buffer, uint32_t buflen, uint32_t size, uint32_t align)
+{
+    if (!buffer || !size || (buflen < size)) {
+        return false;
+    }
+
+    return !((uintptr_t)buffer & (align - 1)) && !(size & (align - 1));
+}
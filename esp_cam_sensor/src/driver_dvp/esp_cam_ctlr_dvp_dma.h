@@ -0,0 +1,76 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal/dma_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * DVP DMA description list builder.
+ *
+ * These functions only fill DMA description nodes and do not access GDMA or CAM hardware,
+ * so that they can be built and tested on the host.
+ */
+
+/**
+ * @brief Get DVP DMA description node count of a list
+ *
+ * @param size      DMA buffer size
+ * @param desc_size DVP DMA description node max size
+ *
+ * @return DMA description node count
+ */
+uint32_t dvp_dma_desc_count(uint32_t size, uint32_t desc_size);
+
+/**
+ * @brief Config DVP DMA description list
+ *
+ * @param dma_desc  DVP DMA description pointer
+ * @param desc_size DVP DMA description node max size
+ * @param buffer    DVP receive buffer pointer
+ * @param size      DMA buffer size, it must be 4 bytes aligned
+ * @param next      DVP DMA description next pointer of this list
+ *
+ * @return None
+ */
+void dvp_config_dma_desc(dma_descriptor_t *dma_desc, uint32_t desc_size, uint8_t *buffer, uint32_t size, dma_descriptor_t *next);
+
+/**
+ * @brief Config DVP DMA description list of one frame buffer, the buffer is split into blocks
+ *        of "block_size" and each block ends at the end of a DMA description node, so that
+ *        the CAM EOF of every block does not drop the left space of a node.
+ *
+ * @param dma_desc   DVP DMA description pointer, its count must be not less than "size / block_size" * dvp_dma_desc_count(block_size, desc_size)
+ * @param desc_size  DVP DMA description node max size
+ * @param buffer     DVP frame buffer pointer
+ * @param size       DVP frame buffer size, it must be multiple of "block_size"
+ * @param block_size DVP CAM EOF block size
+ *
+ * @return Used DMA description node count
+ */
+uint32_t dvp_config_frame_dma_desc(dma_descriptor_t *dma_desc, uint32_t desc_size, uint8_t *buffer, uint32_t size, uint32_t block_size);
+
+/**
+ * @brief Check if DVP DMA can receive a frame directly into the buffer
+ *
+ * @param buffer DVP frame buffer pointer
+ * @param buflen DVP frame buffer length
+ * @param size   DVP frame size
+ * @param align  Buffer address and frame size align size
+ *
+ * @return true if DMA can receive the frame into the buffer directly, or false if not
+ */
+bool dvp_dma_buffer_is_capable(const uint8_t *buffer, uint32_t buflen, uint32_t size, uint32_t align);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,13 +1,53 @@
 /*
- * SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <sys/lock.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_cam_sensor.h"
+#include "esp_cam_sensor_regtab.h"
+
+#define REGTAB_CHUNK_SIZE 64
 
 static const char *TAG = "cam_sensor";
 
+static esp_err_t write_group_hold_regs(esp_cam_sensor_device_t *dev, const esp_sccb_reg_t *regs, size_t num)
+{
+    esp_err_t ret = ESP_OK;
+
+    /* Not a burst, so that group hold registers are queued with control registers if SCCB writes are deferred */
+    for (size_t i = 0; i < num && ret == ESP_OK; i++) {
+        if (dev->group_hold->flags & ESP_SCCB_BURST_FLAG_ADDR_16BIT) {
+            ret = esp_sccb_transmit_reg_a16v8(dev->sccb_handle, regs[i].reg, regs[i].val);
+        } else {
+            ret = esp_sccb_transmit_reg_a8v8(dev->sccb_handle, regs[i].reg, regs[i].val);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Set exposure and gain by the driver's group exposure and gain operation between group hold begin and commit
+ */
+static esp_err_t set_group_exp_gain(esp_cam_sensor_device_t *dev, const void *arg, size_t size)
+{
+    esp_err_t ret;
+    esp_err_t commit_ret;
+
+    ESP_RETURN_ON_ERROR(esp_cam_sensor_group_hold_begin(dev), TAG, "failed to begin group hold");
+
+    ret = dev->ops->set_para_value(dev, ESP_CAM_SENSOR_GROUP_EXP_GAIN, arg, size);
+
+    /* Always commit, so that the sensor does not keep recording */
+    commit_ret = esp_cam_sensor_group_hold_commit(dev);
+
+    return ret != ESP_OK ? ret : commit_ret;
+}
+
 esp_err_t esp_cam_sensor_query_para_desc(esp_cam_sensor_device_t *dev, esp_cam_sensor_param_desc_t *qdesc)
 {
     ESP_RETURN_ON_FALSE(dev && qdesc, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
@@ -29,6 +69,10 @@ esp_err_t esp_cam_sensor_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
     ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     ESP_RETURN_ON_FALSE(dev->ops->set_para_value, ESP_ERR_NOT_SUPPORTED, TAG, "unsupported operation");
 
+    if (id == ESP_CAM_SENSOR_GROUP_EXP_GAIN && dev->group_hold) {
+        return set_group_exp_gain(dev, arg, size);
+    }
+
     return dev->ops->set_para_value(dev, id, arg, size);
 }
 
@@ -69,6 +113,86 @@ esp_err_t esp_cam_sensor_ioctl(esp_cam_sensor_device_t *dev, uint32_t cmd, void
     return dev->ops->priv_ioctl(dev, cmd, arg);
 }
 
+esp_err_t esp_cam_sensor_standby(esp_cam_sensor_device_t *dev)
+{
+    esp_err_t ret;
+    int enable = 1;
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    /*
+     * Drivers which do not support standby either ignore the command or reject it as an unknown
+     * command with ESP_ERR_INVALID_ARG or ESP_ERR_NOT_SUPPORTED, and leave the flag cleared.
+     */
+    ret = dev->ops->priv_ioctl(dev, ESP_CAM_SENSOR_IOC_S_SUSPEND, &enable);
+    if (!dev->standby_status && (ret == ESP_OK || ret == ESP_ERR_INVALID_ARG || ret == ESP_ERR_NOT_SUPPORTED)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "failed to enter standby");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_cam_sensor_resume(esp_cam_sensor_device_t *dev)
+{
+    int enable = 0;
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(dev->standby_status, ESP_ERR_INVALID_STATE, TAG, "sensor is not in standby");
+
+    return dev->ops->priv_ioctl(dev, ESP_CAM_SENSOR_IOC_S_SUSPEND, &enable);
+}
+
+esp_err_t esp_cam_sensor_group_hold_begin(esp_cam_sensor_device_t *dev)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    if (!dev->group_hold) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    _lock_acquire_recursive(&dev->group_hold_lock);
+    if (dev->group_hold_depth == 0) {
+        ret = write_group_hold_regs(dev, dev->group_hold->begin_regs, dev->group_hold->begin_num);
+    }
+
+    if (ret == ESP_OK) {
+        dev->group_hold_depth++;
+    } else {
+        ESP_LOGE(TAG, "failed to write group hold begin regs");
+        _lock_release_recursive(&dev->group_hold_lock);
+    }
+
+    return ret;
+}
+
+esp_err_t esp_cam_sensor_group_hold_commit(esp_cam_sensor_device_t *dev)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    /* Only the task which holds the lock may have started the group */
+    _lock_acquire_recursive(&dev->group_hold_lock);
+    if (!dev->group_hold_depth) {
+        _lock_release_recursive(&dev->group_hold_lock);
+        ESP_LOGE(TAG, "group hold is not started");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    dev->group_hold_depth--;
+    if (dev->group_hold_depth == 0) {
+        ret = write_group_hold_regs(dev, dev->group_hold->commit_regs, dev->group_hold->commit_num);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to write group hold commit regs");
+        }
+    }
+
+    /* Release the lock taken by this call and the one taken by the matching begin */
+    _lock_release_recursive(&dev->group_hold_lock);
+    _lock_release_recursive(&dev->group_hold_lock);
+
+    return ret;
+}
+
 const char *esp_cam_sensor_get_name(esp_cam_sensor_device_t *dev)
 {
     ESP_RETURN_ON_FALSE(dev, NULL, TAG, "invalid argument");
@@ -76,9 +200,102 @@ const char *esp_cam_sensor_get_name(esp_cam_sensor_device_t *dev)
     return dev->name;
 }
 
+esp_err_t esp_cam_sensor_write_reg_table(esp_sccb_io_handle_t sccb_handle, const esp_sccb_reg_t *regs, uint16_t reg_end, uint16_t reg_delay, uint32_t flags)
+{
+    size_t i = 0;
+    size_t start = 0;
+    ESP_RETURN_ON_FALSE(sccb_handle && regs, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    while (1) {
+        if ((regs[i].reg != reg_end) && (regs[i].reg != reg_delay)) {
+            i++;
+            continue;
+        }
+
+        ESP_RETURN_ON_ERROR(esp_sccb_transmit_burst(sccb_handle, &regs[start], i - start, flags), TAG, "failed to write regs");
+        if (regs[i].reg == reg_end) {
+            break;
+        }
+
+        vTaskDelay(regs[i].val > portTICK_PERIOD_MS ? regs[i].val / portTICK_PERIOD_MS : 1);
+        start = ++i;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_cam_sensor_write_regtab(esp_sccb_io_handle_t sccb_handle, const uint8_t *tab, uint32_t flags)
+{
+    size_t num = 0;
+    esp_sccb_reg_t regs[REGTAB_CHUNK_SIZE];
+    ESP_RETURN_ON_FALSE(sccb_handle && tab, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    while (1) {
+        uint8_t op = *tab++;
+
+        if (op < ESP_CAM_SENSOR_REGTAB_DELAY) {
+            uint16_t reg = *tab++;
+            size_t run = op + 1;
+
+            if (flags & ESP_SCCB_BURST_FLAG_ADDR_16BIT) {
+                reg = (reg << 8) | *tab++;
+            }
+
+            /* Registers are collected until a delay or the end, so that burst transmit can merge runs */
+            for (size_t i = 0; i < run; i++) {
+                if (num == REGTAB_CHUNK_SIZE) {
+                    ESP_RETURN_ON_ERROR(esp_sccb_transmit_burst(sccb_handle, regs, num, flags), TAG, "failed to write regs");
+                    num = 0;
+                }
+
+                regs[num].reg = reg++;
+                regs[num].val = *tab++;
+                num++;
+            }
+
+            continue;
+        }
+
+        ESP_RETURN_ON_FALSE(op == ESP_CAM_SENSOR_REGTAB_DELAY || op == ESP_CAM_SENSOR_REGTAB_END,
+                            ESP_ERR_INVALID_ARG, TAG, "invalid opcode 0x%x", op);
+
+        if (num) {
+            ESP_RETURN_ON_ERROR(esp_sccb_transmit_burst(sccb_handle, regs, num, flags), TAG, "failed to write regs");
+            num = 0;
+        }
+
+        if (op == ESP_CAM_SENSOR_REGTAB_END) {
+            break;
+        }
+
+        uint8_t delay_ms = *tab++;
+        vTaskDelay(delay_ms > portTICK_PERIOD_MS ? delay_ms / portTICK_PERIOD_MS : 1);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_cam_sensor_write_regtab_diff(esp_sccb_io_handle_t sccb_handle, const esp_cam_sensor_regtab_diff_t *diffs,
+                                          const uint8_t *cur_tab, const uint8_t *tab, uint32_t flags)
+{
+    ESP_RETURN_ON_FALSE(sccb_handle && diffs && cur_tab && tab, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    for (; diffs->diff_tab; diffs++) {
+        if (diffs->cur_tab == cur_tab && diffs->tab == tab) {
+            return esp_cam_sensor_write_regtab(sccb_handle, diffs->diff_tab, flags);
+        }
+    }
+
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
 esp_err_t esp_cam_sensor_del_dev(esp_cam_sensor_device_t *dev)
 {
     ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     ESP_RETURN_ON_FALSE(dev->ops->del, ESP_ERR_NOT_SUPPORTED, TAG, "unsupported operation");
+
+    /* The lock is created by the first group hold begin, and must be closed before the driver frees the device */
+    _lock_close_recursive(&dev->group_hold_lock);
+
     return dev->ops->del(dev);
 }
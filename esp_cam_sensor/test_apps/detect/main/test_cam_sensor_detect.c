@@ -6,11 +6,14 @@
 
 #include <esp_log.h>
 #include <esp_system.h>
+#include <esp_timer.h>
+#include <inttypes.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "esp_sccb_intf.h"
 #include "esp_sccb_i2c.h"
+#include "esp_sccb_sim.h"
 #include "esp_cam_sensor.h"
 
 #include "unity.h"
@@ -32,9 +35,14 @@
 #elif CONFIG_CAMERA_GC0308
 #include "gc0308.h"
 #define SCCB0_CAM_DEVICE_ADDR GC0308_SCCB_ADDR
+/* Chip ID registers for detect test on SCCB simulator */
+#define TEST_CAM_SIM_ADDR_BITS  8
+#define TEST_CAM_SIM_ID_REGS    {{0x00, GC0308_PID}}
 #elif CONFIG_CAMERA_GC2145
 #include "gc2145.h"
 #define SCCB0_CAM_DEVICE_ADDR GC2145_SCCB_ADDR
+#define TEST_CAM_SIM_ADDR_BITS  8
+#define TEST_CAM_SIM_ID_REGS    {{0xf0, GC2145_PID >> 8}, {0xf1, GC2145_PID & 0xff}}
 #elif CONFIG_CAMERA_LT6911
 #include "lt6911.h"
 #define SCCB0_CAM_DEVICE_ADDR LT6911_SCCB_ADDR
@@ -50,6 +58,9 @@
 #elif CONFIG_CAMERA_OV2640
 #include "ov2640.h"
 #define SCCB0_CAM_DEVICE_ADDR OV2640_SCCB_ADDR
+/* The simulator has no register banks, the PID register is the one of the sensor bank */
+#define TEST_CAM_SIM_ADDR_BITS  8
+#define TEST_CAM_SIM_ID_REGS    {{0x0a, OV2640_PID}}
 #elif CONFIG_CAMERA_OV2710
 #include "ov2710.h"
 #define SCCB0_CAM_DEVICE_ADDR OV2710_SCCB_ADDR
@@ -83,6 +94,12 @@
 #elif CONFIG_CAMERA_SC2336
 #include "sc2336.h"
 #define SCCB0_CAM_DEVICE_ADDR SC2336_SCCB_ADDR
+/* Register table markers of "sc2336_regs.h", the driver writes its tables by esp_cam_sensor_write_reg_table */
+#define TEST_CAM_REG_END        0xffff
+#define TEST_CAM_REG_DELAY      0xfffe
+#define TEST_CAM_BURST_FLAGS    (ESP_SCCB_BURST_FLAG_ADDR_16BIT | ESP_SCCB_BURST_FLAG_AUTO_INC)
+#define TEST_CAM_SIM_ADDR_BITS  16
+#define TEST_CAM_SIM_ID_REGS    {{0x3107, SC2336_PID >> 8}, {0x3108, SC2336_PID & 0xff}}
 #elif CONFIG_CAMERA_SP0A39
 #include "sp0a39.h"
 #define SCCB0_CAM_DEVICE_ADDR SP0A39_SCCB_ADDR
@@ -128,28 +145,8 @@ void tearDown(void)
     check_leak(before_free_32bit, after_free_32bit, "32BIT");
 }
 
-TEST_CASE("Camera sensor detect test", "[video]")
+static esp_cam_sensor_device_t *test_sensor_detect(esp_sccb_io_handle_t sccb_io)
 {
-    i2c_master_bus_config_t i2c_bus_config = {
-        .clk_source = I2C_CLK_SRC_DEFAULT,
-        .i2c_port = SCCB0_PORT_NUM,
-        .scl_io_num = SCCB0_SCL,
-        .sda_io_num = SCCB0_SDA,
-        .glitch_ignore_cnt = 7,
-    };
-    i2c_master_bus_handle_t bus_handle;
-    esp_sccb_io_handle_t sccb_io;
-
-    TEST_ESP_OK(i2c_new_master_bus(&i2c_bus_config, &bus_handle));
-
-    sccb_i2c_config_t sccb_config = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = SCCB0_CAM_DEVICE_ADDR,
-        .scl_speed_hz = SCCB0_FREQ_HZ,
-    };
-
-    TEST_ESP_OK(sccb_new_i2c_io(bus_handle, &sccb_config, &sccb_io));
-
     esp_cam_sensor_config_t cam0_config = {
         .sccb_handle = sccb_io,
         .reset_pin = -1,
@@ -209,12 +206,121 @@ TEST_CASE("Camera sensor detect test", "[video]")
     cam0 = pivariety_detect(&cam0_config);
 #endif
 
+    return cam0;
+}
+
+static void test_sccb_init(i2c_master_bus_handle_t *bus_handle, esp_sccb_io_handle_t *sccb_io)
+{
+    i2c_master_bus_config_t i2c_bus_config = {
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .i2c_port = SCCB0_PORT_NUM,
+        .scl_io_num = SCCB0_SCL,
+        .sda_io_num = SCCB0_SDA,
+        .glitch_ignore_cnt = 7,
+    };
+    sccb_i2c_config_t sccb_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = SCCB0_CAM_DEVICE_ADDR,
+        .scl_speed_hz = SCCB0_FREQ_HZ,
+    };
+
+    TEST_ESP_OK(i2c_new_master_bus(&i2c_bus_config, bus_handle));
+    TEST_ESP_OK(sccb_new_i2c_io(*bus_handle, &sccb_config, sccb_io));
+}
+
+static void test_sccb_deinit(i2c_master_bus_handle_t bus_handle, esp_sccb_io_handle_t sccb_io)
+{
+    TEST_ESP_OK(esp_sccb_del_i2c_io(sccb_io));
+    TEST_ESP_OK(i2c_del_master_bus(bus_handle));
+}
+
+TEST_CASE("Camera sensor detect test", "[video]")
+{
+    i2c_master_bus_handle_t bus_handle;
+    esp_sccb_io_handle_t sccb_io;
+
+    test_sccb_init(&bus_handle, &sccb_io);
+
+    esp_cam_sensor_device_t *cam0 = test_sensor_detect(sccb_io);
+    TEST_ASSERT_MESSAGE(cam0 != NULL, "detect fail");
+    TEST_ESP_OK(esp_cam_sensor_del_dev(cam0));
+
+    test_sccb_deinit(bus_handle, sccb_io);
+}
+
+/* Runs the real sensor driver without a camera, only for sensors whose chip ID registers are listed above */
+#if CONFIG_ESP_SCCB_ENABLE_SIM_IO && defined(TEST_CAM_SIM_ID_REGS)
+TEST_CASE("Camera sensor detect test on SCCB simulator", "[video][sim]")
+{
+    esp_sccb_io_handle_t sccb_io;
+    const esp_sccb_reg_t id_regs[] = TEST_CAM_SIM_ID_REGS;
+    sccb_sim_config_t sim_config = {
+        .device_address = SCCB0_CAM_DEVICE_ADDR,
+        .scl_speed_hz = SCCB0_FREQ_HZ,
+        .addr_bits_width = TEST_CAM_SIM_ADDR_BITS,
+        .regs = id_regs,
+        .reg_num = sizeof(id_regs) / sizeof(id_regs[0]),
+    };
+
+    TEST_ESP_OK(sccb_new_sim_io(&sim_config, &sccb_io));
+
+    esp_cam_sensor_device_t *cam0 = test_sensor_detect(sccb_io);
     TEST_ASSERT_MESSAGE(cam0 != NULL, "detect fail");
     TEST_ESP_OK(esp_cam_sensor_del_dev(cam0));
+
     TEST_ESP_OK(esp_sccb_del_i2c_io(sccb_io));
+}
+#endif
 
-    TEST_ESP_OK(i2c_del_master_bus(bus_handle));
+/* Only for sensors whose register tables are written by esp_cam_sensor_write_reg_table */
+#ifdef TEST_CAM_REG_END
+TEST_CASE("Camera sensor register table burst write benchmark", "[video][bench]")
+{
+    i2c_master_bus_handle_t bus_handle;
+    esp_sccb_io_handle_t sccb_io;
+
+    test_sccb_init(&bus_handle, &sccb_io);
+
+    esp_cam_sensor_device_t *cam0 = test_sensor_detect(sccb_io);
+    TEST_ASSERT_MESSAGE(cam0 != NULL, "detect fail");
+
+    esp_cam_sensor_format_t format;
+    TEST_ESP_OK(esp_cam_sensor_set_format(cam0, NULL));
+    TEST_ESP_OK(esp_cam_sensor_get_format(cam0, &format));
+    if (format.regs_type != ESP_CAM_SENSOR_REGS_ARRAY) {
+        TEST_ESP_OK(esp_cam_sensor_del_dev(cam0));
+        test_sccb_deinit(bus_handle, sccb_io);
+        TEST_IGNORE_MESSAGE("format register table is not a register array");
+    }
+    const esp_sccb_reg_t *regs = format.regs;
+
+    /* Baseline: one SCCB transaction per register */
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; regs[i].reg != TEST_CAM_REG_END; i++) {
+        if (regs[i].reg == TEST_CAM_REG_DELAY) {
+            vTaskDelay(regs[i].val > portTICK_PERIOD_MS ? regs[i].val / portTICK_PERIOD_MS : 1);
+        } else if (TEST_CAM_BURST_FLAGS & ESP_SCCB_BURST_FLAG_ADDR_16BIT) {
+            TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(sccb_io, regs[i].reg, regs[i].val));
+        } else {
+            TEST_ESP_OK(esp_sccb_transmit_reg_a8v8(sccb_io, regs[i].reg, regs[i].val));
+        }
+    }
+    int64_t single_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    TEST_ESP_OK(esp_cam_sensor_write_reg_table(sccb_io, regs, TEST_CAM_REG_END, TEST_CAM_REG_DELAY, TEST_CAM_BURST_FLAGS));
+    int64_t burst_us = esp_timer_get_time() - start;
+
+    printf("%s %d registers: single write %" PRId64 " us, burst write %" PRId64 " us\n",
+           format.name, format.regs_size, single_us, burst_us);
+    TEST_ASSERT_LESS_THAN_INT32((int32_t)single_us, (int32_t)burst_us);
+
+    TEST_ESP_OK(esp_cam_sensor_del_dev(cam0));
+
+    test_sccb_deinit(bus_handle, sccb_io);
 }
+#endif
 
 void app_main(void)
 {
@@ -0,0 +1,212 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+#include "unity.h"
+
+#include "esp_cam_ctlr_dvp_dma.h"
+
+#define TEST_DESC_SIZE              (DMA_DESCRIPTOR_BUFFER_MAX_SIZE & ~3)
+#define TEST_ALIGN_SIZE             32
+#define TEST_DESC_ALIGN_SIZE        (DMA_DESCRIPTOR_BUFFER_MAX_SIZE & ~(TEST_ALIGN_SIZE - 1))
+
+/* 640x480 RGB565 frame, and DMA buffer half size is the same as the DVP driver calculates */
+#define TEST_FRAME_SIZE             (640 * 480 * 2)
+#define TEST_BLOCK_SIZE             15360
+#define TEST_GUARD_SIZE             64
+#define TEST_GUARD_VALUE            0xa5
+
+#define TEST_DESC_NUM               (TEST_FRAME_SIZE / TEST_BLOCK_SIZE * ((TEST_BLOCK_SIZE + TEST_DESC_ALIGN_SIZE - 1) / TEST_DESC_ALIGN_SIZE))
+
+/**
+ * @brief Mocked GDMA RX channel, it walks the DMA description list as hardware does.
+ */
+typedef struct test_gdma {
+    dma_descriptor_t *desc;                 /*!< Current DMA description node */
+    uint32_t offset;                        /*!< Received data size of current node */
+    uint32_t eof_size;                      /*!< CAM EOF block size, the same as cam_rec_data_bytelen + 1 */
+    uint32_t block_offset;                  /*!< Received data size of current block */
+    uint32_t eof_count;                     /*!< Count of "on_recv_eof" events */
+    uint32_t recv_size;                     /*!< Total received data size */
+    bool desc_error;                        /*!< No DMA description node to receive data */
+} test_gdma_t;
+
+static uint8_t s_frame[TEST_FRAME_SIZE + TEST_GUARD_SIZE] __attribute__((aligned(TEST_ALIGN_SIZE)));
+static uint8_t s_bounce[TEST_BLOCK_SIZE * 2] __attribute__((aligned(TEST_ALIGN_SIZE)));
+static dma_descriptor_t s_desc[TEST_DESC_NUM];
+
+static uint8_t test_pattern(uint32_t i)
+{
+    return (uint8_t)((i * 7) ^ (i >> 8));
+}
+
+static void test_gdma_start(test_gdma_t *gdma, dma_descriptor_t *desc, uint32_t eof_size)
+{
+    memset(gdma, 0, sizeof(test_gdma_t));
+    gdma->desc = desc;
+    gdma->eof_size = eof_size;
+}
+
+/**
+ * @brief Close current DMA description node and move to next one
+ */
+static void test_gdma_next_desc(test_gdma_t *gdma, bool eof)
+{
+    gdma->desc->dw0.length = gdma->offset;
+    gdma->desc->dw0.suc_eof = eof;
+    gdma->desc->dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_CPU;
+    gdma->desc = gdma->desc->next;
+    gdma->offset = 0;
+}
+
+/**
+ * @brief Receive data from CAM, CAM triggers EOF every "eof_size" bytes, and the left space of
+ *        current node is dropped when EOF triggers.
+ */
+static void test_gdma_recv(test_gdma_t *gdma, uint32_t start, uint32_t size)
+{
+    for (uint32_t i = start; i < start + size; i++) {
+        if (!gdma->desc) {
+            gdma->desc_error = true;
+            return;
+        }
+
+        ((uint8_t *)gdma->desc->buffer)[gdma->offset++] = test_pattern(i);
+        gdma->block_offset++;
+        gdma->recv_size++;
+
+        if (gdma->block_offset == gdma->eof_size) {
+            test_gdma_next_desc(gdma, true);
+            gdma->block_offset = 0;
+            gdma->eof_count++;
+        } else if (gdma->offset == gdma->desc->dw0.size) {
+            test_gdma_next_desc(gdma, false);
+        }
+    }
+}
+
+TEST_CASE("DMA description list", "[dvp_dma]")
+{
+    uint32_t size = 10000;
+    dma_descriptor_t next;
+    uint32_t count = dvp_dma_desc_count(size, TEST_DESC_SIZE);
+
+    TEST_ASSERT_EQUAL_UINT32(3, count);
+
+    dvp_config_dma_desc(s_desc, TEST_DESC_SIZE, s_bounce, size, &next);
+
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_PTR(s_bounce + offset, s_desc[i].buffer);
+        TEST_ASSERT_EQUAL_UINT32(DMA_DESCRIPTOR_BUFFER_OWNER_DMA, s_desc[i].dw0.owner);
+        TEST_ASSERT_EQUAL_UINT32(0, s_desc[i].dw0.length);
+        TEST_ASSERT_EQUAL_UINT32(0, s_desc[i].dw0.size % 4);
+        TEST_ASSERT_EQUAL_UINT32(i == count - 1, s_desc[i].dw0.suc_eof);
+        TEST_ASSERT_EQUAL_PTR(i == count - 1 ? &next : &s_desc[i + 1], s_desc[i].next);
+        offset += s_desc[i].dw0.size;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(size, offset);
+}
+
+TEST_CASE("Bounce buffer DMA description ring", "[dvp_dma]")
+{
+    test_gdma_t gdma;
+    uint32_t hcnt = dvp_dma_desc_count(TEST_BLOCK_SIZE, TEST_DESC_SIZE);
+
+    dvp_config_dma_desc(s_desc, TEST_DESC_SIZE, s_bounce, TEST_BLOCK_SIZE, &s_desc[hcnt]);
+    dvp_config_dma_desc(&s_desc[hcnt], TEST_DESC_SIZE, &s_bounce[TEST_BLOCK_SIZE], TEST_BLOCK_SIZE, s_desc);
+
+    /* Receive 3 blocks, the 3rd block overwrites the 1st half of bounce buffer */
+
+    test_gdma_start(&gdma, s_desc, TEST_BLOCK_SIZE);
+    test_gdma_recv(&gdma, 0, TEST_BLOCK_SIZE * 3);
+
+    TEST_ASSERT_FALSE(gdma.desc_error);
+    TEST_ASSERT_EQUAL_UINT32(3, gdma.eof_count);
+    TEST_ASSERT_EQUAL_PTR(&s_desc[hcnt], gdma.desc);
+
+    for (uint32_t i = 0; i < TEST_BLOCK_SIZE; i++) {
+        TEST_ASSERT_EQUAL_HEX8(test_pattern(TEST_BLOCK_SIZE * 2 + i), s_bounce[i]);
+        TEST_ASSERT_EQUAL_HEX8(test_pattern(TEST_BLOCK_SIZE + i), s_bounce[TEST_BLOCK_SIZE + i]);
+    }
+}
+
+TEST_CASE("Frame buffer DMA description list", "[dvp_dma]")
+{
+    test_gdma_t gdma;
+
+    memset(s_frame, TEST_GUARD_VALUE, sizeof(s_frame));
+
+    uint32_t count = dvp_config_frame_dma_desc(s_desc, TEST_DESC_ALIGN_SIZE, s_frame, TEST_FRAME_SIZE, TEST_BLOCK_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(TEST_DESC_NUM, count);
+    TEST_ASSERT_NULL(s_desc[count - 1].next);
+
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)s_desc[i].buffer % TEST_ALIGN_SIZE);
+    }
+
+    test_gdma_start(&gdma, s_desc, TEST_BLOCK_SIZE);
+    test_gdma_recv(&gdma, 0, TEST_FRAME_SIZE);
+
+    /* Every CAM EOF ends at the end of a node, so no space is dropped and the frame is continuous */
+
+    TEST_ASSERT_FALSE(gdma.desc_error);
+    TEST_ASSERT_NULL(gdma.desc);
+    TEST_ASSERT_EQUAL_UINT32(TEST_FRAME_SIZE / TEST_BLOCK_SIZE, gdma.eof_count);
+
+    for (uint32_t i = 0; i < TEST_FRAME_SIZE; i++) {
+        TEST_ASSERT_EQUAL_HEX8(test_pattern(i), s_frame[i]);
+    }
+
+    for (uint32_t i = TEST_FRAME_SIZE; i < sizeof(s_frame); i++) {
+        TEST_ASSERT_EQUAL_HEX8(TEST_GUARD_VALUE, s_frame[i]);
+    }
+}
+
+TEST_CASE("Frame buffer DMA description list overflow", "[dvp_dma]")
+{
+    test_gdma_t gdma;
+
+    memset(s_frame, TEST_GUARD_VALUE, sizeof(s_frame));
+
+    dvp_config_frame_dma_desc(s_desc, TEST_DESC_ALIGN_SIZE, s_frame, TEST_FRAME_SIZE, TEST_BLOCK_SIZE);
+
+    /* Sensor sends more data than one frame, DMA stops at the end of the list */
+
+    test_gdma_start(&gdma, s_desc, TEST_BLOCK_SIZE);
+    test_gdma_recv(&gdma, 0, TEST_FRAME_SIZE + TEST_BLOCK_SIZE);
+
+    TEST_ASSERT_TRUE(gdma.desc_error);
+    TEST_ASSERT_EQUAL_UINT32(TEST_FRAME_SIZE, gdma.recv_size);
+
+    for (uint32_t i = TEST_FRAME_SIZE; i < sizeof(s_frame); i++) {
+        TEST_ASSERT_EQUAL_HEX8(TEST_GUARD_VALUE, s_frame[i]);
+    }
+}
+
+TEST_CASE("Frame buffer zero-copy capability", "[dvp_dma]")
+{
+    TEST_ASSERT_TRUE(dvp_dma_buffer_is_capable(s_frame, TEST_FRAME_SIZE, TEST_FRAME_SIZE, TEST_ALIGN_SIZE));
+    TEST_ASSERT_TRUE(dvp_dma_buffer_is_capable(s_frame, sizeof(s_frame), TEST_FRAME_SIZE, TEST_ALIGN_SIZE));
+
+    TEST_ASSERT_FALSE(dvp_dma_buffer_is_capable(NULL, TEST_FRAME_SIZE, TEST_FRAME_SIZE, TEST_ALIGN_SIZE));
+    TEST_ASSERT_FALSE(dvp_dma_buffer_is_capable(s_frame + 4, TEST_FRAME_SIZE, TEST_FRAME_SIZE, TEST_ALIGN_SIZE));
+    TEST_ASSERT_FALSE(dvp_dma_buffer_is_capable(s_frame, TEST_FRAME_SIZE - 1, TEST_FRAME_SIZE, TEST_ALIGN_SIZE));
+    TEST_ASSERT_FALSE(dvp_dma_buffer_is_capable(s_frame, TEST_FRAME_SIZE, TEST_FRAME_SIZE - 4, TEST_ALIGN_SIZE));
+    TEST_ASSERT_TRUE(dvp_dma_buffer_is_capable(s_frame + 4, TEST_FRAME_SIZE, TEST_FRAME_SIZE - 4, 4));
+}
+
+void app_main(void)
+{
+    printf("DVP DMA description test\n");
+
+    unity_run_menu();
+}
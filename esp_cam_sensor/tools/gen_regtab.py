@@ -0,0 +1,351 @@
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+# Convert camera sensor register table headers into compact register tables.
+#
+# The input is the sensor settings header which includes all format register table
+# headers, for example "sc2336_settings.h". Every "static const xxx_reginfo_t name[]"
+# table is converted into "static const uint8_t name[]" in the format described in
+# "esp_cam_sensor_regtab.h", and the register writes which all tables start with are
+# moved into "<sensor>_common_regtab[]", which is written before the format table.
+# Other lines of the settings header and of the included headers, including preprocessor
+# conditions and macros, are kept, and a register table which can't be parsed is an error.
+#
+# With "--diff", a "<from>_to_<to>_diff_regtab[]" table is generated for every pair of tables
+# under the same preprocessor conditions, which writes only the registers whose last value
+# differs between them, in the order of their last write in the target table. A pair is left
+# out if the source table writes a register which the target table doesn't, because its target
+# value is the reset default, which is unknown. The pairs are listed in "<sensor>_regtab_diffs[]".
+
+import argparse
+import os
+import re
+import sys
+
+REGTAB_RUN_MAX = 128
+REGTAB_DELAY = 0x80
+REGTAB_END = 0xff
+
+include_re = re.compile(r'^\s*#\s*include\s+"([^"]+)"')
+define_re = re.compile(r'^\s*#\s*define\s+(\w+)\s+(\w+)')
+table_re = re.compile(r'static\s+const\s+\w+_reginfo_t\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\}\s*;', re.S)
+pragma_once_re = re.compile(r'^\s*#\s*pragma\s+once')
+cond_re = re.compile(r'^\s*#\s*(if|ifdef|ifndef|elif|else|endif)\b')
+entry_re = re.compile(r'\{\s*(\w+)\s*,\s*(\w+)\s*\}')
+
+
+def strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', '', text, flags=re.S)
+    return re.sub(r'//[^\n]*', '', text)
+
+
+class regtab_c(object):
+    def __init__(self, settings, addr_bits):
+        self.dir = os.path.dirname(os.path.abspath(settings))
+        self.reg_end = None
+        self.reg_delay = None
+        self.addr_bits = addr_bits
+        self.macros = dict()
+        self.tables = dict()
+        self.lines = list()
+        self.common_pos = None
+
+        with open(settings) as f:
+            text = f.read()
+        self.check_tables(settings, strip_comments(text))
+
+        # The common table goes after the "extern "C"" block of the settings header, or at the end
+        extern_c = False
+        for line in text.splitlines():
+            if line.startswith('extern "C"'):
+                extern_c = True
+            elif extern_c and line.startswith('#endif'):
+                self.common_pos = len(self.lines) + 1
+                extern_c = False
+
+            m = include_re.match(line)
+            path = os.path.join(self.dir, m.group(1)) if m else None
+            if path and os.path.exists(path):
+                with open(path) as h:
+                    text = strip_comments(h.read())
+                self.parse_macros(text)
+                if table_re.search(text):
+                    self.expand(path, text)
+                    continue
+            self.lines.append(line)
+
+    def check_tables(self, path, text):
+        if '_reginfo_t' in table_re.sub('', text):
+            raise ValueError('%s: unsupported register table' % path)
+
+    def expand(self, path, text):
+        """
+        Put the header content in place of its "#include" line, with every register table
+        replaced by its name, which is converted when the output is generated.
+        """
+        self.check_tables(path, text)
+
+        pos = 0
+        for m in table_re.finditer(text):
+            self.lines += self.header_lines(text[pos:m.start()])
+            name, body = m.groups()
+            if name in self.tables:
+                raise ValueError('%s: duplicated register table %s' % (path, name))
+            self.tables[name] = entry_re.findall(body)
+            self.lines.append(name)
+            pos = m.end()
+        self.lines += self.header_lines(text[pos:])
+
+    def header_lines(self, text):
+        # "#pragma once" of the included header doesn't work once it is put in place
+        return [line.rstrip() for line in text.splitlines() if line.strip() and not pragma_once_re.match(line)]
+
+    def load(self, reg_end, reg_delay):
+        self.reg_end = self.value(reg_end)
+        self.reg_delay = self.value(reg_delay)
+        for name in self.tables:
+            self.tables[name] = self.resolve(name, self.tables[name])
+
+    def parse_macros(self, text):
+        for line in text.splitlines():
+            m = define_re.match(line)
+            if m:
+                self.macros[m.group(1)] = m.group(2)
+
+    def value(self, token):
+        while token in self.macros:
+            token = self.macros[token]
+        return int(token, 0)
+
+    def resolve(self, name, entries):
+        regs = list()
+        for reg, val in entries:
+            reg = self.value(reg)
+            val = self.value(val)
+            if reg == self.reg_end:
+                return regs
+            if reg != self.reg_delay and (reg >> self.addr_bits or val > 0xff):
+                raise ValueError('%s: invalid register 0x%x=0x%x' % (name, reg, val))
+            regs.append((reg, val))
+        raise ValueError('%s: missing end of table' % name)
+
+    def common_prefix(self):
+        tables = list(self.tables.values())
+        prefix = tables[0] if tables else []
+        for regs in tables[1:]:
+            n = 0
+            while n < min(len(prefix), len(regs)) and prefix[n] == regs[n]:
+                n += 1
+            prefix = prefix[:n]
+        return prefix
+
+    def encode(self, regs):
+        data = list()
+        i = 0
+        while i < len(regs):
+            reg, val = regs[i]
+            if reg == self.reg_delay:
+                data += [REGTAB_DELAY, min(val, 0xff)]
+                i += 1
+                continue
+
+            n = 1
+            while (i + n < len(regs) and n < REGTAB_RUN_MAX and
+                   regs[i + n][0] == reg + n and regs[i + n][0] != self.reg_delay):
+                n += 1
+
+            data.append(n - 1)
+            if self.addr_bits == 16:
+                data += [reg >> 8, reg & 0xff]
+            else:
+                data.append(reg)
+            data += [v for _, v in regs[i:i + n]]
+            i += n
+        data.append(REGTAB_END)
+
+        if self.decode(data) != regs:
+            raise ValueError('failed to encode register table')
+
+        return data
+
+    def decode(self, data):
+        regs = list()
+        i = 0
+        while data[i] != REGTAB_END:
+            op = data[i]
+            if op == REGTAB_DELAY:
+                regs.append((self.reg_delay, data[i + 1]))
+                i += 2
+                continue
+            i += 1
+            reg = data[i]
+            if self.addr_bits == 16:
+                i += 1
+                reg = (reg << 8) | data[i]
+            i += 1
+            for n in range(op + 1):
+                regs.append((reg + n, data[i + n]))
+            i += op + 1
+        return regs
+
+    def final(self, regs):
+        """
+        Return the last value of every register written by a table, and the position of its
+        last write, delays are skipped.
+        """
+        state = dict()
+        for pos, (reg, val) in enumerate(regs):
+            if reg != self.reg_delay:
+                state[reg] = (val, pos)
+        return state
+
+    def diff(self, cur, regs):
+        """
+        Return the register writes which switch the registers from the state which table "cur"
+        leaves them in to the state of table "regs", or None if it can't be done without reset.
+        """
+        cur_state = self.final(cur)
+        state = self.final(regs)
+        if any(reg not in state for reg in cur_state):
+            return None
+
+        diff = sorted((pos, reg, val) for reg, (val, pos) in state.items()
+                      if reg not in cur_state or cur_state[reg][0] != val)
+        return [(reg, val) for _, reg, val in diff]
+
+    def cond_groups(self):
+        """
+        Group the tables by the preprocessor conditions around them, a group is a list of
+        condition lines, which can be put around generated code, and a list of table names.
+        """
+        groups = list()
+        stack = list()
+        for line in self.lines:
+            m = cond_re.match(line)
+            if m:
+                if m.group(1) in ('if', 'ifdef', 'ifndef'):
+                    stack.append([line])
+                elif m.group(1) == 'endif':
+                    stack.pop()
+                else:
+                    stack[-1].append(line)
+                continue
+
+            if line in self.tables:
+                conds = [c for level in stack for c in level]
+                if not groups or groups[-1][0] != conds:
+                    groups.append((conds, list()))
+                groups[-1][1].append(line)
+
+        return groups
+
+    def diff_arrays(self, names, stats):
+        out = list()
+        pairs = list()
+        for cur in names:
+            for name in names:
+                if cur == name:
+                    continue
+                regs = self.diff(self.tables[cur], self.tables[name])
+                stats[1] += 1
+                if regs is None:
+                    continue
+                diff_name = '%s_to_%s_diff_regtab' % (cur, name)
+                data = self.encode(regs)
+                stats[0] += 1
+                stats[2] += len(data)
+                out += [''] + self.array(diff_name, data)
+                pairs.append((cur, name, diff_name))
+        return out, pairs
+
+    def array(self, name, data):
+        out = ['static const uint8_t %s[] = {' % name]
+        for i in range(0, len(data), 16):
+            out.append('    ' + ' '.join('0x%02x,' % d for d in data[i:i + 16]))
+        out.append('};')
+        return out
+
+    def generate(self, sensor, output, gen_diff, verbose):
+        prefix = self.common_prefix()
+        old_size = 0
+        new_size = 0
+        diff_stats = [0, 0, 0]
+        diff_pairs = list()
+        diff_groups = self.cond_groups() if gen_diff else list()
+        diff_last = dict((names[-1], (conds, names)) for conds, names in diff_groups)
+
+        out = ['/*',
+               ' * This file is generated by gen_regtab.py, do not edit it.',
+               ' */',
+               '']
+
+        common = self.encode(prefix)
+        new_size += len(common)
+
+        common_pos = len(self.lines) if self.common_pos is None else self.common_pos
+        for i, line in enumerate(self.lines):
+            if i == common_pos:
+                out += [''] + self.array('%s_common_regtab' % sensor, common)
+
+            if line in self.tables:
+                regs = self.tables[line]
+                data = self.encode(regs[len(prefix):])
+                old_size += (len(regs) + 1) * 4
+                new_size += len(data)
+                out += self.array(line, data)
+
+                # Diff tables of a group go after its last table, under the same conditions
+                if line in diff_last:
+                    conds, names = diff_last[line]
+                    arrays, pairs = self.diff_arrays(names, diff_stats)
+                    out += arrays
+                    diff_pairs.append((conds, pairs))
+                continue
+
+            out.append(line)
+
+        if common_pos == len(self.lines):
+            out += [''] + self.array('%s_common_regtab' % sensor, common)
+
+        if gen_diff:
+            out += ['', 'static const esp_cam_sensor_regtab_diff_t %s_regtab_diffs[] = {' % sensor]
+            for conds, pairs in diff_pairs:
+                if not pairs:
+                    continue
+                out += conds
+                out += ['    {%s, %s, %s},' % pair for pair in pairs]
+                out += ['#endif'] * sum(1 for c in conds if cond_re.match(c).group(1) in ('if', 'ifdef', 'ifndef'))
+            out += ['    {NULL, NULL, NULL},', '};']
+
+        with open(output, 'w') as f:
+            f.write('\n'.join(out) + '\n')
+
+        if verbose:
+            print('%s: %d tables, %d common registers, %d -> %d bytes' %
+                  (sensor, len(self.tables), len(prefix), old_size, new_size))
+            if gen_diff:
+                print('%s: %d of %d table pairs have diff tables, %d bytes' %
+                      (sensor, diff_stats[0], diff_stats[1], diff_stats[2]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate compact camera sensor register tables')
+    parser.add_argument('-i', '--input', required=True, help='sensor settings header')
+    parser.add_argument('-o', '--output', required=True, help='output header')
+    parser.add_argument('-s', '--sensor', required=True, help='sensor name, prefix of the common table')
+    parser.add_argument('--reg-end', required=True, help='end of table register, address or macro name')
+    parser.add_argument('--reg-delay', required=True, help='delay register, address or macro name')
+    parser.add_argument('--addr-bits', type=int, choices=[8, 16], default=16, help='register address width')
+    parser.add_argument('--diff', action='store_true', help='generate diff tables of table pairs')
+    parser.add_argument('-v', '--verbose', action='store_true', help='print table sizes')
+    args = parser.parse_args()
+
+    regtab = regtab_c(args.input, args.addr_bits)
+    regtab.load(args.reg_end, args.reg_delay)
+    regtab.generate(args.sensor, args.output, args.diff, args.verbose)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
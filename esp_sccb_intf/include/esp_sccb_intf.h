@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "esp_sccb_types.h"
 
@@ -157,6 +158,173 @@ esp_err_t esp_sccb_transmit_v16(esp_sccb_io_handle_t io_handle, uint16_t val);
  */
 esp_err_t esp_sccb_receive_v16(esp_sccb_io_handle_t io_handle, uint16_t *val);
 
+/**
+ * @brief Perform write transactions for a list of 8-bit reg_val registers.
+ *
+ * @note If ESP_SCCB_BURST_FLAG_AUTO_INC is set, runs of consecutive register addresses are written
+ *       as single auto-increment transfers and transfers may be joined by repeated START, only set
+ *       it if the device supports both. If the controller driver doesn't implement burst transmit,
+ *       registers are written one by one.
+ *
+ * @param[in] handle SCCB IO handle
+ * @param[in] regs Register address and value list.
+ * @param[in] reg_num Number of registers in the list.
+ * @param[in] flags Burst flags, see ESP_SCCB_BURST_FLAG_*.
+ * @return
+ *      - ESP_OK: sccb transmit success
+ *      - ESP_ERR_INVALID_ARG: sccb transmit parameter invalid.
+ */
+esp_err_t esp_sccb_transmit_burst(esp_sccb_io_handle_t io_handle, const esp_sccb_reg_t *regs, size_t reg_num, uint32_t flags);
+
+/**
+ * @brief Update bits of a 16-bit reg_addr and 8-bit reg_val register.
+ *
+ * @note The register is read and then written only if its value changes, with the register shadow
+ *       enabled, the read and the unchanged write don't reach the sccb bus.
+ *
+ * @param[in] handle SCCB IO handle
+ * @param[in] reg_addr address to send on the sccb bus.
+ * @param[in] mask Bits to update.
+ * @param[in] reg_val New value of the bits in mask.
+ * @return
+ *      - ESP_OK: sccb transmit success
+ *      - ESP_ERR_INVALID_ARG: sccb transmit parameter invalid.
+ */
+esp_err_t esp_sccb_update_reg_a16v8(esp_sccb_io_handle_t io_handle, uint16_t reg_addr, uint8_t mask, uint8_t reg_val);
+
+/**
+ * @brief Update bits of an 8-bit reg_addr and 8-bit reg_val register.
+ *
+ * @note The register is read and then written only if its value changes, with the register shadow
+ *       enabled, the read and the unchanged write don't reach the sccb bus.
+ *
+ * @param[in] handle SCCB IO handle
+ * @param[in] reg_addr address to send on the sccb bus.
+ * @param[in] mask Bits to update.
+ * @param[in] reg_val New value of the bits in mask.
+ * @return
+ *      - ESP_OK: sccb transmit success
+ *      - ESP_ERR_INVALID_ARG: sccb transmit parameter invalid.
+ */
+esp_err_t esp_sccb_update_reg_a8v8(esp_sccb_io_handle_t io_handle, uint8_t reg_addr, uint8_t mask, uint8_t reg_val);
+
+/**
+ * @brief Enable the register shadow of sccb IO handle.
+ *
+ * @note The shadow records the 8-bit value of every register written or read by a8v8 and a16v8
+ *       transactions and burst transmit. Then reading a cached register returns the cached value,
+ *       and writing the cached value to a register by esp_sccb_transmit_reg_a8v8/a16v8 is skipped.
+ *       Burst transmit always writes all registers, so register tables are written as they are.
+ *
+ * @note The device driver must list the registers which may change by themselves in volatile ranges,
+ *       and call esp_sccb_shadow_invalidate after the device is reset or powered off by other ways
+ *       than writing the soft reset bits to the soft reset register. Reading the soft reset register
+ *       or writing it without the soft reset bits keeps the cached registers.
+ *
+ * @param[in] handle SCCB IO handle
+ * @param[in] config Register shadow configuration.
+ * @return
+ *      - ESP_OK: register shadow enable success
+ *      - ESP_ERR_INVALID_ARG: parameter invalid.
+ *      - ESP_ERR_INVALID_STATE: register shadow has been enabled.
+ *      - ESP_ERR_NO_MEM: no memory for register shadow.
+ */
+esp_err_t esp_sccb_shadow_enable(esp_sccb_io_handle_t io_handle, const esp_sccb_shadow_config_t *config);
+
+/**
+ * @brief Drop all cached registers of sccb IO handle register shadow.
+ *
+ * @param[in] handle SCCB IO handle
+ * @return
+ *      - ESP_OK: register shadow invalidate success
+ *      - ESP_ERR_INVALID_ARG: parameter invalid.
+ */
+esp_err_t esp_sccb_shadow_invalidate(esp_sccb_io_handle_t io_handle);
+
+/**
+ * @brief Disable the register shadow of sccb IO handle and free its memory.
+ *
+ * @param[in] handle SCCB IO handle
+ * @return
+ *      - ESP_OK: register shadow disable success
+ *      - ESP_ERR_INVALID_ARG: parameter invalid.
+ */
+esp_err_t esp_sccb_shadow_disable(esp_sccb_io_handle_t io_handle);
+
+/**
+ * @brief Enable deferred writes of sccb IO handle, and create the flush task.
+ *
+ * @note Between esp_sccb_defer_begin and esp_sccb_defer_end, a8v8 and a16v8 register writes from the
+ *       calling task return at once without accessing the sccb bus, and the writes are queued in order,
+ *       so register sequences like group hold are kept. esp_sccb_defer_flush_from_isr, normally
+ *       called at frame start, hands the queued writes over to the flush task, which writes them in one
+ *       burst transmit and then calls on_done with the sequence number passed to flush. Failed writes are
+ *       retried by the next flushes.
+ *
+ * @note A register written directly, i.e. not queued, drops its queued writes, and waits for the flush
+ *       task if it is writing the register, so an older queued value never overwrites a newer one.
+ *
+ * @param[in] handle SCCB IO handle
+ * @param[in] config Deferred write configuration.
+ * @return
+ *      - ESP_OK: deferred write enable success
+ *      - ESP_ERR_INVALID_ARG: parameter invalid.
+ *      - ESP_ERR_INVALID_STATE: deferred write has been enabled.
+ *      - ESP_ERR_NO_MEM: no memory for queue or flush task.
+ */
+esp_err_t esp_sccb_defer_enable(esp_sccb_io_handle_t io_handle, const esp_sccb_defer_config_t *config);
+
+/**
+ * @brief Start queueing register writes of the calling task.
+ *
+ * @note Writes queued between esp_sccb_defer_begin and esp_sccb_defer_end are always flushed together.
+ *       If the queue is full, all of them are dropped and this and later writes until
+ *       esp_sccb_defer_end fail with ESP_ERR_NO_MEM.
+ *
+ * @param[in] handle SCCB IO handle
+ * @return
+ *      - ESP_OK: success
+ *      - ESP_ERR_INVALID_ARG: parameter invalid.
+ *      - ESP_ERR_INVALID_STATE: deferred write is not enabled or other task is queueing writes.
+ */
+esp_err_t esp_sccb_defer_begin(esp_sccb_io_handle_t io_handle);
+
+/**
+ * @brief Stop queueing register writes, queued writes are flushed by the next esp_sccb_defer_flush_from_isr.
+ *
+ * @param[in] handle SCCB IO handle
+ * @return
+ *      - ESP_OK: success
+ *      - ESP_ERR_INVALID_ARG: parameter invalid.
+ *      - ESP_ERR_INVALID_STATE: the calling task is not queueing writes.
+ */
+esp_err_t esp_sccb_defer_end(esp_sccb_io_handle_t io_handle);
+
+/**
+ * @brief Hand the queued register writes over to the flush task, it can be called in ISR, e.g. at frame start.
+ *
+ * @note Nothing is flushed if a task is between esp_sccb_defer_begin and esp_sccb_defer_end, or the
+ *       flush task is still writing the previous writes, the queued writes wait for the next call.
+ *
+ * @param[in] handle SCCB IO handle
+ * @param[in] sequence Sequence number reported by on_done of these writes.
+ * @return
+ *      - ESP_OK: success
+ *      - ESP_ERR_INVALID_ARG: parameter invalid.
+ */
+esp_err_t esp_sccb_defer_flush_from_isr(esp_sccb_io_handle_t io_handle, uint32_t sequence);
+
+/**
+ * @brief Disable deferred writes of sccb IO handle, queued writes which are not flushed are written now.
+ *
+ * @param[in] handle SCCB IO handle
+ * @return
+ *      - ESP_OK: deferred write disable success
+ *      - ESP_ERR_INVALID_ARG: parameter invalid.
+ *      - Others: An error occurred while writing queued writes, deferred write is disabled anyway.
+ */
+esp_err_t esp_sccb_defer_disable(esp_sccb_io_handle_t io_handle);
+
 /**
  * @brief Delete sccb I2C IO handle
  *
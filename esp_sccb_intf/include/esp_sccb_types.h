@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 #include "esp_err.h"
 
 #ifdef __cplusplus
@@ -18,6 +19,62 @@ extern "C" {
  */
 typedef struct esp_sccb_io_t* esp_sccb_io_handle_t;
 
+/**
+ * @brief sccb burst transmit flags
+ */
+#define ESP_SCCB_BURST_FLAG_ADDR_16BIT      (1 << 0)    /*!< Register address is 16-bit, otherwise 8-bit */
+#define ESP_SCCB_BURST_FLAG_AUTO_INC        (1 << 1)    /*!< Device increases register address automatically after each byte written,
+                                                             so registers with consecutive addresses are written in one transfer */
+
+/**
+ * @brief sccb register address and 8-bit value pair, used by burst transmit
+ */
+typedef struct {
+    uint16_t reg;           /*!< Register address, only the low 8 bits are used for 8-bit register address */
+    uint8_t val;            /*!< Register value */
+} esp_sccb_reg_t;
+
+/**
+ * @brief sccb register address range, both start and end are included
+ */
+typedef struct {
+    uint16_t start;         /*!< First register address of range */
+    uint16_t end;           /*!< Last register address of range */
+} esp_sccb_reg_range_t;
+
+/**
+ * @brief sccb register shadow configuration
+ */
+typedef struct {
+    size_t max_reg_num;                             /*!< Maximum number of registers cached, 0 means CONFIG_ESP_SCCB_REG_SHADOW_SIZE */
+    const esp_sccb_reg_range_t *volatile_ranges;    /*!< Registers which are never cached, e.g. status, self-clearing or trigger registers */
+    size_t volatile_range_num;                      /*!< Number of volatile register ranges */
+    int32_t reset_reg;                              /*!< Soft reset register, it is never cached, -1 if none */
+    uint8_t reset_mask;                             /*!< Soft reset bits of reset_reg, writing a value with any of them set drops all cached registers,
+                                                         0 means any non-zero value */
+} esp_sccb_shadow_config_t;
+
+/**
+ * @brief sccb deferred write done callback, it is called in the flush task
+ *
+ * @param io_handle SCCB IO handle
+ * @param sequence  Sequence number passed to flush, e.g. the frame sequence number when the writes were flushed
+ * @param status    ESP_OK if all deferred writes are transmitted, others if failed
+ * @param user_data User data of callback
+ */
+typedef void (*esp_sccb_defer_done_cb_t)(esp_sccb_io_handle_t io_handle, uint32_t sequence, esp_err_t status, void *user_data);
+
+/**
+ * @brief sccb deferred write configuration
+ */
+typedef struct {
+    size_t max_reg_num;                             /*!< Maximum number of register writes waiting for flush, 0 means CONFIG_ESP_SCCB_DEFER_REG_NUM */
+    uint32_t task_priority;                         /*!< Flush task priority, 0 means CONFIG_ESP_SCCB_DEFER_TASK_PRIORITY */
+    uint32_t task_stack_size;                       /*!< Flush task stack size in bytes, 0 means CONFIG_ESP_SCCB_DEFER_TASK_STACK_SIZE */
+    esp_sccb_defer_done_cb_t on_done;               /*!< Called after every flush, can be NULL */
+    void *user_data;                                /*!< User data of on_done */
+} esp_sccb_defer_config_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -201,6 +201,27 @@ struct esp_sccb_io_t {
      */
     esp_err_t (*receive_v16)(esp_sccb_io_t *io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
 
+    /**
+     * @brief Perform write transactions for a list of 8-bit reg_val registers.
+     *
+     * @note Registers are written in list order. If ESP_SCCB_BURST_FLAG_AUTO_INC is set, a run of
+     *       consecutive register addresses is written as one transfer, and the controller can put
+     *       several transfers into one bus transaction with repeated START. Without the flag, every
+     *       transfer ends with a STOP, because some SCCB devices don't accept a repeated START.
+     *
+     * @param[in] handle SCCB IO handle
+     * @param[in] regs   Register address and value list.
+     * @param[in] reg_num Number of registers in the list.
+     * @param[in] flags  Burst flags, see ESP_SCCB_BURST_FLAG_*.
+     * @param[in] xfer_timeout_ms Wait timeout of every bus transaction, in ms.
+     * @return
+     *      - ESP_OK: sccb transmit success
+     *      - ESP_ERR_INVALID_ARG: sccb transmit parameter invalid.
+     *      - ESP_ERR_NO_MEM: No memory for the transaction buffer.
+     *      - ESP_ERR_TIMEOUT: Operation timeout(larger than xfer_timeout_ms) because the bus is busy or hardware crash.
+     */
+    esp_err_t (*transmit_burst)(esp_sccb_io_t *io_handle, const esp_sccb_reg_t *regs, size_t reg_num, uint32_t flags, int xfer_timeout_ms);
+
     /**
      * @brief Delete sccb io handle
      *
@@ -209,6 +230,16 @@ struct esp_sccb_io_t {
      *        - ESP_OK: If controller is successfully deleted.
      */
     esp_err_t (*del)(esp_sccb_io_t *io_handle);
+
+    /**
+     * @brief Register shadow, it is managed by esp_sccb_intf, controller drivers must set it NULL on creation.
+     */
+    struct esp_sccb_shadow *shadow;
+
+    /**
+     * @brief Deferred write queue, it is managed by esp_sccb_intf, controller drivers must set it NULL on creation.
+     */
+    struct esp_sccb_defer *defer;
 };
 
 #ifdef __cplusplus
@@ -11,15 +11,30 @@
 #include "esp_log.h"
 #include "esp_check.h"
 #include "esp_heap_caps.h"
+#include "esp_idf_version.h"
 #include "freertos/FreeRTOS.h"
 #include "driver/i2c_master.h"
 #include "esp_sccb_types.h"
 #include "esp_sccb_i2c.h"
 #include "sccb_i2c_internal.h"
+#include "sccb_burst.h"
 #include "esp_sccb_io_interface.h"
 
 #define SCCB_I2C_MEM_CAPS   MALLOC_CAP_DEFAULT
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 4, 0)
+#define SCCB_I2C_BURST_COMBINED         1
+#endif
+
+/**
+ * @brief SCCB I2C burst transaction argument
+ */
+typedef struct sccb_i2c_burst_arg {
+    sccb_io_i2c_t *io_i2c;                  /*!< SCCB I2C IO object */
+    int xfer_timeout_ms;                    /*!< Transaction timeout in ms */
+    bool combined_trans;                    /*!< true: send transfers of a burst in one transaction with repeated START */
+} sccb_i2c_burst_arg_t;
+
 static const char *TAG = "sccb_i2c";
 
 static esp_err_t s_sccb_i2c_transmit_reg_a8v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
@@ -34,6 +49,7 @@ static esp_err_t s_sccb_i2c_transmit_receive_reg_a16v16(esp_sccb_io_t *io_handle
 static esp_err_t s_sccb_i2c_transmit_receive_reg_a16v32(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
 static esp_err_t s_sccb_i2c_transmit_v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
 static esp_err_t s_sccb_i2c_receive_v16(esp_sccb_io_t *io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_i2c_transmit_burst(esp_sccb_io_t *io_handle, const esp_sccb_reg_t *regs, size_t reg_num, uint32_t flags, int xfer_timeout_ms);
 static esp_err_t s_sccb_i2c_destroy(esp_sccb_io_t *io_handle);
 
 esp_err_t sccb_new_i2c_io(i2c_master_bus_handle_t bus_handle, const sccb_i2c_config_t *config, esp_sccb_io_handle_t *io_handle)
@@ -52,6 +68,12 @@ esp_err_t sccb_new_i2c_io(i2c_master_bus_handle_t bus_handle, const sccb_i2c_con
     ESP_GOTO_ON_ERROR(i2c_master_bus_add_device(bus_handle, &dev_cfg, &dev_handle), err, TAG, "failed to add device");
 
     io_i2c->i2c_device = dev_handle;
+    if (config->dev_addr_length == I2C_ADDR_BIT_LEN_7) {
+        io_i2c->write_addr = (config->device_address << 1) & 0xfe;
+#if SCCB_I2C_BURST_COMBINED
+        io_i2c->combined_trans = true;
+#endif
+    }
     io_i2c->base.transmit_reg_a8v8 = s_sccb_i2c_transmit_reg_a8v8;
     io_i2c->base.transmit_reg_a16v8 = s_sccb_i2c_transmit_reg_a16v8;
     io_i2c->base.transmit_reg_a8v16 = s_sccb_i2c_transmit_reg_a8v16;
@@ -64,6 +86,7 @@ esp_err_t sccb_new_i2c_io(i2c_master_bus_handle_t bus_handle, const sccb_i2c_con
     io_i2c->base.transmit_receive_reg_a16v32 = s_sccb_i2c_transmit_receive_reg_a16v32;
     io_i2c->base.transmit_v16 = s_sccb_i2c_transmit_v16;
     io_i2c->base.receive_v16 = s_sccb_i2c_receive_v16;
+    io_i2c->base.transmit_burst = s_sccb_i2c_transmit_burst;
     io_i2c->base.del = s_sccb_i2c_destroy;
     *io_handle = &(io_i2c->base);
     ESP_LOGD(TAG, "new io_i2c: %p", io_i2c);
@@ -170,6 +193,72 @@ static esp_err_t s_sccb_i2c_receive_v16(esp_sccb_io_t *io_handle, uint8_t *read_
     return ESP_OK;
 }
 
+static esp_err_t s_sccb_i2c_burst_flush(const sccb_burst_t *burst, void *arg)
+{
+    esp_err_t ret = ESP_OK;
+    sccb_i2c_burst_arg_t *burst_arg = (sccb_i2c_burst_arg_t *)arg;
+    sccb_io_i2c_t *io_i2c = burst_arg->io_i2c;
+
+#if SCCB_I2C_BURST_COMBINED
+    if (burst_arg->combined_trans && burst->seg_num > 1) {
+        size_t n = 0;
+        i2c_operation_job_t ops[SCCB_BURST_SEG_MAX * 2 + 1];
+
+        /* Every transfer starts with a (repeated) START and the device address, one STOP ends them all */
+        for (size_t i = 0; i < burst->seg_num; i++) {
+            ops[n++] = (i2c_operation_job_t) {
+                .command = I2C_MASTER_CMD_START,
+            };
+            ops[n++] = (i2c_operation_job_t) {
+                .command = I2C_MASTER_CMD_WRITE,
+                .write = {
+                    .ack_check = true,
+                    .data = (uint8_t *) &burst->buffer[burst->seg_offset[i]],
+                    .total_bytes = burst->seg_offset[i + 1] - burst->seg_offset[i],
+                },
+            };
+        }
+        ops[n++] = (i2c_operation_job_t) {
+            .command = I2C_MASTER_CMD_STOP,
+        };
+
+        ret = i2c_master_execute_defined_operations(io_i2c->i2c_device, ops, n, burst_arg->xfer_timeout_ms);
+    } else
+#endif
+    {
+        /* The I2C driver sends the device address itself */
+        for (size_t i = 0; i < burst->seg_num; i++) {
+            ret = i2c_master_transmit(io_i2c->i2c_device, &burst->buffer[burst->seg_offset[i] + 1],
+                                      burst->seg_offset[i + 1] - burst->seg_offset[i] - 1, burst_arg->xfer_timeout_ms);
+            if (ret != ESP_OK) {
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
+
+static esp_err_t s_sccb_i2c_transmit_burst(esp_sccb_io_t *io_handle, const esp_sccb_reg_t *regs, size_t reg_num, uint32_t flags, int xfer_timeout_ms)
+{
+    sccb_io_i2c_t *io_i2c = __containerof(io_handle, sccb_io_i2c_t, base);
+    /**
+     * Only a device which increases register address automatically is known to follow the I2C
+     * protocol, some SCCB devices don't accept a repeated START, so they get one STOP per transfer.
+     */
+    sccb_i2c_burst_arg_t burst_arg = {
+        .io_i2c = io_i2c,
+        .xfer_timeout_ms = xfer_timeout_ms,
+        .combined_trans = io_i2c->combined_trans && (flags & ESP_SCCB_BURST_FLAG_AUTO_INC),
+    };
+    sccb_burst_t burst;
+
+    ESP_RETURN_ON_ERROR(sccb_burst_pack(&burst, io_i2c->write_addr, regs, reg_num, flags, s_sccb_i2c_burst_flush, &burst_arg),
+                        TAG, "failed to transmit burst");
+
+    return ESP_OK;
+}
+
 static esp_err_t s_sccb_i2c_destroy(esp_sccb_io_t *io_handle)
 {
     sccb_io_i2c_t *io_i2c = __containerof(io_handle, sccb_io_i2c_t, base);
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -30,6 +30,8 @@ typedef struct sccb_io_i2c_t sccb_io_i2c_t;
  */
 struct sccb_io_i2c_t {
     i2c_master_dev_handle_t i2c_device;
+    uint8_t write_addr;             /*!< 7-bit device address with write bit, used to build combined transactions */
+    bool combined_trans;            /*!< true: several transfers can be put into one bus transaction */
     struct esp_sccb_io_t base;
 };
 
@@ -0,0 +1,106 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_sccb_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief SCCB simulator configuration
+ */
+typedef struct {
+    uint16_t device_address;              ///< 7-bit device address, only used to log
+    uint32_t scl_speed_hz;                ///< Modelled SCL line frequency
+    uint32_t addr_bits_width;             ///< Reg address bit-width, 8 or 16
+    const esp_sccb_reg_t *regs;           ///< Register model: initial register values, e.g. sensor chip ID, other registers are 0
+    size_t reg_num;                       ///< Number of initial register values
+    bool disable_burst;                   ///< true: no burst transmit operation, esp_sccb_transmit_burst writes registers one by one
+} sccb_sim_config_t;
+
+/**
+ * @brief SCCB simulator bus statistics
+ */
+typedef struct {
+    uint32_t transactions;                ///< Number of bus transactions, every one is from START to STOP
+    uint32_t write_regs;                  ///< Number of 8-bit registers written, a multi-byte value counts one per byte
+    uint32_t read_regs;                   ///< Number of 8-bit registers read, a multi-byte value counts one per byte
+    uint64_t bytes;                       ///< Number of bytes on bus, including device address bytes
+    uint64_t bus_time_ns;                 ///< Modelled bus time, 9 SCL cycles per byte plus 1 per START, repeated START or STOP
+} sccb_sim_stats_t;
+
+/**
+ * @brief New SCCB simulator IO handle, its operations access an in-memory register model
+ *        instead of a device on a real bus.
+ *
+ * @param[in]  config      ///< Simulator configuration
+ * @param[out] io_handle   ///< SCCB IO handle
+ *
+ * @return
+ *        - ESP_OK:  On success
+ *        - ESP_ERR_INVALID_ARG: Invalid argument
+ *        - ESP_ERR_NO_MEM: Out of memory
+ */
+esp_err_t sccb_new_sim_io(const sccb_sim_config_t *config, esp_sccb_io_handle_t *io_handle);
+
+/**
+ * @brief Get bus statistics of SCCB simulator IO handle
+ *
+ * @param[in]  io_handle   ///< SCCB simulator IO handle
+ * @param[out] stats       ///< Bus statistics buffer
+ *
+ * @return
+ *        - ESP_OK:  On success
+ *        - ESP_ERR_INVALID_ARG: Invalid argument
+ */
+esp_err_t sccb_sim_get_stats(esp_sccb_io_handle_t io_handle, sccb_sim_stats_t *stats);
+
+/**
+ * @brief Reset bus statistics of SCCB simulator IO handle
+ *
+ * @param[in]  io_handle   ///< SCCB simulator IO handle
+ *
+ * @return
+ *        - ESP_OK:  On success
+ *        - ESP_ERR_INVALID_ARG: Invalid argument
+ */
+esp_err_t sccb_sim_reset_stats(esp_sccb_io_handle_t io_handle);
+
+/**
+ * @brief Set register value of register model directly, it is not counted in bus statistics
+ *
+ * @param[in]  io_handle   ///< SCCB simulator IO handle
+ * @param[in]  reg         ///< Register address
+ * @param[in]  val         ///< Register value
+ *
+ * @return
+ *        - ESP_OK:  On success
+ *        - ESP_ERR_INVALID_ARG: Invalid argument
+ */
+esp_err_t sccb_sim_set_reg(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val);
+
+/**
+ * @brief Get register value of register model directly, it is not counted in bus statistics
+ *
+ * @param[in]  io_handle   ///< SCCB simulator IO handle
+ * @param[in]  reg         ///< Register address
+ * @param[out] val         ///< Register value buffer
+ *
+ * @return
+ *        - ESP_OK:  On success
+ *        - ESP_ERR_INVALID_ARG: Invalid argument
+ */
+esp_err_t sccb_sim_get_reg(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t *val);
+
+#ifdef __cplusplus
+}
+#endif
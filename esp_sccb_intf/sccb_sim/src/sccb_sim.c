@@ -0,0 +1,370 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <esp_types.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_sccb_types.h"
+#include "esp_sccb_sim.h"
+#include "esp_sccb_io_interface.h"
+#include "sccb_burst.h"
+
+#define SCCB_SIM_MEM_CAPS               MALLOC_CAP_DEFAULT
+
+/* Every byte is 8 data bits and 1 ACK bit, START, repeated START and STOP are counted as 1 bit */
+#define SCCB_SIM_BYTE_BITS              9
+#define SCCB_SIM_COND_BITS              1
+
+/**
+ * @brief SCCB simulator controller type
+ */
+typedef struct sccb_io_sim {
+    SemaphoreHandle_t mutex;                /*!< Register model and statistics lock */
+    uint32_t scl_speed_hz;                  /*!< Modelled SCL line frequency */
+    uint16_t device_address;                /*!< 7-bit device address */
+    uint32_t reg_mask;                      /*!< Register address mask of register model */
+    uint16_t v16;                           /*!< Value of 2-byte transmit_v16 and receive_v16, which have no register address */
+    uint8_t reg_ptr;                        /*!< Register address set by 1-byte transmit_v16, and read by 1-byte receive_v16 */
+    sccb_sim_stats_t stats;                 /*!< Bus statistics */
+    struct esp_sccb_io_t base;
+    uint8_t regs[];                         /*!< Register model */
+} sccb_io_sim_t;
+
+/**
+ * @brief SCCB simulator burst transaction argument
+ */
+typedef struct sccb_sim_burst_arg {
+    sccb_io_sim_t *io_sim;                  /*!< SCCB simulator object */
+    size_t addr_size;                       /*!< Register address bytes of every transfer */
+    bool combined_trans;                    /*!< true: transfers of a burst are in one transaction with repeated START */
+} sccb_sim_burst_arg_t;
+
+static const char *TAG = "sccb_sim";
+
+static esp_err_t s_sccb_sim_transmit_reg_a8v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_reg_a16v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_reg_a8v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_reg_a16v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_reg_a16v32(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_receive_reg_a8v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_receive_reg_a16v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_receive_reg_a8v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_receive_reg_a16v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_receive_reg_a16v32(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_receive_v16(esp_sccb_io_t *io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_transmit_burst(esp_sccb_io_t *io_handle, const esp_sccb_reg_t *regs, size_t reg_num, uint32_t flags, int xfer_timeout_ms);
+static esp_err_t s_sccb_sim_destroy(esp_sccb_io_t *io_handle);
+
+esp_err_t sccb_new_sim_io(const sccb_sim_config_t *config, esp_sccb_io_handle_t *io_handle)
+{
+    ESP_RETURN_ON_FALSE(config && io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->addr_bits_width == 8 || config->addr_bits_width == 16, ESP_ERR_INVALID_ARG, TAG, "invalid address bit-width");
+    ESP_RETURN_ON_FALSE(config->scl_speed_hz, ESP_ERR_INVALID_ARG, TAG, "invalid SCL speed");
+    ESP_RETURN_ON_FALSE(!config->reg_num || config->regs, ESP_ERR_INVALID_ARG, TAG, "invalid register model");
+
+    size_t reg_size = 1 << config->addr_bits_width;
+    sccb_io_sim_t *io_sim = heap_caps_calloc(1, sizeof(sccb_io_sim_t) + reg_size, SCCB_SIM_MEM_CAPS);
+    ESP_RETURN_ON_FALSE(io_sim, ESP_ERR_NO_MEM, TAG, "no mem for io handle");
+
+    io_sim->mutex = xSemaphoreCreateMutex();
+    if (!io_sim->mutex) {
+        heap_caps_free(io_sim);
+        ESP_LOGE(TAG, "failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    io_sim->scl_speed_hz = config->scl_speed_hz;
+    io_sim->device_address = config->device_address;
+    io_sim->reg_mask = reg_size - 1;
+    for (size_t i = 0; i < config->reg_num; i++) {
+        io_sim->regs[config->regs[i].reg & io_sim->reg_mask] = config->regs[i].val;
+    }
+
+    io_sim->base.transmit_reg_a8v8 = s_sccb_sim_transmit_reg_a8v8;
+    io_sim->base.transmit_reg_a16v8 = s_sccb_sim_transmit_reg_a16v8;
+    io_sim->base.transmit_reg_a8v16 = s_sccb_sim_transmit_reg_a8v16;
+    io_sim->base.transmit_reg_a16v16 = s_sccb_sim_transmit_reg_a16v16;
+    io_sim->base.transmit_reg_a16v32 = s_sccb_sim_transmit_reg_a16v32;
+    io_sim->base.transmit_receive_reg_a8v8 = s_sccb_sim_transmit_receive_reg_a8v8;
+    io_sim->base.transmit_receive_reg_a16v8 = s_sccb_sim_transmit_receive_reg_a16v8;
+    io_sim->base.transmit_receive_reg_a8v16 = s_sccb_sim_transmit_receive_reg_a8v16;
+    io_sim->base.transmit_receive_reg_a16v16 = s_sccb_sim_transmit_receive_reg_a16v16;
+    io_sim->base.transmit_receive_reg_a16v32 = s_sccb_sim_transmit_receive_reg_a16v32;
+    io_sim->base.transmit_v16 = s_sccb_sim_transmit_v16;
+    io_sim->base.receive_v16 = s_sccb_sim_receive_v16;
+    if (!config->disable_burst) {
+        io_sim->base.transmit_burst = s_sccb_sim_transmit_burst;
+    }
+    io_sim->base.del = s_sccb_sim_destroy;
+    *io_handle = &(io_sim->base);
+    ESP_LOGD(TAG, "new io_sim: %p, addr=0x%02x", io_sim, config->device_address);
+    return ESP_OK;
+}
+
+/**
+ * @brief Account one bus transaction, caller must hold the lock
+ *
+ * @param io_sim     SCCB simulator object
+ * @param bytes      Number of bytes on bus, including device address bytes
+ * @param conditions Number of START, repeated START and STOP conditions
+ */
+static void s_sccb_sim_account(sccb_io_sim_t *io_sim, size_t bytes, size_t conditions)
+{
+    uint64_t bits = bytes * SCCB_SIM_BYTE_BITS + conditions * SCCB_SIM_COND_BITS;
+
+    io_sim->stats.transactions++;
+    io_sim->stats.bytes += bytes;
+    io_sim->stats.bus_time_ns += bits * 1000000000ULL / io_sim->scl_speed_hz;
+}
+
+static uint32_t s_sccb_sim_get_addr(const uint8_t *buffer, size_t addr_size)
+{
+    return addr_size == 2 ? ((buffer[0] << 8) | buffer[1]) : buffer[0];
+}
+
+static esp_err_t s_sccb_sim_transmit(esp_sccb_io_t *io_handle, size_t addr_size, const uint8_t *write_buffer, size_t write_size)
+{
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+    ESP_RETURN_ON_FALSE(write_size > addr_size, ESP_ERR_INVALID_ARG, TAG, "invalid write size");
+
+    uint32_t reg = s_sccb_sim_get_addr(write_buffer, addr_size);
+
+    xSemaphoreTake(io_sim->mutex, portMAX_DELAY);
+    /* Multi-byte values are written to consecutive registers, high byte first, like sensors do */
+    for (size_t i = addr_size; i < write_size; i++) {
+        io_sim->regs[(reg + i - addr_size) & io_sim->reg_mask] = write_buffer[i];
+    }
+    io_sim->stats.write_regs += write_size - addr_size;
+    s_sccb_sim_account(io_sim, 1 + write_size, 2);
+    xSemaphoreGive(io_sim->mutex);
+
+    return ESP_OK;
+}
+
+static esp_err_t s_sccb_sim_transmit_receive(esp_sccb_io_t *io_handle, size_t addr_size, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size)
+{
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+    ESP_RETURN_ON_FALSE(write_size == addr_size && read_size, ESP_ERR_INVALID_ARG, TAG, "invalid transfer size");
+
+    uint32_t reg = s_sccb_sim_get_addr(write_buffer, addr_size);
+
+    xSemaphoreTake(io_sim->mutex, portMAX_DELAY);
+    for (size_t i = 0; i < read_size; i++) {
+        read_buffer[i] = io_sim->regs[(reg + i) & io_sim->reg_mask];
+    }
+    io_sim->stats.read_regs += read_size;
+    /* START, address+W, register address, repeated START, address+R, values, STOP */
+    s_sccb_sim_account(io_sim, 2 + write_size + read_size, 3);
+    xSemaphoreGive(io_sim->mutex);
+
+    return ESP_OK;
+}
+
+static esp_err_t s_sccb_sim_transmit_reg_a8v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit(io_handle, 1, write_buffer, write_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_reg_a16v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit(io_handle, 2, write_buffer, write_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_reg_a8v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit(io_handle, 1, write_buffer, write_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_reg_a16v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit(io_handle, 2, write_buffer, write_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_reg_a16v32(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit(io_handle, 2, write_buffer, write_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_receive_reg_a8v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit_receive(io_handle, 1, write_buffer, write_size, read_buffer, read_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_receive_reg_a16v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit_receive(io_handle, 2, write_buffer, write_size, read_buffer, read_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_receive_reg_a8v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit_receive(io_handle, 1, write_buffer, write_size, read_buffer, read_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_receive_reg_a16v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit_receive(io_handle, 2, write_buffer, write_size, read_buffer, read_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_receive_reg_a16v32(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
+{
+    return s_sccb_sim_transmit_receive(io_handle, 2, write_buffer, write_size, read_buffer, read_size);
+}
+
+static esp_err_t s_sccb_sim_transmit_v16(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
+{
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+    ESP_RETURN_ON_FALSE(write_size == 1 || write_size == 2, ESP_ERR_INVALID_ARG, TAG, "invalid write size");
+
+    xSemaphoreTake(io_sim->mutex, portMAX_DELAY);
+    /* A single byte is the register address of the next receive, e.g. the address phase of a8v8 read */
+    if (write_size == 1) {
+        io_sim->reg_ptr = write_buffer[0];
+    } else {
+        io_sim->v16 = (write_buffer[0] << 8) | write_buffer[1];
+        io_sim->stats.write_regs += write_size;
+    }
+    s_sccb_sim_account(io_sim, 1 + write_size, 2);
+    xSemaphoreGive(io_sim->mutex);
+
+    return ESP_OK;
+}
+
+static esp_err_t s_sccb_sim_receive_v16(esp_sccb_io_t *io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
+{
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+    ESP_RETURN_ON_FALSE(read_size == 1 || read_size == 2, ESP_ERR_INVALID_ARG, TAG, "invalid read size");
+
+    xSemaphoreTake(io_sim->mutex, portMAX_DELAY);
+    if (read_size == 1) {
+        read_buffer[0] = io_sim->regs[io_sim->reg_ptr & io_sim->reg_mask];
+    } else {
+        read_buffer[0] = io_sim->v16 >> 8;
+        read_buffer[1] = io_sim->v16 & 0xff;
+    }
+    io_sim->stats.read_regs += read_size;
+    s_sccb_sim_account(io_sim, 1 + read_size, 2);
+    xSemaphoreGive(io_sim->mutex);
+
+    return ESP_OK;
+}
+
+/* Decode the transfers packed as the I2C controller sends them, so that burst statistics match the real bus */
+static esp_err_t s_sccb_sim_burst_flush(const sccb_burst_t *burst, void *arg)
+{
+    sccb_sim_burst_arg_t *burst_arg = (sccb_sim_burst_arg_t *)arg;
+    sccb_io_sim_t *io_sim = burst_arg->io_sim;
+
+    for (size_t i = 0; i < burst->seg_num; i++) {
+        /* Skip the device address byte */
+        const uint8_t *data = &burst->buffer[burst->seg_offset[i] + 1];
+        size_t size = burst->seg_offset[i + 1] - burst->seg_offset[i] - 1;
+        uint32_t reg = s_sccb_sim_get_addr(data, burst_arg->addr_size);
+
+        for (size_t j = burst_arg->addr_size; j < size; j++) {
+            io_sim->regs[(reg + j - burst_arg->addr_size) & io_sim->reg_mask] = data[j];
+        }
+        io_sim->stats.write_regs += size - burst_arg->addr_size;
+
+        if (!burst_arg->combined_trans) {
+            /* Every transfer is a transaction with its own START and STOP */
+            s_sccb_sim_account(io_sim, size + 1, 2);
+        }
+    }
+
+    if (burst_arg->combined_trans) {
+        /* One START and device address per transfer, one STOP ends them all */
+        s_sccb_sim_account(io_sim, burst->size, burst->seg_num + 1);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t s_sccb_sim_transmit_burst(esp_sccb_io_t *io_handle, const esp_sccb_reg_t *regs, size_t reg_num, uint32_t flags, int xfer_timeout_ms)
+{
+    esp_err_t ret;
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+    sccb_sim_burst_arg_t burst_arg = {
+        .io_sim = io_sim,
+        .addr_size = (flags & ESP_SCCB_BURST_FLAG_ADDR_16BIT) ? 2 : 1,
+        .combined_trans = flags & ESP_SCCB_BURST_FLAG_AUTO_INC,
+    };
+    sccb_burst_t burst;
+
+    xSemaphoreTake(io_sim->mutex, portMAX_DELAY);
+    ret = sccb_burst_pack(&burst, (io_sim->device_address << 1) & 0xfe, regs, reg_num, flags, s_sccb_sim_burst_flush, &burst_arg);
+    xSemaphoreGive(io_sim->mutex);
+
+    return ret;
+}
+
+static esp_err_t s_sccb_sim_destroy(esp_sccb_io_t *io_handle)
+{
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+
+    vSemaphoreDelete(io_sim->mutex);
+    heap_caps_free(io_sim);
+
+    return ESP_OK;
+}
+
+esp_err_t sccb_sim_get_stats(esp_sccb_io_handle_t io_handle, sccb_sim_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(io_handle && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(io_handle->del == s_sccb_sim_destroy, ESP_ERR_INVALID_ARG, TAG, "not a simulator IO handle");
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+
+    xSemaphoreTake(io_sim->mutex, portMAX_DELAY);
+    *stats = io_sim->stats;
+    xSemaphoreGive(io_sim->mutex);
+
+    return ESP_OK;
+}
+
+esp_err_t sccb_sim_reset_stats(esp_sccb_io_handle_t io_handle)
+{
+    ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(io_handle->del == s_sccb_sim_destroy, ESP_ERR_INVALID_ARG, TAG, "not a simulator IO handle");
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+
+    xSemaphoreTake(io_sim->mutex, portMAX_DELAY);
+    memset(&io_sim->stats, 0, sizeof(io_sim->stats));
+    xSemaphoreGive(io_sim->mutex);
+
+    return ESP_OK;
+}
+
+esp_err_t sccb_sim_set_reg(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val)
+{
+    ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(io_handle->del == s_sccb_sim_destroy, ESP_ERR_INVALID_ARG, TAG, "not a simulator IO handle");
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+
+    xSemaphoreTake(io_sim->mutex, portMAX_DELAY);
+    io_sim->regs[reg & io_sim->reg_mask] = val;
+    xSemaphoreGive(io_sim->mutex);
+
+    return ESP_OK;
+}
+
+esp_err_t sccb_sim_get_reg(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t *val)
+{
+    ESP_RETURN_ON_FALSE(io_handle && val, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(io_handle->del == s_sccb_sim_destroy, ESP_ERR_INVALID_ARG, TAG, "not a simulator IO handle");
+    sccb_io_sim_t *io_sim = __containerof(io_handle, sccb_io_sim_t, base);
+
+    xSemaphoreTake(io_sim->mutex, portMAX_DELAY);
+    *val = io_sim->regs[reg & io_sim->reg_mask];
+    xSemaphoreGive(io_sim->mutex);
+
+    return ESP_OK;
+}
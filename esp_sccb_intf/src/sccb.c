@@ -13,6 +13,8 @@
 #include "esp_check.h"
 #include "esp_sccb_io_interface.h"
 #include "esp_sccb_intf.h"
+#include "sccb_shadow.h"
+#include "sccb_defer.h"
 
 #define ESP_SCCB_TRANS_DEALY CONFIG_ESP_SCCB_TRANS_TIMEOUT_DEFAULT
 
@@ -20,27 +22,63 @@ static const char *TAG = "sccb";
 
 esp_err_t esp_sccb_transmit_reg_a8v8(esp_sccb_io_handle_t io_handle, uint8_t reg_addr, uint8_t reg_val)
 {
+    esp_err_t ret;
+    uint8_t cached_val;
     ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
     ESP_RETURN_ON_FALSE(io_handle->transmit_reg_a8v8, ESP_ERR_NOT_SUPPORTED, TAG, "controller driver function not supported");
 
+    if (sccb_defer_write(io_handle, reg_addr, reg_val, false, &ret)) {
+        return ret;
+    }
+    sccb_defer_drop(io_handle, reg_addr);
+
+    if (sccb_shadow_get(io_handle, reg_addr, &cached_val) && (cached_val == reg_val)) {
+        return ESP_OK;
+    }
+
     uint8_t data[2] = {0};
     data[0] = reg_addr & 0xff;
     data[1] = reg_val;
 
-    return io_handle->transmit_reg_a8v8(io_handle, data, 2, ESP_SCCB_TRANS_DEALY);
+    ret = io_handle->transmit_reg_a8v8(io_handle, data, 2, ESP_SCCB_TRANS_DEALY);
+    if (ret == ESP_OK) {
+        sccb_shadow_write(io_handle, reg_addr, reg_val);
+    } else {
+        sccb_shadow_clear(io_handle);
+    }
+
+    return ret;
 }
 
 esp_err_t esp_sccb_transmit_reg_a16v8(esp_sccb_io_handle_t io_handle, uint16_t reg_addr, uint8_t reg_val)
 {
+    esp_err_t ret;
+    uint8_t cached_val;
     ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
     ESP_RETURN_ON_FALSE(io_handle->transmit_reg_a16v8, ESP_ERR_NOT_SUPPORTED, TAG, "controller driver function not supported");
 
+    if (sccb_defer_write(io_handle, reg_addr, reg_val, true, &ret)) {
+        return ret;
+    }
+    sccb_defer_drop(io_handle, reg_addr);
+
+    if (sccb_shadow_get(io_handle, reg_addr, &cached_val) && (cached_val == reg_val)) {
+        return ESP_OK;
+    }
+
     uint8_t data[3] = {0};
     data[0] = (reg_addr & 0xff00) >> 8;
     data[1] = reg_addr & 0xff;
     data[2] = reg_val;
 
-    return io_handle->transmit_reg_a16v8(io_handle, data, 3, ESP_SCCB_TRANS_DEALY);
+    ret = io_handle->transmit_reg_a16v8(io_handle, data, 3, ESP_SCCB_TRANS_DEALY);
+    if (ret == ESP_OK) {
+        sccb_shadow_write(io_handle, reg_addr, reg_val);
+    } else {
+        sccb_shadow_clear(io_handle);
+    }
+
+    return ret;
 }
 
 esp_err_t esp_sccb_transmit_reg_a8v16(esp_sccb_io_handle_t io_handle, uint8_t reg_addr, uint16_t reg_val)
@@ -99,6 +137,10 @@ esp_err_t esp_sccb_transmit_receive_reg_a8v8(esp_sccb_io_handle_t io_handle, uin
     ESP_RETURN_ON_FALSE(io_handle->transmit_receive_reg_a8v8, ESP_ERR_NOT_SUPPORTED, TAG, "controller driver function not supported");
     ESP_RETURN_ON_FALSE(reg_val, ESP_ERR_INVALID_ARG, TAG, "invalid argument: reg_val null pointer");
 
+    if (sccb_shadow_get(io_handle, reg_addr, reg_val)) {
+        return ESP_OK;
+    }
+
     uint8_t tx_buffer[1];
     tx_buffer[0] = reg_addr;
 
@@ -108,7 +150,12 @@ esp_err_t esp_sccb_transmit_receive_reg_a8v8(esp_sccb_io_handle_t io_handle, uin
         return ret;
     }
 
-    return io_handle->receive_v16(io_handle, reg_val, 1, ESP_SCCB_TRANS_DEALY);
+    ret = io_handle->receive_v16(io_handle, reg_val, 1, ESP_SCCB_TRANS_DEALY);
+    if (ret == ESP_OK) {
+        sccb_shadow_set(io_handle, reg_addr, *reg_val);
+    }
+
+    return ret;
 }
 
 esp_err_t esp_sccb_transmit_receive_reg_a16v8(esp_sccb_io_handle_t io_handle, uint16_t reg_addr, uint8_t *reg_val)
@@ -117,11 +164,20 @@ esp_err_t esp_sccb_transmit_receive_reg_a16v8(esp_sccb_io_handle_t io_handle, ui
     ESP_RETURN_ON_FALSE(io_handle->transmit_receive_reg_a16v8, ESP_ERR_NOT_SUPPORTED, TAG, "controller driver function not supported");
     ESP_RETURN_ON_FALSE(reg_val, ESP_ERR_INVALID_ARG, TAG, "invalid argument: reg_val null pointer");
 
+    if (sccb_shadow_get(io_handle, reg_addr, reg_val)) {
+        return ESP_OK;
+    }
+
     uint8_t data[2] = {0};
     data[0] = (reg_addr & 0xff00) >> 8;
     data[1] = reg_addr & 0xff;
 
-    return io_handle->transmit_receive_reg_a16v8(io_handle, data, 2, reg_val, 1, ESP_SCCB_TRANS_DEALY);
+    esp_err_t ret = io_handle->transmit_receive_reg_a16v8(io_handle, data, 2, reg_val, 1, ESP_SCCB_TRANS_DEALY);
+    if (ret == ESP_OK) {
+        sccb_shadow_set(io_handle, reg_addr, *reg_val);
+    }
+
+    return ret;
 }
 
 esp_err_t esp_sccb_transmit_receive_reg_a8v16(esp_sccb_io_handle_t io_handle, uint8_t reg_addr, uint16_t *reg_val)
@@ -194,10 +250,94 @@ esp_err_t esp_sccb_receive_v16(esp_sccb_io_handle_t io_handle, uint16_t *val)
     return ret;
 }
 
+esp_err_t esp_sccb_transmit_burst(esp_sccb_io_handle_t io_handle, const esp_sccb_reg_t *regs, size_t reg_num, uint32_t flags)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+    ESP_RETURN_ON_FALSE(regs || !reg_num, ESP_ERR_INVALID_ARG, TAG, "invalid argument: regs null pointer");
+
+    if (!reg_num) {
+        return ESP_OK;
+    }
+
+    for (size_t i = 0; i < reg_num; i++) {
+        sccb_defer_drop(io_handle, regs[i].reg);
+    }
+
+    if (io_handle->transmit_burst) {
+        ret = io_handle->transmit_burst(io_handle, regs, reg_num, flags, ESP_SCCB_TRANS_DEALY);
+        if (ret != ESP_OK) {
+            sccb_shadow_clear(io_handle);
+            return ret;
+        }
+
+        for (size_t i = 0; i < reg_num; i++) {
+            sccb_shadow_write(io_handle, regs[i].reg, regs[i].val);
+        }
+
+        return ESP_OK;
+    }
+
+    for (size_t i = 0; i < reg_num; i++) {
+        uint8_t data[3];
+        size_t size = 0;
+
+        /* Register tables are written as they are, so don't skip registers by register shadow */
+        if (flags & ESP_SCCB_BURST_FLAG_ADDR_16BIT) {
+            ESP_RETURN_ON_FALSE(io_handle->transmit_reg_a16v8, ESP_ERR_NOT_SUPPORTED, TAG, "controller driver function not supported");
+            data[size++] = (regs[i].reg & 0xff00) >> 8;
+            data[size++] = regs[i].reg & 0xff;
+            data[size++] = regs[i].val;
+            ret = io_handle->transmit_reg_a16v8(io_handle, data, size, ESP_SCCB_TRANS_DEALY);
+        } else {
+            ESP_RETURN_ON_FALSE(io_handle->transmit_reg_a8v8, ESP_ERR_NOT_SUPPORTED, TAG, "controller driver function not supported");
+            data[size++] = regs[i].reg & 0xff;
+            data[size++] = regs[i].val;
+            ret = io_handle->transmit_reg_a8v8(io_handle, data, size, ESP_SCCB_TRANS_DEALY);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to transmit reg:0x%04x, ret:%d", regs[i].reg, ret);
+            sccb_shadow_clear(io_handle);
+            break;
+        }
+
+        sccb_shadow_write(io_handle, regs[i].reg, regs[i].val);
+    }
+
+    return ret;
+}
+
+esp_err_t esp_sccb_update_reg_a16v8(esp_sccb_io_handle_t io_handle, uint16_t reg_addr, uint8_t mask, uint8_t reg_val)
+{
+    uint8_t val;
+
+    ESP_RETURN_ON_ERROR(esp_sccb_transmit_receive_reg_a16v8(io_handle, reg_addr, &val), TAG, "failed to read reg:0x%04x", reg_addr);
+    val = (val & ~mask) | (reg_val & mask);
+
+    return esp_sccb_transmit_reg_a16v8(io_handle, reg_addr, val);
+}
+
+esp_err_t esp_sccb_update_reg_a8v8(esp_sccb_io_handle_t io_handle, uint8_t reg_addr, uint8_t mask, uint8_t reg_val)
+{
+    uint8_t val;
+
+    ESP_RETURN_ON_ERROR(esp_sccb_transmit_receive_reg_a8v8(io_handle, reg_addr, &val), TAG, "failed to read reg:0x%02x", reg_addr);
+    val = (val & ~mask) | (reg_val & mask);
+
+    return esp_sccb_transmit_reg_a8v8(io_handle, reg_addr, val);
+}
+
 esp_err_t esp_sccb_del_i2c_io(esp_sccb_io_handle_t io_handle)
 {
     ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
     ESP_RETURN_ON_FALSE(io_handle->del, ESP_ERR_NOT_SUPPORTED, TAG, "controller driver function not supported");
 
+#if CONFIG_ESP_SCCB_ENABLE_DEFERRED_WRITE
+    esp_sccb_defer_disable(io_handle);
+#endif
+#if CONFIG_ESP_SCCB_ENABLE_REG_SHADOW
+    esp_sccb_shadow_disable(io_handle);
+#endif
+
     return io_handle->del(io_handle);
 }
@@ -0,0 +1,61 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include "esp_sccb_types.h"
+#include "sccb_burst.h"
+
+static esp_err_t sccb_burst_flush(sccb_burst_t *burst, sccb_burst_flush_t flush, void *arg)
+{
+    esp_err_t ret = flush(burst, arg);
+
+    burst->size = 0;
+    burst->seg_num = 0;
+
+    return ret;
+}
+
+esp_err_t sccb_burst_pack(sccb_burst_t *burst, uint8_t write_addr, const esp_sccb_reg_t *regs, size_t reg_num,
+                          uint32_t flags, sccb_burst_flush_t flush, void *arg)
+{
+    esp_err_t ret;
+    size_t addr_size = (flags & ESP_SCCB_BURST_FLAG_ADDR_16BIT) ? 2 : 1;
+    bool auto_inc = flags & ESP_SCCB_BURST_FLAG_AUTO_INC;
+
+    burst->size = 0;
+    burst->seg_num = 0;
+
+    for (size_t i = 0; i < reg_num; i++) {
+        /* The previous register is always the last byte of the last transfer if the buffer is not empty */
+        bool append = auto_inc && burst->seg_num && (regs[i].reg == (uint16_t)(regs[i - 1].reg + 1)) &&
+                      (burst->size < SCCB_BURST_TRANS_SIZE);
+
+        if (!append) {
+            if ((burst->seg_num >= SCCB_BURST_SEG_MAX) || (burst->size + 1 + addr_size + 1 > SCCB_BURST_TRANS_SIZE)) {
+                ret = sccb_burst_flush(burst, flush, arg);
+                if (ret != ESP_OK) {
+                    return ret;
+                }
+            }
+
+            burst->seg_offset[burst->seg_num++] = burst->size;
+            burst->buffer[burst->size++] = write_addr;
+            if (addr_size == 2) {
+                burst->buffer[burst->size++] = (regs[i].reg & 0xff00) >> 8;
+            }
+            burst->buffer[burst->size++] = regs[i].reg & 0xff;
+        }
+
+        burst->buffer[burst->size++] = regs[i].val;
+        burst->seg_offset[burst->seg_num] = burst->size;
+    }
+
+    if (burst->seg_num) {
+        return sccb_burst_flush(burst, flush, arg);
+    }
+
+    return ESP_OK;
+}
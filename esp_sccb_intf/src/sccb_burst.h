@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_sccb_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCCB_BURST_TRANS_SIZE           CONFIG_ESP_SCCB_BURST_TRANS_SIZE
+#define SCCB_BURST_SEG_MAX              8
+
+/**
+ * @brief SCCB burst transmit context, it is small enough to be put on the stack of the caller
+ *
+ * Every transfer in buffer starts with the device address byte, then the register address
+ * and the values of consecutive registers.
+ */
+typedef struct sccb_burst {
+    size_t size;                                            /*!< Used bytes of buffer */
+    size_t seg_num;                                         /*!< Number of transfers in buffer */
+    uint16_t seg_offset[SCCB_BURST_SEG_MAX + 1];            /*!< Transfer start offsets in buffer, the last one is the end offset */
+    uint8_t buffer[SCCB_BURST_TRANS_SIZE];                  /*!< Device address, register address and value bytes of transfers */
+} sccb_burst_t;
+
+/**
+ * @brief SCCB burst transaction callback, it sends all transfers of the burst in one bus transaction
+ *
+ * @param burst SCCB burst transmit context
+ * @param arg   User argument passed to sccb_burst_pack
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+typedef esp_err_t (*sccb_burst_flush_t)(const sccb_burst_t *burst, void *arg);
+
+/**
+ * @brief Pack registers into bus transactions, consecutive registers are merged into one
+ *        transfer if ESP_SCCB_BURST_FLAG_AUTO_INC is set.
+ *
+ * @param burst     SCCB burst transmit context
+ * @param write_addr Device address byte of write transfers
+ * @param regs      Register array
+ * @param reg_num   Register count
+ * @param flags     Burst transmit flags, ESP_SCCB_BURST_FLAG_x
+ * @param flush     Called when a transaction is full and after the last register
+ * @param arg       User argument of "flush"
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others returned by "flush"
+ */
+esp_err_t sccb_burst_pack(sccb_burst_t *burst, uint8_t write_addr, const esp_sccb_reg_t *regs, size_t reg_num,
+                          uint32_t flags, sccb_burst_flush_t flush, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
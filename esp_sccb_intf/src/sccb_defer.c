@@ -0,0 +1,363 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include <sys/cdefs.h>
+#include "esp_types.h"
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_sccb_io_interface.h"
+#include "esp_sccb_intf.h"
+#include "sccb_defer.h"
+
+#define SCCB_DEFER_MEM_CAPS         (MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL)
+#define SCCB_DEFER_RETRY_MAX        3       /* Flushes of the same writes before they are dropped */
+#define SCCB_DEFER_DROP_WAITERS_MAX 32      /* Tasks which can wait for a flush at the same time */
+
+/**
+ * @brief Deferred write queue object
+ *
+ * Writes are appended to "queued", and the flush trigger swaps "queued" and
+ * "flushing" so that the flush task can write them without holding the lock.
+ */
+struct esp_sccb_defer {
+    portMUX_TYPE lock;                              /*!< Queue lock */
+    TaskHandle_t task;                              /*!< Flush task */
+    SemaphoreHandle_t exit_sem;                     /*!< Given by flush task when it exits */
+    SemaphoreHandle_t drop_sem;                     /*!< Given by flush task to each drop waiter when a flush finishes */
+    uint32_t drop_waiters;                          /*!< Number of tasks waiting for the flush of a register they write */
+    volatile bool running;                          /*!< false: flush task should exit */
+
+    TaskHandle_t queue_task;                        /*!< Task which is queueing writes, NULL if none */
+    size_t group_start;                             /*!< Index of the first write queued by queue_task */
+    bool group_failed;                              /*!< true: queue_task's writes have been dropped for no slot */
+    uint32_t fail_count;                            /*!< Number of failed flushes in a row */
+    bool addr_16bit;                                /*!< Register address width of queued writes */
+    esp_sccb_defer_done_cb_t on_done;               /*!< Flush done callback */
+    void *user_data;                                /*!< User data of flush done callback */
+
+    size_t max_reg_num;                             /*!< Register slot count of both queues */
+    size_t queued_num;                              /*!< Number of queued writes */
+    esp_sccb_reg_t *queued;                         /*!< Writes waiting for flush */
+    size_t flushing_num;                            /*!< Number of writes flush task is writing, 0 if idle */
+    esp_sccb_reg_t *flushing;                       /*!< Writes flush task is writing */
+    uint32_t flushing_sequence;                     /*!< Sequence number of flushing writes */
+};
+
+static const char *TAG = "sccb_defer";
+
+/* Put writes failed to flush back to the queue head, so that the next flush retries them. Must be called in the lock */
+static bool sccb_defer_requeue(struct esp_sccb_defer *defer, const esp_sccb_reg_t *regs, size_t reg_num)
+{
+    if ((++defer->fail_count > SCCB_DEFER_RETRY_MAX) || (defer->queued_num + reg_num > defer->max_reg_num)) {
+        defer->fail_count = 0;
+        return false;
+    }
+
+    memmove(&defer->queued[reg_num], defer->queued, defer->queued_num * sizeof(esp_sccb_reg_t));
+    memcpy(defer->queued, regs, reg_num * sizeof(esp_sccb_reg_t));
+    defer->queued_num += reg_num;
+    if (defer->queue_task) {
+        defer->group_start += reg_num;
+    }
+
+    return true;
+}
+
+static void sccb_defer_task(void *arg)
+{
+    esp_err_t ret;
+    esp_sccb_io_handle_t io_handle = (esp_sccb_io_handle_t)arg;
+    struct esp_sccb_defer *defer = io_handle->defer;
+
+    while (defer->running) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (!defer->running || !defer->flushing_num) {
+            continue;
+        }
+
+        ret = esp_sccb_transmit_burst(io_handle, defer->flushing, defer->flushing_num,
+                                      defer->addr_16bit ? ESP_SCCB_BURST_FLAG_ADDR_16BIT : 0);
+
+        /**
+         * Camera drivers record control values when the writes are queued, so retry failed writes
+         * in the next flush rather than leave the device behind the values reported by drivers.
+         */
+        bool requeued = false;
+        portENTER_CRITICAL(&defer->lock);
+        if (ret == ESP_OK) {
+            defer->fail_count = 0;
+        } else {
+            requeued = sccb_defer_requeue(defer, defer->flushing, defer->flushing_num);
+        }
+        portEXIT_CRITICAL(&defer->lock);
+
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to flush %zu registers, ret:%d, %s", defer->flushing_num, ret, requeued ? "retry" : "dropped");
+        }
+
+        if (defer->on_done) {
+            defer->on_done(io_handle, defer->flushing_sequence, ret, defer->user_data);
+        }
+
+        portENTER_CRITICAL(&defer->lock);
+        uint32_t waiters = defer->drop_waiters;
+        defer->flushing_num = 0;
+        defer->drop_waiters = 0;
+        portEXIT_CRITICAL(&defer->lock);
+
+        while (waiters--) {
+            xSemaphoreGive(defer->drop_sem);
+        }
+    }
+
+    xSemaphoreGive(defer->exit_sem);
+    vTaskDelete(NULL);
+}
+
+bool sccb_defer_write(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val, bool addr_16bit, esp_err_t *ret)
+{
+    struct esp_sccb_defer *defer = io_handle->defer;
+
+    if (!defer || (defer->queue_task != xTaskGetCurrentTaskHandle())) {
+        return false;
+    }
+
+    bool dropped = false;
+
+    /* Writes are not merged, because sensors need some registers written twice, e.g. group hold */
+    portENTER_CRITICAL(&defer->lock);
+    if (defer->group_failed) {
+        *ret = ESP_ERR_NO_MEM;
+    } else if (defer->queued_num < defer->max_reg_num) {
+        defer->queued[defer->queued_num].reg = reg;
+        defer->queued[defer->queued_num].val = val;
+        defer->queued_num++;
+        defer->addr_16bit = addr_16bit;
+        *ret = ESP_OK;
+    } else {
+        /* A part of the writes between begin and end must not be flushed, so drop all of them */
+        defer->queued_num = defer->group_start;
+        defer->group_failed = true;
+        dropped = true;
+        *ret = ESP_ERR_NO_MEM;
+    }
+    portEXIT_CRITICAL(&defer->lock);
+
+    if (dropped) {
+        ESP_LOGE(TAG, "no slot for reg:0x%04x, drop queued writes of this task", reg);
+    }
+
+    return true;
+}
+
+void sccb_defer_drop(esp_sccb_io_handle_t io_handle, uint16_t reg)
+{
+    bool in_flight;
+    struct esp_sccb_defer *defer = io_handle->defer;
+
+    if (!defer || (defer->task == xTaskGetCurrentTaskHandle())) {
+        return;
+    }
+
+    do {
+        size_t n = 0;
+        size_t group_start;
+
+        in_flight = false;
+        portENTER_CRITICAL(&defer->lock);
+        group_start = defer->group_start;
+        for (size_t i = 0; i < defer->queued_num; i++) {
+            if (defer->queued[i].reg != reg) {
+                defer->queued[n++] = defer->queued[i];
+            } else if (i < defer->group_start) {
+                group_start--;
+            }
+        }
+        defer->queued_num = n;
+        defer->group_start = group_start;
+
+        for (size_t i = 0; i < defer->flushing_num; i++) {
+            if (defer->flushing[i].reg == reg) {
+                in_flight = true;
+                defer->drop_waiters++;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&defer->lock);
+
+        /* The flush task is writing an older value of the register, so write this one after it */
+        if (in_flight) {
+            xSemaphoreTake(defer->drop_sem, portMAX_DELAY);
+        }
+    } while (in_flight);
+}
+
+esp_err_t esp_sccb_defer_enable(esp_sccb_io_handle_t io_handle, const esp_sccb_defer_config_t *config)
+{
+    esp_err_t ret;
+    ESP_RETURN_ON_FALSE(io_handle && config, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+    ESP_RETURN_ON_FALSE(!io_handle->defer, ESP_ERR_INVALID_STATE, TAG, "deferred write has been enabled");
+
+    size_t max_reg_num = config->max_reg_num ? config->max_reg_num : CONFIG_ESP_SCCB_DEFER_REG_NUM;
+    uint32_t priority = config->task_priority ? config->task_priority : CONFIG_ESP_SCCB_DEFER_TASK_PRIORITY;
+    uint32_t stack_size = config->task_stack_size ? config->task_stack_size : CONFIG_ESP_SCCB_DEFER_TASK_STACK_SIZE;
+
+    size_t size = sizeof(struct esp_sccb_defer) + max_reg_num * 2 * sizeof(esp_sccb_reg_t);
+    struct esp_sccb_defer *defer = heap_caps_calloc(1, size, SCCB_DEFER_MEM_CAPS);
+    ESP_RETURN_ON_FALSE(defer, ESP_ERR_NO_MEM, TAG, "no mem for deferred write");
+
+    portMUX_INITIALIZE(&defer->lock);
+    defer->max_reg_num = max_reg_num;
+    defer->queued = (esp_sccb_reg_t *)(defer + 1);
+    defer->flushing = defer->queued + max_reg_num;
+    defer->on_done = config->on_done;
+    defer->user_data = config->user_data;
+
+    defer->exit_sem = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(defer->exit_sem, ESP_ERR_NO_MEM, exit_0, TAG, "failed to create exit semaphore");
+
+    defer->drop_sem = xSemaphoreCreateCounting(SCCB_DEFER_DROP_WAITERS_MAX, 0);
+    ESP_GOTO_ON_FALSE(defer->drop_sem, ESP_ERR_NO_MEM, exit_1, TAG, "failed to create drop semaphore");
+
+    defer->running = true;
+    io_handle->defer = defer;
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(sccb_defer_task, "sccb_defer", stack_size, io_handle, priority,
+                      &defer->task, tskNO_AFFINITY) == pdPASS, ESP_ERR_NO_MEM, exit_2, TAG, "failed to create flush task");
+
+    ESP_LOGD(TAG, "enable deferred write: %p, %zu registers", defer, max_reg_num);
+
+    return ESP_OK;
+
+exit_2:
+    io_handle->defer = NULL;
+    vSemaphoreDelete(defer->drop_sem);
+exit_1:
+    vSemaphoreDelete(defer->exit_sem);
+exit_0:
+    heap_caps_free(defer);
+    return ret;
+}
+
+esp_err_t esp_sccb_defer_begin(esp_sccb_io_handle_t io_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    struct esp_sccb_defer *defer = io_handle->defer;
+    ESP_RETURN_ON_FALSE(defer, ESP_ERR_INVALID_STATE, TAG, "deferred write is not enabled");
+
+    portENTER_CRITICAL(&defer->lock);
+    if (!defer->queue_task) {
+        defer->queue_task = xTaskGetCurrentTaskHandle();
+        defer->group_start = defer->queued_num;
+        defer->group_failed = false;
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    portEXIT_CRITICAL(&defer->lock);
+
+    return ret;
+}
+
+esp_err_t esp_sccb_defer_end(esp_sccb_io_handle_t io_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    struct esp_sccb_defer *defer = io_handle->defer;
+    ESP_RETURN_ON_FALSE(defer, ESP_ERR_INVALID_STATE, TAG, "deferred write is not enabled");
+
+    portENTER_CRITICAL(&defer->lock);
+    if (defer->queue_task == xTaskGetCurrentTaskHandle()) {
+        defer->queue_task = NULL;
+        defer->group_failed = false;
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    portEXIT_CRITICAL(&defer->lock);
+
+    return ret;
+}
+
+esp_err_t IRAM_ATTR esp_sccb_defer_flush_from_isr(esp_sccb_io_handle_t io_handle, uint32_t sequence)
+{
+    bool wakeup = false;
+    BaseType_t task_woken = pdFALSE;
+    ESP_RETURN_ON_FALSE_ISR(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    struct esp_sccb_defer *defer = io_handle->defer;
+    if (!defer) {
+        return ESP_OK;
+    }
+
+    portENTER_CRITICAL_SAFE(&defer->lock);
+    if (!defer->queue_task && defer->queued_num && !defer->flushing_num) {
+        esp_sccb_reg_t *regs = defer->flushing;
+
+        defer->flushing = defer->queued;
+        defer->flushing_num = defer->queued_num;
+        defer->flushing_sequence = sequence;
+        defer->queued = regs;
+        defer->queued_num = 0;
+        wakeup = true;
+    }
+    portEXIT_CRITICAL_SAFE(&defer->lock);
+
+    if (wakeup) {
+        vTaskNotifyGiveFromISR(defer->task, &task_woken);
+        if (task_woken == pdTRUE) {
+            portYIELD_FROM_ISR();
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_sccb_defer_disable(esp_sccb_io_handle_t io_handle)
+{
+    ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    struct esp_sccb_defer *defer = io_handle->defer;
+    if (!defer) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = ESP_OK;
+    uint32_t flags = defer->addr_16bit ? ESP_SCCB_BURST_FLAG_ADDR_16BIT : 0;
+
+    /* Wait for the flush in process to finish */
+    defer->running = false;
+    xTaskNotifyGive(defer->task);
+    xSemaphoreTake(defer->exit_sem, portMAX_DELAY);
+
+    /* Camera drivers have recorded the values of writes not flushed yet, so write them now */
+    io_handle->defer = NULL;
+    if (defer->flushing_num) {
+        ret = esp_sccb_transmit_burst(io_handle, defer->flushing, defer->flushing_num, flags);
+    }
+    if ((ret == ESP_OK) && defer->queued_num) {
+        ret = esp_sccb_transmit_burst(io_handle, defer->queued, defer->queued_num, flags);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to write queued registers, ret:%d", ret);
+    }
+
+    vSemaphoreDelete(defer->drop_sem);
+    vSemaphoreDelete(defer->exit_sem);
+    heap_caps_free(defer);
+
+    return ret;
+}
@@ -0,0 +1,59 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_sccb_io_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ESP_SCCB_ENABLE_DEFERRED_WRITE
+/**
+ * @brief Queue register write if the calling task is queueing writes.
+ *
+ * @param io_handle SCCB IO handle
+ * @param reg       Register address
+ * @param val       Register value
+ * @param addr_16bit true: 16-bit register address, false: 8-bit register address
+ * @param ret       Result of queueing, only valid when returning true
+ *
+ * @return
+ *      - true if the write is handled by deferred write queue
+ *      - false if the write should be transmitted now
+ */
+bool sccb_defer_write(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val, bool addr_16bit, esp_err_t *ret);
+
+/**
+ * @brief Drop the queued writes of a register before it is written on the bus directly, and wait
+ *        for the flush task if it is writing the register, so that older deferred values never
+ *        overwrite the direct write.
+ *
+ * @param io_handle SCCB IO handle
+ * @param reg       Register address
+ *
+ * @return None
+ */
+void sccb_defer_drop(esp_sccb_io_handle_t io_handle, uint16_t reg);
+#else
+static inline bool sccb_defer_write(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val, bool addr_16bit, esp_err_t *ret)
+{
+    return false;
+}
+
+static inline void sccb_defer_drop(esp_sccb_io_handle_t io_handle, uint16_t reg)
+{
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,212 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include <sys/cdefs.h>
+#include "esp_types.h"
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_sccb_io_interface.h"
+#include "esp_sccb_intf.h"
+#include "sccb_shadow.h"
+
+#define SCCB_SHADOW_MEM_CAPS        MALLOC_CAP_DEFAULT
+#define SCCB_SHADOW_HASH(reg)       (((uint32_t)(reg) * 2654435761u) >> 16)
+
+/**
+ * @brief Register shadow slot
+ */
+typedef struct sccb_shadow_slot {
+    uint16_t reg;                                   /*!< Register address */
+    uint8_t val;                                    /*!< Register value */
+    uint8_t valid;                                  /*!< 1: slot is in use */
+} sccb_shadow_slot_t;
+
+/**
+ * @brief Register shadow object, a fixed size hash table with linear probing
+ */
+struct esp_sccb_shadow {
+    portMUX_TYPE lock;                              /*!< Slot lock */
+    int32_t reset_reg;                              /*!< Soft reset register, -1 if none */
+    uint8_t reset_mask;                             /*!< Soft reset bits of reset_reg */
+    esp_sccb_reg_range_t *volatile_ranges;          /*!< Registers which are never cached */
+    size_t volatile_range_num;                      /*!< Number of volatile register ranges */
+    uint32_t max_reg_num;                           /*!< Maximum number of registers cached */
+    uint32_t reg_num;                               /*!< Number of registers cached */
+    uint32_t slot_mask;                             /*!< Slot count minus 1, slot count is a power of 2 */
+    sccb_shadow_slot_t *slot;                       /*!< Slot array */
+};
+
+static const char *TAG = "sccb_shadow";
+
+static bool sccb_shadow_is_volatile(struct esp_sccb_shadow *shadow, uint16_t reg)
+{
+    for (size_t i = 0; i < shadow->volatile_range_num; i++) {
+        if ((reg >= shadow->volatile_ranges[i].start) && (reg <= shadow->volatile_ranges[i].end)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Return the slot of register, or the empty slot to put it in */
+static sccb_shadow_slot_t *sccb_shadow_find_slot(struct esp_sccb_shadow *shadow, uint16_t reg)
+{
+    uint32_t index = SCCB_SHADOW_HASH(reg);
+
+    /* There is always an empty slot because slots are at least twice as many as cached registers */
+    while (1) {
+        sccb_shadow_slot_t *slot = &shadow->slot[index & shadow->slot_mask];
+
+        if (!slot->valid || (slot->reg == reg)) {
+            return slot;
+        }
+
+        index++;
+    }
+}
+
+bool sccb_shadow_get(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t *val)
+{
+    bool cached = false;
+    struct esp_sccb_shadow *shadow = io_handle->shadow;
+
+    if (!shadow) {
+        return false;
+    }
+
+    portENTER_CRITICAL_SAFE(&shadow->lock);
+    sccb_shadow_slot_t *slot = sccb_shadow_find_slot(shadow, reg);
+    if (slot->valid) {
+        *val = slot->val;
+        cached = true;
+    }
+    portEXIT_CRITICAL_SAFE(&shadow->lock);
+
+    return cached;
+}
+
+void sccb_shadow_set(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val)
+{
+    struct esp_sccb_shadow *shadow = io_handle->shadow;
+
+    if (!shadow) {
+        return;
+    }
+
+    /* Reading the soft reset register doesn't reset the device, it is just not cached */
+    if ((reg == shadow->reset_reg) || sccb_shadow_is_volatile(shadow, reg)) {
+        return;
+    }
+
+    portENTER_CRITICAL_SAFE(&shadow->lock);
+    sccb_shadow_slot_t *slot = sccb_shadow_find_slot(shadow, reg);
+    if (slot->valid) {
+        slot->val = val;
+    } else if (shadow->reg_num < shadow->max_reg_num) {
+        slot->reg = reg;
+        slot->val = val;
+        slot->valid = 1;
+        shadow->reg_num++;
+    }
+    portEXIT_CRITICAL_SAFE(&shadow->lock);
+}
+
+void sccb_shadow_write(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val)
+{
+    struct esp_sccb_shadow *shadow = io_handle->shadow;
+
+    if (!shadow) {
+        return;
+    }
+
+    if (reg == shadow->reset_reg) {
+        if (val & shadow->reset_mask) {
+            sccb_shadow_clear(io_handle);
+        }
+        return;
+    }
+
+    sccb_shadow_set(io_handle, reg, val);
+}
+
+void sccb_shadow_clear(esp_sccb_io_handle_t io_handle)
+{
+    struct esp_sccb_shadow *shadow = io_handle->shadow;
+
+    if (!shadow) {
+        return;
+    }
+
+    portENTER_CRITICAL_SAFE(&shadow->lock);
+    memset(shadow->slot, 0, (shadow->slot_mask + 1) * sizeof(sccb_shadow_slot_t));
+    shadow->reg_num = 0;
+    portEXIT_CRITICAL_SAFE(&shadow->lock);
+}
+
+esp_err_t esp_sccb_shadow_enable(esp_sccb_io_handle_t io_handle, const esp_sccb_shadow_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(io_handle && config, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+    ESP_RETURN_ON_FALSE(config->volatile_ranges || !config->volatile_range_num, ESP_ERR_INVALID_ARG, TAG, "invalid argument: volatile ranges null pointer");
+    ESP_RETURN_ON_FALSE(!io_handle->shadow, ESP_ERR_INVALID_STATE, TAG, "register shadow has been enabled");
+
+    uint32_t max_reg_num = config->max_reg_num ? config->max_reg_num : CONFIG_ESP_SCCB_REG_SHADOW_SIZE;
+    ESP_RETURN_ON_FALSE(max_reg_num <= UINT16_MAX + 1, ESP_ERR_INVALID_ARG, TAG, "invalid argument: max_reg_num");
+
+    uint32_t slot_num = 1;
+    while (slot_num < max_reg_num * 2) {
+        slot_num <<= 1;
+    }
+
+    size_t ranges_size = config->volatile_range_num * sizeof(esp_sccb_reg_range_t);
+    size_t size = sizeof(struct esp_sccb_shadow) + slot_num * sizeof(sccb_shadow_slot_t) + ranges_size;
+    struct esp_sccb_shadow *shadow = heap_caps_calloc(1, size, SCCB_SHADOW_MEM_CAPS);
+    ESP_RETURN_ON_FALSE(shadow, ESP_ERR_NO_MEM, TAG, "no mem for register shadow");
+
+    portMUX_INITIALIZE(&shadow->lock);
+    shadow->reset_reg = config->reset_reg;
+    shadow->reset_mask = config->reset_mask ? config->reset_mask : 0xff;
+    shadow->max_reg_num = max_reg_num;
+    shadow->slot_mask = slot_num - 1;
+    shadow->slot = (sccb_shadow_slot_t *)(shadow + 1);
+    shadow->volatile_ranges = (esp_sccb_reg_range_t *)(shadow->slot + slot_num);
+    shadow->volatile_range_num = config->volatile_range_num;
+    if (ranges_size) {
+        memcpy(shadow->volatile_ranges, config->volatile_ranges, ranges_size);
+    }
+
+    io_handle->shadow = shadow;
+    ESP_LOGD(TAG, "enable shadow: %p, %" PRIu32 " registers", shadow, max_reg_num);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_sccb_shadow_invalidate(esp_sccb_io_handle_t io_handle)
+{
+    ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    sccb_shadow_clear(io_handle);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_sccb_shadow_disable(esp_sccb_io_handle_t io_handle)
+{
+    ESP_RETURN_ON_FALSE(io_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    if (io_handle->shadow) {
+        heap_caps_free(io_handle->shadow);
+        io_handle->shadow = NULL;
+    }
+
+    return ESP_OK;
+}
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_sccb_io_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ESP_SCCB_ENABLE_REG_SHADOW
+/**
+ * @brief Get cached register value from register shadow.
+ *
+ * @param io_handle SCCB IO handle
+ * @param reg       Register address
+ * @param val       Register value buffer pointer
+ *
+ * @return
+ *      - true if register is cached
+ *      - false if register shadow is not enabled or register is not cached
+ */
+bool sccb_shadow_get(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t *val);
+
+/**
+ * @brief Record register value which has been read from device.
+ *
+ * @param io_handle SCCB IO handle
+ * @param reg       Register address
+ * @param val       Register value
+ *
+ * @return None
+ */
+void sccb_shadow_set(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val);
+
+/**
+ * @brief Record register value which has been written to device, writing the soft
+ *        reset value to the soft reset register drops all cached registers.
+ *
+ * @param io_handle SCCB IO handle
+ * @param reg       Register address
+ * @param val       Register value
+ *
+ * @return None
+ */
+void sccb_shadow_write(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val);
+
+/**
+ * @brief Drop all cached registers, called when the register state of device is unknown.
+ *
+ * @param io_handle SCCB IO handle
+ *
+ * @return None
+ */
+void sccb_shadow_clear(esp_sccb_io_handle_t io_handle);
+#else
+static inline bool sccb_shadow_get(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t *val)
+{
+    return false;
+}
+
+static inline void sccb_shadow_set(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val)
+{
+}
+
+static inline void sccb_shadow_write(esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val)
+{
+}
+
+static inline void sccb_shadow_clear(esp_sccb_io_handle_t io_handle)
+{
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
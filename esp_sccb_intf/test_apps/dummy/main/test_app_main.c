@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -10,11 +10,15 @@
 #include "esp_sccb_i2c.h"
 
 extern void test_op(esp_sccb_io_handle_t handle);
+extern void test_update_op(esp_sccb_io_handle_t handle);
+extern void test_burst_op(esp_sccb_io_handle_t handle);
 
 void app_main(void)
 {
     sccb_i2c_config_t config = {};
     esp_sccb_io_handle_t handle = NULL;
     sccb_new_i2c_io(NULL, &config, &handle);
+    test_update_op(handle);
+    test_burst_op(handle);
     test_op(handle);
 }
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -11,3 +11,21 @@ void test_op(esp_sccb_io_handle_t handle)
     esp_sccb_transmit_reg_a8v8(handle, 0, 0);
     esp_sccb_del_i2c_io(handle);
 }
+
+void test_update_op(esp_sccb_io_handle_t handle)
+{
+    esp_sccb_update_reg_a8v8(handle, 0x12, 0x06, 0x06);
+    esp_sccb_update_reg_a16v8(handle, 0x3221, 0x06, 0x06);
+}
+
+void test_burst_op(esp_sccb_io_handle_t handle)
+{
+    const esp_sccb_reg_t regs[] = {
+        {0x3018, 0x32},
+        {0x3019, 0x0c},
+        {0x301f, 0x12},
+    };
+
+    esp_sccb_transmit_burst(handle, regs, sizeof(regs) / sizeof(regs[0]), ESP_SCCB_BURST_FLAG_ADDR_16BIT);
+    esp_sccb_transmit_burst(handle, regs, sizeof(regs) / sizeof(regs[0]), ESP_SCCB_BURST_FLAG_ADDR_16BIT | ESP_SCCB_BURST_FLAG_AUTO_INC);
+}
@@ -0,0 +1,643 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+#include "unity.h"
+
+#include "esp_sccb_intf.h"
+#include "esp_sccb_sim.h"
+/**
+ * Deferred write tests flush queued writes from a GPTimer interrupt, and from a FreeRTOS
+ * software timer on the host, which has no GPTimer
+ */
+#define TEST_DEFER_ENABLED          CONFIG_ESP_SCCB_ENABLE_DEFERRED_WRITE
+#define TEST_DEFER_GPTIMER          (TEST_DEFER_ENABLED && CONFIG_SOC_GPTIMER_SUPPORTED)
+
+#if TEST_DEFER_ENABLED
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#if TEST_DEFER_GPTIMER
+#include "driver/gptimer.h"
+#else
+#include "freertos/timers.h"
+#endif
+#endif
+
+#define TEST_SCCB_ADDR              0x30
+#define TEST_SCCB_FREQ              100000
+#define TEST_BURST_REG_START        0x3200
+#define TEST_BURST_REG_NUM          16
+
+/* START and STOP, device address byte, 2 register address bytes and the value byte, 9 bits per byte */
+#define TEST_A16V8_WRITE_NS         ((4 * 9 + 2) * 1000000000ULL / TEST_SCCB_FREQ)
+
+static const esp_sccb_reg_t s_test_model[] = {
+    {0x3107, 0xcb},
+    {0x3108, 0x3a},
+};
+
+static esp_sccb_io_handle_t test_new_sim_io(bool disable_burst)
+{
+    esp_sccb_io_handle_t io_handle = NULL;
+    sccb_sim_config_t config = {
+        .device_address = TEST_SCCB_ADDR,
+        .scl_speed_hz = TEST_SCCB_FREQ,
+        .addr_bits_width = 16,
+        .regs = s_test_model,
+        .reg_num = sizeof(s_test_model) / sizeof(s_test_model[0]),
+        .disable_burst = disable_burst,
+    };
+
+    TEST_ESP_OK(sccb_new_sim_io(&config, &io_handle));
+    TEST_ASSERT_NOT_NULL(io_handle);
+
+    return io_handle;
+}
+
+TEST_CASE("SCCB simulator register model", "[sccb_sim]")
+{
+    uint8_t val8;
+    uint16_t val16;
+    uint32_t val32;
+    esp_sccb_io_handle_t io_handle = test_new_sim_io(false);
+
+    /* Chip ID is loaded from the model */
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v16(io_handle, 0x3107, &val16));
+    TEST_ASSERT_EQUAL_HEX16(0xcb3a, val16);
+
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(io_handle, 0x0100, 0x01));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, 0x0100, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0x01, val8);
+
+    /* Multi-byte values go to consecutive registers, high byte first */
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v16(io_handle, 0x3e01, 0x1234));
+    TEST_ESP_OK(sccb_sim_get_reg(io_handle, 0x3e01, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0x12, val8);
+    TEST_ESP_OK(sccb_sim_get_reg(io_handle, 0x3e02, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0x34, val8);
+
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v32(io_handle, 0x4000, 0x89abcdef));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v32(io_handle, 0x4000, &val32));
+    TEST_ASSERT_EQUAL_HEX32(0x89abcdef, val32);
+
+    TEST_ESP_OK(sccb_sim_set_reg(io_handle, 0x3e03, 0x5a));
+    TEST_ESP_OK(esp_sccb_update_reg_a16v8(io_handle, 0x3e03, 0x0f, 0x03));
+    TEST_ESP_OK(sccb_sim_get_reg(io_handle, 0x3e03, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0x53, val8);
+
+    TEST_ESP_OK(esp_sccb_transmit_v16(io_handle, 0x1357));
+    TEST_ESP_OK(esp_sccb_receive_v16(io_handle, &val16));
+    TEST_ASSERT_EQUAL_HEX16(0x1357, val16);
+
+    TEST_ESP_OK(esp_sccb_del_i2c_io(io_handle));
+}
+
+TEST_CASE("SCCB simulator bus accounting", "[sccb_sim]")
+{
+    uint8_t val8;
+    uint16_t val16;
+    sccb_sim_stats_t stats;
+    esp_sccb_io_handle_t io_handle = test_new_sim_io(false);
+
+    TEST_ESP_OK(sccb_sim_get_stats(io_handle, &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.transactions);
+
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(io_handle, 0x3e00, 0x10));
+    TEST_ESP_OK(sccb_sim_get_stats(io_handle, &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.write_regs);
+    TEST_ASSERT_EQUAL_UINT64(4, stats.bytes);
+    TEST_ASSERT_EQUAL_UINT64(TEST_A16V8_WRITE_NS, stats.bus_time_ns);
+
+    /* Register address write and value read are joined by a repeated START */
+    TEST_ESP_OK(sccb_sim_reset_stats(io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, 0x3e00, &val8));
+    TEST_ESP_OK(sccb_sim_get_stats(io_handle, &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.read_regs);
+    TEST_ASSERT_EQUAL_UINT64(5, stats.bytes);
+    TEST_ASSERT_EQUAL_UINT64((5 * 9 + 3) * 1000000000ULL / TEST_SCCB_FREQ, stats.bus_time_ns);
+
+    /* A 16-bit value counts one register per byte, as burst writes of the same registers do */
+    TEST_ESP_OK(sccb_sim_reset_stats(io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v16(io_handle, 0x3e00, 0x1234));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v16(io_handle, 0x3e00, &val16));
+    TEST_ASSERT_EQUAL_HEX16(0x1234, val16);
+    TEST_ESP_OK(sccb_sim_get_stats(io_handle, &stats));
+    TEST_ASSERT_EQUAL_UINT32(2, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.write_regs);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.read_regs);
+
+    /* Direct model access is not a bus access */
+    TEST_ESP_OK(sccb_sim_reset_stats(io_handle));
+    TEST_ESP_OK(sccb_sim_set_reg(io_handle, 0x3e00, 0x20));
+    TEST_ESP_OK(sccb_sim_get_stats(io_handle, &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.transactions);
+
+    TEST_ESP_OK(esp_sccb_del_i2c_io(io_handle));
+}
+
+TEST_CASE("SCCB simulator burst vs single register writes", "[sccb_sim]")
+{
+    uint8_t val8;
+    sccb_sim_stats_t burst_stats;
+    sccb_sim_stats_t single_stats;
+    esp_sccb_reg_t regs[TEST_BURST_REG_NUM];
+    esp_sccb_io_handle_t burst_io = test_new_sim_io(false);
+    esp_sccb_io_handle_t single_io = test_new_sim_io(true);
+
+    for (int i = 0; i < TEST_BURST_REG_NUM; i++) {
+        regs[i].reg = TEST_BURST_REG_START + i;
+        regs[i].val = i + 1;
+    }
+
+    TEST_ESP_OK(esp_sccb_transmit_burst(burst_io, regs, TEST_BURST_REG_NUM, ESP_SCCB_BURST_FLAG_ADDR_16BIT | ESP_SCCB_BURST_FLAG_AUTO_INC));
+    TEST_ESP_OK(esp_sccb_transmit_burst(single_io, regs, TEST_BURST_REG_NUM, ESP_SCCB_BURST_FLAG_ADDR_16BIT | ESP_SCCB_BURST_FLAG_AUTO_INC));
+
+    for (int i = 0; i < TEST_BURST_REG_NUM; i++) {
+        TEST_ESP_OK(sccb_sim_get_reg(burst_io, regs[i].reg, &val8));
+        TEST_ASSERT_EQUAL_HEX8(regs[i].val, val8);
+        TEST_ESP_OK(sccb_sim_get_reg(single_io, regs[i].reg, &val8));
+        TEST_ASSERT_EQUAL_HEX8(regs[i].val, val8);
+    }
+
+    TEST_ESP_OK(sccb_sim_get_stats(burst_io, &burst_stats));
+    TEST_ESP_OK(sccb_sim_get_stats(single_io, &single_stats));
+
+    printf("%d registers: burst %" PRIu32 " transactions %" PRIu64 " ns, single %" PRIu32 " transactions %" PRIu64 " ns\n",
+           TEST_BURST_REG_NUM, burst_stats.transactions, burst_stats.bus_time_ns,
+           single_stats.transactions, single_stats.bus_time_ns);
+
+    /* One device address byte and one register address, then all values */
+    TEST_ASSERT_EQUAL_UINT32(1, burst_stats.transactions);
+    TEST_ASSERT_EQUAL_UINT64(1 + 2 + TEST_BURST_REG_NUM, burst_stats.bytes);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BURST_REG_NUM, burst_stats.write_regs);
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_BURST_REG_NUM, single_stats.transactions);
+    TEST_ASSERT_EQUAL_UINT64(TEST_BURST_REG_NUM * TEST_A16V8_WRITE_NS, single_stats.bus_time_ns);
+    TEST_ASSERT_LESS_THAN_UINT64(single_stats.bus_time_ns, burst_stats.bus_time_ns);
+
+    TEST_ESP_OK(esp_sccb_del_i2c_io(burst_io));
+    TEST_ESP_OK(esp_sccb_del_i2c_io(single_io));
+}
+
+TEST_CASE("SCCB simulator burst without auto-increment", "[sccb_sim]")
+{
+    uint8_t val8;
+    sccb_sim_stats_t stats;
+    esp_sccb_reg_t regs[TEST_BURST_REG_NUM];
+    esp_sccb_io_handle_t io_handle = test_new_sim_io(false);
+
+    for (int i = 0; i < TEST_BURST_REG_NUM; i++) {
+        regs[i].reg = TEST_BURST_REG_START + i;
+        regs[i].val = 0x40 + i;
+    }
+
+    /* Without auto-increment, every register is a transfer ended by STOP, no repeated START is used */
+    TEST_ESP_OK(esp_sccb_transmit_burst(io_handle, regs, TEST_BURST_REG_NUM, ESP_SCCB_BURST_FLAG_ADDR_16BIT));
+    TEST_ESP_OK(sccb_sim_get_stats(io_handle, &stats));
+    TEST_ASSERT_EQUAL_UINT32(TEST_BURST_REG_NUM, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT64(TEST_BURST_REG_NUM * 4, stats.bytes);
+    TEST_ASSERT_EQUAL_UINT64(TEST_BURST_REG_NUM * TEST_A16V8_WRITE_NS, stats.bus_time_ns);
+
+    for (int i = 0; i < TEST_BURST_REG_NUM; i++) {
+        TEST_ESP_OK(sccb_sim_get_reg(io_handle, regs[i].reg, &val8));
+        TEST_ASSERT_EQUAL_HEX8(regs[i].val, val8);
+    }
+
+    TEST_ESP_OK(esp_sccb_del_i2c_io(io_handle));
+}
+
+TEST_CASE("SCCB simulator 8-bit register address", "[sccb_sim]")
+{
+    uint8_t val8;
+    esp_sccb_io_handle_t io_handle = NULL;
+    const esp_sccb_reg_t model[] = {
+        {0x0a, 0x26},
+        {0x0b, 0x42},
+    };
+    sccb_sim_config_t config = {
+        .device_address = TEST_SCCB_ADDR,
+        .scl_speed_hz = TEST_SCCB_FREQ,
+        .addr_bits_width = 8,
+        .regs = model,
+        .reg_num = sizeof(model) / sizeof(model[0]),
+    };
+
+    TEST_ESP_OK(sccb_new_sim_io(&config, &io_handle));
+
+    /* a8v8 read sends the register address and receives the value in 2 transfers, as sensors like OV2640 need */
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a8v8(io_handle, 0x0a, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0x26, val8);
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a8v8(io_handle, 0x0b, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0x42, val8);
+
+    TEST_ESP_OK(esp_sccb_transmit_reg_a8v8(io_handle, 0xff, 0x01));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a8v8(io_handle, 0xff, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0x01, val8);
+
+    /* Burst of scattered registers is split into transactions of at most 8 transfers */
+    esp_sccb_reg_t regs[TEST_BURST_REG_NUM];
+    sccb_sim_stats_t stats;
+
+    for (int i = 0; i < TEST_BURST_REG_NUM; i++) {
+        regs[i].reg = 0x40 + i * 2;
+        regs[i].val = 0x80 + i;
+    }
+
+    TEST_ESP_OK(sccb_sim_reset_stats(io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_burst(io_handle, regs, TEST_BURST_REG_NUM, ESP_SCCB_BURST_FLAG_AUTO_INC));
+    TEST_ESP_OK(sccb_sim_get_stats(io_handle, &stats));
+    TEST_ASSERT_EQUAL_UINT32((TEST_BURST_REG_NUM + 7) / 8, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BURST_REG_NUM, stats.write_regs);
+    TEST_ASSERT_EQUAL_UINT64(TEST_BURST_REG_NUM * 3, stats.bytes);
+
+    for (int i = 0; i < TEST_BURST_REG_NUM; i++) {
+        TEST_ESP_OK(esp_sccb_transmit_receive_reg_a8v8(io_handle, regs[i].reg, &val8));
+        TEST_ASSERT_EQUAL_HEX8(regs[i].val, val8);
+        TEST_ESP_OK(sccb_sim_get_reg(io_handle, regs[i].reg + 1, &val8));
+        TEST_ASSERT_EQUAL_HEX8(0x00, val8);
+    }
+
+    TEST_ESP_OK(esp_sccb_del_i2c_io(io_handle));
+}
+
+#if CONFIG_ESP_SCCB_ENABLE_REG_SHADOW
+#define TEST_SHADOW_RESET_REG       0x0103
+#define TEST_SHADOW_VOLATILE_REG    0x3e20
+
+static uint32_t test_get_transactions(esp_sccb_io_handle_t io_handle)
+{
+    sccb_sim_stats_t stats;
+
+    TEST_ESP_OK(sccb_sim_get_stats(io_handle, &stats));
+    TEST_ESP_OK(sccb_sim_reset_stats(io_handle));
+
+    return stats.transactions;
+}
+
+TEST_CASE("SCCB register shadow hit and invalidate", "[sccb_sim]")
+{
+    uint8_t val8;
+    const esp_sccb_reg_range_t volatile_ranges[] = {
+        {TEST_SHADOW_VOLATILE_REG, TEST_SHADOW_VOLATILE_REG},
+    };
+    const esp_sccb_shadow_config_t shadow_config = {
+        .volatile_ranges = volatile_ranges,
+        .volatile_range_num = sizeof(volatile_ranges) / sizeof(volatile_ranges[0]),
+        .reset_reg = TEST_SHADOW_RESET_REG,
+        .reset_mask = 0x01,
+    };
+    esp_sccb_io_handle_t io_handle = test_new_sim_io(false);
+
+    TEST_ESP_OK(esp_sccb_shadow_enable(io_handle, &shadow_config));
+
+    /* Writing the cached value again and reading a cached register don't access the bus */
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(io_handle, 0x3e00, 0x10));
+    TEST_ASSERT_EQUAL_UINT32(1, test_get_transactions(io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(io_handle, 0x3e00, 0x10));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, 0x3e00, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0x10, val8);
+    TEST_ASSERT_EQUAL_UINT32(0, test_get_transactions(io_handle));
+
+    /* A register read from the device is cached too */
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, 0x3107, &val8));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, 0x3107, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0xcb, val8);
+    TEST_ASSERT_EQUAL_UINT32(1, test_get_transactions(io_handle));
+
+    /* Volatile registers are always accessed on the bus */
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, TEST_SHADOW_VOLATILE_REG, &val8));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, TEST_SHADOW_VOLATILE_REG, &val8));
+    TEST_ASSERT_EQUAL_UINT32(2, test_get_transactions(io_handle));
+
+    /* Reading the reset register or writing it without the reset bit keeps the cache */
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, TEST_SHADOW_RESET_REG, &val8));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(io_handle, TEST_SHADOW_RESET_REG, 0x00));
+    TEST_ASSERT_EQUAL_UINT32(2, test_get_transactions(io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, 0x3e00, &val8));
+    TEST_ASSERT_EQUAL_UINT32(0, test_get_transactions(io_handle));
+
+    /* Writing the reset bit drops the cache */
+    TEST_ESP_OK(sccb_sim_set_reg(io_handle, 0x3e00, 0x55));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(io_handle, TEST_SHADOW_RESET_REG, 0x01));
+    TEST_ESP_OK(esp_sccb_transmit_receive_reg_a16v8(io_handle, 0x3e00, &val8));
+    TEST_ASSERT_EQUAL_HEX8(0x55, val8);
+    TEST_ASSERT_EQUAL_UINT32(2, test_get_transactions(io_handle));
+
+    /* Burst transmit writes all registers and updates the cache */
+    const esp_sccb_reg_t regs[] = {
+        {0x3e00, 0x55},
+        {0x3e01, 0x66},
+    };
+    TEST_ESP_OK(esp_sccb_transmit_burst(io_handle, regs, sizeof(regs) / sizeof(regs[0]), ESP_SCCB_BURST_FLAG_ADDR_16BIT | ESP_SCCB_BURST_FLAG_AUTO_INC));
+    TEST_ASSERT_EQUAL_UINT32(1, test_get_transactions(io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(io_handle, 0x3e01, 0x66));
+    TEST_ASSERT_EQUAL_UINT32(0, test_get_transactions(io_handle));
+
+    /* Explicit invalidation */
+    TEST_ESP_OK(esp_sccb_shadow_invalidate(io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(io_handle, 0x3e01, 0x66));
+    TEST_ASSERT_EQUAL_UINT32(1, test_get_transactions(io_handle));
+
+    TEST_ESP_OK(esp_sccb_del_i2c_io(io_handle));
+}
+#endif
+
+#if TEST_DEFER_ENABLED
+#define TEST_DEFER_REG_NUM          4
+#define TEST_DEFER_TIMEOUT_MS       1000
+
+/**
+ * @brief Deferred write test context, a GPTimer alarm calls esp_sccb_defer_flush_from_isr
+ *        in interrupt context as the camera frame start interrupt does. On the host, the
+ *        FreeRTOS timer task calls it instead.
+ */
+typedef struct test_defer {
+    esp_sccb_io_handle_t io_handle;         /*!< SCCB IO handle */
+#if TEST_DEFER_GPTIMER
+    gptimer_handle_t timer;                 /*!< Flush trigger timer */
+#else
+    TimerHandle_t timer;                    /*!< Flush trigger timer */
+#endif
+    SemaphoreHandle_t done_sem;             /*!< Given by flush done callback */
+    uint32_t sequence;                      /*!< Sequence number of the next flush */
+    uint32_t done_sequence;                 /*!< Sequence number of the last flush done */
+    esp_err_t done_status;                  /*!< Status of the last flush done */
+    uint32_t done_delay_ms;                 /*!< Time flush done callback keeps the flush in flight */
+    volatile bool done_exit;                /*!< true: flush done callback has returned */
+} test_defer_t;
+
+#if TEST_DEFER_GPTIMER
+static bool test_defer_timer_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx)
+{
+    test_defer_t *test = (test_defer_t *)user_ctx;
+
+    esp_sccb_defer_flush_from_isr(test->io_handle, test->sequence);
+
+    return false;
+}
+
+static void test_defer_timer_init(test_defer_t *test)
+{
+    const gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,
+    };
+    const gptimer_event_callbacks_t cbs = {
+        .on_alarm = test_defer_timer_cb,
+    };
+    const gptimer_alarm_config_t alarm_config = {
+        .alarm_count = 100,
+    };
+
+    TEST_ESP_OK(gptimer_new_timer(&timer_config, &test->timer));
+    TEST_ESP_OK(gptimer_register_event_callbacks(test->timer, &cbs, test));
+    TEST_ESP_OK(gptimer_set_alarm_action(test->timer, &alarm_config));
+    TEST_ESP_OK(gptimer_enable(test->timer));
+}
+
+static void test_defer_timer_deinit(test_defer_t *test)
+{
+    TEST_ESP_OK(gptimer_disable(test->timer));
+    TEST_ESP_OK(gptimer_del_timer(test->timer));
+}
+
+static void test_defer_timer_start(test_defer_t *test)
+{
+    TEST_ESP_OK(gptimer_set_raw_count(test->timer, 0));
+    TEST_ESP_OK(gptimer_start(test->timer));
+}
+
+static void test_defer_timer_stop(test_defer_t *test)
+{
+    TEST_ESP_OK(gptimer_stop(test->timer));
+}
+#else
+static void test_defer_timer_cb(TimerHandle_t timer)
+{
+    test_defer_t *test = (test_defer_t *)pvTimerGetTimerID(timer);
+
+    esp_sccb_defer_flush_from_isr(test->io_handle, test->sequence);
+}
+
+static void test_defer_timer_init(test_defer_t *test)
+{
+    test->timer = xTimerCreate("test_defer", 1, pdFALSE, test, test_defer_timer_cb);
+    TEST_ASSERT_NOT_NULL(test->timer);
+}
+
+static void test_defer_timer_deinit(test_defer_t *test)
+{
+    TEST_ASSERT_TRUE(xTimerDelete(test->timer, portMAX_DELAY));
+}
+
+static void test_defer_timer_start(test_defer_t *test)
+{
+    TEST_ASSERT_TRUE(xTimerStart(test->timer, portMAX_DELAY));
+}
+
+static void test_defer_timer_stop(test_defer_t *test)
+{
+    TEST_ASSERT_TRUE(xTimerStop(test->timer, portMAX_DELAY));
+}
+#endif
+
+static void test_defer_done_cb(esp_sccb_io_handle_t io_handle, uint32_t sequence, esp_err_t status, void *user_data)
+{
+    test_defer_t *test = (test_defer_t *)user_data;
+
+    test->done_sequence = sequence;
+    test->done_status = status;
+    test->done_exit = false;
+    xSemaphoreGive(test->done_sem);
+
+    if (test->done_delay_ms) {
+        vTaskDelay(pdMS_TO_TICKS(test->done_delay_ms));
+    }
+    test->done_exit = true;
+}
+
+static void test_defer_init(test_defer_t *test)
+{
+    memset(test, 0, sizeof(test_defer_t));
+    test->io_handle = test_new_sim_io(false);
+    test->done_sem = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(test->done_sem);
+
+    test_defer_timer_init(test);
+
+    const esp_sccb_defer_config_t defer_config = {
+        .max_reg_num = TEST_DEFER_REG_NUM,
+        .on_done = test_defer_done_cb,
+        .user_data = test,
+    };
+    TEST_ESP_OK(esp_sccb_defer_enable(test->io_handle, &defer_config));
+}
+
+static void test_defer_deinit(test_defer_t *test)
+{
+    TEST_ESP_OK(esp_sccb_defer_disable(test->io_handle));
+    test_defer_timer_deinit(test);
+    vSemaphoreDelete(test->done_sem);
+    TEST_ESP_OK(esp_sccb_del_i2c_io(test->io_handle));
+}
+
+/**
+ * @brief Trigger a flush in interrupt context, and wait for the flush task to finish it if "wait" is true
+ */
+static void test_defer_flush(test_defer_t *test, bool wait)
+{
+    test->sequence++;
+    test_defer_timer_start(test);
+    if (wait) {
+        TEST_ASSERT_TRUE(xSemaphoreTake(test->done_sem, pdMS_TO_TICKS(TEST_DEFER_TIMEOUT_MS)));
+        TEST_ASSERT_EQUAL_UINT32(test->sequence, test->done_sequence);
+        TEST_ESP_OK(test->done_status);
+    } else {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        TEST_ASSERT_FALSE(xSemaphoreTake(test->done_sem, 0));
+    }
+    test_defer_timer_stop(test);
+}
+
+static uint8_t test_get_reg(esp_sccb_io_handle_t io_handle, uint16_t reg)
+{
+    uint8_t val;
+
+    TEST_ESP_OK(sccb_sim_get_reg(io_handle, reg, &val));
+
+    return val;
+}
+
+TEST_CASE("SCCB deferred write group overflow", "[sccb_sim]")
+{
+    test_defer_t test;
+
+    test_defer_init(&test);
+
+    /* The first group fills 3 of 4 slots */
+    TEST_ESP_OK(esp_sccb_defer_begin(test.io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e00, 0x11));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e01, 0x22));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e02, 0x33));
+    TEST_ESP_OK(esp_sccb_defer_end(test.io_handle));
+
+    /* The second group does not fit, so all of its writes are dropped, even the one queued before overflow */
+    TEST_ESP_OK(esp_sccb_defer_begin(test.io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e10, 0x44));
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e11, 0x55));
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e12, 0x66));
+    TEST_ESP_OK(esp_sccb_defer_end(test.io_handle));
+
+    /* Nothing is written on the bus before flush */
+    TEST_ASSERT_EQUAL_HEX8(0x00, test_get_reg(test.io_handle, 0x3e00));
+
+    test_defer_flush(&test, true);
+    TEST_ASSERT_EQUAL_HEX8(0x11, test_get_reg(test.io_handle, 0x3e00));
+    TEST_ASSERT_EQUAL_HEX8(0x22, test_get_reg(test.io_handle, 0x3e01));
+    TEST_ASSERT_EQUAL_HEX8(0x33, test_get_reg(test.io_handle, 0x3e02));
+    TEST_ASSERT_EQUAL_HEX8(0x00, test_get_reg(test.io_handle, 0x3e10));
+    TEST_ASSERT_EQUAL_HEX8(0x00, test_get_reg(test.io_handle, 0x3e11));
+
+    /* The queue is empty, so the next flush does nothing */
+    test_defer_flush(&test, false);
+
+    /* A new group after overflow is queued again */
+    TEST_ESP_OK(esp_sccb_defer_begin(test.io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e10, 0x44));
+    TEST_ESP_OK(esp_sccb_defer_end(test.io_handle));
+    test_defer_flush(&test, true);
+    TEST_ASSERT_EQUAL_HEX8(0x44, test_get_reg(test.io_handle, 0x3e10));
+
+    test_defer_deinit(&test);
+}
+
+TEST_CASE("SCCB direct write drops deferred writes", "[sccb_sim]")
+{
+    test_defer_t test;
+
+    test_defer_init(&test);
+
+    TEST_ESP_OK(esp_sccb_defer_begin(test.io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e00, 0x11));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e01, 0x22));
+    TEST_ESP_OK(esp_sccb_defer_end(test.io_handle));
+
+    /* Direct writes out of begin and end go on the bus at once */
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e00, 0x33));
+    TEST_ASSERT_EQUAL_HEX8(0x33, test_get_reg(test.io_handle, 0x3e00));
+
+    const esp_sccb_reg_t regs[] = {
+        {0x3e01, 0x44},
+    };
+    TEST_ESP_OK(esp_sccb_transmit_burst(test.io_handle, regs, 1, ESP_SCCB_BURST_FLAG_ADDR_16BIT));
+
+    /* The older queued values are dropped, so they don't overwrite the direct writes */
+    test_defer_flush(&test, false);
+    TEST_ASSERT_EQUAL_HEX8(0x33, test_get_reg(test.io_handle, 0x3e00));
+    TEST_ASSERT_EQUAL_HEX8(0x44, test_get_reg(test.io_handle, 0x3e01));
+
+    test_defer_deinit(&test);
+}
+
+TEST_CASE("SCCB direct write waits for in-flight flush", "[sccb_sim]")
+{
+    test_defer_t test;
+
+    test_defer_init(&test);
+
+    TEST_ESP_OK(esp_sccb_defer_begin(test.io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e00, 0x11));
+    TEST_ESP_OK(esp_sccb_defer_end(test.io_handle));
+
+    /* The flush done callback keeps the flush in flight after the flush has been written */
+    test.done_delay_ms = 50;
+    test_defer_flush(&test, true);
+    TEST_ASSERT_FALSE(test.done_exit);
+
+    /* The direct write of a register in flight returns after the flush finishes, so it is the last value */
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e00, 0x22));
+    TEST_ASSERT_TRUE(test.done_exit);
+    TEST_ASSERT_EQUAL_HEX8(0x22, test_get_reg(test.io_handle, 0x3e00));
+
+    test_defer_deinit(&test);
+}
+
+TEST_CASE("SCCB deferred write disable writes queued registers", "[sccb_sim]")
+{
+    test_defer_t test;
+
+    test_defer_init(&test);
+
+    TEST_ESP_OK(esp_sccb_defer_begin(test.io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e00, 0x11));
+    TEST_ESP_OK(esp_sccb_defer_end(test.io_handle));
+    TEST_ASSERT_EQUAL_HEX8(0x00, test_get_reg(test.io_handle, 0x3e00));
+
+    TEST_ESP_OK(esp_sccb_defer_disable(test.io_handle));
+    TEST_ASSERT_EQUAL_HEX8(0x11, test_get_reg(test.io_handle, 0x3e00));
+
+    /* Writes go on the bus at once after disable, and begin fails */
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_sccb_defer_begin(test.io_handle));
+    TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(test.io_handle, 0x3e00, 0x22));
+    TEST_ASSERT_EQUAL_HEX8(0x22, test_get_reg(test.io_handle, 0x3e00));
+
+    test_defer_deinit(&test);
+}
+#endif
+
+void app_main(void)
+{
+    printf("SCCB simulator test\n");
+
+    unity_run_menu();
+}
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -70,12 +70,24 @@ extern "C" {
 #define ESP_VIDEO_H264_DEVICE_ID            11
 #define ESP_VIDEO_H264_DEVICE_NAME          "/dev/video11"
 
+#define ESP_VIDEO_SW_JPEG_DEVICE_ID         12
+#define ESP_VIDEO_SW_JPEG_DEVICE_NAME       "/dev/video12"
+
+#define ESP_VIDEO_SW_JPEG_DEC_DEVICE_ID     13
+#define ESP_VIDEO_SW_JPEG_DEC_DEVICE_NAME   "/dev/video13"
+
 /**
  * @brief ISP video device
  */
 #define ESP_VIDEO_ISP1_DEVICE_ID            20
 #define ESP_VIDEO_ISP1_DEVICE_NAME          "/dev/video20"
 
+/**
+ * @brief Virtual test pattern video device
+ */
+#define ESP_VIDEO_VIVID_DEVICE_ID           30
+#define ESP_VIDEO_VIVID_DEVICE_NAME         "/dev/video30"
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -47,7 +47,10 @@ extern "C" {
 #define ESP_VIDEO_INIT_FLAGS_H264           (1 << 5)
 #define ESP_VIDEO_INIT_FLAGS_JPEG           (1 << 6)
 #define ESP_VIDEO_INIT_FLAGS_MOTOR          (1 << 7)
-#define ESP_VIDEO_INIT_FLAGS_ALL            (ESP_VIDEO_INIT_FLAGS_MIPI_CSI | ESP_VIDEO_INIT_FLAGS_DVP | ESP_VIDEO_INIT_FLAGS_SPI | ESP_VIDEO_INIT_FLAGS_ISP | ESP_VIDEO_INIT_FLAGS_USB_UVC | ESP_VIDEO_INIT_FLAGS_H264 | ESP_VIDEO_INIT_FLAGS_JPEG | ESP_VIDEO_INIT_FLAGS_MOTOR)
+#define ESP_VIDEO_INIT_FLAGS_VIVID          (1 << 8)
+#define ESP_VIDEO_INIT_FLAGS_SW_JPEG        (1 << 9)
+#define ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC    (1 << 10)
+#define ESP_VIDEO_INIT_FLAGS_ALL            (ESP_VIDEO_INIT_FLAGS_MIPI_CSI | ESP_VIDEO_INIT_FLAGS_DVP | ESP_VIDEO_INIT_FLAGS_SPI | ESP_VIDEO_INIT_FLAGS_ISP | ESP_VIDEO_INIT_FLAGS_USB_UVC | ESP_VIDEO_INIT_FLAGS_H264 | ESP_VIDEO_INIT_FLAGS_JPEG | ESP_VIDEO_INIT_FLAGS_MOTOR | ESP_VIDEO_INIT_FLAGS_VIVID | ESP_VIDEO_INIT_FLAGS_SW_JPEG | ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC)
 
 #if CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE || \
@@ -185,6 +188,27 @@ typedef struct esp_video_init_jpeg_config {
 } esp_video_init_jpeg_config_t;
 #endif
 
+/**
+ * @brief Virtual test pattern video device initialization configuration
+ */
+#if CONFIG_ESP_VIDEO_ENABLE_VIVID_VIDEO_DEVICE
+typedef enum esp_video_vivid_pattern {
+    ESP_VIDEO_VIVID_PATTERN_COLOR_BARS = 0,     /*!< 8 vertical color bars */
+    ESP_VIDEO_VIVID_PATTERN_GRADIENT,           /*!< Horizontal gradient moving with frame count */
+    ESP_VIDEO_VIVID_PATTERN_NOISE,              /*!< Pseudo-random noise */
+    ESP_VIDEO_VIVID_PATTERN_MAX,
+} esp_video_vivid_pattern_t;
+
+typedef struct esp_video_init_vivid_config {
+    uint32_t width;                             /*!< Frame width, multiple of 8 in range [16, 4096], 0 means 640 */
+    uint32_t height;                            /*!< Frame height, multiple of 8 in range [16, 4096], 0 means 480 */
+    uint32_t pixel_format;                      /*!< V4L2_PIX_FMT_SBGGR8, V4L2_PIX_FMT_SBGGR10, V4L2_PIX_FMT_RGB565, V4L2_PIX_FMT_YUYV
+                                                     or V4L2_PIX_FMT_JPEG, 0 means V4L2_PIX_FMT_RGB565 */
+    uint32_t fps;                               /*!< Frame rate in range [1, 240], 0 means 30 */
+    esp_video_vivid_pattern_t pattern;          /*!< Initial test pattern, it can be changed by V4L2_CID_TEST_PATTERN */
+} esp_video_init_vivid_config_t;
+#endif
+
 /**
  * @brief Camera motor connection configuration
  */
@@ -220,6 +244,9 @@ typedef struct esp_video_init_config {
 #if CONFIG_ESP_VIDEO_ENABLE_USB_UVC_VIDEO_DEVICE
     const esp_video_init_usb_uvc_config_t *usb_uvc; /*!< USB UVC video device initialization configuration */
 #endif
+#if CONFIG_ESP_VIDEO_ENABLE_VIVID_VIDEO_DEVICE
+    const esp_video_init_vivid_config_t *vivid; /*!< Virtual test pattern video device initialization configuration, NULL means default */
+#endif
 } esp_video_init_config_t;
 
 
@@ -244,7 +271,7 @@ esp_err_t esp_video_init_with_flags(const esp_video_init_config_t *config, uint3
  *      - ESP_OK on success
  *      - Others if failed
  *
- * @note This function will deinitialize the video hardware and software in the order of JPEG, H.264, MIPI CSI, DVP, SPI, USB UVC, ISP.
+ * @note This function will deinitialize the video hardware and software in the order of JPEG, software JPEG, H.264, MIPI CSI, DVP, SPI, USB UVC, ISP, virtual test pattern.
  */
 esp_err_t esp_video_deinit_with_flags(uint32_t flags);
 
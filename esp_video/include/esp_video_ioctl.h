@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -32,10 +32,52 @@ extern "C" {
 #define VIDIOC_S_DQBUF_TIMEOUT  _IOWR('V',  BASE_VIDIOC_PRIVATE + 6, struct timeval)
 #define VIDIOC_G_DQBUF_TIMEOUT  _IOWR('V',  BASE_VIDIOC_PRIVATE + 7, struct timeval)
 
+#define VIDIOC_G_M2M_STATS      _IOWR('V',  BASE_VIDIOC_PRIVATE + 8, struct esp_video_m2m_stats)
+#define VIDIOC_G_STREAM_STATS   _IOWR('V',  BASE_VIDIOC_PRIVATE + 9, struct esp_video_stream_stats)
+
 #define V4L2_CID_CAMERA_AE_LEVEL        (V4L2_CID_CAMERA_CLASS_BASE + 40)
 #define V4L2_CID_CAMERA_STATS           (V4L2_CID_CAMERA_CLASS_BASE + 41)
 #define V4L2_CID_CAMERA_GROUP           (V4L2_CID_CAMERA_CLASS_BASE + 42)
 #define V4L2_CID_MOTOR_START_TIME       (V4L2_CID_CAMERA_CLASS_BASE + 43)
+#define V4L2_CID_CAMERA_CTRL_SEQUENCE   (V4L2_CID_CAMERA_CLASS_BASE + 44)
+
+#define V4L2_CID_JPEG_TARGET_SIZE       (V4L2_CID_JPEG_CLASS_BASE + 40)
+#define V4L2_CID_JPEG_RC_REENCODE       (V4L2_CID_JPEG_CLASS_BASE + 41)
+#define V4L2_CID_JPEG_FRAME_QUALITY     (V4L2_CID_JPEG_CLASS_BASE + 42)
+
+/**
+ * @brief M2M video device job statistics, they are reset when the video stream starts.
+ */
+struct esp_video_m2m_stats {
+    uint32_t jobs;                      /*!< Count of processed jobs */
+    uint32_t failed_jobs;               /*!< Count of jobs whose process failed */
+    uint32_t last_wait_us;              /*!< Time from queuing the source buffer to starting the last job */
+    uint32_t last_process_us;           /*!< Process time of the last job */
+    uint32_t max_process_us;            /*!< Maximum process time of jobs */
+    uint64_t total_process_us;          /*!< Total process time of jobs */
+};
+
+#define ESP_VIDEO_STREAM_STATS_FLAG_RESET   (1 << 0)   /*!< Reset video stream statistics after reading them */
+
+#define ESP_VIDEO_STREAM_LATENCY_HIST_NUM   10          /*!< Video stream buffer latency histogram bucket count */
+
+/**
+ * @brief Video stream statistics, they are reset when the video stream starts.
+ */
+struct esp_video_stream_stats {
+    uint32_t type;                      /*!< Video stream type, set by application */
+    uint32_t flags;                     /*!< Video stream statistics flags ESP_VIDEO_STREAM_STATS_FLAG_XXX, set by application */
+
+    uint32_t completed;                 /*!< Count of buffers filled and put into done queue by driver */
+    uint32_t skipped;                   /*!< Count of frames skipped by driver, e.g. broken frames or frames skipped by VIDIOC_S_PARM */
+    uint32_t dropped;                   /*!< Count of frames dropped by driver because application queued no buffer */
+    uint32_t dequeued;                  /*!< Count of buffers dequeued by application */
+    uint32_t done_high_water;           /*!< Maximum count of buffers in done queue waiting for application to dequeue */
+    uint32_t max_latency_us;            /*!< Maximum latency from buffer timestamp to dequeuing it */
+    uint32_t latency_hist[ESP_VIDEO_STREAM_LATENCY_HIST_NUM];  /*!< Latency histogram, bucket 0 counts latency less than 1ms,
+                                                                    bucket n counts latency in [2^(n-1), 2^n) ms, and the last
+                                                                    bucket also counts all larger latency */
+};
 
 /**
  * @brief Use this class to call esp_cam_sensor ioctl commands directly, this is only
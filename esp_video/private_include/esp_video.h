@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdatomic.h>
 #include <sys/queue.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -15,11 +16,18 @@
 #include "linux/videodev2.h"
 #include "esp_video_buffer.h"
 #include "esp_video_internal.h"
+#include "esp_video_ioctl.h"
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+#include "esp_video_ring.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define ESP_VIDEO_POLL_READABLE             (1 << 0)    /*!< A buffer can be dequeued from the capture stream without blocking */
+#define ESP_VIDEO_POLL_WRITABLE             (1 << 1)    /*!< A buffer can be queued into the output stream */
+
 /**
  * @brief Video format description object.
  */
@@ -36,6 +44,29 @@ struct esp_video_param {
     uint16_t skip_count;                    /*!< Skip frame count */
 };
 
+/**
+ * @brief Video stream statistics counters.
+ *
+ * @note Each counter has only one writer, the driver writes the producer counters and
+ *       DQBUF writes the consumer counters, so writers update them by plain atomic loads
+ *       and stores without the stream lock, and esp_video_get_stream_stats reads them by
+ *       atomic loads. See struct esp_video_stream_stats for the meaning of each counter.
+ */
+struct esp_video_stream_counters {
+    /* Producer counters, written by the driver which puts buffers into done queue */
+
+    atomic_uint completed;
+    atomic_uint skipped;
+    atomic_uint dropped;
+    atomic_uint done_high_water;
+
+    /* Consumer counters, written by DQBUF */
+
+    atomic_uint dequeued;
+    atomic_uint max_latency_us;
+    atomic_uint latency_hist[ESP_VIDEO_STREAM_LATENCY_HIST_NUM];
+};
+
 /**
  * @brief Video stream object.
  */
@@ -45,8 +76,15 @@ struct esp_video_stream {
     struct v4l2_format format;              /*!< Video stream format */
     struct esp_video_buffer_info buf_info;  /*!< Video stream buffer information */
 
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    struct esp_video_ring queued_ring;      /*!< Workqueue buffer elements index ring, QBUF is the producer */
+    struct esp_video_ring done_ring;        /*!< Done buffer elements index ring, driver is the producer */
+    atomic_uint released_mask;              /*!< Bit mask of exported buffer elements released by importers, driver takes them after queued_ring */
+#else
     esp_video_buffer_list_t queued_list;    /*!< Workqueue buffer elements list */
     esp_video_buffer_list_t done_list;      /*!< Done buffer elements list */
+    uint32_t done_count;                    /*!< Count of buffer elements in done list */
+#endif
 
     struct esp_video_buffer *buffer;        /*!< Video stream buffer */
     SemaphoreHandle_t ready_sem;            /*!< Video stream buffer element ready semaphore */
@@ -54,8 +92,26 @@ struct esp_video_stream {
     struct v4l2_rect rect;                  /*!< Selection rectangles */
 
     struct esp_video_param param;           /*!< Video stream parameters */
+
+    uint32_t sequence;                      /*!< Next frame sequence number, skipped frames also consume a number */
+
+    struct esp_video_stream_counters stats; /*!< Video stream statistics counters */
+    struct esp_video_stream_stats stats_base; /*!< Counter values when statistics were reset by reading them, "type" and "flags" are not used */
+
+    atomic_uint dqbuf_metadata;             /*!< Frame metadata of the buffer dequeued last, see esp_video_get_dqbuf_metadata */
 };
 
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+/**
+ * @brief M2M video device worker object.
+ */
+struct esp_video_m2m_worker {
+    TaskHandle_t task;                      /*!< Worker task handle */
+    SemaphoreHandle_t exit_sem;             /*!< Worker task exit semaphore */
+    volatile bool running;                  /*!< Worker task is running */
+};
+#endif
+
 /**
  * @brief Video object.
  */
@@ -78,6 +134,11 @@ struct esp_video {
     SemaphoreHandle_t mutex;                /*!< Video device mutex lock */
     uint8_t reference;                      /*!< video device open reference count */
 
+    struct esp_video_m2m_stats m2m_stats;   /*!< M2M video device job statistics */
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+    struct esp_video_m2m_worker *m2m_worker; /*!< M2M video device worker, it exists when video stream starts */
+#endif
+
     uint8_t inited : 1;                     /*!< video device is initialized */
 };
 
@@ -255,6 +316,27 @@ uint8_t *esp_video_get_queued_buffer(struct esp_video *video, uint32_t type);
  */
 struct esp_video_buffer_element *esp_video_get_done_element(struct esp_video *video, uint32_t type);
 
+/**
+ * @brief Get the first buffer element of buffer done list without removing it.
+ *
+ * @param video Video object
+ * @param type  Video stream type
+ *
+ * @return
+ *      - Video buffer element object pointer on success
+ *      - NULL if failed
+ */
+struct esp_video_buffer_element *esp_video_get_first_done_element(struct esp_video *video, uint32_t type);
+
+/**
+ * @brief Check if video device buffers can be dequeued or queued without blocking.
+ *
+ * @param video Video object
+ *
+ * @return Mask of ESP_VIDEO_POLL_READABLE and ESP_VIDEO_POLL_WRITABLE
+ */
+uint32_t esp_video_poll(struct esp_video *video);
+
 /**
  * @brief Process a done video buffer element.
  *
@@ -322,30 +404,64 @@ esp_err_t esp_video_queue_element(struct esp_video *video, uint32_t type, struct
 /**
  * @brief Put buffer element index into queued list.
  *
- * @param video   Video object
- * @param type    Video stream type
- * @param index   Video buffer element index
+ * @param video     Video object
+ * @param type      Video stream type
+ * @param index     Video buffer element index
+ * @param bytesused Output stream buffer valid data size, 0 means the whole buffer, it is ignored by capture stream
  *
  * @return
  *      - ESP_OK on success
  *      - Others if failed
  */
-esp_err_t esp_video_queue_element_index(struct esp_video *video, uint32_t type, int index);
+esp_err_t esp_video_queue_element_index(struct esp_video *video, uint32_t type, int index, uint32_t bytesused);
 
 /**
  * @brief Put buffer element index into queued list.
  *
- * @param video   Video object
- * @param type    Video stream type
- * @param index   Video buffer element index
- * @param buffer  Receive buffer pointer from user space
- * @param size    Receive buffer size
+ * @param video     Video object
+ * @param type      Video stream type
+ * @param index     Video buffer element index
+ * @param buffer    Receive buffer pointer from user space
+ * @param size      Receive buffer size
+ * @param bytesused Output stream buffer valid data size, 0 means the whole buffer, it is ignored by capture stream
  *
  * @return
  *      - ESP_OK on success
  *      - Others if failed
  */
-esp_err_t esp_video_queue_element_index_buffer(struct esp_video *video, uint32_t type, int index, uint8_t *buffer, uint32_t size);
+esp_err_t esp_video_queue_element_index_buffer(struct esp_video *video, uint32_t type, int index, uint8_t *buffer, uint32_t size, uint32_t bytesused);
+
+/**
+ * @brief Export buffer element index as DMABUF.
+ *
+ * @note The buffer element is put back into queued list automatically when the
+ *       importer finishes processing it.
+ *
+ * @param video Video object
+ * @param type  Video stream type, only V4L2_BUF_TYPE_VIDEO_CAPTURE is supported
+ * @param index Video buffer element index
+ * @param fd    DMABUF handle buffer pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_export_element_index(struct esp_video *video, uint32_t type, int index, int *fd);
+
+/**
+ * @brief Put buffer element index into queued list, its buffer is an imported DMABUF.
+ *
+ * @param video     Video object
+ * @param type      Video stream type
+ * @param index     Video buffer element index
+ * @param fd        DMABUF handle
+ * @param bytesused Output stream buffer valid data size, 0 means the exporter buffer valid data size
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_queue_element_index_dmabuf(struct esp_video *video, uint32_t type, int index, int fd, uint32_t bytesused);
 
 /**
  * @brief Get buffer element payload.
@@ -369,6 +485,15 @@ uint8_t *esp_video_get_element_index_payload(struct esp_video *video, uint32_t t
  */
 struct esp_video *esp_video_device_get_object(const char *name);
 
+/**
+ * @brief Get video object by ID
+ *
+ * @param id The video object ID, it is also the local file description of the video device
+ *
+ * @return Video object pointer if found by ID
+ */
+struct esp_video *esp_video_device_get_object_by_id(uint8_t id);
+
 /**
  * @brief Get video stream object pointer by stream type.
  *
@@ -546,6 +671,40 @@ esp_err_t esp_video_query_ext_control(struct esp_video *video, struct v4l2_query
  */
 esp_err_t esp_video_m2m_process(struct esp_video *video, uint32_t src_type, uint32_t dst_type, esp_video_m2m_process_t proc);
 
+/**
+ * @brief Get M2M video device job statistics.
+ *
+ * @param video Video object
+ * @param stats M2M job statistics buffer pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_get_m2m_stats(struct esp_video *video, struct esp_video_m2m_stats *stats);
+
+/**
+ * @brief Get frame metadata of the buffer which is dequeued last from a video stream.
+ *
+ * @param video Video object
+ * @param type  Video stream type
+ *
+ * @return Frame metadata set by the device, 0 if no buffer is dequeued after the stream starts
+ */
+uint32_t esp_video_get_dqbuf_metadata(struct esp_video *video, uint32_t type);
+
+/**
+ * @brief Get video stream statistics.
+ *
+ * @param video Video object
+ * @param stats Video stream statistics buffer pointer, "type" and "flags" are set by caller
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_get_stream_stats(struct esp_video *video, struct esp_video_stream_stats *stats);
+
 /**
  * @brief Set format to sensor
  *
@@ -679,6 +838,28 @@ esp_err_t esp_video_get_parm(struct esp_video *video, struct v4l2_streamparm *st
  */
 void esp_video_skip_buffer(struct esp_video *video, uint32_t type, uint8_t *buffer);
 
+/**
+ * @brief Drop a video frame which has no buffer to receive it
+ *
+ * @param video  Video object
+ * @param type   Video stream type
+ *
+ * @return None
+ */
+void esp_video_drop_frame(struct esp_video *video, uint32_t type);
+
+/**
+ * @brief Drop a video frame which is received by a buffer but is broken, e.g. it overflows the
+ *        buffer, and put the buffer back to receive the next frame
+ *
+ * @param video  Video object
+ * @param type   Video stream type
+ * @param buffer Video buffer pointer, it may be a driver internal buffer which is not in the stream
+ *
+ * @return None
+ */
+void esp_video_drop_buffer(struct esp_video *video, uint32_t type, uint8_t *buffer);
+
 /**
  * @brief Enumerate video frame sizes
  *
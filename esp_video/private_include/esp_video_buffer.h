@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -40,6 +40,29 @@ typedef TAILQ_HEAD(esp_video_buffer_list, esp_video_buffer_element) esp_video_bu
 
 
 struct esp_video_buffer;
+struct esp_video_dmabuf;
+
+/**
+ * @brief DMABUF release callback, it is called when the last importer finishes using the buffer.
+ *
+ * @note The callback runs in a critical section which keeps the exported element from
+ *       being destroyed by its exporter, so it must not block.
+ *
+ * @param element Exported buffer element
+ * @param arg     Callback argument given when exporting the buffer
+ *
+ * @return None
+ */
+typedef void (*esp_video_dmabuf_release_t)(struct esp_video_buffer_element *element, void *arg);
+
+/**
+ * @brief DMABUF notify callback, it is called out of the critical section after the release callback.
+ *
+ * @param arg Callback argument given when exporting the buffer
+ *
+ * @return None
+ */
+typedef void (*esp_video_dmabuf_notify_t)(void *arg);
 
 /**
  * @brief Video buffer information object.
@@ -64,10 +87,38 @@ struct esp_video_buffer_element {
     uint8_t *buffer;                                  /*!< Buffer space to fill data */
 
     uint32_t valid_size;                              /*!< Valid data size */
+    int64_t timestamp;                                /*!< Monotonic capture time in microseconds */
+    uint32_t sequence;                                /*!< Frame sequence number of the stream */
+    uint32_t flags;                                   /*!< Frame flags set by the device, e.g. V4L2_BUF_FLAG_KEYFRAME */
+    uint32_t metadata;                                /*!< Frame metadata set by the device, see esp_video_get_dqbuf_metadata */
+
+    struct esp_video_dmabuf *dmabuf;                  /*!< MMAP buffer: exported DMABUF; DMABUF buffer: imported DMABUF */
+    bool dmabuf_busy;                                 /*!< Imported DMABUF is used by this element */
 
     void *priv_data;                                  /*!< Private data */
 };
 
+/**
+ * @brief Video DMABUF object, it shares one MMAP buffer element with other video devices.
+ */
+struct esp_video_dmabuf {
+    SLIST_ENTRY(esp_video_dmabuf) node;               /*!< List node */
+
+    int fd;                                           /*!< DMABUF handle, it is not a VFS file description */
+    uint32_t refcount;                                /*!< Reference count, the exporter holds one until its buffer is destroyed */
+    uint32_t users;                                   /*!< Count of importer elements which are using the buffer */
+
+    struct esp_video_buffer_element *element;         /*!< Exported element, NULL if the exporter buffer has been destroyed */
+    uint8_t *buffer;                                  /*!< Buffer space */
+    uint32_t size;                                    /*!< Buffer size */
+    uint32_t caps;                                    /*!< Buffer capability: refer to esp_heap_caps.h MALLOC_CAP_XXX */
+    bool owns_buffer;                                 /*!< Buffer space is freed with this object */
+
+    esp_video_dmabuf_release_t release;               /*!< Release callback of the exporter */
+    esp_video_dmabuf_notify_t notify;                 /*!< Notify callback of the exporter */
+    void *release_arg;                                /*!< Release and notify callback argument */
+};
+
 /**
  * @brief Video buffer object.
  */
@@ -112,6 +163,72 @@ struct esp_video_buffer *esp_video_buffer_clone(const struct esp_video_buffer *b
  */
 esp_err_t esp_video_buffer_destroy(struct esp_video_buffer *buffer);
 
+/**
+ * @brief Export buffer element as DMABUF, the same object is returned if the element has been exported.
+ *
+ * @param element Video buffer element object, its buffer memory type must be V4L2_MEMORY_MMAP
+ * @param release Release callback, it is called when the last importer finishes using the buffer
+ * @param notify  Notify callback, it is called after the release callback, it can be NULL
+ * @param arg     Release and notify callback argument
+ *
+ * @return
+ *      - DMABUF object pointer on success
+ *      - NULL if failed
+ */
+struct esp_video_dmabuf *esp_video_buffer_export_element(struct esp_video_buffer_element *element,
+        esp_video_dmabuf_release_t release,
+        esp_video_dmabuf_notify_t notify,
+        void *arg);
+
+/**
+ * @brief Import DMABUF into buffer element and mark it busy, previous imported DMABUF is detached.
+ *
+ * @param element Video buffer element object, its buffer memory type must be V4L2_MEMORY_DMABUF
+ * @param fd      DMABUF handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_buffer_element_import_dmabuf(struct esp_video_buffer_element *element, int fd);
+
+/**
+ * @brief Check if the exported DMABUF of buffer element is used by any importer.
+ *
+ * @param element Video buffer element object, its buffer memory type must be V4L2_MEMORY_MMAP
+ *
+ * @return true if the buffer is used by an importer
+ */
+bool esp_video_buffer_element_is_imported(struct esp_video_buffer_element *element);
+
+/**
+ * @brief Importer finishes using the DMABUF of buffer element.
+ *
+ * @param element Video buffer element object
+ *
+ * @return None
+ */
+void esp_video_buffer_element_release_dmabuf(struct esp_video_buffer_element *element);
+
+/**
+ * @brief Cancel the busy mark set by "esp_video_buffer_element_import_dmabuf" when the
+ *        element fails to be queued, the exporter is not notified and the DMABUF stays attached.
+ *
+ * @param element Video buffer element object
+ *
+ * @return None
+ */
+void esp_video_buffer_element_cancel_dmabuf(struct esp_video_buffer_element *element);
+
+/**
+ * @brief Detach the imported DMABUF from buffer element.
+ *
+ * @param element Video buffer element object
+ *
+ * @return DMABUF handle which has been detached, or -1 if no DMABUF is imported
+ */
+int esp_video_buffer_element_detach_dmabuf(struct esp_video_buffer_element *element);
+
 /**
  * @brief Get element object pointer by buffer
  *
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -9,6 +9,9 @@
 #include "esp_video.h"
 #include "esp_cam_sensor_types.h"
 #include "esp_cam_motor_types.h"
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+#include "esp_sccb_intf.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,6 +20,10 @@ extern "C" {
 typedef struct esp_video_cam {
     esp_cam_sensor_device_t *sensor;
     esp_cam_motor_device_t *motor;
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    bool defer_ctrl;                        /*!< true: exposure and gain control register writes are flushed at frame start */
+    volatile uint32_t ctrl_sequence;        /*!< First frame sequence number which the last flushed controls take effect on */
+#endif
 } esp_video_cam_t;
 
 /**
@@ -67,6 +74,72 @@ esp_err_t esp_video_cam_query_ext_ctrls(esp_video_cam_t *cam, struct v4l2_query_
  */
 esp_err_t esp_video_cam_query_menu(esp_video_cam_t *cam, struct v4l2_querymenu *qmenu);
 
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+/**
+ * @brief Start writing exposure and gain controls of camera device at frame start
+ *
+ * @param cam      Camera device pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_cam_start_defer_ctrl(esp_video_cam_t *cam);
+
+/**
+ * @brief Stop writing exposure and gain controls of camera device at frame start, the controls
+ *        which are not written yet are dropped
+ *
+ * @param cam      Camera device pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_cam_stop_defer_ctrl(esp_video_cam_t *cam);
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY
+/**
+ * @brief Put camera sensor into software standby when the video device is closed
+ *
+ * @param cam      Camera device pointer
+ *
+ * @return
+ *      - ESP_OK on success, including the case that the camera sensor does not support standby
+ *      - Others if failed
+ */
+esp_err_t esp_video_cam_standby(esp_video_cam_t *cam);
+
+/**
+ * @brief Make camera sensor leave software standby when the video device is opened
+ *
+ * @param cam      Camera device pointer
+ *
+ * @return
+ *      - ESP_OK on success, including the case that the camera sensor is not in standby
+ *      - Others if failed
+ */
+esp_err_t esp_video_cam_resume(esp_video_cam_t *cam);
+#endif
+
+/**
+ * @brief Notify camera device that a new frame starts, this is called in ISR
+ *
+ * @param cam      Camera device pointer
+ * @param sequence Sequence number of the new frame
+ *
+ * @return None
+ */
+static inline void esp_video_cam_frame_start(esp_video_cam_t *cam, uint32_t sequence)
+{
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    if (cam->defer_ctrl) {
+        esp_sccb_defer_flush_from_isr(cam->sensor->sccb_handle, sequence);
+    }
+#endif
+}
+
 #ifdef __cplusplus
 }
 #endif
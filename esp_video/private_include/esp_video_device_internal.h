@@ -12,6 +12,9 @@
 #if CONFIG_ESP_VIDEO_ENABLE_HW_JPEG_VIDEO_DEVICE
 #include "driver/jpeg_encode.h"
 #endif
+#if CONFIG_ESP_VIDEO_ENABLE_VIVID_VIDEO_DEVICE
+#include "esp_video_init.h"
+#endif
 #include "esp_video_device.h"
 #include "hal/cam_ctlr_types.h"
 #include "esp_cam_ctlr_spi.h"
@@ -194,7 +197,7 @@ esp_cam_sensor_device_t *esp_video_get_dvp_video_device_sensor(void);
 /**
  * @brief Create H.264 video device
  *
- * @param hw_codec true: hardware H.264, false: software H.264(has not supported)
+ * @param hw_codec true: hardware H.264, false: software H.264
  *
  * @return
  *      - ESP_OK on success
@@ -205,7 +208,7 @@ esp_err_t esp_video_create_h264_video_device(bool hw_codec);
 /**
  * @brief Destroy H.264 video device
  *
- * @param hw_codec true: hardware H.264, false: software H.264(has not supported)
+ * @param hw_codec true: hardware H.264, false: software H.264
  *
  * @return
  *      - ESP_OK on success
@@ -241,6 +244,54 @@ esp_err_t esp_video_create_jpeg_video_device(jpeg_encoder_handle_t enc_handle);
 esp_err_t esp_video_destroy_jpeg_video_device(void);
 #endif
 
+#ifdef CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_VIDEO_DEVICE
+/**
+ * @brief Create software JPEG video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_create_sw_jpeg_video_device(void);
+
+/**
+ * @brief Destroy software JPEG video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_destroy_sw_jpeg_video_device(void);
+#endif
+
+#ifdef CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_DEC_VIDEO_DEVICE
+/**
+ * @brief Create software JPEG decoder video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_create_sw_jpeg_dec_video_device(void);
+
+/**
+ * @brief Destroy software JPEG decoder video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_destroy_sw_jpeg_dec_video_device(void);
+#endif
+
 #if CONFIG_ESP_VIDEO_ENABLE_ISP
 /**
  * @brief Start ISP process based on MIPI-CSI state
@@ -375,6 +426,30 @@ esp_err_t esp_video_install_usb_uvc_driver(const esp_video_usb_uvc_device_config
 esp_err_t esp_video_uninstall_usb_uvc_driver(void);
 #endif // CONFIG_ESP_VIDEO_ENABLE_USB_UVC_VIDEO_DEVICE
 
+#if CONFIG_ESP_VIDEO_ENABLE_VIVID_VIDEO_DEVICE
+/**
+ * @brief Create virtual test pattern video device
+ *
+ * @param config Virtual test pattern video device configuration, NULL means using default configuration
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_create_vivid_video_device(const esp_video_init_vivid_config_t *config);
+
+/**
+ * @brief Destroy virtual test pattern video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_destroy_vivid_video_device(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -87,6 +87,8 @@ extern "C" {
 
 #define CAPTURE_VIDEO_DONE_BUF(v, b, n)     esp_video_done_buffer(v, V4L2_BUF_TYPE_VIDEO_CAPTURE, b, n)
 #define CAPTURE_VIDEO_SKIP_BUF(v, b)        esp_video_skip_buffer(v, V4L2_BUF_TYPE_VIDEO_CAPTURE, b)
+#define CAPTURE_VIDEO_DROP_FRAME(v)         esp_video_drop_frame(v, V4L2_BUF_TYPE_VIDEO_CAPTURE)
+#define CAPTURE_VIDEO_DROP_BUF(v, b)        esp_video_drop_buffer(v, V4L2_BUF_TYPE_VIDEO_CAPTURE, b)
 
 #define CAPTURE_VIDEO_PARAM(v)              STREAM_PARAM(CAPTURE_VIDEO_STREAM(v))
 
@@ -129,7 +131,7 @@ extern "C" {
     esp_video_get_queued_element(v, V4L2_BUF_TYPE_VIDEO_CAPTURE)
 
 #define CAPTURE_VIDEO_GET_FIRST_DONE_ELEMENT_PTR(v)                     \
-    TAILQ_FIRST(&CAPTURE_VIDEO_STREAM(v)->done_list)
+    esp_video_get_first_done_element(v, V4L2_BUF_TYPE_VIDEO_CAPTURE)
 
 /* video M2M operations */
 
@@ -283,12 +285,16 @@ struct esp_video_stream;
  * @param dst           Destination buffer
  * @param dst_size      Destination buffer maximum size
  * @param dst_out_size  Actual destination data size
+ * @param dst_flags     Destination frame flags, V4L2_BUF_FLAG_KEYFRAME, V4L2_BUF_FLAG_PFRAME or
+ *                      V4L2_BUF_FLAG_BFRAME, it is cleared before calling the function
+ * @param dst_metadata  Destination frame metadata, see esp_video_get_dqbuf_metadata, it is cleared
+ *                      before calling the function
  *
  * @return
  *      - ESP_OK on success
  *      - Others if failed
  */
-typedef esp_err_t (*esp_video_m2m_process_t)(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size);
+typedef esp_err_t (*esp_video_m2m_process_t)(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size, uint32_t *dst_flags, uint32_t *dst_metadata);
 
 /**
  * @brief Video operations object.
@@ -374,6 +380,10 @@ struct esp_video_ops {
     /*!< Enumerate video frame intervals */
 
     esp_err_t (*enum_frameintervals)(struct esp_video *video, struct v4l2_frmivalenum *frmival, struct esp_video_stream *stream);
+
+    /*!< M2M video device input data size is variable, e.g. a decoder, so the source data size is the output buffer "bytesused" instead of the frame size */
+
+    bool m2m_variable_input;
 };
 
 #ifdef __cplusplus
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -18,6 +18,7 @@ extern "C" {
  * @brief video device ioctl
  *
  * @param video video object
+ * @param flags file status flags of the file description, e.g. O_NONBLOCK
  * @param cmd ioctl cmd which is defined in include/linux/videodev2.h
  * @param args the args list of the ioctl cmd
  *
@@ -25,7 +26,7 @@ extern "C" {
  *      - ESP_OK on success
  *      - Others if failed
  */
-esp_err_t esp_video_ioctl(struct esp_video *video, int cmd, va_list args);
+esp_err_t esp_video_ioctl(struct esp_video *video, int flags, int cmd, va_list args);
 
 #ifdef __cplusplus
 }
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -23,6 +23,27 @@ typedef struct esp_video_isp_config {
     const esp_ipa_config_t *ipa_config; /*!< IPA configuration */
 } esp_video_isp_config_t;
 
+/**
+ * @brief ISP pipeline controller ioctl statistics
+ */
+typedef struct esp_video_isp_ioctl_stats {
+    uint32_t frames;                    /*!< Number of frames processed by the controller */
+    uint32_t last_frame_ioctls;         /*!< Number of ioctls issued when processing the last frame */
+    uint32_t max_frame_ioctls;          /*!< Maximum number of ioctls issued when processing one frame */
+    uint64_t total_ioctls;              /*!< Total number of ioctls issued when processing all frames */
+    uint32_t cache_refreshes;           /*!< Number of times the sensor control cache has been refreshed */
+} esp_video_isp_ioctl_stats_t;
+
+/**
+ * @brief ISP pipeline controller 3A convergence statistics
+ */
+typedef struct esp_video_isp_3a_stats {
+    bool restored;                      /*!< true if the 3A state persisted by the last run seeded this start */
+    uint32_t frames;                    /*!< Number of frames processed since the controller started */
+    uint32_t converge_frames;           /*!< Number of frames to 3A convergence, 0 if 3A has not converged yet */
+    uint32_t saves;                     /*!< Number of times the 3A state has been persisted */
+} esp_video_isp_3a_stats_t;
+
 /**
  * @brief Initialize and start ISP system module.
  *
@@ -54,6 +75,28 @@ esp_err_t esp_video_isp_pipeline_deinit(void);
  */
 bool esp_video_isp_pipeline_is_initialized(void);
 
+/**
+ * @brief Get ISP pipeline controller ioctl statistics.
+ *
+ * @param stats ISP pipeline controller ioctl statistics buffer pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_get_ioctl_stats(esp_video_isp_ioctl_stats_t *stats);
+
+/**
+ * @brief Get ISP pipeline controller 3A convergence statistics.
+ *
+ * @param stats ISP pipeline controller 3A convergence statistics buffer pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_get_3a_stats(esp_video_isp_3a_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
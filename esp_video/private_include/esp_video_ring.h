@@ -0,0 +1,167 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Video buffer index ring slot count, it must be a power of 2.
+ *
+ * @note A stream using index rings can have at most ESP_VIDEO_RING_SIZE - 1
+ *       buffer elements, this keeps "esp_video_ring_unget" from overwriting
+ *       a slot which the producer is filling.
+ */
+#define ESP_VIDEO_RING_SIZE                 32
+
+#define ESP_VIDEO_RING_MASK                 (ESP_VIDEO_RING_SIZE - 1)
+
+_Static_assert((ESP_VIDEO_RING_SIZE & ESP_VIDEO_RING_MASK) == 0, "ESP_VIDEO_RING_SIZE must be a power of 2");
+
+/**
+ * @brief Lock-free single-producer/single-consumer video buffer index ring.
+ *
+ * Only the producer writes "head" and only the consumer writes "tail", so
+ * neither side needs a lock, the slot content is published by the
+ * release-store of "head" and handed back by the release-store of "tail".
+ */
+struct esp_video_ring {
+    atomic_uint head;                       /*!< Next slot to write, written by producer only */
+    atomic_uint tail;                       /*!< Next slot to read, written by consumer only */
+    uint8_t slot[ESP_VIDEO_RING_SIZE];      /*!< Buffer element index slots */
+};
+
+/**
+ * @brief Reset index ring, both producer and consumer must be stopped.
+ *
+ * @param ring Index ring object
+ *
+ * @return None
+ */
+static inline void esp_video_ring_reset(struct esp_video_ring *ring)
+{
+    atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief Get count of indexes in index ring.
+ *
+ * @param ring Index ring object
+ *
+ * @return Index count
+ */
+static inline uint32_t esp_video_ring_count(struct esp_video_ring *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    return head - tail;
+}
+
+/**
+ * @brief Put index into the tail of index ring, called by producer only.
+ *
+ * @param ring  Index ring object
+ * @param index Buffer element index
+ *
+ * @return
+ *      - true on success
+ *      - false if ring is full
+ */
+static inline bool esp_video_ring_push(struct esp_video_ring *ring, uint8_t index)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail >= ESP_VIDEO_RING_SIZE) {
+        return false;
+    }
+
+    ring->slot[head & ESP_VIDEO_RING_MASK] = index;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+/**
+ * @brief Get the first index of index ring without removing it, called by consumer only.
+ *
+ * @param ring  Index ring object
+ * @param index Buffer element index buffer pointer
+ *
+ * @return
+ *      - true on success
+ *      - false if ring is empty
+ */
+static inline bool esp_video_ring_peek(struct esp_video_ring *ring, uint8_t *index)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) {
+        return false;
+    }
+
+    *index = ring->slot[tail & ESP_VIDEO_RING_MASK];
+
+    return true;
+}
+
+/**
+ * @brief Remove the first index from index ring, called by consumer only.
+ *
+ * @param ring  Index ring object
+ * @param index Buffer element index buffer pointer
+ *
+ * @return
+ *      - true on success
+ *      - false if ring is empty
+ */
+static inline bool esp_video_ring_pop(struct esp_video_ring *ring, uint8_t *index)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) {
+        return false;
+    }
+
+    *index = ring->slot[tail & ESP_VIDEO_RING_MASK];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+/**
+ * @brief Put index back into the head of index ring, called by consumer only.
+ *
+ * @note The slot in front of "tail" has been consumed, and the producer can't
+ *       reach it as long as fewer than ESP_VIDEO_RING_SIZE - 1 indexes are in
+ *       the ring, which is guaranteed by the stream buffer count limit.
+ *
+ * @param ring  Index ring object
+ * @param index Buffer element index
+ *
+ * @return None
+ */
+static inline void esp_video_ring_unget(struct esp_video_ring *ring, uint8_t index)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed) - 1;
+
+    ring->slot[tail & ESP_VIDEO_RING_MASK] = index;
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -46,6 +46,21 @@ esp_err_t esp_video_vfs_dev_register(const char *name, struct esp_video *video);
  */
 esp_err_t esp_video_vfs_dev_unregister(const char *name);
 
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+/**
+ * @brief Wake up the select() calls which are waiting for the video device.
+ *
+ * @note This function can be called in ISR.
+ *
+ * @param video Video object
+ *
+ * @return None
+ */
+void esp_video_vfs_select_notify(struct esp_video *video);
+#else
+#define esp_video_vfs_select_notify(v)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
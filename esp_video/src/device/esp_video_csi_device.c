@@ -315,6 +315,9 @@ static bool IRAM_ATTR csi_video_on_trans_finished(esp_cam_ctlr_handle_t handle,
         if (param->skip_frames) {
             param->skip_count = (param->skip_count + 1) % param->skip_frames;
         }
+    } else {
+        /* No free buffer when the frame started, so the frame is received by the backup buffer and dropped */
+        CAPTURE_VIDEO_DROP_FRAME(video);
     }
 #else
     if (!param->skip_count) {
@@ -335,11 +338,12 @@ static bool IRAM_ATTR csi_video_on_get_new_trans(esp_cam_ctlr_handle_t handle, e
 {
     struct esp_video_buffer_element *element;
     struct esp_video *video = (struct esp_video *)user_data;
+    struct csi_video *csi_video = VIDEO_PRIV_DATA(struct csi_video *, video);
+
+    esp_video_cam_frame_start(&csi_video->cam, CAPTURE_VIDEO_STREAM(video)->sequence);
 
     element = CAPTURE_VIDEO_GET_QUEUED_ELEMENT(video);
 #if CONFIG_ESP_VIDEO_DISABLE_MIPI_CSI_DRIVER_BACKUP_BUFFER
-    struct csi_video *csi_video = VIDEO_PRIV_DATA(struct csi_video *, video);
-
     if (!element) {
         element = csi_video->element;
     } else {
@@ -347,6 +351,8 @@ static bool IRAM_ATTR csi_video_on_get_new_trans(esp_cam_ctlr_handle_t handle, e
     }
 #else
     if (!element) {
+        /* CSI driver receives this frame by its backup buffer and drops it */
+        CAPTURE_VIDEO_DROP_FRAME(video);
         return false;
     }
 #endif
@@ -425,6 +431,9 @@ static esp_err_t csi_video_init(struct esp_video *video)
     }
 
     ESP_GOTO_ON_ERROR(esp_cam_sensor_set_format(csi_video->cam.sensor, NULL), fail_0, TAG, "failed to set basic format");
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY
+    ESP_GOTO_ON_ERROR(esp_video_cam_resume(&csi_video->cam), fail_0, TAG, "failed to resume sensor");
+#endif
     ESP_GOTO_ON_ERROR(init_config(video), fail_0, TAG, "failed to initialize config");
 
     return ESP_OK;
@@ -511,6 +520,10 @@ static esp_err_t csi_video_start(struct esp_video *video, uint32_t type)
 #endif
 #endif
 
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    ESP_GOTO_ON_ERROR(esp_video_cam_start_defer_ctrl(&csi_video->cam), exit_0, TAG, "failed to start deferred camera control");
+#endif
+
     ESP_GOTO_ON_ERROR(esp_cam_new_csi_ctlr(&csi_config, &csi_video->cam_ctrl_handle), exit_0, TAG, "failed to new CSI");
 
     esp_cam_ctlr_evt_cbs_t cam_ctrl_cbs = {
@@ -549,6 +562,9 @@ exit_1:
     esp_cam_ctlr_del(csi_video->cam_ctrl_handle);
     csi_video->cam_ctrl_handle = NULL;
 exit_0:
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    esp_video_cam_stop_defer_ctrl(&csi_video->cam);
+#endif
 #if ESP_VIDEO_CSI_DEVICE_SW_SWAP_SHORT
     if (csi_video->swap_short) {
         esp_video_swap_short_free(csi_video->swap_short);
@@ -574,6 +590,10 @@ static esp_err_t csi_video_stop(struct esp_video *video, uint32_t type)
     ESP_RETURN_ON_ERROR(esp_cam_ctlr_del(csi_video->cam_ctrl_handle), TAG, "failed to delete CAM ctlr");
     csi_video->cam_ctrl_handle = NULL;
 
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    ESP_RETURN_ON_ERROR(esp_video_cam_stop_defer_ctrl(&csi_video->cam), TAG, "failed to stop deferred camera control");
+#endif
+
 #if ESP_VIDEO_CSI_DEVICE_SW_SWAP_SHORT
     if (csi_video->swap_short) {
         esp_video_swap_short_free(csi_video->swap_short);
@@ -593,6 +613,10 @@ static esp_err_t csi_video_deinit(struct esp_video *video)
         csi_video->ldo_handle = NULL;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY
+    ESP_RETURN_ON_ERROR(esp_video_cam_standby(&csi_video->cam), TAG, "failed to put sensor into standby");
+#endif
+
     return ESP_OK;
 }
 
@@ -128,7 +128,12 @@ static bool IRAM_ATTR dvp_video_on_trans_finished(esp_cam_ctlr_handle_t handle,
 
     ESP_EARLY_LOGD(TAG, "size=%d", (int)trans->received_size);
 
-    CAPTURE_VIDEO_DONE_BUF(video, trans->buffer, trans->received_size);
+    if (trans->received_size) {
+        CAPTURE_VIDEO_DONE_BUF(video, trans->buffer, trans->received_size);
+    } else {
+        /* The controller reports a frame which overflows the buffer or fails to be decoded by 0 size */
+        CAPTURE_VIDEO_DROP_BUF(video, trans->buffer);
+    }
 
     return true;
 }
@@ -137,10 +142,11 @@ static bool IRAM_ATTR dvp_video_on_get_new_trans(esp_cam_ctlr_handle_t handle, e
 {
     struct esp_video_buffer_element *element;
     struct esp_video *video = (struct esp_video *)user_data;
-
-#if CONFIG_ESP_VIDEO_ENABLE_SWAP_BYTE
     struct dvp_video *dvp_video = VIDEO_PRIV_DATA(struct dvp_video *, video);
 
+    esp_video_cam_frame_start(&dvp_video->cam, CAPTURE_VIDEO_STREAM(video)->sequence);
+
+#if CONFIG_ESP_VIDEO_ENABLE_SWAP_BYTE
     if (dvp_video->swap_byte) {
         esp_err_t ret = esp_video_swap_byte_start(dvp_video->swap_byte);
         if (ret != ESP_OK) {
@@ -151,6 +157,8 @@ static bool IRAM_ATTR dvp_video_on_get_new_trans(esp_cam_ctlr_handle_t handle, e
 
     element = CAPTURE_VIDEO_GET_QUEUED_ELEMENT(video);
     if (!element) {
+        /* No free buffer, so the controller drops this frame */
+        CAPTURE_VIDEO_DROP_FRAME(video);
         return false;
     }
 
@@ -199,6 +207,9 @@ static esp_err_t dvp_video_init(struct esp_video *video)
     struct dvp_video *dvp_video = VIDEO_PRIV_DATA(struct dvp_video *, video);
 
     ESP_RETURN_ON_ERROR(esp_cam_sensor_set_format(dvp_video->cam.sensor, NULL), TAG, "failed to set basic format");
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY
+    ESP_RETURN_ON_ERROR(esp_video_cam_resume(&dvp_video->cam), TAG, "failed to resume sensor");
+#endif
     ESP_RETURN_ON_ERROR(init_config(video), TAG, "failed to initialize config");
 
     return ESP_OK;
@@ -239,6 +250,14 @@ static esp_err_t dvp_video_start(struct esp_video *video, uint32_t type)
     }
 #endif
 
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    ret = esp_video_cam_start_defer_ctrl(&dvp_video->cam);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to start deferred camera control");
+        goto exit_0;
+    }
+#endif
+
     esp_cam_ctlr_dvp_config_t dvp_config = {
         .ctlr_id = DVP_CTLR_ID,
         .clk_src = CAM_CLK_SRC_DEFAULT,
@@ -307,6 +326,9 @@ exit_1:
     esp_cam_ctlr_del(dvp_video->cam_ctrl_handle);
     dvp_video->cam_ctrl_handle = NULL;
 exit_0:
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    esp_video_cam_stop_defer_ctrl(&dvp_video->cam);
+#endif
 #if CONFIG_ESP_VIDEO_ENABLE_SWAP_BYTE
     if (dvp_video->swap_byte) {
         esp_video_swap_byte_free(dvp_video->swap_byte);
@@ -356,11 +378,25 @@ static esp_err_t dvp_video_stop(struct esp_video *video, uint32_t type)
 
     dvp_video->cam_ctrl_handle = NULL;
 
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    ret = esp_video_cam_stop_defer_ctrl(&dvp_video->cam);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to stop deferred camera control");
+        return ret;
+    }
+#endif
+
     return ret;
 }
 
 static esp_err_t dvp_video_deinit(struct esp_video *video)
 {
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY
+    struct dvp_video *dvp_video = VIDEO_PRIV_DATA(struct dvp_video *, video);
+
+    ESP_RETURN_ON_ERROR(esp_video_cam_standby(&dvp_video->cam), TAG, "failed to put sensor into standby");
+#endif
+
     return ESP_OK;
 }
 
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -11,9 +11,17 @@
 #include "esp_log.h"
 #include "esp_attr.h"
 #include "esp_private/esp_cache_private.h"
+#include "esp_check.h"
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
 #include "esp_h264_enc_single_hw.h"
+#include "esp_h264_enc_param_hw.h"
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
 #include "esp_h264_enc_single_sw.h"
+#include "esp_h264_enc_param_sw.h"
+#endif
 #include "esp_h264_enc_single.h"
+#include "esp_h264_enc_param.h"
 
 #include "esp_video.h"
 #include "esp_video_device_internal.h"
@@ -30,6 +38,7 @@
 #define H264_VIDEO_DEVICE_MIN_QP    25
 #define H264_VIDEO_DEVICE_MAX_QP    26
 #define H264_VIDEO_DEVICE_BITRATE   10000000
+#define H264_VIDEO_DEVICE_FPS       30
 
 #define H264_VIDEO_MAX_I_PERIOD     120
 #define H264_VIDEO_MIN_I_PERIOD     1
@@ -43,13 +52,40 @@
 #define H264_VIDEO_MIN_QP           0
 #define H264_VIDEO_QP_STEP          1
 
+#define H264_VIDEO_MAX_FPS          UINT8_MAX
+#define H264_VIDEO_MIN_FPS          1
+
 #define H264_VIDEO_MIN_WIDTH            64
 #define H264_VIDEO_MIN_HEIGHT           64
 
+/**
+ * Hardware and software encoders share the same configuration fields.
+ */
+#define H264_VIDEO_ENC_CONFIG(video, h264_video)                        \
+    {                                                                   \
+        .pic_type = (h264_video)->input_format,                         \
+        .gop = (h264_video)->gop,                                       \
+        .fps = (h264_video)->fps,                                       \
+        .res = {                                                        \
+            .width = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video),          \
+            .height = M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video),        \
+        },                                                              \
+        .rc = {                                                         \
+            .bitrate = (h264_video)->bitrate,                           \
+            .qp_min = (h264_video)->min_qp,                             \
+            .qp_max = (h264_video)->max_qp,                             \
+        }                                                               \
+    }
+
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(x)   (sizeof(x) / sizeof((x)[0]))
 #endif
 
+/**
+ * Controls and stream parameters are set by the application task and applied by the M2M
+ * process function before encoding the next frame, so only the M2M process context accesses
+ * the encoder after it is opened.
+ */
 struct h264_video {
     bool hw_codec;
 
@@ -57,8 +93,21 @@ struct h264_video {
     uint8_t gop;
     uint8_t min_qp;
     uint8_t max_qp;
+    uint8_t fps;
     uint32_t bitrate;
+    uint32_t key_frame_req;                     /*!< Count of V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME requests */
+
     esp_h264_enc_handle_t enc_handle;
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+    uint8_t *i420_buf;                          /*!< Input frame converted to I420 for the software encoder */
+    uint32_t i420_size;                         /*!< Size of i420_buf */
+#endif
+    uint8_t enc_gop;                            /*!< GOP of the running encoder */
+    uint8_t enc_min_qp;                         /*!< Minimum QP of the running encoder */
+    uint8_t enc_max_qp;                         /*!< Maximum QP of the running encoder */
+    uint8_t enc_fps;                            /*!< Frame rate of the running encoder */
+    uint32_t enc_bitrate;                       /*!< Bitrate of the running encoder */
+    uint32_t enc_key_frame_req;                 /*!< Key frame requests which have been handled by the running encoder */
 };
 
 static const struct v4l2_query_ext_ctrl s_h264_qctrl[] = {
@@ -106,6 +155,18 @@ static const struct v4l2_query_ext_ctrl s_h264_qctrl[] = {
         .default_value = H264_VIDEO_DEVICE_BITRATE,
         .name = "Video Bitrate"
     },
+    {
+        .id = V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME,
+        .type = V4L2_CTRL_TYPE_BUTTON,
+        .maximum = 0,
+        .minimum = 0,
+        .step = 0,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .default_value = 0,
+        .flags = V4L2_CTRL_FLAG_WRITE_ONLY | V4L2_CTRL_FLAG_EXECUTE_ON_WRITE,
+        .name = "Force Key Frame"
+    },
 };
 
 static const char *TAG = "h.264_video";
@@ -130,13 +191,33 @@ static esp_err_t errno_h264_to_std(esp_h264_err_t h264_err)
     }
 }
 
-static esp_err_t h264_get_input_format_from_v4l2(uint32_t v4l2_format, esp_h264_raw_format_t *input_format, uint8_t *input_bpp)
+static bool h264_codec_is_supported(bool hw_codec)
+{
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+    if (hw_codec) {
+        return true;
+    }
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+    if (!hw_codec) {
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+/**
+ * The software encoder only takes I420, so Espressif YUV420 input, whose odd lines are UYY and
+ * even lines are VYY, is converted to I420 before it is encoded.
+ */
+static esp_err_t h264_get_input_format_from_v4l2(bool hw_codec, uint32_t v4l2_format, esp_h264_raw_format_t *input_format, uint8_t *input_bpp)
 {
     esp_err_t ret = ESP_OK;
 
     switch (v4l2_format) {
     case V4L2_PIX_FMT_YUV420:
-        *input_format = ESP_H264_RAW_FMT_O_UYY_E_VYY;
+        *input_format = hw_codec ? ESP_H264_RAW_FMT_O_UYY_E_VYY : ESP_H264_RAW_FMT_I420;
         *input_bpp = 12;
         break;
     default:
@@ -147,7 +228,270 @@ static esp_err_t h264_get_input_format_from_v4l2(uint32_t v4l2_format, esp_h264_
     return ret;
 }
 
-static esp_err_t h264_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+static void h264_yuv420_to_i420(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height)
+{
+    uint8_t *dst_y = dst;
+    uint8_t *dst_u = dst + width * height;
+    uint8_t *dst_v = dst_u + width * height / 4;
+    const uint32_t line_size = width * 3 / 2;
+
+    for (uint32_t y = 0; y < height; y += 2) {
+        const uint8_t *uyy = src;
+        const uint8_t *vyy = src + line_size;
+
+        for (uint32_t x = 0; x < width; x += 2) {
+            *dst_u++ = uyy[0];
+            dst_y[x] = uyy[1];
+            dst_y[x + 1] = uyy[2];
+            uyy += 3;
+
+            *dst_v++ = vyy[0];
+            dst_y[width + x] = vyy[1];
+            dst_y[width + x + 1] = vyy[2];
+            vyy += 3;
+        }
+
+        src += line_size * 2;
+        dst_y += width * 2;
+    }
+}
+#endif
+
+/**
+ * @brief Create and open an encoder with the current configuration, the running encoder and
+ *        the I420 buffer are not changed.
+ */
+static esp_err_t h264_video_new_encoder(struct esp_video *video, esp_h264_enc_handle_t *enc_handle)
+{
+    esp_h264_err_t h264_err = ESP_H264_ERR_UNSUPPORTED;
+    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+
+    if (h264_video->hw_codec) {
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+        esp_h264_enc_cfg_hw_t config = H264_VIDEO_ENC_CONFIG(video, h264_video);
+
+        h264_err = esp_h264_enc_hw_new(&config, enc_handle);
+#endif
+    } else {
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+        esp_h264_enc_cfg_sw_t config = H264_VIDEO_ENC_CONFIG(video, h264_video);
+
+        h264_err = esp_h264_enc_sw_new(&config, enc_handle);
+#endif
+    }
+
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to create H.264 encoder");
+        return errno_h264_to_std(h264_err);
+    }
+
+    h264_err = esp_h264_enc_open(*enc_handle);
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to open H.264 encoder");
+        esp_h264_enc_del(*enc_handle);
+        *enc_handle = NULL;
+        return errno_h264_to_std(h264_err);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t h264_video_free_encoder(esp_h264_enc_handle_t enc_handle)
+{
+    esp_h264_err_t h264_err;
+
+    h264_err = esp_h264_enc_close(enc_handle);
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to close H.264 encoder");
+        return errno_h264_to_std(h264_err);
+    }
+
+    h264_err = esp_h264_enc_del(enc_handle);
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to delete H.264 encoder");
+        return errno_h264_to_std(h264_err);
+    }
+
+    return ESP_OK;
+}
+
+static void h264_video_save_encoder_config(struct h264_video *h264_video)
+{
+    h264_video->enc_gop = h264_video->gop;
+    h264_video->enc_min_qp = h264_video->min_qp;
+    h264_video->enc_max_qp = h264_video->max_qp;
+    h264_video->enc_fps = h264_video->fps;
+    h264_video->enc_bitrate = h264_video->bitrate;
+}
+
+static esp_err_t h264_video_create_encoder(struct esp_video *video)
+{
+    esp_err_t ret;
+    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+    if (!h264_video->hw_codec) {
+        h264_video->i420_size = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video) * M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video) * 3 / 2;
+        h264_video->i420_buf = heap_caps_malloc(h264_video->i420_size, H264_MEM_CAPS);
+        ESP_RETURN_ON_FALSE(h264_video->i420_buf, ESP_ERR_NO_MEM, TAG, "failed to malloc I420 buffer");
+    }
+#endif
+
+    ret = h264_video_new_encoder(video, &h264_video->enc_handle);
+    if (ret != ESP_OK) {
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+        heap_caps_free(h264_video->i420_buf);
+        h264_video->i420_buf = NULL;
+#endif
+        return ret;
+    }
+
+    h264_video_save_encoder_config(h264_video);
+
+    return ESP_OK;
+}
+
+static esp_err_t h264_video_delete_encoder(struct esp_video *video)
+{
+    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+
+    if (!h264_video->enc_handle) {
+        return ESP_OK;
+    }
+
+    ESP_RETURN_ON_ERROR(h264_video_free_encoder(h264_video->enc_handle), TAG, "failed to free H.264 encoder");
+    h264_video->enc_handle = NULL;
+
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+    heap_caps_free(h264_video->i420_buf);
+    h264_video->i420_buf = NULL;
+#endif
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Replace the running encoder by a new one with the current configuration.
+ *
+ * The new encoder is created before the running one is deleted, so the running encoder and
+ * the I420 buffer are kept if the new encoder can't be created, and the next frame retries.
+ */
+static esp_err_t h264_video_recreate_encoder(struct esp_video *video)
+{
+    esp_err_t ret;
+    esp_h264_enc_handle_t enc_handle;
+    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+
+    ESP_RETURN_ON_ERROR(h264_video_new_encoder(video, &enc_handle), TAG, "failed to create new H.264 encoder");
+
+    ret = h264_video_free_encoder(h264_video->enc_handle);
+    if (ret != ESP_OK) {
+        h264_video_free_encoder(enc_handle);
+        return ret;
+    }
+
+    h264_video->enc_handle = enc_handle;
+    h264_video_save_encoder_config(h264_video);
+
+    return ESP_OK;
+}
+
+static esp_h264_err_t h264_video_get_param_handle(struct h264_video *h264_video, esp_h264_enc_param_handle_t *param)
+{
+    esp_h264_err_t h264_err = ESP_H264_ERR_UNSUPPORTED;
+
+    if (h264_video->hw_codec) {
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+        esp_h264_enc_param_hw_handle_t param_hw;
+
+        h264_err = esp_h264_enc_hw_get_param_hd(h264_video->enc_handle, &param_hw);
+        *param = (esp_h264_enc_param_handle_t)param_hw;
+#endif
+    } else {
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+        esp_h264_enc_param_sw_handle_t param_sw;
+
+        h264_err = esp_h264_enc_sw_get_param_hd(h264_video->enc_handle, &param_sw);
+        *param = (esp_h264_enc_param_handle_t)param_sw;
+#endif
+    }
+
+    return h264_err;
+}
+
+/**
+ * @brief Apply changed controls and stream parameters to the running encoder.
+ *
+ * GOP, frame rate and bitrate are changed by encoder parameter APIs. The encoder has no API
+ * to change the QP range or to force an IDR frame, so it is replaced by a new encoder with the
+ * new configuration, and the first frame of the new encoder is an IDR frame. If the encoder
+ * can't be replaced, the running encoder is kept and the error is returned.
+ */
+static esp_err_t h264_video_update_encoder(struct esp_video *video)
+{
+    esp_h264_err_t h264_err;
+    esp_h264_enc_param_handle_t param;
+    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+    uint32_t key_frame_req = h264_video->key_frame_req;
+
+    if (!h264_video->enc_handle) {
+        ESP_RETURN_ON_ERROR(h264_video_create_encoder(video), TAG, "failed to create H.264 encoder");
+        h264_video->enc_key_frame_req = key_frame_req;
+        return ESP_OK;
+    }
+
+    if ((h264_video->enc_min_qp != h264_video->min_qp) ||
+            (h264_video->enc_max_qp != h264_video->max_qp) ||
+            (h264_video->enc_key_frame_req != key_frame_req)) {
+        ESP_RETURN_ON_ERROR(h264_video_recreate_encoder(video), TAG, "failed to re-create H.264 encoder");
+        h264_video->enc_key_frame_req = key_frame_req;
+        return ESP_OK;
+    }
+
+    if ((h264_video->enc_gop == h264_video->gop) &&
+            (h264_video->enc_fps == h264_video->fps) &&
+            (h264_video->enc_bitrate == h264_video->bitrate)) {
+        return ESP_OK;
+    }
+
+    h264_err = h264_video_get_param_handle(h264_video, &param);
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to get H.264 encoder parameter handle");
+        return errno_h264_to_std(h264_err);
+    }
+
+    if (h264_video->enc_gop != h264_video->gop) {
+        h264_err = esp_h264_enc_set_gop(param, h264_video->gop);
+        if (h264_err != ESP_H264_ERR_OK) {
+            ESP_LOGE(TAG, "failed to set GOP=%u", h264_video->gop);
+            return errno_h264_to_std(h264_err);
+        }
+        h264_video->enc_gop = h264_video->gop;
+    }
+
+    if (h264_video->enc_fps != h264_video->fps) {
+        h264_err = esp_h264_enc_set_fps(param, h264_video->fps);
+        if (h264_err != ESP_H264_ERR_OK) {
+            ESP_LOGE(TAG, "failed to set fps=%u", h264_video->fps);
+            return errno_h264_to_std(h264_err);
+        }
+        h264_video->enc_fps = h264_video->fps;
+    }
+
+    if (h264_video->enc_bitrate != h264_video->bitrate) {
+        h264_err = esp_h264_enc_set_bitrate(param, h264_video->bitrate);
+        if (h264_err != ESP_H264_ERR_OK) {
+            ESP_LOGE(TAG, "failed to set bitrate=%" PRIu32, h264_video->bitrate);
+            return errno_h264_to_std(h264_err);
+        }
+        h264_video->enc_bitrate = h264_video->bitrate;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t h264_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size, uint32_t *dst_flags, uint32_t *dst_metadata)
 {
     esp_h264_err_t h264_err;
     esp_h264_enc_in_frame_t in_frame = {
@@ -164,9 +508,27 @@ static esp_err_t h264_video_m2m_process(struct esp_video *video, uint8_t *src, u
     };
     struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
 
+    ESP_RETURN_ON_ERROR(h264_video_update_encoder(video), TAG, "failed to update H.264 encoder");
+
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+    if (!h264_video->hw_codec) {
+        ESP_RETURN_ON_FALSE(src_size >= h264_video->i420_size, ESP_ERR_INVALID_SIZE, TAG, "input frame is too small");
+        h264_yuv420_to_i420(src, h264_video->i420_buf, M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video),
+                            M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video));
+        in_frame.raw_data.buffer = h264_video->i420_buf;
+        in_frame.raw_data.len = h264_video->i420_size;
+    }
+#endif
+
     h264_err = esp_h264_enc_process(h264_video->enc_handle, &in_frame, &out_frame);
     if (h264_err == ESP_H264_ERR_OK) {
         *dst_out_size = out_frame.length;
+
+        if ((out_frame.frame_type == ESP_H264_FRAME_TYPE_IDR) || (out_frame.frame_type == ESP_H264_FRAME_TYPE_I)) {
+            *dst_flags = V4L2_BUF_FLAG_KEYFRAME;
+        } else if (out_frame.frame_type == ESP_H264_FRAME_TYPE_P) {
+            *dst_flags = V4L2_BUF_FLAG_PFRAME;
+        }
     }
 
     return errno_h264_to_std(h264_err);
@@ -187,7 +549,6 @@ static esp_err_t h264_video_deinit(struct esp_video *video)
 
 static esp_err_t h264_video_start(struct esp_video *video, uint32_t type)
 {
-    esp_h264_err_t h264_err = ESP_H264_ERR_UNSUPPORTED;
     struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
 
     if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
@@ -197,40 +558,8 @@ static esp_err_t h264_video_start(struct esp_video *video, uint32_t type)
     }
 
     if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
-        esp_h264_enc_cfg_hw_t config = {
-            .pic_type = h264_video->input_format,
-            .gop = h264_video->gop,
-            .fps = h264_video->gop,
-            .res = {
-                .width = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video),
-                .height = M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video),
-            },
-            .rc = {
-                .bitrate = h264_video->bitrate,
-                .qp_min = h264_video->min_qp,
-                .qp_max = h264_video->max_qp,
-            }
-        };
-
-        if (h264_video->hw_codec) {
-            h264_err = esp_h264_enc_hw_new(&config, &h264_video->enc_handle);
-        } else {
-            h264_err = ESP_H264_ERR_UNSUPPORTED;
-        }
-
-        if (h264_err != ESP_H264_ERR_OK) {
-            ESP_LOGE(TAG, "failed to create H.264 encoder");
-            return errno_h264_to_std(h264_err);
-        }
-
-        h264_err = esp_h264_enc_open(h264_video->enc_handle);
-        if (h264_err != ESP_H264_ERR_OK) {
-            esp_h264_enc_del(h264_video->enc_handle);
-            h264_video->enc_handle = NULL;
-
-            ESP_LOGE(TAG, "failed to open H.264 encoder");
-            return errno_h264_to_std(h264_err);
-        }
+        ESP_RETURN_ON_ERROR(h264_video_create_encoder(video), TAG, "failed to start H.264 encoder");
+        h264_video->enc_key_frame_req = h264_video->key_frame_req;
     }
 
     return ESP_OK;
@@ -238,22 +567,8 @@ static esp_err_t h264_video_start(struct esp_video *video, uint32_t type)
 
 static esp_err_t h264_video_stop(struct esp_video *video, uint32_t type)
 {
-    esp_h264_err_t h264_err;
-    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
-
     if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
-        h264_err = esp_h264_enc_close(h264_video->enc_handle);
-        if (h264_err != ESP_H264_ERR_OK) {
-            ESP_LOGE(TAG, "failed to close H.264 encoder");
-            return errno_h264_to_std(h264_err);
-        }
-
-        h264_err = esp_h264_enc_del(h264_video->enc_handle);
-        if (h264_err != ESP_H264_ERR_OK) {
-            ESP_LOGE(TAG, "failed to delete H.264 encoder");
-            return errno_h264_to_std(h264_err);
-        }
-        h264_video->enc_handle = NULL;
+        ESP_RETURN_ON_ERROR(h264_video_delete_encoder(video), TAG, "failed to stop H.264 encoder");
     }
 
     return ESP_OK;
@@ -312,7 +627,7 @@ static esp_err_t h264_video_set_format(struct esp_video *video, const struct v4l
             return ESP_ERR_INVALID_ARG;
         }
 
-        ret = h264_get_input_format_from_v4l2(pix->pixelformat, &h264_video->input_format, &input_bpp);
+        ret = h264_get_input_format_from_v4l2(h264_video->hw_codec, pix->pixelformat, &h264_video->input_format, &input_bpp);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "pixel format is invalid");
             return ret;
@@ -369,6 +684,9 @@ static esp_err_t h264_video_set_ext_ctrl(struct esp_video *video, const struct v
         case V4L2_CID_MPEG_VIDEO_H264_MAX_QP:
             h264_video->max_qp = ctrl->value;
             break;
+        case V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME:
+            h264_video->key_frame_req++;
+            break;
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
             ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
@@ -400,6 +718,9 @@ static esp_err_t h264_video_get_ext_ctrl(struct esp_video *video, struct v4l2_ex
         case V4L2_CID_MPEG_VIDEO_H264_MAX_QP:
             ctrl->value = h264_video->max_qp;
             break;
+        case V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME:
+            ctrl->value = 0;
+            break;
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
             ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
@@ -456,6 +777,65 @@ static esp_err_t h264_video_query_ext_ctrl(struct esp_video *video, struct v4l2_
     return ret;
 }
 
+static struct v4l2_fract *h264_video_get_timeperframe(struct v4l2_streamparm *stream_parm)
+{
+    if (stream_parm->type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        return &stream_parm->parm.output.timeperframe;
+    } else if (stream_parm->type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        return &stream_parm->parm.capture.timeperframe;
+    }
+
+    return NULL;
+}
+
+/**
+ * Frame rate of the input images is used by encoder rate control to calculate the bits of
+ * every frame, it can be set by both output and capture stream.
+ */
+static esp_err_t h264_video_set_parm(struct esp_video *video, struct v4l2_streamparm *stream_parm, struct esp_video_stream *stream)
+{
+    uint32_t fps;
+    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+    struct v4l2_fract *tpf = h264_video_get_timeperframe(stream_parm);
+
+    if (!tpf || !tpf->numerator || !tpf->denominator) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fps = tpf->denominator / tpf->numerator;
+    if (fps < H264_VIDEO_MIN_FPS || fps > H264_VIDEO_MAX_FPS) {
+        ESP_LOGE(TAG, "fps=%" PRIu32 " is out of range", fps);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    h264_video->fps = fps;
+
+    tpf->numerator = 1;
+    tpf->denominator = fps;
+
+    return ESP_OK;
+}
+
+static esp_err_t h264_video_get_parm(struct esp_video *video, struct v4l2_streamparm *stream_parm, struct esp_video_stream *stream)
+{
+    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+    struct v4l2_fract *tpf = h264_video_get_timeperframe(stream_parm);
+
+    if (!tpf) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (stream_parm->type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        stream_parm->parm.output.capability |= V4L2_CAP_TIMEPERFRAME;
+    } else {
+        stream_parm->parm.capture.capability |= V4L2_CAP_TIMEPERFRAME;
+    }
+    tpf->numerator = 1;
+    tpf->denominator = h264_video->fps;
+
+    return ESP_OK;
+}
+
 static const struct esp_video_ops s_h264_video_ops = {
     .init           = h264_video_init,
     .deinit         = h264_video_deinit,
@@ -467,12 +847,14 @@ static const struct esp_video_ops s_h264_video_ops = {
     .set_ext_ctrl   = h264_video_set_ext_ctrl,
     .get_ext_ctrl   = h264_video_get_ext_ctrl,
     .query_ext_ctrl = h264_video_query_ext_ctrl,
+    .set_parm       = h264_video_set_parm,
+    .get_parm       = h264_video_get_parm,
 };
 
 /**
  * @brief Create H.264 video device
  *
- * @param hw_codec true: hardware H.264, false: software H.264(has not supported)
+ * @param hw_codec true: hardware H.264, false: software H.264
  *
  * @return
  *      - ESP_OK on success
@@ -481,11 +863,12 @@ static const struct esp_video_ops s_h264_video_ops = {
 esp_err_t esp_video_create_h264_video_device(bool hw_codec)
 {
     struct esp_video *video;
+    uint8_t input_bpp;
     struct h264_video *h264_video;
     uint32_t device_caps = V4L2_CAP_VIDEO_M2M | V4L2_CAP_EXT_PIX_FORMAT | V4L2_CAP_STREAMING;
     uint32_t caps = device_caps | V4L2_CAP_DEVICE_CAPS;
 
-    if (hw_codec == false) {
+    if (!h264_codec_is_supported(hw_codec)) {
         return ESP_ERR_NOT_SUPPORTED;
     }
 
@@ -495,10 +878,12 @@ esp_err_t esp_video_create_h264_video_device(bool hw_codec)
     }
 
     h264_video->hw_codec = hw_codec;
+    h264_get_input_format_from_v4l2(hw_codec, V4L2_PIX_FMT_YUV420, &h264_video->input_format, &input_bpp);
     h264_video->gop = H264_VIDEO_DEVICE_GOP;
     h264_video->min_qp = H264_VIDEO_DEVICE_MIN_QP;
     h264_video->max_qp = H264_VIDEO_DEVICE_MAX_QP;
     h264_video->bitrate = H264_VIDEO_DEVICE_BITRATE;
+    h264_video->fps = H264_VIDEO_DEVICE_FPS;
 
     video = esp_video_create(H264_NAME, ESP_VIDEO_H264_DEVICE_ID, &s_h264_video_ops, h264_video, caps, device_caps);
     if (!video) {
@@ -512,7 +897,7 @@ esp_err_t esp_video_create_h264_video_device(bool hw_codec)
 /**
  * @brief Destroy H.264 video device
  *
- * @param hw_codec true: hardware H.264, false: software H.264(has not supported)
+ * @param hw_codec true: hardware H.264, false: software H.264
  *
  * @return
  *      - ESP_OK on success
@@ -524,7 +909,7 @@ esp_err_t esp_video_destroy_h264_video_device(bool hw_codec)
     struct esp_video *video;
     struct h264_video *h264_video;
 
-    if (hw_codec == false) {
+    if (!h264_codec_is_supported(hw_codec)) {
         return ESP_ERR_NOT_SUPPORTED;
     }
 
@@ -534,6 +919,9 @@ esp_err_t esp_video_destroy_h264_video_device(bool hw_codec)
     }
 
     h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+    if (h264_video->hw_codec != hw_codec) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
     ret = esp_video_destroy(video);
     if (ret != ESP_OK) {
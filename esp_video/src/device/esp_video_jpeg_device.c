@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -36,6 +36,20 @@
 #define JPEG_VIDEO_MIN_WIDTH            64
 #define JPEG_VIDEO_MIN_HEIGHT           64
 
+#define JPEG_VIDEO_MAX_TARGET_SIZE      (4 * 1024 * 1024)
+
+/**
+ * Rate control keeps the frame size in [100 - JPEG_RC_TOLERANCE, 100 + JPEG_RC_TOLERANCE]
+ * percent of the target size. Quality is lowered faster than it is raised, because a frame
+ * larger than the target costs bandwidth, while a smaller one only costs some image details.
+ */
+#define JPEG_RC_TOLERANCE               10
+#define JPEG_RC_DOWN_DIV                8
+#define JPEG_RC_UP_DIV                  16
+#define JPEG_RC_MAX_STEP                20
+#define JPEG_RC_MAX_RATIO               1000
+#define JPEG_RC_OVERFLOW                25      /*!< Re-encode the frame if it is larger than (100 + JPEG_RC_OVERFLOW) percent of the target size */
+
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(x)                   (sizeof(x) / sizeof((x)[0]))
 #endif
@@ -46,7 +60,13 @@ struct jpeg_video {
 
     jpeg_enc_input_format_t src_type;
     jpeg_down_sampling_type_t sub_sample;
-    uint8_t image_quality;
+    uint8_t image_quality;                      /*!< Fixed quality, or maximum quality if rate control is enabled */
+
+    portMUX_TYPE rc_lock;                       /*!< Rate control lock, controls are set by the application task and read by the encoding task */
+    uint32_t target_size;                       /*!< Target frame size in bytes, 0 means rate control is disabled */
+    bool rc_reencode;                           /*!< Re-encode the frame once if it overflows the target size */
+    uint8_t rc_quality;                         /*!< Rate control quality of the next frame */
+    uint32_t rc_seq;                            /*!< Rate control restart count, a frame doesn't update "rc_quality" if it changes */
 };
 
 static const struct v4l2_query_ext_ctrl s_jpeg_qctrl[] = {
@@ -78,6 +98,43 @@ static const struct v4l2_query_ext_ctrl s_jpeg_qctrl[] = {
         .nr_of_dims = 0,
         .name = "Compression Quality",
     },
+    {
+        .id = V4L2_CID_JPEG_TARGET_SIZE,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .minimum = 0,
+        .maximum = JPEG_VIDEO_MAX_TARGET_SIZE,
+        .step = 1,
+        .default_value = 0,
+        .elem_size = sizeof(uint32_t),
+        .elems = 1,
+        .nr_of_dims = 0,
+        .name = "Target Frame Size",
+    },
+    {
+        .id = V4L2_CID_JPEG_RC_REENCODE,
+        .type = V4L2_CTRL_TYPE_BOOLEAN,
+        .minimum = 0,
+        .maximum = 1,
+        .step = 1,
+        .default_value = 0,
+        .elem_size = sizeof(uint8_t),
+        .elems = 1,
+        .nr_of_dims = 0,
+        .name = "Re-encode Overflowed Frame",
+    },
+    {
+        .id = V4L2_CID_JPEG_FRAME_QUALITY,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .minimum = 0,
+        .maximum = JPEG_VIDEO_MAX_COMP_QUALITY,
+        .step = 1,
+        .default_value = 0,
+        .flags = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .elem_size = sizeof(uint8_t),
+        .elems = 1,
+        .nr_of_dims = 0,
+        .name = "Frame Quality",
+    },
 };
 
 static const char *TAG = "jpeg_video";
@@ -129,35 +186,111 @@ static esp_err_t jpeg_get_input_format_from_v4l2(uint32_t v4l2_format, jpeg_enc_
     return ret;
 }
 
-static esp_err_t jpeg_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
+/**
+ * @brief Calculate the quality of the next frame from the size of the frame encoded by "quality".
+ */
+static uint8_t jpeg_rc_next_quality(uint8_t quality, uint8_t max_quality, uint32_t size, uint32_t target_size)
 {
-    esp_err_t ret;
-    uint32_t jpeg_codeced_size;
-    struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
+    int step = 0;
+    uint32_t ratio = MIN((uint64_t)size * 100 / target_size, JPEG_RC_MAX_RATIO);
 
-    if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
-            (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
-        ESP_LOGE(TAG, "capture and output width or height is invalid");
-        return ESP_ERR_INVALID_ARG;
+    if (ratio > 100 + JPEG_RC_TOLERANCE) {
+        step = -MAX(1, (int)(ratio - 100) / JPEG_RC_DOWN_DIV);
+    } else if (ratio < 100 - JPEG_RC_TOLERANCE) {
+        step = MAX(1, (int)(100 - ratio) / JPEG_RC_UP_DIV);
     }
+    step = MAX(MIN(step, JPEG_RC_MAX_STEP), -JPEG_RC_MAX_STEP);
+
+    return MAX(MIN((int)quality + step, (int)max_quality), JPEG_VIDEO_MIN_COMP_QUALITY);
+}
 
+static esp_err_t jpeg_video_encode(struct esp_video *video, uint8_t quality, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
+{
+    struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
     jpeg_encode_cfg_t enc_config = {
         .src_type = jpeg_video->src_type,
         .sub_sample = jpeg_video->sub_sample,
-        .image_quality = jpeg_video->image_quality,
+        .image_quality = quality,
         .width = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video),
         .height = M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video),
     };
 
-    ret = jpeg_encoder_process(jpeg_video->enc_handle,
-                               &enc_config,
-                               src,
-                               src_size,
-                               dst,
-                               dst_size,
-                               &jpeg_codeced_size);
+    return jpeg_encoder_process(jpeg_video->enc_handle,
+                                &enc_config,
+                                src,
+                                src_size,
+                                dst,
+                                dst_size,
+                                dst_out_size);
+}
+
+static esp_err_t jpeg_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size, uint32_t *dst_flags, uint32_t *dst_metadata)
+{
+    esp_err_t ret;
+    uint8_t quality;
+    uint8_t next_quality;
+    uint8_t rc_quality;
+    uint8_t max_quality;
+    bool rc_reencode;
+    bool overflow;
+    uint32_t rc_seq;
+    uint32_t target_size;
+    uint32_t jpeg_codeced_size = 0;
+    struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
+
+    if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
+            (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
+        ESP_LOGE(TAG, "capture and output width or height is invalid");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Take a snapshot of the rate control state, so that the whole frame uses one configuration */
+
+    portENTER_CRITICAL(&jpeg_video->rc_lock);
+    max_quality = jpeg_video->image_quality;
+    target_size = jpeg_video->target_size;
+    rc_reencode = jpeg_video->rc_reencode;
+    rc_quality = jpeg_video->rc_quality;
+    rc_seq = jpeg_video->rc_seq;
+    portEXIT_CRITICAL(&jpeg_video->rc_lock);
+
+    quality = target_size ? MIN(rc_quality, max_quality) : max_quality;
+    ret = jpeg_video_encode(video, quality, src, src_size, dst, dst_size, &jpeg_codeced_size);
+    if (ret != ESP_OK) {
+        /* Mostly the frame doesn't fit in the capture buffer, its size is unknown, so step down by the maximum step */
+        next_quality = MAX((int)quality - JPEG_RC_MAX_STEP, JPEG_VIDEO_MIN_COMP_QUALITY);
+        overflow = true;
+    } else if (target_size) {
+        next_quality = jpeg_rc_next_quality(quality, max_quality, jpeg_codeced_size, target_size);
+        overflow = rc_reencode && ((uint64_t)jpeg_codeced_size * 100 > (uint64_t)target_size * (100 + JPEG_RC_OVERFLOW));
+    } else {
+        next_quality = quality;
+        overflow = false;
+    }
+
+    if (overflow && (next_quality < quality)) {
+        ESP_LOGD(TAG, "ret=%d size=%" PRIu32 " overflows, re-encode with quality=%u", ret, jpeg_codeced_size, next_quality);
+
+        quality = next_quality;
+        ret = jpeg_video_encode(video, quality, src, src_size, dst, dst_size, &jpeg_codeced_size);
+        if ((ret == ESP_OK) && target_size) {
+            next_quality = jpeg_rc_next_quality(quality, max_quality, jpeg_codeced_size, target_size);
+        }
+    }
+
+    if (target_size) {
+        /* Drop the result if rate control is restarted or its target is changed during encoding */
+
+        portENTER_CRITICAL(&jpeg_video->rc_lock);
+        if (jpeg_video->rc_seq == rc_seq) {
+            jpeg_video->rc_quality = next_quality;
+        }
+        portEXIT_CRITICAL(&jpeg_video->rc_lock);
+    }
+
     if (ret == ESP_OK) {
         *dst_out_size = jpeg_codeced_size;
+        *dst_metadata = quality;
     }
 
     return ret;
@@ -207,12 +340,20 @@ static esp_err_t jpeg_video_deinit(struct esp_video *video)
 
 static esp_err_t jpeg_video_start(struct esp_video *video, uint32_t type)
 {
+    struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
+
     if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
             (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
         ESP_LOGE(TAG, "width or height is invalid");
         return ESP_ERR_INVALID_ARG;
     }
 
+    /* Rate control starts from the maximum quality and converges in the first frames */
+    portENTER_CRITICAL(&jpeg_video->rc_lock);
+    jpeg_video->rc_quality = jpeg_video->image_quality;
+    jpeg_video->rc_seq++;
+    portEXIT_CRITICAL(&jpeg_video->rc_lock);
+
     return ESP_OK;
 }
 
@@ -329,7 +470,36 @@ static esp_err_t jpeg_video_set_ext_ctrl(struct esp_video *video, const struct v
             jpeg_video->sub_sample = ctrl->value;
             break;
         case V4L2_CID_JPEG_COMPRESSION_QUALITY:
+            portENTER_CRITICAL(&jpeg_video->rc_lock);
             jpeg_video->image_quality = ctrl->value;
+            portEXIT_CRITICAL(&jpeg_video->rc_lock);
+            break;
+        case V4L2_CID_JPEG_TARGET_SIZE:
+            if ((ctrl->value < 0) || (ctrl->value > JPEG_VIDEO_MAX_TARGET_SIZE)) {
+                ret = ESP_ERR_INVALID_ARG;
+                ESP_LOGE(TAG, "target size=%" PRIi32 " is out of range", ctrl->value);
+                break;
+            }
+
+            portENTER_CRITICAL(&jpeg_video->rc_lock);
+            /* Restart rate control if it is enabled now */
+            if (!jpeg_video->target_size) {
+                jpeg_video->rc_quality = jpeg_video->image_quality;
+            }
+            if (jpeg_video->target_size != ctrl->value) {
+                jpeg_video->target_size = ctrl->value;
+                jpeg_video->rc_seq++;
+            }
+            portEXIT_CRITICAL(&jpeg_video->rc_lock);
+            break;
+        case V4L2_CID_JPEG_RC_REENCODE:
+            portENTER_CRITICAL(&jpeg_video->rc_lock);
+            jpeg_video->rc_reencode = !!ctrl->value;
+            portEXIT_CRITICAL(&jpeg_video->rc_lock);
+            break;
+        case V4L2_CID_JPEG_FRAME_QUALITY:
+            ret = ESP_ERR_INVALID_ARG;
+            ESP_LOGE(TAG, "frame quality is read-only");
             break;
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
@@ -356,6 +526,15 @@ static esp_err_t jpeg_video_get_ext_ctrl(struct esp_video *video, struct v4l2_ex
         case V4L2_CID_JPEG_COMPRESSION_QUALITY:
             ctrl->value = jpeg_video->image_quality;
             break;
+        case V4L2_CID_JPEG_TARGET_SIZE:
+            ctrl->value = jpeg_video->target_size;
+            break;
+        case V4L2_CID_JPEG_RC_REENCODE:
+            ctrl->value = jpeg_video->rc_reencode;
+            break;
+        case V4L2_CID_JPEG_FRAME_QUALITY:
+            ctrl->value = esp_video_get_dqbuf_metadata(video, V4L2_BUF_TYPE_VIDEO_CAPTURE);
+            break;
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
             ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
@@ -453,6 +632,8 @@ esp_err_t esp_video_create_jpeg_video_device(jpeg_encoder_handle_t enc_handle)
     }
     jpeg_video->sub_sample = JPEG_VIDEO_CHROMA_SUBSAMPLING;
     jpeg_video->image_quality = JPEG_VIDEO_COMP_QUALITY;
+    jpeg_video->rc_quality = JPEG_VIDEO_COMP_QUALITY;
+    portMUX_INITIALIZE(&jpeg_video->rc_lock);
 
     video = esp_video_create(JPEG_NAME, ESP_VIDEO_JPEG_DEVICE_ID, &s_jpeg_video_ops, jpeg_video, caps, device_caps);
     if (!video) {
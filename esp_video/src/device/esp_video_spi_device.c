@@ -115,7 +115,12 @@ static bool IRAM_ATTR spi_video_on_trans_finished(esp_cam_ctlr_handle_t handle,
 
     ESP_EARLY_LOGD(TAG, "size=%zu", trans->received_size);
 
-    CAPTURE_VIDEO_DONE_BUF(video, trans->buffer, trans->received_size);
+    if (trans->received_size) {
+        CAPTURE_VIDEO_DONE_BUF(video, trans->buffer, trans->received_size);
+    } else {
+        /* The controller reports a frame which overflows the buffer or fails to be decoded by 0 size */
+        CAPTURE_VIDEO_DROP_BUF(video, trans->buffer);
+    }
 
     return true;
 }
@@ -124,9 +129,14 @@ static bool IRAM_ATTR spi_video_on_get_new_trans(esp_cam_ctlr_handle_t handle, e
 {
     struct esp_video_buffer_element *element;
     struct esp_video *video = (struct esp_video *)user_data;
+    struct spi_video *spi_video = VIDEO_PRIV_DATA(struct spi_video *, video);
+
+    esp_video_cam_frame_start(&spi_video->cam, CAPTURE_VIDEO_STREAM(video)->sequence);
 
     element = CAPTURE_VIDEO_GET_QUEUED_ELEMENT(video);
     if (!element) {
+        /* No free buffer, so the controller drops this frame */
+        CAPTURE_VIDEO_DROP_FRAME(video);
         return false;
     }
 
@@ -188,6 +198,9 @@ static esp_err_t spi_video_init(struct esp_video *video)
 #endif
 
     ESP_RETURN_ON_ERROR(esp_cam_sensor_set_format(spi_video->cam.sensor, NULL), TAG, "failed to set basic format");
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY
+    ESP_RETURN_ON_ERROR(esp_video_cam_resume(&spi_video->cam), TAG, "failed to resume sensor");
+#endif
     ESP_RETURN_ON_ERROR(init_config(video), TAG, "failed to initialize config");
 
     return ESP_OK;
@@ -220,7 +233,11 @@ static esp_err_t spi_video_start(struct esp_video *video, uint32_t type)
         .auto_decode_dis = 1,
     };
 
-    ESP_RETURN_ON_ERROR(esp_cam_new_spi_ctlr(&spi_config, &spi_video->cam_ctrl_handle), TAG, "failed to create SPI");
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    ESP_RETURN_ON_ERROR(esp_video_cam_start_defer_ctrl(&spi_video->cam), TAG, "failed to start deferred camera control");
+#endif
+
+    ESP_GOTO_ON_ERROR(esp_cam_new_spi_ctlr(&spi_config, &spi_video->cam_ctrl_handle), fail, TAG, "failed to create SPI");
 
     esp_cam_ctlr_evt_cbs_t cam_ctrl_cbs = {
         .on_get_new_trans = spi_video_on_get_new_trans,
@@ -242,6 +259,10 @@ fail1:
 fail0:
     esp_cam_ctlr_del(spi_video->cam_ctrl_handle);
     spi_video->cam_ctrl_handle = NULL;
+fail:
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    esp_video_cam_stop_defer_ctrl(&spi_video->cam);
+#endif
     return ret;
 }
 
@@ -259,11 +280,21 @@ static esp_err_t spi_video_stop(struct esp_video *video, uint32_t type)
 
     spi_video->cam_ctrl_handle = NULL;
 
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    ESP_RETURN_ON_ERROR(esp_video_cam_stop_defer_ctrl(&spi_video->cam), TAG, "failed to stop deferred camera control");
+#endif
+
     return ESP_OK;
 }
 
 static esp_err_t spi_video_deinit(struct esp_video *video)
 {
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY
+    struct spi_video *spi_video = VIDEO_PRIV_DATA(struct spi_video *, video);
+
+    ESP_RETURN_ON_ERROR(esp_video_cam_standby(&spi_video->cam), TAG, "failed to put sensor into standby");
+#endif
+
     return ESP_OK;
 }
 
@@ -0,0 +1,387 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_jpeg_dec.h"
+
+#include "esp_video.h"
+#include "esp_video_device_internal.h"
+
+#define SW_JPEG_DEC_NAME                "SW_JPEG_DEC"
+
+#if CONFIG_SPIRAM
+#define SW_JPEG_DEC_MEM_CAPS            (MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM | MALLOC_CAP_CACHE_ALIGNED)
+#else
+#define SW_JPEG_DEC_MEM_CAPS            (MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL)
+#endif
+
+/* The decoder writes the output image by 16-byte aligned blocks */
+
+#define SW_JPEG_DEC_BUF_ALIGN           16
+
+#define SW_JPEG_DEC_VIDEO_MIN_WIDTH     16
+#define SW_JPEG_DEC_VIDEO_MIN_HEIGHT    16
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(x)                   (sizeof(x) / sizeof((x)[0]))
+#endif
+
+/**
+ * @brief Software JPEG decoder output format
+ */
+typedef struct sw_jpeg_dec_output_format {
+    uint32_t pixel_format;                      /*!< V4L2 pixel format */
+    jpeg_pixel_format_t output_type;            /*!< JPEG decoder output type */
+} sw_jpeg_dec_output_format_t;
+
+struct sw_jpeg_dec_video {
+    jpeg_dec_handle_t dec_handle;
+
+    const sw_jpeg_dec_output_format_t *output_format;
+};
+
+static const sw_jpeg_dec_output_format_t s_sw_jpeg_dec_output_format[] = {
+    {
+        .pixel_format = V4L2_PIX_FMT_RGB565,
+        .output_type = JPEG_PIXEL_FORMAT_RGB565_LE,
+    },
+    {
+        .pixel_format = V4L2_PIX_FMT_RGB565X,
+        .output_type = JPEG_PIXEL_FORMAT_RGB565_BE,
+    },
+    {
+        .pixel_format = V4L2_PIX_FMT_RGB24,
+        .output_type = JPEG_PIXEL_FORMAT_RGB888,
+    },
+    {
+        .pixel_format = V4L2_PIX_FMT_UYVY,
+        .output_type = JPEG_PIXEL_FORMAT_CbYCrY,
+    },
+};
+
+static const char *TAG = "sw_jpeg_dec_video";
+
+static esp_err_t errno_jpeg_to_std(jpeg_error_t jpeg_err)
+{
+    switch (jpeg_err) {
+    case JPEG_ERR_OK:
+        return ESP_OK;
+    case JPEG_ERR_NO_MEM:
+        return ESP_ERR_NO_MEM;
+    case JPEG_ERR_INVALID_PARAM:
+        return ESP_ERR_INVALID_ARG;
+    case JPEG_ERR_UNSUPPORT_FMT:
+    case JPEG_ERR_UNSUPPORT_STD:
+        return ESP_ERR_NOT_SUPPORTED;
+    default:
+        return ESP_FAIL;
+    }
+}
+
+static const sw_jpeg_dec_output_format_t *sw_jpeg_dec_get_output_format(uint32_t pixel_format)
+{
+    for (int i = 0; i < ARRAY_SIZE(s_sw_jpeg_dec_output_format); i++) {
+        if (s_sw_jpeg_dec_output_format[i].pixel_format == pixel_format) {
+            return &s_sw_jpeg_dec_output_format[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Open the software JPEG decoder with the current capture format
+ *
+ * @param video Video object
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+static esp_err_t sw_jpeg_dec_video_open_decoder(struct esp_video *video)
+{
+    jpeg_error_t jpeg_err;
+    struct sw_jpeg_dec_video *sw_jpeg_dec_video = VIDEO_PRIV_DATA(struct sw_jpeg_dec_video *, video);
+    jpeg_dec_config_t config = DEFAULT_JPEG_DEC_CONFIG();
+
+    config.output_type = sw_jpeg_dec_video->output_format->output_type;
+
+    jpeg_err = jpeg_dec_open(&config, &sw_jpeg_dec_video->dec_handle);
+    if (jpeg_err != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "failed to open JPEG decoder");
+        sw_jpeg_dec_video->dec_handle = NULL;
+        return errno_jpeg_to_std(jpeg_err);
+    }
+
+    return ESP_OK;
+}
+
+static void sw_jpeg_dec_video_close_decoder(struct esp_video *video)
+{
+    struct sw_jpeg_dec_video *sw_jpeg_dec_video = VIDEO_PRIV_DATA(struct sw_jpeg_dec_video *, video);
+
+    if (sw_jpeg_dec_video->dec_handle) {
+        jpeg_dec_close(sw_jpeg_dec_video->dec_handle);
+        sw_jpeg_dec_video->dec_handle = NULL;
+    }
+}
+
+static esp_err_t sw_jpeg_dec_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size, uint32_t *dst_flags, uint32_t *dst_metadata)
+{
+    int out_size = 0;
+    jpeg_error_t jpeg_err;
+    jpeg_dec_io_t io;
+    jpeg_dec_header_info_t header;
+    struct sw_jpeg_dec_video *sw_jpeg_dec_video = VIDEO_PRIV_DATA(struct sw_jpeg_dec_video *, video);
+
+    /* The source size is "bytesused" of the output buffer, because JPEG images have variable size */
+
+    memset(&io, 0, sizeof(io));
+    io.inbuf = src;
+    io.inbuf_len = src_size;
+
+    jpeg_err = jpeg_dec_parse_header(sw_jpeg_dec_video->dec_handle, &io, &header);
+    if (jpeg_err != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "failed to parse JPEG header");
+        return errno_jpeg_to_std(jpeg_err);
+    }
+
+    if ((header.width != M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video)) ||
+            (header.height != M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video))) {
+        ESP_LOGE(TAG, "JPEG image %ux%u doesn't match capture format", header.width, header.height);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    jpeg_err = jpeg_dec_get_outbuf_len(sw_jpeg_dec_video->dec_handle, &out_size);
+    if ((jpeg_err != JPEG_ERR_OK) || (out_size > dst_size)) {
+        ESP_LOGE(TAG, "output image size=%d is larger than buffer size=%" PRIu32, out_size, dst_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    io.outbuf = dst;
+    jpeg_err = jpeg_dec_process(sw_jpeg_dec_video->dec_handle, &io);
+    if (jpeg_err != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "failed to decode JPEG image");
+        return errno_jpeg_to_std(jpeg_err);
+    }
+
+    *dst_out_size = out_size;
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_dec_video_init(struct esp_video *video)
+{
+    struct sw_jpeg_dec_video *sw_jpeg_dec_video = VIDEO_PRIV_DATA(struct sw_jpeg_dec_video *, video);
+
+    M2M_VIDEO_SET_CAPTURE_FORMAT(video, SW_JPEG_DEC_VIDEO_MIN_WIDTH, SW_JPEG_DEC_VIDEO_MIN_HEIGHT, V4L2_PIX_FMT_RGB565);
+    M2M_VIDEO_SET_OUTPUT_FORMAT(video, SW_JPEG_DEC_VIDEO_MIN_WIDTH, SW_JPEG_DEC_VIDEO_MIN_HEIGHT, V4L2_PIX_FMT_JPEG);
+
+    sw_jpeg_dec_video->output_format = sw_jpeg_dec_get_output_format(V4L2_PIX_FMT_RGB565);
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_dec_video_deinit(struct esp_video *video)
+{
+    sw_jpeg_dec_video_close_decoder(video);
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_dec_video_start(struct esp_video *video, uint32_t type)
+{
+    if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
+            (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
+        ESP_LOGE(TAG, "width or height is invalid");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        return sw_jpeg_dec_video_open_decoder(video);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_dec_video_stop(struct esp_video *video, uint32_t type)
+{
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        sw_jpeg_dec_video_close_decoder(video);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_dec_video_enum_format(struct esp_video *video, uint32_t type, uint32_t index, uint32_t *pixel_format)
+{
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        if (index >= ARRAY_SIZE(s_sw_jpeg_dec_output_format)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        *pixel_format = s_sw_jpeg_dec_output_format[index].pixel_format;
+    } else if (type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        if (index >= 1) {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        *pixel_format = V4L2_PIX_FMT_JPEG;
+    } else {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_dec_video_set_format(struct esp_video *video, const struct v4l2_format *format)
+{
+    const struct v4l2_pix_format *pix = &format->fmt.pix;
+    struct sw_jpeg_dec_video *sw_jpeg_dec_video = VIDEO_PRIV_DATA(struct sw_jpeg_dec_video *, video);
+
+    if ((pix->width < SW_JPEG_DEC_VIDEO_MIN_WIDTH) || (pix->height < SW_JPEG_DEC_VIDEO_MIN_HEIGHT)) {
+        ESP_LOGE(TAG, "width or height is invalid");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (format->type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        const sw_jpeg_dec_output_format_t *output_format;
+        const struct esp_video_buffer_info *info;
+
+        /**
+         * Capture data is the decoded image.
+         */
+        output_format = sw_jpeg_dec_get_output_format(pix->pixelformat);
+        if (!output_format) {
+            ESP_LOGE(TAG, "pixel format is invalid");
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+
+        ESP_RETURN_ON_ERROR(esp_video_config_buffer(video, format, SW_JPEG_DEC_MEM_CAPS), TAG, "failed to configure stream buffer");
+
+        info = STREAM_BUF_INFO(M2M_VIDEO_CAPTURE_STREAM(video));
+        if (info->align_size < SW_JPEG_DEC_BUF_ALIGN) {
+            M2M_VIDEO_SET_CAPTURE_BUF_INFO(video, ESP_VIDEO_ALIGN(info->size, SW_JPEG_DEC_BUF_ALIGN),
+                                           SW_JPEG_DEC_BUF_ALIGN, info->caps);
+        }
+
+        sw_jpeg_dec_video->output_format = output_format;
+    } else if (format->type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        /**
+         * Output data is JPEG image, its buffer size is "sizeimage" if it is set, or else
+         * it is calculated by width and height.
+         */
+        if (pix->pixelformat != V4L2_PIX_FMT_JPEG) {
+            ESP_LOGE(TAG, "pixel format is invalid");
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+
+        ESP_RETURN_ON_ERROR(esp_video_config_buffer(video, format, SW_JPEG_DEC_MEM_CAPS), TAG, "failed to configure stream buffer");
+    } else {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_dec_video_notify(struct esp_video *video, enum esp_video_event event, void *arg)
+{
+    esp_err_t ret;
+
+    if (event == ESP_VIDEO_M2M_TRIGGER) {
+        uint32_t type = *(uint32_t *)arg;
+
+        if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+            ret = esp_video_m2m_process(video,
+                                        V4L2_BUF_TYPE_VIDEO_OUTPUT,
+                                        V4L2_BUF_TYPE_VIDEO_CAPTURE,
+                                        sw_jpeg_dec_video_m2m_process);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "failed to process M2M device data");
+                return ret;
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+static const struct esp_video_ops s_sw_jpeg_dec_video_ops = {
+    .init               = sw_jpeg_dec_video_init,
+    .deinit             = sw_jpeg_dec_video_deinit,
+    .start              = sw_jpeg_dec_video_start,
+    .stop               = sw_jpeg_dec_video_stop,
+    .enum_format        = sw_jpeg_dec_video_enum_format,
+    .set_format         = sw_jpeg_dec_video_set_format,
+    .notify             = sw_jpeg_dec_video_notify,
+    .m2m_variable_input = true,
+};
+
+/**
+ * @brief Create software JPEG decoder video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_create_sw_jpeg_dec_video_device(void)
+{
+    struct esp_video *video;
+    struct sw_jpeg_dec_video *sw_jpeg_dec_video;
+    uint32_t device_caps = V4L2_CAP_VIDEO_M2M | V4L2_CAP_EXT_PIX_FORMAT | V4L2_CAP_STREAMING;
+    uint32_t caps = device_caps | V4L2_CAP_DEVICE_CAPS;
+
+    sw_jpeg_dec_video = heap_caps_calloc(1, sizeof(struct sw_jpeg_dec_video), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    if (!sw_jpeg_dec_video) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    video = esp_video_create(SW_JPEG_DEC_NAME, ESP_VIDEO_SW_JPEG_DEC_DEVICE_ID, &s_sw_jpeg_dec_video_ops, sw_jpeg_dec_video, caps, device_caps);
+    if (!video) {
+        heap_caps_free(sw_jpeg_dec_video);
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Destroy software JPEG decoder video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_destroy_sw_jpeg_dec_video_device(void)
+{
+    esp_err_t ret;
+    struct esp_video *video;
+    struct sw_jpeg_dec_video *sw_jpeg_dec_video;
+
+    video = esp_video_device_get_object(SW_JPEG_DEC_NAME);
+    if (!video) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    sw_jpeg_dec_video = VIDEO_PRIV_DATA(struct sw_jpeg_dec_video *, video);
+
+    ret = esp_video_destroy(video);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    heap_caps_free(sw_jpeg_dec_video);
+
+    return ESP_OK;
+}
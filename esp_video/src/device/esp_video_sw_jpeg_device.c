@@ -0,0 +1,610 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_jpeg_enc.h"
+
+#include "esp_video.h"
+#include "esp_video_device_internal.h"
+
+#define SW_JPEG_NAME                    "SW_JPEG"
+
+#if CONFIG_SPIRAM
+#define SW_JPEG_MEM_CAPS                (MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM | MALLOC_CAP_CACHE_ALIGNED)
+#else
+#define SW_JPEG_MEM_CAPS                (MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL)
+#endif
+
+#define SW_JPEG_VIDEO_MAX_COMP_QUALITY  100
+#define SW_JPEG_VIDEO_MIN_COMP_QUALITY  1
+#define SW_JPEG_VIDEO_COMP_QUALITY_STEP 1
+
+#define SW_JPEG_VIDEO_COMP_QUALITY      80
+
+#define SW_JPEG_VIDEO_MIN_WIDTH         16
+#define SW_JPEG_VIDEO_MIN_HEIGHT        16
+
+#define SW_JPEG_SUBSAMPLING_MASK(s)     (1 << (s))
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(x)                   (sizeof(x) / sizeof((x)[0]))
+#endif
+
+/**
+ * @brief Software JPEG encoder input format
+ */
+typedef struct sw_jpeg_input_format {
+    uint32_t pixel_format;                      /*!< V4L2 pixel format */
+    jpeg_pixel_format_t src_type;               /*!< JPEG encoder source type */
+    uint8_t subsampling;                        /*!< Default chroma subsampling, V4L2_JPEG_CHROMA_SUBSAMPLING_x */
+    uint8_t subsampling_mask;                   /*!< Supported chroma subsampling mask, SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_x) */
+} sw_jpeg_input_format_t;
+
+struct sw_jpeg_video {
+    jpeg_enc_handle_t enc_handle;
+
+    const sw_jpeg_input_format_t *input_format;
+    uint8_t subsampling;
+    uint8_t image_quality;
+
+    /* Parameters of the opened encoder, controls set while streaming take effect from the next frame */
+    uint8_t enc_subsampling;
+    uint8_t enc_quality;
+};
+
+#define SW_JPEG_SUBSAMPLING_COLOR       (SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_444) | \
+                                         SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_422) | \
+                                         SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_420))
+
+static const sw_jpeg_input_format_t s_sw_jpeg_input_format[] = {
+    {
+        .pixel_format = V4L2_PIX_FMT_RGB565,
+        .src_type = JPEG_PIXEL_FORMAT_RGB565_LE,
+        .subsampling = V4L2_JPEG_CHROMA_SUBSAMPLING_422,
+        .subsampling_mask = SW_JPEG_SUBSAMPLING_COLOR,
+    },
+    {
+        .pixel_format = V4L2_PIX_FMT_RGB565X,
+        .src_type = JPEG_PIXEL_FORMAT_RGB565_BE,
+        .subsampling = V4L2_JPEG_CHROMA_SUBSAMPLING_422,
+        .subsampling_mask = SW_JPEG_SUBSAMPLING_COLOR,
+    },
+    {
+        .pixel_format = V4L2_PIX_FMT_RGB24,
+        .src_type = JPEG_PIXEL_FORMAT_RGB888,
+        .subsampling = V4L2_JPEG_CHROMA_SUBSAMPLING_444,
+        .subsampling_mask = SW_JPEG_SUBSAMPLING_COLOR,
+    },
+    {
+        .pixel_format = V4L2_PIX_FMT_UYVY,
+        .src_type = JPEG_PIXEL_FORMAT_CbYCrY,
+        .subsampling = V4L2_JPEG_CHROMA_SUBSAMPLING_422,
+        .subsampling_mask = SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_422) |
+        SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_420),
+    },
+    {
+        .pixel_format = V4L2_PIX_FMT_YUYV,
+        .src_type = JPEG_PIXEL_FORMAT_YCbYCr,
+        .subsampling = V4L2_JPEG_CHROMA_SUBSAMPLING_422,
+        .subsampling_mask = SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_422) |
+        SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_420),
+    },
+    {
+        /* Espressif YUV420 output of ISP and PPA, odd lines are UYY and even lines are VYY */
+        .pixel_format = V4L2_PIX_FMT_YUV420,
+        .src_type = JPEG_PIXEL_FORMAT_YCbY2YCrY2,
+        .subsampling = V4L2_JPEG_CHROMA_SUBSAMPLING_420,
+        .subsampling_mask = SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_420),
+    },
+    {
+        .pixel_format = V4L2_PIX_FMT_GREY,
+        .src_type = JPEG_PIXEL_FORMAT_GRAY,
+        .subsampling = V4L2_JPEG_CHROMA_SUBSAMPLING_GRAY,
+        .subsampling_mask = SW_JPEG_SUBSAMPLING_MASK(V4L2_JPEG_CHROMA_SUBSAMPLING_GRAY),
+    },
+};
+
+static const struct v4l2_query_ext_ctrl s_sw_jpeg_qctrl[] = {
+    {
+        .id = V4L2_CID_JPEG_CHROMA_SUBSAMPLING,
+        .type = V4L2_CTRL_TYPE_INTEGER_MENU,
+        .minimum = V4L2_JPEG_CHROMA_SUBSAMPLING_444,
+        .maximum = V4L2_JPEG_CHROMA_SUBSAMPLING_GRAY,
+        .step = 1,
+        .elem_size = sizeof(uint8_t),
+        .elems = 1,
+        .nr_of_dims = 0,
+        .default_value = V4L2_JPEG_CHROMA_SUBSAMPLING_422,
+        .name = "Chroma Subsampling",
+    },
+    {
+        .id = V4L2_CID_JPEG_COMPRESSION_QUALITY,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .minimum = SW_JPEG_VIDEO_MIN_COMP_QUALITY,
+        .maximum = SW_JPEG_VIDEO_MAX_COMP_QUALITY,
+        .step = SW_JPEG_VIDEO_COMP_QUALITY_STEP,
+        .default_value = SW_JPEG_VIDEO_COMP_QUALITY,
+        .elem_size = sizeof(uint8_t),
+        .elems = 1,
+        .nr_of_dims = 0,
+        .name = "Compression Quality",
+    },
+    {
+        .id = V4L2_CID_JPEG_FRAME_QUALITY,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .minimum = 0,
+        .maximum = SW_JPEG_VIDEO_MAX_COMP_QUALITY,
+        .step = 1,
+        .default_value = 0,
+        .flags = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .elem_size = sizeof(uint8_t),
+        .elems = 1,
+        .nr_of_dims = 0,
+        .name = "Frame Quality",
+    },
+};
+
+static const char *TAG = "sw_jpeg_video";
+
+static esp_err_t errno_jpeg_to_std(jpeg_error_t jpeg_err)
+{
+    switch (jpeg_err) {
+    case JPEG_ERR_OK:
+        return ESP_OK;
+    case JPEG_ERR_NO_MEM:
+        return ESP_ERR_NO_MEM;
+    case JPEG_ERR_INVALID_PARAM:
+        return ESP_ERR_INVALID_ARG;
+    case JPEG_ERR_UNSUPPORT_FMT:
+    case JPEG_ERR_UNSUPPORT_STD:
+        return ESP_ERR_NOT_SUPPORTED;
+    default:
+        return ESP_FAIL;
+    }
+}
+
+static const sw_jpeg_input_format_t *sw_jpeg_get_input_format(uint32_t pixel_format)
+{
+    for (int i = 0; i < ARRAY_SIZE(s_sw_jpeg_input_format); i++) {
+        if (s_sw_jpeg_input_format[i].pixel_format == pixel_format) {
+            return &s_sw_jpeg_input_format[i];
+        }
+    }
+
+    return NULL;
+}
+
+static jpeg_subsampling_t sw_jpeg_get_subsampling(uint8_t subsampling)
+{
+    switch (subsampling) {
+    case V4L2_JPEG_CHROMA_SUBSAMPLING_444:
+        return JPEG_SUBSAMPLE_444;
+    case V4L2_JPEG_CHROMA_SUBSAMPLING_420:
+        return JPEG_SUBSAMPLE_420;
+    case V4L2_JPEG_CHROMA_SUBSAMPLING_GRAY:
+        return JPEG_SUBSAMPLE_GRAY;
+    default:
+        return JPEG_SUBSAMPLE_422;
+    }
+}
+
+/**
+ * @brief Open the software JPEG encoder with the current format and controls
+ *
+ * @param video Video object
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+static esp_err_t sw_jpeg_video_open_encoder(struct esp_video *video)
+{
+    jpeg_error_t jpeg_err;
+    struct sw_jpeg_video *sw_jpeg_video = VIDEO_PRIV_DATA(struct sw_jpeg_video *, video);
+    jpeg_enc_config_t config = DEFAULT_JPEG_ENC_CONFIG();
+
+    if (!(sw_jpeg_video->input_format->subsampling_mask & SW_JPEG_SUBSAMPLING_MASK(sw_jpeg_video->subsampling))) {
+        ESP_LOGE(TAG, "chroma subsampling %d is not supported by input format", sw_jpeg_video->subsampling);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    config.width = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video);
+    config.height = M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video);
+    config.src_type = sw_jpeg_video->input_format->src_type;
+    config.subsampling = sw_jpeg_get_subsampling(sw_jpeg_video->subsampling);
+    config.quality = sw_jpeg_video->image_quality;
+#if CONFIG_ESP_VIDEO_SW_JPEG_ENABLE_HFM_TASK
+    config.task_enable = true;
+    config.hfm_task_core = CONFIG_ESP_VIDEO_SW_JPEG_HFM_TASK_CORE_ID;
+    config.hfm_task_priority = CONFIG_ESP_VIDEO_SW_JPEG_HFM_TASK_PRIORITY;
+#else
+    config.task_enable = false;
+#endif
+
+    jpeg_err = jpeg_enc_open(&config, &sw_jpeg_video->enc_handle);
+    if (jpeg_err != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "failed to open JPEG encoder");
+        sw_jpeg_video->enc_handle = NULL;
+        return errno_jpeg_to_std(jpeg_err);
+    }
+
+    sw_jpeg_video->enc_subsampling = sw_jpeg_video->subsampling;
+    sw_jpeg_video->enc_quality = sw_jpeg_video->image_quality;
+
+    return ESP_OK;
+}
+
+static void sw_jpeg_video_close_encoder(struct esp_video *video)
+{
+    struct sw_jpeg_video *sw_jpeg_video = VIDEO_PRIV_DATA(struct sw_jpeg_video *, video);
+
+    if (sw_jpeg_video->enc_handle) {
+        jpeg_enc_close(sw_jpeg_video->enc_handle);
+        sw_jpeg_video->enc_handle = NULL;
+    }
+}
+
+static esp_err_t sw_jpeg_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size, uint32_t *dst_flags, uint32_t *dst_metadata)
+{
+    esp_err_t ret;
+    int out_size = 0;
+    jpeg_error_t jpeg_err;
+    struct sw_jpeg_video *sw_jpeg_video = VIDEO_PRIV_DATA(struct sw_jpeg_video *, video);
+
+    /**
+     * Controls are applied here instead of in the control callback, so the encoder is only
+     * accessed by the task which processes M2M jobs.
+     */
+    if (sw_jpeg_video->enc_subsampling != sw_jpeg_video->subsampling) {
+        sw_jpeg_video_close_encoder(video);
+        ret = sw_jpeg_video_open_encoder(video);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    } else if (sw_jpeg_video->enc_quality != sw_jpeg_video->image_quality) {
+        jpeg_err = jpeg_enc_set_quality(sw_jpeg_video->enc_handle, sw_jpeg_video->image_quality);
+        if (jpeg_err != JPEG_ERR_OK) {
+            ESP_LOGE(TAG, "failed to set quality");
+            return errno_jpeg_to_std(jpeg_err);
+        }
+
+        sw_jpeg_video->enc_quality = sw_jpeg_video->image_quality;
+    }
+
+    jpeg_err = jpeg_enc_process(sw_jpeg_video->enc_handle, src, src_size, dst, dst_size, &out_size);
+    if (jpeg_err != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "failed to encode JPEG image");
+        return errno_jpeg_to_std(jpeg_err);
+    }
+
+    *dst_out_size = out_size;
+    *dst_metadata = sw_jpeg_video->enc_quality;
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_video_init(struct esp_video *video)
+{
+    struct sw_jpeg_video *sw_jpeg_video = VIDEO_PRIV_DATA(struct sw_jpeg_video *, video);
+
+    M2M_VIDEO_SET_CAPTURE_FORMAT(video, SW_JPEG_VIDEO_MIN_WIDTH, SW_JPEG_VIDEO_MIN_HEIGHT, V4L2_PIX_FMT_JPEG);
+    M2M_VIDEO_SET_OUTPUT_FORMAT(video, SW_JPEG_VIDEO_MIN_WIDTH, SW_JPEG_VIDEO_MIN_HEIGHT, V4L2_PIX_FMT_RGB565);
+
+    sw_jpeg_video->input_format = sw_jpeg_get_input_format(V4L2_PIX_FMT_RGB565);
+    sw_jpeg_video->subsampling = sw_jpeg_video->input_format->subsampling;
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_video_deinit(struct esp_video *video)
+{
+    sw_jpeg_video_close_encoder(video);
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_video_start(struct esp_video *video, uint32_t type)
+{
+    if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
+            (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
+        ESP_LOGE(TAG, "width or height is invalid");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        return sw_jpeg_video_open_encoder(video);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_video_stop(struct esp_video *video, uint32_t type)
+{
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        sw_jpeg_video_close_encoder(video);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_video_enum_format(struct esp_video *video, uint32_t type, uint32_t index, uint32_t *pixel_format)
+{
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        if (index >= 1) {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        *pixel_format = V4L2_PIX_FMT_JPEG;
+    } else if (type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        if (index >= ARRAY_SIZE(s_sw_jpeg_input_format)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        *pixel_format = s_sw_jpeg_input_format[index].pixel_format;
+    } else {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_video_set_format(struct esp_video *video, const struct v4l2_format *format)
+{
+    const struct v4l2_pix_format *pix = &format->fmt.pix;
+    struct sw_jpeg_video *sw_jpeg_video = VIDEO_PRIV_DATA(struct sw_jpeg_video *, video);
+
+    if (format->type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        /**
+         * Capture data is JPEG image, so width and height are limited by output image.
+         */
+        if ((pix->pixelformat != V4L2_PIX_FMT_JPEG) ||
+                (pix->width < SW_JPEG_VIDEO_MIN_WIDTH) ||
+                (pix->height < SW_JPEG_VIDEO_MIN_HEIGHT)) {
+            ESP_LOGE(TAG, "pixel format or width or height is invalid");
+            return ESP_ERR_INVALID_ARG;
+        }
+    } else if (format->type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        const sw_jpeg_input_format_t *input_format;
+
+        /**
+         * Output data is input source image, so width and height are not limited by capture image.
+         */
+        if ((pix->width < SW_JPEG_VIDEO_MIN_WIDTH) || (pix->height < SW_JPEG_VIDEO_MIN_HEIGHT)) {
+            ESP_LOGE(TAG, "width or height is invalid");
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        input_format = sw_jpeg_get_input_format(pix->pixelformat);
+        if (!input_format) {
+            ESP_LOGE(TAG, "pixel format is invalid");
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+
+        /* Keep the chroma subsampling set by the application if the new input format supports it */
+        sw_jpeg_video->input_format = input_format;
+        if (!(input_format->subsampling_mask & SW_JPEG_SUBSAMPLING_MASK(sw_jpeg_video->subsampling))) {
+            sw_jpeg_video->subsampling = input_format->subsampling;
+        }
+    } else {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    ESP_RETURN_ON_ERROR(esp_video_config_buffer(video, format, SW_JPEG_MEM_CAPS), TAG, "failed to configure stream buffer");
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_video_notify(struct esp_video *video, enum esp_video_event event, void *arg)
+{
+    esp_err_t ret;
+
+    if (event == ESP_VIDEO_M2M_TRIGGER) {
+        uint32_t type = *(uint32_t *)arg;
+
+        if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+            ret = esp_video_m2m_process(video,
+                                        V4L2_BUF_TYPE_VIDEO_OUTPUT,
+                                        V4L2_BUF_TYPE_VIDEO_CAPTURE,
+                                        sw_jpeg_video_m2m_process);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "failed to process M2M device data");
+                return ret;
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t sw_jpeg_video_set_ext_ctrl(struct esp_video *video, const struct v4l2_ext_controls *ctrls)
+{
+    esp_err_t ret = ESP_OK;
+    struct sw_jpeg_video *sw_jpeg_video = VIDEO_PRIV_DATA(struct sw_jpeg_video *, video);
+
+    for (int i = 0; i < ctrls->count; i++) {
+        struct v4l2_ext_control *ctrl = &ctrls->controls[i];
+
+        switch (ctrl->id) {
+        case V4L2_CID_JPEG_CHROMA_SUBSAMPLING:
+            if ((ctrl->value < V4L2_JPEG_CHROMA_SUBSAMPLING_444) ||
+                    (ctrl->value > V4L2_JPEG_CHROMA_SUBSAMPLING_GRAY) ||
+                    !(sw_jpeg_video->input_format->subsampling_mask & SW_JPEG_SUBSAMPLING_MASK(ctrl->value))) {
+                ret = ESP_ERR_INVALID_ARG;
+                ESP_LOGE(TAG, "chroma subsampling %" PRIi32 " is not supported by input format", ctrl->value);
+                break;
+            }
+            sw_jpeg_video->subsampling = ctrl->value;
+            break;
+        case V4L2_CID_JPEG_COMPRESSION_QUALITY:
+            if ((ctrl->value < SW_JPEG_VIDEO_MIN_COMP_QUALITY) || (ctrl->value > SW_JPEG_VIDEO_MAX_COMP_QUALITY)) {
+                ret = ESP_ERR_INVALID_ARG;
+                ESP_LOGE(TAG, "quality %" PRIi32 " is out of range", ctrl->value);
+                break;
+            }
+            sw_jpeg_video->image_quality = ctrl->value;
+            break;
+        case V4L2_CID_JPEG_FRAME_QUALITY:
+            ret = ESP_ERR_INVALID_ARG;
+            ESP_LOGE(TAG, "frame quality is read-only");
+            break;
+        default:
+            ret = ESP_ERR_NOT_SUPPORTED;
+            ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
+            break;
+        }
+    }
+
+    return ret;
+}
+
+static esp_err_t sw_jpeg_video_get_ext_ctrl(struct esp_video *video, struct v4l2_ext_controls *ctrls)
+{
+    esp_err_t ret = ESP_OK;
+    struct sw_jpeg_video *sw_jpeg_video = VIDEO_PRIV_DATA(struct sw_jpeg_video *, video);
+
+    for (int i = 0; i < ctrls->count; i++) {
+        struct v4l2_ext_control *ctrl = &ctrls->controls[i];
+
+        switch (ctrl->id) {
+        case V4L2_CID_JPEG_CHROMA_SUBSAMPLING:
+            ctrl->value = sw_jpeg_video->subsampling;
+            break;
+        case V4L2_CID_JPEG_COMPRESSION_QUALITY:
+            ctrl->value = sw_jpeg_video->image_quality;
+            break;
+        case V4L2_CID_JPEG_FRAME_QUALITY:
+            ctrl->value = esp_video_get_dqbuf_metadata(video, V4L2_BUF_TYPE_VIDEO_CAPTURE);
+            break;
+        default:
+            ret = ESP_ERR_NOT_SUPPORTED;
+            ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
+            break;
+        }
+    }
+
+    return ret;
+}
+
+static esp_err_t sw_jpeg_video_query_ext_ctrl(struct esp_video *video, struct v4l2_query_ext_ctrl *qctrl)
+{
+    int num = -1;
+    uint32_t id = qctrl->id;
+    int sw_jpeg_qctrl_cnt = ARRAY_SIZE(s_sw_jpeg_qctrl);
+
+    if (id & V4L2_CTRL_FLAG_NEXT_CTRL) {
+        id &= ~V4L2_CTRL_FLAG_NEXT_CTRL;
+        if (id == 0) {
+            num = 0;
+        } else {
+            for (int i = 0; i < (sw_jpeg_qctrl_cnt - 1); i++) {
+                if (id == s_sw_jpeg_qctrl[i].id) {
+                    num = i + 1;
+                    break;
+                }
+            }
+        }
+
+        if (num < 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    } else {
+        for (int i = 0; i < sw_jpeg_qctrl_cnt; i++) {
+            if (id == s_sw_jpeg_qctrl[i].id) {
+                num = i;
+                break;
+            }
+        }
+    }
+
+    if (num < 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    memcpy(qctrl, &s_sw_jpeg_qctrl[num], sizeof(struct v4l2_query_ext_ctrl));
+
+    return ESP_OK;
+}
+
+static const struct esp_video_ops s_sw_jpeg_video_ops = {
+    .init           = sw_jpeg_video_init,
+    .deinit         = sw_jpeg_video_deinit,
+    .start          = sw_jpeg_video_start,
+    .stop           = sw_jpeg_video_stop,
+    .enum_format    = sw_jpeg_video_enum_format,
+    .set_format     = sw_jpeg_video_set_format,
+    .notify         = sw_jpeg_video_notify,
+    .set_ext_ctrl   = sw_jpeg_video_set_ext_ctrl,
+    .get_ext_ctrl   = sw_jpeg_video_get_ext_ctrl,
+    .query_ext_ctrl = sw_jpeg_video_query_ext_ctrl,
+};
+
+/**
+ * @brief Create software JPEG video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_create_sw_jpeg_video_device(void)
+{
+    struct esp_video *video;
+    struct sw_jpeg_video *sw_jpeg_video;
+    uint32_t device_caps = V4L2_CAP_VIDEO_M2M | V4L2_CAP_EXT_PIX_FORMAT | V4L2_CAP_STREAMING;
+    uint32_t caps = device_caps | V4L2_CAP_DEVICE_CAPS;
+
+    sw_jpeg_video = heap_caps_calloc(1, sizeof(struct sw_jpeg_video), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    if (!sw_jpeg_video) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    sw_jpeg_video->image_quality = SW_JPEG_VIDEO_COMP_QUALITY;
+
+    video = esp_video_create(SW_JPEG_NAME, ESP_VIDEO_SW_JPEG_DEVICE_ID, &s_sw_jpeg_video_ops, sw_jpeg_video, caps, device_caps);
+    if (!video) {
+        heap_caps_free(sw_jpeg_video);
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Destroy software JPEG video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_destroy_sw_jpeg_video_device(void)
+{
+    esp_err_t ret;
+    struct esp_video *video;
+    struct sw_jpeg_video *sw_jpeg_video;
+
+    video = esp_video_device_get_object(SW_JPEG_NAME);
+    if (!video) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    sw_jpeg_video = VIDEO_PRIV_DATA(struct sw_jpeg_video *, video);
+
+    ret = esp_video_destroy(video);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    heap_caps_free(sw_jpeg_video);
+
+    return ESP_OK;
+}
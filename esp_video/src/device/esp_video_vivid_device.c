@@ -0,0 +1,884 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_video.h"
+#include "esp_video_init.h"
+#include "esp_video_device_internal.h"
+
+#if CONFIG_SPIRAM
+#define VIVID_MEM_CAPS                  (MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM | MALLOC_CAP_CACHE_ALIGNED)
+#else
+#define VIVID_MEM_CAPS                  (MALLOC_CAP_8BIT | MALLOC_CAP_DMA)
+#endif
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(x)                   (sizeof(x) / sizeof((x)[0]))
+#endif
+
+#define VIVID_DEFAULT_WIDTH             640
+#define VIVID_DEFAULT_HEIGHT            480
+#define VIVID_DEFAULT_PIXEL_FORMAT      V4L2_PIX_FMT_RGB565
+#define VIVID_DEFAULT_FPS               30
+
+#define VIVID_MIN_SIZE                  16
+#define VIVID_MAX_SIZE                  4096
+#define VIVID_SIZE_STEP                 8       /* JPEG block size, and also keeps RAW10 4-pixel groups aligned */
+#define VIVID_MAX_FPS                   240
+
+#define VIVID_COLOR_BAR_NUM             8
+#define VIVID_GRADIENT_SPEED            4       /* Gradient phase shift per frame */
+#define VIVID_NOISE_SEED                0x2545f491
+
+#define VIVID_JPEG_BLOCK_SIZE           8
+#define VIVID_JPEG_QUANT                8
+
+#define VIVID_TASK_STACK_SIZE           4096
+#define VIVID_TASK_PRIORITY             5
+
+struct vivid_video {
+    esp_timer_handle_t timer;                   /*!< Frame timer, it only wakes up the frame task */
+    TaskHandle_t task;                          /*!< Frame task which generates frames */
+    SemaphoreHandle_t exit_sem;                 /*!< Given by the frame task when it exits */
+    volatile bool streaming;
+
+    uint32_t width;                             /*!< Initial format from configuration */
+    uint32_t height;
+    uint32_t pixel_format;
+
+    uint32_t fps;
+    uint32_t pattern;
+
+    uint32_t frame_count;
+    uint32_t noise_state;
+
+    /* Streaming format snapshot, the frame task doesn't read stream format */
+
+    uint32_t cur_width;
+    uint32_t cur_height;
+    uint32_t cur_pixel_format;
+    uint32_t line_size;                         /*!< Bytes of one line, or one luma value per column for JPEG */
+    uint8_t *line;                              /*!< Two lines, even and odd rows of Bayer formats differ */
+};
+
+struct vivid_bit_writer {
+    uint8_t *buffer;
+    uint32_t size;
+    uint32_t pos;
+    uint32_t acc;
+    uint32_t bits;
+};
+
+static const uint32_t s_vivid_formats[] = {
+    V4L2_PIX_FMT_SBGGR8,
+    V4L2_PIX_FMT_SBGGR10,
+    V4L2_PIX_FMT_RGB565,
+    V4L2_PIX_FMT_YUYV,
+    V4L2_PIX_FMT_JPEG,
+};
+
+static const uint8_t s_vivid_color_bars[VIVID_COLOR_BAR_NUM][3] = {
+    {255, 255, 255},    /* White */
+    {255, 255, 0},      /* Yellow */
+    {0, 255, 255},      /* Cyan */
+    {0, 255, 0},        /* Green */
+    {255, 0, 255},      /* Magenta */
+    {255, 0, 0},        /* Red */
+    {0, 0, 255},        /* Blue */
+    {0, 0, 0},          /* Black */
+};
+
+static const char *s_vivid_pattern_names[] = {
+    "Color Bars",
+    "Moving Gradient",
+    "Noise",
+};
+
+static const struct v4l2_query_ext_ctrl s_vivid_qctrl[] = {
+    {
+        .id = V4L2_CID_TEST_PATTERN,
+        .type = V4L2_CTRL_TYPE_MENU,
+        .minimum = 0,
+        .maximum = ESP_VIDEO_VIVID_PATTERN_MAX - 1,
+        .step = 1,
+        .elem_size = sizeof(uint32_t),
+        .elems = 1,
+        .nr_of_dims = 0,
+        .default_value = ESP_VIDEO_VIVID_PATTERN_COLOR_BARS,
+        .name = "Test Pattern",
+    },
+};
+
+/* Standard JPEG luminance DC Huffman table, indexed by DC difference category */
+
+static const uint8_t s_vivid_jpeg_dc_bits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+static const uint16_t s_vivid_jpeg_dc_code[12] = {0x000, 0x002, 0x003, 0x004, 0x005, 0x006, 0x00e, 0x01e, 0x03e, 0x07e, 0x0fe, 0x1fe};
+static const uint8_t s_vivid_jpeg_dc_len[12] = {2, 3, 3, 3, 3, 3, 4, 5, 6, 7, 8, 9};
+
+static const char *TAG = "vivid_video";
+
+static bool vivid_is_supported_format(uint32_t pixel_format)
+{
+    for (int i = 0; i < ARRAY_SIZE(s_vivid_formats); i++) {
+        if (s_vivid_formats[i] == pixel_format) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint32_t vivid_get_line_size(uint32_t width, uint32_t pixel_format)
+{
+    switch (pixel_format) {
+    case V4L2_PIX_FMT_SBGGR10:
+        return width * 10 / 8;
+    case V4L2_PIX_FMT_RGB565:
+    case V4L2_PIX_FMT_YUYV:
+        return width * 2;
+    default:
+        return width;
+    }
+}
+
+static inline uint32_t vivid_noise(struct vivid_video *vivid)
+{
+    uint32_t x = vivid->noise_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    vivid->noise_state = x;
+
+    return x;
+}
+
+static inline uint8_t vivid_rgb_to_y(const uint8_t *rgb)
+{
+    return (77 * rgb[0] + 150 * rgb[1] + 29 * rgb[2]) >> 8;
+}
+
+static void vivid_get_pixel(struct vivid_video *vivid, uint32_t x, uint8_t *rgb)
+{
+    if (vivid->pattern == ESP_VIDEO_VIVID_PATTERN_COLOR_BARS) {
+        memcpy(rgb, s_vivid_color_bars[x * VIVID_COLOR_BAR_NUM / vivid->cur_width], 3);
+    } else {
+        uint8_t v = x * 256 / vivid->cur_width + vivid->frame_count * VIVID_GRADIENT_SPEED;
+
+        rgb[0] = v;
+        rgb[1] = v + 85;
+        rgb[2] = v + 170;
+    }
+}
+
+/**
+ * @brief Build the even and odd line templates of current frame, both bars
+ *        and gradient are constant along the vertical direction.
+ */
+static void vivid_build_lines(struct vivid_video *vivid)
+{
+    uint8_t rgb[3];
+    uint8_t rgb1[3];
+    uint32_t width = vivid->cur_width;
+    uint8_t *even = vivid->line;
+    uint8_t *odd = vivid->line + vivid->line_size;
+
+    switch (vivid->cur_pixel_format) {
+    case V4L2_PIX_FMT_RGB565: {
+        uint16_t *p = (uint16_t *)even;
+
+        for (uint32_t x = 0; x < width; x++) {
+            vivid_get_pixel(vivid, x, rgb);
+            p[x] = ((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3);
+        }
+        memcpy(odd, even, vivid->line_size);
+        break;
+    }
+    case V4L2_PIX_FMT_YUYV:
+        for (uint32_t x = 0; x < width; x += 2) {
+            uint8_t *p = &even[x * 2];
+
+            vivid_get_pixel(vivid, x, rgb);
+            vivid_get_pixel(vivid, x + 1, rgb1);
+            p[0] = vivid_rgb_to_y(rgb);
+            p[1] = ((-43 * rgb[0] - 85 * rgb[1] + 128 * rgb[2]) >> 8) + 128;
+            p[2] = vivid_rgb_to_y(rgb1);
+            p[3] = ((128 * rgb[0] - 107 * rgb[1] - 21 * rgb[2]) >> 8) + 128;
+        }
+        memcpy(odd, even, vivid->line_size);
+        break;
+    case V4L2_PIX_FMT_SBGGR8:
+        for (uint32_t x = 0; x < width; x += 2) {
+            vivid_get_pixel(vivid, x, rgb);
+            even[x] = rgb[2];
+            odd[x] = rgb[1];
+            vivid_get_pixel(vivid, x + 1, rgb);
+            even[x + 1] = rgb[1];
+            odd[x + 1] = rgb[0];
+        }
+        break;
+    case V4L2_PIX_FMT_SBGGR10:
+        /* MIPI RAW10 packing: 4 pixels take 4 MSB bytes plus 1 byte of 2-bit LSBs */
+        for (uint32_t x = 0; x < width; x += 4) {
+            uint8_t *pe = &even[x * 10 / 8];
+            uint8_t *po = &odd[x * 10 / 8];
+            uint8_t lsb_e = 0;
+            uint8_t lsb_o = 0;
+
+            for (int i = 0; i < 4; i++) {
+                uint8_t ve;
+                uint8_t vo;
+
+                vivid_get_pixel(vivid, x + i, rgb);
+                if (i & 1) {
+                    ve = rgb[1];
+                    vo = rgb[0];
+                } else {
+                    ve = rgb[2];
+                    vo = rgb[1];
+                }
+
+                /* Extend 8 bits to 10 bits by repeating the MSBs */
+                pe[i] = ve;
+                po[i] = vo;
+                lsb_e |= (ve >> 6) << (i * 2);
+                lsb_o |= (vo >> 6) << (i * 2);
+            }
+            pe[4] = lsb_e;
+            po[4] = lsb_o;
+        }
+        break;
+    case V4L2_PIX_FMT_JPEG:
+        for (uint32_t x = 0; x < width; x++) {
+            vivid_get_pixel(vivid, x, rgb);
+            even[x] = vivid_rgb_to_y(rgb);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void vivid_put_byte(struct vivid_bit_writer *w, uint8_t byte)
+{
+    if (w->pos < w->size) {
+        w->buffer[w->pos] = byte;
+    }
+    w->pos++;
+}
+
+static void vivid_put_bits(struct vivid_bit_writer *w, uint32_t value, uint32_t n)
+{
+    w->acc = (w->acc << n) | (value & ((1 << n) - 1));
+    w->bits += n;
+
+    while (w->bits >= 8) {
+        uint8_t byte = w->acc >> (w->bits - 8);
+
+        vivid_put_byte(w, byte);
+        if (byte == 0xff) {
+            /* Byte stuffing, 0xFF in entropy-coded data must be followed by 0x00 */
+            vivid_put_byte(w, 0x00);
+        }
+        w->bits -= 8;
+    }
+}
+
+static void vivid_put_data(struct vivid_bit_writer *w, const uint8_t *data, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        vivid_put_byte(w, data[i]);
+    }
+}
+
+static void vivid_jpeg_write_header(struct vivid_bit_writer *w, uint32_t width, uint32_t height)
+{
+    const uint8_t soi_dqt[] = {0xff, 0xd8, 0xff, 0xdb, 0x00, 0x43, 0x00};
+    const uint8_t sof0[] = {
+        0xff, 0xc0, 0x00, 0x0b, 0x08,
+        height >> 8, height & 0xff, width >> 8, width & 0xff,
+        0x01, 0x01, 0x11, 0x00
+    };
+    const uint8_t dht_dc[] = {0xff, 0xc4, 0x00, 0x1f, 0x00};
+    /* AC table has only the EOB symbol whose code is a single "0" bit */
+    const uint8_t dht_ac[] = {
+        0xff, 0xc4, 0x00, 0x14, 0x10,
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00
+    };
+    const uint8_t sos[] = {0xff, 0xda, 0x00, 0x08, 0x01, 0x01, 0x00, 0x00, 0x3f, 0x00};
+
+    vivid_put_data(w, soi_dqt, sizeof(soi_dqt));
+    for (int i = 0; i < 64; i++) {
+        vivid_put_byte(w, VIVID_JPEG_QUANT);
+    }
+    vivid_put_data(w, sof0, sizeof(sof0));
+    vivid_put_data(w, dht_dc, sizeof(dht_dc));
+    vivid_put_data(w, s_vivid_jpeg_dc_bits, sizeof(s_vivid_jpeg_dc_bits));
+    for (int i = 0; i < ARRAY_SIZE(s_vivid_jpeg_dc_len); i++) {
+        vivid_put_byte(w, i);
+    }
+    vivid_put_data(w, dht_ac, sizeof(dht_ac));
+    vivid_put_data(w, sos, sizeof(sos));
+}
+
+/**
+ * @brief Encode a grayscale baseline JPEG which only has DC coefficients,
+ *        so every 8x8 block is flat and takes a few bits.
+ *
+ * @return Encoded size, or 0 if the buffer is too small
+ */
+static uint32_t vivid_fill_jpeg(struct vivid_video *vivid, uint8_t *buffer, uint32_t size)
+{
+    int prev_dc = 0;
+    uint8_t *luma = vivid->line;
+    struct vivid_bit_writer w = {
+        .buffer = buffer,
+        .size = size,
+    };
+
+    vivid_jpeg_write_header(&w, vivid->cur_width, vivid->cur_height);
+
+    for (uint32_t y = 0; y < vivid->cur_height; y += VIVID_JPEG_BLOCK_SIZE) {
+        if (vivid->pattern == ESP_VIDEO_VIVID_PATTERN_NOISE) {
+            for (uint32_t x = 0; x < vivid->cur_width; x += 4) {
+                uint32_t v = vivid_noise(vivid);
+
+                memcpy(&luma[x], &v, 4);
+            }
+        }
+
+        for (uint32_t x = 0; x < vivid->cur_width; x += VIVID_JPEG_BLOCK_SIZE) {
+            int sum = 0;
+
+            for (int i = 0; i < VIVID_JPEG_BLOCK_SIZE; i++) {
+                sum += luma[x + i];
+            }
+
+            /* FDCT DC is 8 times the level-shifted mean, which is divided by the quantizer 8 again */
+            int dc = sum / VIVID_JPEG_BLOCK_SIZE - 128;
+            int diff = dc - prev_dc;
+            uint32_t mag = diff < 0 ? -diff : diff;
+            uint32_t cat = 0;
+
+            while (mag) {
+                cat++;
+                mag >>= 1;
+            }
+
+            vivid_put_bits(&w, s_vivid_jpeg_dc_code[cat], s_vivid_jpeg_dc_len[cat]);
+            if (cat) {
+                vivid_put_bits(&w, diff < 0 ? diff - 1 : diff, cat);
+            }
+            vivid_put_bits(&w, 0, 1);
+
+            prev_dc = dc;
+        }
+    }
+
+    /* Pad the last byte with 1 bits */
+    if (w.bits) {
+        vivid_put_bits(&w, 0xff, 8 - w.bits);
+    }
+    vivid_put_byte(&w, 0xff);
+    vivid_put_byte(&w, 0xd9);
+
+    return w.pos <= size ? w.pos : 0;
+}
+
+/**
+ * @brief Generate one frame into the buffer.
+ *
+ * @return Frame size, or 0 if the buffer is too small
+ */
+static uint32_t vivid_fill_frame(struct vivid_video *vivid, uint8_t *buffer, uint32_t size)
+{
+    uint32_t frame_size;
+
+    if (vivid->pattern != ESP_VIDEO_VIVID_PATTERN_NOISE) {
+        vivid_build_lines(vivid);
+    }
+
+    if (vivid->cur_pixel_format == V4L2_PIX_FMT_JPEG) {
+        return vivid_fill_jpeg(vivid, buffer, size);
+    }
+
+    frame_size = vivid->line_size * vivid->cur_height;
+    if (frame_size > size) {
+        return 0;
+    }
+
+    if (vivid->pattern == ESP_VIDEO_VIVID_PATTERN_NOISE) {
+        uint32_t i;
+
+        for (i = 0; i + 4 <= frame_size; i += 4) {
+            uint32_t v = vivid_noise(vivid);
+
+            memcpy(&buffer[i], &v, 4);
+        }
+        for (; i < frame_size; i++) {
+            buffer[i] = vivid_noise(vivid);
+        }
+    } else {
+        for (uint32_t y = 0; y < vivid->cur_height; y++) {
+            memcpy(&buffer[y * vivid->line_size], &vivid->line[(y & 1) * vivid->line_size], vivid->line_size);
+        }
+    }
+
+    return frame_size;
+}
+
+static void vivid_video_timer_cb(void *arg)
+{
+    struct vivid_video *vivid = (struct vivid_video *)arg;
+
+    /* Runs in the shared esp_timer task, so leave the frame generation to the frame task */
+    xTaskNotifyGive(vivid->task);
+}
+
+static void vivid_video_task(void *arg)
+{
+    struct esp_video *video = (struct esp_video *)arg;
+    struct vivid_video *vivid = VIDEO_PRIV_DATA(struct vivid_video *, video);
+    struct esp_video_buffer_element *element;
+
+    while (vivid->streaming) {
+        /* Timer ticks missed while generating a frame are merged, like a busy sensor drops frames */
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!vivid->streaming) {
+            break;
+        }
+
+        element = CAPTURE_VIDEO_GET_QUEUED_ELEMENT(video);
+        if (element) {
+            uint32_t n = vivid_fill_frame(vivid, element->buffer, ELEMENT_SIZE(element));
+
+            if (n) {
+                CAPTURE_VIDEO_DONE_BUF(video, element->buffer, n);
+            } else {
+                ESP_LOGD(TAG, "buffer size=%" PRIu32 " is too small", ELEMENT_SIZE(element));
+                CAPTURE_VIDEO_SKIP_BUF(video, element->buffer);
+            }
+        } else {
+            CAPTURE_VIDEO_DROP_FRAME(video);
+        }
+
+        vivid->frame_count++;
+    }
+
+    xSemaphoreGive(vivid->exit_sem);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t vivid_video_init(struct esp_video *video)
+{
+    struct vivid_video *vivid = VIDEO_PRIV_DATA(struct vivid_video *, video);
+    struct v4l2_format format = {
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .fmt.pix = {
+            .width = vivid->width,
+            .height = vivid->height,
+            .pixelformat = vivid->pixel_format,
+        },
+    };
+
+    CAPTURE_VIDEO_SET_FORMAT(video, vivid->width, vivid->height, vivid->pixel_format);
+    ESP_RETURN_ON_ERROR(esp_video_config_buffer(video, &format, VIVID_MEM_CAPS), TAG, "failed to configure stream buffer");
+
+    return ESP_OK;
+}
+
+static esp_err_t vivid_video_deinit(struct esp_video *video)
+{
+    return ESP_OK;
+}
+
+static esp_err_t vivid_video_start(struct esp_video *video, uint32_t type)
+{
+    esp_err_t ret;
+    struct vivid_video *vivid = VIDEO_PRIV_DATA(struct vivid_video *, video);
+    const esp_timer_create_args_t timer_args = {
+        .callback = vivid_video_timer_cb,
+        .arg = vivid,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "vivid",
+    };
+
+    vivid->cur_width = CAPTURE_VIDEO_GET_FORMAT_WIDTH(video);
+    vivid->cur_height = CAPTURE_VIDEO_GET_FORMAT_HEIGHT(video);
+    vivid->cur_pixel_format = CAPTURE_VIDEO_GET_FORMAT_PIXEL_FORMAT(video);
+    vivid->line_size = vivid_get_line_size(vivid->cur_width, vivid->cur_pixel_format);
+    vivid->frame_count = 0;
+    vivid->noise_state = VIVID_NOISE_SEED;
+
+    vivid->line = heap_caps_malloc(vivid->line_size * 2, MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    ESP_RETURN_ON_FALSE(vivid->line, ESP_ERR_NO_MEM, TAG, "failed to malloc line buffer");
+
+    ESP_GOTO_ON_ERROR(esp_timer_create(&timer_args, &vivid->timer), fail0, TAG, "failed to create timer");
+
+    vivid->streaming = true;
+    ESP_GOTO_ON_FALSE(xTaskCreate(vivid_video_task, "vivid", VIVID_TASK_STACK_SIZE, video,
+                                  VIVID_TASK_PRIORITY, &vivid->task) == pdPASS,
+                      ESP_ERR_NO_MEM, fail1, TAG, "failed to create task");
+    ESP_GOTO_ON_ERROR(esp_timer_start_periodic(vivid->timer, 1000000 / vivid->fps), fail2, TAG, "failed to start timer");
+
+    return ESP_OK;
+
+fail2:
+    vivid->streaming = false;
+    xTaskNotifyGive(vivid->task);
+    xSemaphoreTake(vivid->exit_sem, portMAX_DELAY);
+fail1:
+    vivid->streaming = false;
+    vivid->task = NULL;
+    esp_timer_delete(vivid->timer);
+    vivid->timer = NULL;
+fail0:
+    heap_caps_free(vivid->line);
+    vivid->line = NULL;
+    return ret;
+}
+
+static esp_err_t vivid_video_stop(struct esp_video *video, uint32_t type)
+{
+    struct vivid_video *vivid = VIDEO_PRIV_DATA(struct vivid_video *, video);
+
+    ESP_RETURN_ON_ERROR(esp_timer_stop(vivid->timer), TAG, "failed to stop timer");
+
+    /* Wait for the frame in progress, then the frame task will not touch the stream any more */
+    vivid->streaming = false;
+    xTaskNotifyGive(vivid->task);
+    xSemaphoreTake(vivid->exit_sem, portMAX_DELAY);
+    vivid->task = NULL;
+
+    ESP_RETURN_ON_ERROR(esp_timer_delete(vivid->timer), TAG, "failed to delete timer");
+    vivid->timer = NULL;
+
+    heap_caps_free(vivid->line);
+    vivid->line = NULL;
+
+    return ESP_OK;
+}
+
+static esp_err_t vivid_video_enum_format(struct esp_video *video, uint32_t type, uint32_t index, uint32_t *pixel_format)
+{
+    if (index >= ARRAY_SIZE(s_vivid_formats)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *pixel_format = s_vivid_formats[index];
+
+    return ESP_OK;
+}
+
+static esp_err_t vivid_video_set_format(struct esp_video *video, const struct v4l2_format *format)
+{
+    const struct v4l2_pix_format *pix = &format->fmt.pix;
+
+    if (format->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (!vivid_is_supported_format(pix->pixelformat)) {
+        ESP_LOGE(TAG, "pixel format is not supported");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (pix->width < VIVID_MIN_SIZE || pix->width > VIVID_MAX_SIZE || (pix->width % VIVID_SIZE_STEP) ||
+            pix->height < VIVID_MIN_SIZE || pix->height > VIVID_MAX_SIZE || (pix->height % VIVID_SIZE_STEP)) {
+        ESP_LOGE(TAG, "resolution %" PRIu32 "x%" PRIu32 " is not supported", pix->width, pix->height);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ESP_RETURN_ON_ERROR(esp_video_config_buffer(video, format, VIVID_MEM_CAPS), TAG, "failed to configure stream buffer");
+
+    return ESP_OK;
+}
+
+static esp_err_t vivid_video_set_ext_ctrl(struct esp_video *video, const struct v4l2_ext_controls *ctrls)
+{
+    esp_err_t ret = ESP_OK;
+    struct vivid_video *vivid = VIDEO_PRIV_DATA(struct vivid_video *, video);
+
+    for (int i = 0; i < ctrls->count; i++) {
+        struct v4l2_ext_control *ctrl = &ctrls->controls[i];
+
+        switch (ctrl->id) {
+        case V4L2_CID_TEST_PATTERN:
+            if (ctrl->value < 0 || ctrl->value >= ESP_VIDEO_VIVID_PATTERN_MAX) {
+                ret = ESP_ERR_INVALID_ARG;
+                ESP_LOGE(TAG, "pattern=%" PRIi32 " is out of range", ctrl->value);
+                break;
+            }
+            vivid->pattern = ctrl->value;
+            break;
+        default:
+            ret = ESP_ERR_NOT_SUPPORTED;
+            ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
+            break;
+        }
+    }
+
+    return ret;
+}
+
+static esp_err_t vivid_video_get_ext_ctrl(struct esp_video *video, struct v4l2_ext_controls *ctrls)
+{
+    esp_err_t ret = ESP_OK;
+    struct vivid_video *vivid = VIDEO_PRIV_DATA(struct vivid_video *, video);
+
+    for (int i = 0; i < ctrls->count; i++) {
+        struct v4l2_ext_control *ctrl = &ctrls->controls[i];
+
+        switch (ctrl->id) {
+        case V4L2_CID_TEST_PATTERN:
+            ctrl->value = vivid->pattern;
+            break;
+        default:
+            ret = ESP_ERR_NOT_SUPPORTED;
+            ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
+            break;
+        }
+    }
+
+    return ret;
+}
+
+static esp_err_t vivid_video_query_ext_ctrl(struct esp_video *video, struct v4l2_query_ext_ctrl *qctrl)
+{
+    int num = -1;
+    uint32_t id = qctrl->id;
+    int vivid_qctrl_cnt = ARRAY_SIZE(s_vivid_qctrl);
+
+    if (id & V4L2_CTRL_FLAG_NEXT_CTRL) {
+        id &= ~V4L2_CTRL_FLAG_NEXT_CTRL;
+        if (id == 0) {
+            num = 0;
+        } else {
+            for (int i = 0; i < (vivid_qctrl_cnt - 1); i++) {
+                if (id == s_vivid_qctrl[i].id) {
+                    num = i + 1;
+                    break;
+                }
+            }
+        }
+
+        if (num < 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    } else {
+        for (int i = 0; i < vivid_qctrl_cnt; i++) {
+            if (id == s_vivid_qctrl[i].id) {
+                num = i;
+                break;
+            }
+        }
+
+        if (num < 0) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+
+    memcpy(qctrl, &s_vivid_qctrl[num], sizeof(struct v4l2_query_ext_ctrl));
+
+    return ESP_OK;
+}
+
+static esp_err_t vivid_video_query_menu(struct esp_video *video, struct v4l2_querymenu *qmenu)
+{
+    if (qmenu->id != V4L2_CID_TEST_PATTERN) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (qmenu->index >= ARRAY_SIZE(s_vivid_pattern_names)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    snprintf((char *)qmenu->name, sizeof(qmenu->name), "%s", s_vivid_pattern_names[qmenu->index]);
+
+    return ESP_OK;
+}
+
+static esp_err_t vivid_video_set_parm(struct esp_video *video, struct v4l2_streamparm *stream_parm, struct esp_video_stream *stream)
+{
+    uint32_t fps;
+    struct vivid_video *vivid = VIDEO_PRIV_DATA(struct vivid_video *, video);
+    struct v4l2_fract *tpf = &stream_parm->parm.capture.timeperframe;
+
+    if (!tpf->numerator || !tpf->denominator) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fps = tpf->denominator / tpf->numerator;
+    if (fps < 1 || fps > VIVID_MAX_FPS) {
+        ESP_LOGE(TAG, "fps=%" PRIu32 " is out of range", fps);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (vivid->timer) {
+        ESP_RETURN_ON_ERROR(esp_timer_restart(vivid->timer, 1000000 / fps), TAG, "failed to restart timer");
+    }
+    vivid->fps = fps;
+
+    tpf->numerator = 1;
+    tpf->denominator = fps;
+
+    return ESP_OK;
+}
+
+static esp_err_t vivid_video_get_parm(struct esp_video *video, struct v4l2_streamparm *stream_parm, struct esp_video_stream *stream)
+{
+    struct vivid_video *vivid = VIDEO_PRIV_DATA(struct vivid_video *, video);
+    struct v4l2_captureparm *cp = &stream_parm->parm.capture;
+
+    cp->capability |= V4L2_CAP_TIMEPERFRAME;
+    cp->timeperframe.numerator = 1;
+    cp->timeperframe.denominator = vivid->fps;
+
+    return ESP_OK;
+}
+
+static esp_err_t vivid_video_enum_framesizes(struct esp_video *video, struct v4l2_frmsizeenum *frmsize, struct esp_video_stream *stream)
+{
+    if ((frmsize->index != 0) || !vivid_is_supported_format(frmsize->pixel_format)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    frmsize->type = V4L2_FRMSIZE_TYPE_STEPWISE;
+    frmsize->stepwise.min_width = VIVID_MIN_SIZE;
+    frmsize->stepwise.max_width = VIVID_MAX_SIZE;
+    frmsize->stepwise.step_width = VIVID_SIZE_STEP;
+    frmsize->stepwise.min_height = VIVID_MIN_SIZE;
+    frmsize->stepwise.max_height = VIVID_MAX_SIZE;
+    frmsize->stepwise.step_height = VIVID_SIZE_STEP;
+
+    return ESP_OK;
+}
+
+static const struct esp_video_ops s_vivid_video_ops = {
+    .init           = vivid_video_init,
+    .deinit         = vivid_video_deinit,
+    .start          = vivid_video_start,
+    .stop           = vivid_video_stop,
+    .enum_format    = vivid_video_enum_format,
+    .set_format     = vivid_video_set_format,
+    .set_ext_ctrl   = vivid_video_set_ext_ctrl,
+    .get_ext_ctrl   = vivid_video_get_ext_ctrl,
+    .query_ext_ctrl = vivid_video_query_ext_ctrl,
+    .query_menu     = vivid_video_query_menu,
+    .set_parm       = vivid_video_set_parm,
+    .get_parm       = vivid_video_get_parm,
+    .enum_framesizes = vivid_video_enum_framesizes,
+};
+
+/**
+ * @brief Create virtual test pattern video device
+ *
+ * @param config Virtual test pattern video device configuration, NULL means using default configuration
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_create_vivid_video_device(const esp_video_init_vivid_config_t *config)
+{
+    struct esp_video *video;
+    struct vivid_video *vivid;
+    uint32_t device_caps = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_EXT_PIX_FORMAT | V4L2_CAP_STREAMING;
+    uint32_t caps = device_caps | V4L2_CAP_DEVICE_CAPS;
+
+    vivid = heap_caps_calloc(1, sizeof(struct vivid_video), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    if (!vivid) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    vivid->width = VIVID_DEFAULT_WIDTH;
+    vivid->height = VIVID_DEFAULT_HEIGHT;
+    vivid->pixel_format = VIVID_DEFAULT_PIXEL_FORMAT;
+    vivid->fps = VIVID_DEFAULT_FPS;
+    vivid->pattern = ESP_VIDEO_VIVID_PATTERN_COLOR_BARS;
+    if (config) {
+        if (config->width && config->height) {
+            vivid->width = config->width;
+            vivid->height = config->height;
+        }
+        if (config->pixel_format) {
+            vivid->pixel_format = config->pixel_format;
+        }
+        if (config->fps) {
+            vivid->fps = config->fps;
+        }
+        vivid->pattern = config->pattern;
+    }
+
+    if (!vivid_is_supported_format(vivid->pixel_format) ||
+            vivid->width < VIVID_MIN_SIZE || vivid->width > VIVID_MAX_SIZE || (vivid->width % VIVID_SIZE_STEP) ||
+            vivid->height < VIVID_MIN_SIZE || vivid->height > VIVID_MAX_SIZE || (vivid->height % VIVID_SIZE_STEP) ||
+            vivid->fps > VIVID_MAX_FPS || vivid->pattern >= ESP_VIDEO_VIVID_PATTERN_MAX) {
+        ESP_LOGE(TAG, "invalid configuration");
+        heap_caps_free(vivid);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    vivid->exit_sem = xSemaphoreCreateBinary();
+    if (!vivid->exit_sem) {
+        heap_caps_free(vivid);
+        return ESP_ERR_NO_MEM;
+    }
+
+    video = esp_video_create(ESP_VIDEO_VIVID_DEVICE_NAME, ESP_VIDEO_VIVID_DEVICE_ID, &s_vivid_video_ops, vivid, caps, device_caps);
+    if (!video) {
+        vSemaphoreDelete(vivid->exit_sem);
+        heap_caps_free(vivid);
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Destroy virtual test pattern video device
+ *
+ * @param None
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_destroy_vivid_video_device(void)
+{
+    esp_err_t ret;
+    struct esp_video *video;
+    struct vivid_video *vivid;
+
+    video = esp_video_device_get_object(ESP_VIDEO_VIVID_DEVICE_NAME);
+    if (!video) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    vivid = VIDEO_PRIV_DATA(struct vivid_video *, video);
+
+    ret = esp_video_destroy(video);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    vSemaphoreDelete(vivid->exit_sem);
+    heap_caps_free(vivid);
+
+    return ESP_OK;
+}
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -11,6 +11,7 @@
 #include "esp_check.h"
 #include "esp_memory_utils.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "esp_video.h"
 #include "esp_video_vfs.h"
 #include "esp_video_device.h"
@@ -22,6 +23,12 @@
 
 #define ALLOC_RAM_ATTR (MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL)
 
+/* Each stream statistics counter has one writer, so it is updated by a load and a store */
+
+#define STREAM_STATS_LOAD(c)                atomic_load_explicit(&(c), memory_order_relaxed)
+#define STREAM_STATS_STORE(c, v)            atomic_store_explicit(&(c), (v), memory_order_relaxed)
+#define STREAM_STATS_INC(c)                 STREAM_STATS_STORE(c, STREAM_STATS_LOAD(c) + 1)
+
 #if CONFIG_ESP_VIDEO_CHECK_PARAMETERS
 #define CHECK_VIDEO_OBJ(v)                                  \
 {                                                           \
@@ -126,6 +133,29 @@ static esp_err_t esp_video_get_format_desc(uint32_t pixel_format, char *buffer)
     return ESP_ERR_INVALID_ARG;
 }
 
+/**
+ * @brief Get video stream frame data size, calculated by format width, height and bits per pixel.
+ *
+ * @param stream Video stream object
+ *
+ * @return Frame data size in byte, or buffer size if the format is compressed or unknown
+ */
+static uint32_t esp_video_get_stream_frame_size(struct esp_video_stream *stream)
+{
+    uint32_t pixel_format = GET_STREAM_FORMAT_PIXEL_FORMAT(stream);
+
+    if ((pixel_format != V4L2_PIX_FMT_JPEG) && (pixel_format != V4L2_PIX_FMT_H264)) {
+        for (int i = 0; i < ARRAY_SIZE(esp_video_format_desc_maps); i++) {
+            if (esp_video_format_desc_maps[i].pixel_format == pixel_format) {
+                return GET_STREAM_FORMAT_WIDTH(stream) * GET_STREAM_FORMAT_HEIGHT(stream) *
+                       esp_video_format_desc_maps[i].bpp / 8;
+            }
+        }
+    }
+
+    return stream->buffer->info.size;
+}
+
 /**
  * @brief Get video buffer type.
  *
@@ -273,6 +303,29 @@ struct esp_video *esp_video_device_get_object(const char *name)
     return NULL;
 }
 
+/**
+ * @brief Get video object by ID
+ *
+ * @param id The video object ID, it is also the local file description of the video device
+ *
+ * @return Video object pointer if found by ID
+ */
+struct esp_video *esp_video_device_get_object_by_id(uint8_t id)
+{
+    struct esp_video *video;
+
+    _lock_acquire(&s_video_lock);
+    SLIST_FOREACH(video, &s_video_list, node) {
+        if (video->id == id) {
+            _lock_release(&s_video_lock);
+            return video;
+        }
+    }
+
+    _lock_release(&s_video_lock);
+    return NULL;
+}
+
 #if CONFIG_ESP_VIDEO_CHECK_PARAMETERS
 /**
  * @brief Check if video is valid
@@ -515,8 +568,15 @@ esp_err_t esp_video_open(const char *name, struct esp_video **video_ret)
 
                     stream->buffer = NULL;
                     memset(&stream->param, 0, sizeof(struct esp_video_param));
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+                    esp_video_ring_reset(&stream->queued_ring);
+                    esp_video_ring_reset(&stream->done_ring);
+                    atomic_store(&stream->released_mask, 0);
+#else
                     TAILQ_INIT(&stream->queued_list);
                     TAILQ_INIT(&stream->done_list);
+                    stream->done_count = 0;
+#endif
                 }
 
                 video->inited = 1;
@@ -540,6 +600,245 @@ exit_0:
     return ret;
 }
 
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+/**
+ * @brief Get buffer element index from queued ring, or from exported elements released by importers
+ *        if the ring is empty, called by the driver only.
+ *
+ * @param stream Video stream object
+ * @param index  Buffer element index buffer pointer
+ *
+ * @return true if an index is got
+ */
+static bool IRAM_ATTR esp_video_stream_pop_queued(struct esp_video_stream *stream, uint8_t *index)
+{
+    uint32_t mask;
+
+    if (esp_video_ring_pop(&stream->queued_ring, index)) {
+        return true;
+    }
+
+    /* Importers only set bits and the driver is the only one which clears them */
+
+    mask = atomic_load_explicit(&stream->released_mask, memory_order_acquire);
+    if (!mask) {
+        return false;
+    }
+
+    *index = __builtin_ctz(mask);
+    atomic_fetch_and_explicit(&stream->released_mask, ~(1U << *index), memory_order_relaxed);
+
+    return true;
+}
+
+/**
+ * @brief Get count of buffer elements which the driver can get by "esp_video_stream_pop_queued".
+ *
+ * @param stream Video stream object
+ *
+ * @return Buffer element count
+ */
+static uint32_t IRAM_ATTR esp_video_stream_queued_count(struct esp_video_stream *stream)
+{
+    return esp_video_ring_count(&stream->queued_ring) +
+           __builtin_popcount(atomic_load_explicit(&stream->released_mask, memory_order_acquire));
+}
+#endif
+
+/**
+ * @brief Check if buffer list of video stream is empty.
+ *
+ * @param video  Video object
+ * @param stream Video stream object
+ * @param done   true: check done list; false: check queued list
+ *
+ * @return true if the list is empty
+ */
+static bool IRAM_ATTR esp_video_stream_list_is_empty(struct esp_video *video, struct esp_video_stream *stream, bool done)
+{
+    bool empty;
+
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    empty = done ? !esp_video_ring_count(&stream->done_ring) : !esp_video_stream_queued_count(stream);
+#else
+    portENTER_CRITICAL_SAFE(&video->stream_lock);
+    empty = done ? TAILQ_EMPTY(&stream->done_list) : TAILQ_EMPTY(&stream->queued_list);
+    portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
+
+    return empty;
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+/**
+ * @brief Check if M2M video device has a source and destination buffer pair to process.
+ *
+ * @param video Video object
+ *
+ * @return true if a job is ready
+ */
+static bool esp_video_m2m_job_is_ready(struct esp_video *video)
+{
+    return !esp_video_stream_list_is_empty(video, &video->stream[0], false) &&
+           !esp_video_stream_list_is_empty(video, &video->stream[1], false);
+}
+
+/**
+ * @brief M2M video device worker task, it processes all ready jobs when it is woken up.
+ *
+ * @param arg Video object
+ *
+ * @return None
+ */
+static void esp_video_m2m_worker_task(void *arg)
+{
+    esp_err_t ret;
+    struct esp_video *video = (struct esp_video *)arg;
+    struct esp_video_m2m_worker *worker = video->m2m_worker;
+    uint32_t type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    while (worker->running) {
+        int jobs = 0;
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (worker->running && esp_video_m2m_job_is_ready(video)) {
+            /**
+             * Each job takes the video device lock, so that it doesn't race with format,
+             * parameter and control changes. The worker is stopped with the lock held,
+             * so it is checked again after the lock is taken.
+             */
+
+            xSemaphoreTake(video->mutex, portMAX_DELAY);
+            if (!worker->running) {
+                xSemaphoreGive(video->mutex);
+                break;
+            }
+
+            ret = video->ops->notify(video, ESP_VIDEO_M2M_TRIGGER, &type);
+            xSemaphoreGive(video->mutex);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "video->ops->notify=%x", ret);
+                break;
+            }
+
+            if (++jobs >= CONFIG_ESP_VIDEO_M2M_WORKER_JOB_BATCH) {
+                jobs = 0;
+                taskYIELD();
+            }
+        }
+    }
+
+    /* The stopper holds the lock until it has notified this task, so wait for it before exiting */
+
+    xSemaphoreTake(video->mutex, portMAX_DELAY);
+    xSemaphoreGive(video->mutex);
+
+    xSemaphoreGive(worker->exit_sem);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Create M2M video device worker task.
+ *
+ * @param video Video object
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+static esp_err_t esp_video_m2m_worker_start(struct esp_video *video)
+{
+    esp_err_t ret = ESP_OK;
+    struct esp_video_m2m_worker *worker;
+    BaseType_t core_id = CONFIG_ESP_VIDEO_M2M_WORKER_TASK_CORE_ID < 0 ? tskNO_AFFINITY : CONFIG_ESP_VIDEO_M2M_WORKER_TASK_CORE_ID;
+
+    if (video->m2m_worker) {
+        return ESP_OK;
+    }
+
+    worker = heap_caps_calloc(1, sizeof(struct esp_video_m2m_worker), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    ESP_RETURN_ON_FALSE(worker, ESP_ERR_NO_MEM, TAG, "failed to malloc for M2M worker");
+
+    worker->exit_sem = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(worker->exit_sem, ESP_ERR_NO_MEM, exit_0, TAG, "failed to create M2M worker exit semaphore");
+
+    worker->running = true;
+    video->m2m_worker = worker;
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(esp_video_m2m_worker_task, video->dev_name,
+                      CONFIG_ESP_VIDEO_M2M_WORKER_TASK_STACK_SIZE, video,
+                      CONFIG_ESP_VIDEO_M2M_WORKER_TASK_PRIORITY,
+                      &worker->task, core_id) == pdPASS,
+                      ESP_ERR_NO_MEM, exit_1, TAG, "failed to create M2M worker task");
+
+    return ESP_OK;
+
+exit_1:
+    video->m2m_worker = NULL;
+    vSemaphoreDelete(worker->exit_sem);
+exit_0:
+    heap_caps_free(worker);
+    return ret;
+}
+
+/**
+ * @brief Wake up M2M video device worker task.
+ *
+ * @param video Video object
+ *
+ * @return None
+ */
+static void esp_video_m2m_worker_wakeup(struct esp_video *video)
+{
+    if (video->m2m_worker) {
+        xTaskNotifyGive(video->m2m_worker->task);
+    }
+}
+
+/**
+ * @brief Stop M2M video device worker task, no job is in process because the video device lock is held.
+ *
+ * @note The worker may be blocked on the video device lock, so it exits after the lock is
+ *       released, then "esp_video_m2m_worker_join" waits for it and frees it.
+ *
+ * @param video Video object, the caller must hold its lock
+ *
+ * @return M2M worker object to join, or NULL if there is no worker
+ */
+static struct esp_video_m2m_worker *esp_video_m2m_worker_stop(struct esp_video *video)
+{
+    struct esp_video_m2m_worker *worker = video->m2m_worker;
+
+    if (!worker) {
+        return NULL;
+    }
+
+    video->m2m_worker = NULL;
+    worker->running = false;
+    xTaskNotifyGive(worker->task);
+
+    return worker;
+}
+
+/**
+ * @brief Wait for stopped M2M video device worker task to exit and free it.
+ *
+ * @param worker M2M worker object returned by "esp_video_m2m_worker_stop", it can be NULL
+ *
+ * @return None
+ */
+static void esp_video_m2m_worker_join(struct esp_video_m2m_worker *worker)
+{
+    if (!worker) {
+        return;
+    }
+
+    xSemaphoreTake(worker->exit_sem, portMAX_DELAY);
+    vSemaphoreDelete(worker->exit_sem);
+    heap_caps_free(worker);
+}
+#endif
+
 /**
  * @brief Close a video device, this function will de-initialize hardware.
  *
@@ -552,6 +851,9 @@ exit_0:
 esp_err_t esp_video_close(struct esp_video *video)
 {
     esp_err_t ret = ESP_OK;
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+    struct esp_video_m2m_worker *worker = NULL;
+#endif
 
     CHECK_VIDEO_OBJ(video);
 
@@ -572,6 +874,10 @@ esp_err_t esp_video_close(struct esp_video *video)
      * reference can be set by other tasks.
      */
     if (video->inited) {
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+        worker = esp_video_m2m_worker_stop(video);
+#endif
+
         if (video->ops->deinit) {
             ret = video->ops->deinit(video);
             if (ret != ESP_OK) {
@@ -603,9 +909,81 @@ esp_err_t esp_video_close(struct esp_video *video)
 
 exit_0:
     xSemaphoreGive(video->mutex);
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+    esp_video_m2m_worker_join(worker);
+#endif
     return ret;
 }
 
+/**
+ * @brief Reset video stream statistics, the stream must be stopped.
+ *
+ * @param stream Video stream object
+ *
+ * @return None
+ */
+static void esp_video_stream_stats_reset(struct esp_video_stream *stream)
+{
+    STREAM_STATS_STORE(stream->stats.completed, 0);
+    STREAM_STATS_STORE(stream->stats.skipped, 0);
+    STREAM_STATS_STORE(stream->stats.dropped, 0);
+    STREAM_STATS_STORE(stream->stats.done_high_water, 0);
+    STREAM_STATS_STORE(stream->stats.dequeued, 0);
+    STREAM_STATS_STORE(stream->stats.max_latency_us, 0);
+    for (int i = 0; i < ESP_VIDEO_STREAM_LATENCY_HIST_NUM; i++) {
+        STREAM_STATS_STORE(stream->stats.latency_hist[i], 0);
+    }
+
+    memset(&stream->stats_base, 0, sizeof(stream->stats_base));
+}
+
+/**
+ * @brief Read video stream statistics counters relative to the last reset.
+ *
+ * @note The caller must hold the video device lock, which serializes readers.
+ *
+ * @param stream Video stream object
+ * @param stats  Video stream statistics buffer pointer, "type" and "flags" are not changed
+ * @param reset  true: start the next reading from the current values
+ *
+ * @return None
+ */
+static void esp_video_stream_stats_read(struct esp_video_stream *stream, struct esp_video_stream_stats *stats, bool reset)
+{
+    struct esp_video_stream_stats *base = &stream->stats_base;
+    uint32_t completed = atomic_load(&stream->stats.completed);
+    uint32_t skipped = atomic_load(&stream->stats.skipped);
+    uint32_t dropped = atomic_load(&stream->stats.dropped);
+    uint32_t dequeued = atomic_load(&stream->stats.dequeued);
+    uint32_t latency_hist[ESP_VIDEO_STREAM_LATENCY_HIST_NUM];
+
+    for (int i = 0; i < ESP_VIDEO_STREAM_LATENCY_HIST_NUM; i++) {
+        latency_hist[i] = atomic_load(&stream->stats.latency_hist[i]);
+        stats->latency_hist[i] = latency_hist[i] - base->latency_hist[i];
+    }
+
+    stats->completed = completed - base->completed;
+    stats->skipped = skipped - base->skipped;
+    stats->dropped = dropped - base->dropped;
+    stats->dequeued = dequeued - base->dequeued;
+
+    if (reset) {
+        /* A maximum value stored by a writer at the same time belongs to the next reading */
+
+        stats->done_high_water = atomic_exchange(&stream->stats.done_high_water, 0);
+        stats->max_latency_us = atomic_exchange(&stream->stats.max_latency_us, 0);
+
+        base->completed = completed;
+        base->skipped = skipped;
+        base->dropped = dropped;
+        base->dequeued = dequeued;
+        memcpy(base->latency_hist, latency_hist, sizeof(latency_hist));
+    } else {
+        stats->done_high_water = atomic_load(&stream->stats.done_high_water);
+        stats->max_latency_us = atomic_load(&stream->stats.max_latency_us);
+    }
+}
+
 /**
  * @brief Start capturing video data stream.
  *
@@ -638,6 +1016,9 @@ esp_err_t esp_video_start_capture(struct esp_video *video, uint32_t type)
         for (int i = 0; i < stream_count; i++) {
             struct esp_video_stream *stream = &video->stream[i];
             stream->param.skip_count = 0;
+            stream->sequence = 0;
+            atomic_store(&stream->dqbuf_metadata, 0);
+            esp_video_stream_stats_reset(stream);
         }
 
         ret = video->ops->start(video, type);
@@ -645,6 +1026,18 @@ esp_err_t esp_video_start_capture(struct esp_video *video, uint32_t type)
             ESP_LOGE(TAG, "video->ops->start=%x", ret);
             return ret;
         }
+
+        if (video->caps & V4L2_CAP_VIDEO_M2M) {
+            memset(&video->m2m_stats, 0, sizeof(video->m2m_stats));
+
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+            ret = esp_video_m2m_worker_start(video);
+            if (ret != ESP_OK) {
+                video->ops->stop(video, type);
+                return ret;
+            }
+#endif
+        }
     } else {
         ESP_LOGD(TAG, "video->ops->start=NULL");
         return ESP_ERR_NOT_SUPPORTED;
@@ -682,6 +1075,22 @@ esp_err_t esp_video_stop_capture(struct esp_video *video, uint32_t type)
     }
 
     if (video->ops->stop) {
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+        /* The worker is shared by the capture and output streams, so keep it while the other stream is on */
+
+        if (!(video->caps & V4L2_CAP_VIDEO_M2M) ||
+                !video->stream[stream == &video->stream[0] ? 1 : 0].started) {
+            struct esp_video_m2m_worker *worker;
+
+            /* Wait for the job in process to finish */
+
+            xSemaphoreTake(video->mutex, portMAX_DELAY);
+            worker = esp_video_m2m_worker_stop(video);
+            xSemaphoreGive(video->mutex);
+            esp_video_m2m_worker_join(worker);
+        }
+#endif
+
         ret = video->ops->stop(video, type);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "video->ops->stop=%x", ret);
@@ -696,8 +1105,15 @@ esp_err_t esp_video_stop_capture(struct esp_video *video, uint32_t type)
                     ret = xSemaphoreTake(stream->ready_sem, 0);
                 } while (ret == pdTRUE);
 
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+                esp_video_ring_reset(&stream->queued_ring);
+                esp_video_ring_reset(&stream->done_ring);
+                atomic_store(&stream->released_mask, 0);
+#else
                 TAILQ_INIT(&stream->queued_list);
                 TAILQ_INIT(&stream->done_list);
+                stream->done_count = 0;
+#endif
 
                 esp_video_buffer_reset(stream->buffer);
             }
@@ -806,12 +1222,15 @@ esp_err_t esp_video_set_format(struct esp_video *video, const struct v4l2_format
         return ESP_ERR_INVALID_ARG;
     }
 
+    xSemaphoreTake(video->mutex, portMAX_DELAY);
     ret = video->ops->set_format(video, format);
+    if (ret == ESP_OK) {
+        memcpy(&stream->format, format, sizeof(struct v4l2_format));
+    }
+    xSemaphoreGive(video->mutex);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "video->ops->set_format=%x", ret);
         return ret;
-    } else {
-        memcpy(&stream->format, format, sizeof(struct v4l2_format));
     }
 
     return ESP_OK;
@@ -850,6 +1269,13 @@ esp_err_t esp_video_setup_buffer(struct esp_video *video, uint32_t type, uint32_
         return ESP_ERR_INVALID_STATE;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    if (count >= ESP_VIDEO_RING_SIZE) {
+        ESP_LOGE(TAG, "Buffer count=%" PRIu32 " is out of lock-free queue range", count);
+        return ESP_ERR_INVALID_ARG;
+    }
+#endif
+
     info->count = count;
     info->memory_type = memory_type;
 
@@ -863,6 +1289,20 @@ esp_err_t esp_video_setup_buffer(struct esp_video *video, uint32_t type, uint32_
         stream->buffer = NULL;
     }
 
+    /**
+     * Exported elements released by importers after STREAMOFF may be put into queued list,
+     * the exporter can't be released any more after its buffer is destroyed.
+     */
+
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    esp_video_ring_reset(&stream->queued_ring);
+    atomic_store(&stream->released_mask, 0);
+#else
+    portENTER_CRITICAL_SAFE(&video->stream_lock);
+    TAILQ_INIT(&stream->queued_list);
+    portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
+
     stream->ready_sem = xSemaphoreCreateCounting(info->count, 0);
     if (!stream->ready_sem) {
         ESP_LOGE(TAG, "Failed to create done_sem for video stream");
@@ -927,6 +1367,14 @@ struct esp_video_buffer_element *IRAM_ATTR esp_video_get_queued_element(struct e
         return NULL;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    uint8_t index;
+
+    if (esp_video_stream_pop_queued(stream, &index)) {
+        element = ESP_VIDEO_BUFFER_ELEMENT(stream->buffer, index);
+        ELEMENT_SET_FREE(element);
+    }
+#else
     portENTER_CRITICAL_SAFE(&video->stream_lock);
     if (!TAILQ_EMPTY(&stream->queued_list)) {
         element = TAILQ_FIRST(&stream->queued_list);
@@ -934,6 +1382,7 @@ struct esp_video_buffer_element *IRAM_ATTR esp_video_get_queued_element(struct e
         ELEMENT_SET_FREE(element);
     }
     portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
 
     return element;
 }
@@ -980,58 +1429,267 @@ struct esp_video_buffer_element *esp_video_get_done_element(struct esp_video *vi
         return NULL;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    uint8_t index;
+
+    if (esp_video_ring_pop(&stream->done_ring, &index)) {
+        element = ESP_VIDEO_BUFFER_ELEMENT(stream->buffer, index);
+        ELEMENT_SET_FREE(element);
+    }
+#else
     portENTER_CRITICAL_SAFE(&video->stream_lock);
     if (!TAILQ_EMPTY(&stream->done_list)) {
         element = TAILQ_FIRST(&stream->done_list);
         TAILQ_REMOVE(&stream->done_list, element, node);
+        stream->done_count--;
         ELEMENT_SET_FREE(element);
     }
     portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
 
     return element;
 }
 
 /**
- * @brief Put element into done lost and give semaphore.
+ * @brief Get the first buffer element of buffer done list without removing it.
  *
- * @param video   Video object
- * @param type    Video stream type
- * @param element Video buffer element object get by "esp_video_get_queued_element"
+ * @param video Video object
+ * @param type  Video stream type
  *
  * @return
- *      - ESP_OK on success
- *      - Others if failed
+ *      - Video buffer element object pointer on success
+ *      - NULL if failed
  */
-esp_err_t IRAM_ATTR esp_video_done_element(struct esp_video *video, uint32_t type, struct esp_video_buffer_element *element)
+struct esp_video_buffer_element *esp_video_get_first_done_element(struct esp_video *video, uint32_t type)
 {
     struct esp_video_stream *stream;
+    struct esp_video_buffer_element *element = NULL;
 
     stream = esp_video_get_stream(video, type);
     if (!stream) {
-        return ESP_ERR_INVALID_ARG;
+        return NULL;
     }
 
-    portENTER_CRITICAL_SAFE(&video->stream_lock);
-    if (!ELEMENT_IS_FREE(element)) {
-        portEXIT_CRITICAL_SAFE(&video->stream_lock);
-        return ESP_ERR_INVALID_ARG;
-    }
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    uint8_t index;
 
-    ELEMENT_SET_ALLOCATED(element);
-    TAILQ_INSERT_TAIL(&stream->done_list, element, node);
+    if (esp_video_ring_peek(&stream->done_ring, &index)) {
+        element = ESP_VIDEO_BUFFER_ELEMENT(stream->buffer, index);
+    }
+#else
+    portENTER_CRITICAL_SAFE(&video->stream_lock);
+    element = TAILQ_FIRST(&stream->done_list);
     portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
 
-    if (xPortInIsrContext()) {
-        BaseType_t wakeup = pdFALSE;
+    return element;
+}
 
-        xSemaphoreGiveFromISR(stream->ready_sem, &wakeup);
-        if (wakeup == pdTRUE) {
+/**
+ * @brief Check if output stream has a buffer which application can queue.
+ *
+ * @param video  Video object
+ * @param stream Video stream object
+ *
+ * @return true if a buffer can be queued
+ */
+static bool IRAM_ATTR esp_video_stream_is_writable(struct esp_video *video, struct esp_video_stream *stream)
+{
+    if (!stream->buffer) {
+        return false;
+    }
+
+    /* A finished buffer can be dequeued and then queued again */
+
+    if (!esp_video_stream_list_is_empty(video, stream, true)) {
+        return true;
+    }
+
+    /* A buffer which is not in any list is held by application */
+
+    for (int i = 0; i < stream->buffer->info.count; i++) {
+        if (ELEMENT_IS_FREE(ESP_VIDEO_BUFFER_ELEMENT(stream->buffer, i))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Check if video device buffers can be dequeued or queued without blocking.
+ *
+ * @param video Video object
+ *
+ * @return Mask of ESP_VIDEO_POLL_READABLE and ESP_VIDEO_POLL_WRITABLE
+ */
+uint32_t IRAM_ATTR esp_video_poll(struct esp_video *video)
+{
+    uint32_t events = 0;
+
+    if (!video->stream) {
+        return 0;
+    }
+
+    if (video->caps & V4L2_CAP_VIDEO_M2M) {
+        struct esp_video_stream *capture_stream = &video->stream[0];
+        struct esp_video_stream *output_stream = &video->stream[1];
+
+        /**
+         * M2M device processes data when application dequeues the capture buffer,
+         * so the capture buffer is also ready when both streams have queued buffers.
+         * The M2M worker task processes data by itself, so only the done list counts.
+         */
+
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+        bool job_ready = !video->m2m_worker &&
+#else
+        bool job_ready =
+#endif
+                         !esp_video_stream_list_is_empty(video, capture_stream, false) &&
+                         !esp_video_stream_list_is_empty(video, output_stream, false);
+
+        if (!esp_video_stream_list_is_empty(video, capture_stream, true) || job_ready) {
+            events |= ESP_VIDEO_POLL_READABLE;
+        }
+
+        if (esp_video_stream_is_writable(video, output_stream)) {
+            events |= ESP_VIDEO_POLL_WRITABLE;
+        }
+    } else if (video->caps & V4L2_CAP_VIDEO_OUTPUT) {
+        if (esp_video_stream_is_writable(video, video->stream)) {
+            events |= ESP_VIDEO_POLL_WRITABLE;
+        }
+    } else {
+        if (!esp_video_stream_list_is_empty(video, video->stream, true)) {
+            events |= ESP_VIDEO_POLL_READABLE;
+        }
+    }
+
+    return events;
+}
+
+/**
+ * @brief Record a buffer element put into done queue in video stream statistics.
+ *
+ * @note This function is called by the driver, which is the only writer of the producer
+ *       counters. If the buffer queue is not lockless, it must be called in the stream
+ *       lock because it also counts the done list.
+ *
+ * @param stream Video stream object
+ *
+ * @return None
+ */
+static void IRAM_ATTR esp_video_stream_stats_done(struct esp_video_stream *stream)
+{
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    uint32_t depth = esp_video_ring_count(&stream->done_ring);
+#else
+    uint32_t depth = ++stream->done_count;
+#endif
+
+    STREAM_STATS_INC(stream->stats.completed);
+    if (depth > STREAM_STATS_LOAD(stream->stats.done_high_water)) {
+        STREAM_STATS_STORE(stream->stats.done_high_water, depth);
+    }
+}
+
+/**
+ * @brief Record a buffer element dequeued by application in video stream statistics,
+ *        and keep its frame metadata for esp_video_get_dqbuf_metadata.
+ *
+ * @param video   Video object
+ * @param stream  Video stream object
+ * @param element Video buffer element object
+ *
+ * @return None
+ */
+static void esp_video_stream_stats_dequeue(struct esp_video *video, struct esp_video_stream *stream, struct esp_video_buffer_element *element)
+{
+    uint32_t bucket = 0;
+    int64_t latency_us = esp_timer_get_time() - element->timestamp;
+    uint32_t latency_ms = latency_us / 1000;
+
+    while (latency_ms && bucket < (ESP_VIDEO_STREAM_LATENCY_HIST_NUM - 1)) {
+        bucket++;
+        latency_ms >>= 1;
+    }
+
+    /* DQBUF is the only writer of the consumer counters */
+
+    if (latency_us > STREAM_STATS_LOAD(stream->stats.max_latency_us)) {
+        STREAM_STATS_STORE(stream->stats.max_latency_us, latency_us > UINT32_MAX ? UINT32_MAX : latency_us);
+    }
+
+    STREAM_STATS_INC(stream->stats.dequeued);
+    STREAM_STATS_INC(stream->stats.latency_hist[bucket]);
+    atomic_store(&stream->dqbuf_metadata, element->metadata);
+}
+
+/**
+ * @brief Put element into done lost and give semaphore.
+ *
+ * @param video   Video object
+ * @param type    Video stream type
+ * @param element Video buffer element object get by "esp_video_get_queued_element"
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t IRAM_ATTR esp_video_done_element(struct esp_video *video, uint32_t type, struct esp_video_buffer_element *element)
+{
+    struct esp_video_stream *stream;
+
+    stream = esp_video_get_stream(video, type);
+    if (!stream) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* The sequence number is consumed only when the buffer is delivered to the done list */
+
+    element->timestamp = esp_timer_get_time();
+    element->sequence = stream->sequence;
+
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    if (!ELEMENT_IS_FREE(element)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ELEMENT_SET_ALLOCATED(element);
+    if (!esp_video_ring_push(&stream->done_ring, element->index)) {
+        ELEMENT_SET_FREE(element);
+        return ESP_ERR_NO_MEM;
+    }
+    stream->sequence++;
+    esp_video_stream_stats_done(stream);
+#else
+    portENTER_CRITICAL_SAFE(&video->stream_lock);
+    if (!ELEMENT_IS_FREE(element)) {
+        portEXIT_CRITICAL_SAFE(&video->stream_lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ELEMENT_SET_ALLOCATED(element);
+    TAILQ_INSERT_TAIL(&stream->done_list, element, node);
+    stream->sequence++;
+    esp_video_stream_stats_done(stream);
+    portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
+
+    if (xPortInIsrContext()) {
+        BaseType_t wakeup = pdFALSE;
+
+        xSemaphoreGiveFromISR(stream->ready_sem, &wakeup);
+        if (wakeup == pdTRUE) {
             portYIELD_FROM_ISR();
         }
     } else {
         xSemaphoreGive(stream->ready_sem);
     }
 
+    esp_video_vfs_select_notify(video);
+
     return ESP_OK;
 }
 
@@ -1092,6 +1750,32 @@ esp_err_t esp_video_queue_element(struct esp_video *video, uint32_t type, struct
         return ESP_ERR_INVALID_ARG;
     }
 
+    /* Data of output stream is provided by the application, so the time to queue it is its capture time */
+
+    if (type == V4L2_BUF_TYPE_VIDEO_OUTPUT && ELEMENT_IS_FREE(element)) {
+        element->timestamp = esp_timer_get_time();
+        element->sequence = stream->sequence;
+    }
+
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    /**
+     * QBUF is the only producer of the queued ring, the DMABUF release of an importer
+     * marks "released_mask" instead, see "esp_video_dmabuf_release".
+     */
+
+    if (!ELEMENT_IS_FREE(element)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ELEMENT_SET_ALLOCATED(element);
+    if (!esp_video_ring_push(&stream->queued_ring, element->index)) {
+        ELEMENT_SET_FREE(element);
+        return ESP_ERR_NO_MEM;
+    }
+    if (type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        stream->sequence++;
+    }
+#else
     portENTER_CRITICAL_SAFE(&video->stream_lock);
     if (!ELEMENT_IS_FREE(element)) {
         portEXIT_CRITICAL_SAFE(&video->stream_lock);
@@ -1100,27 +1784,74 @@ esp_err_t esp_video_queue_element(struct esp_video *video, uint32_t type, struct
 
     ELEMENT_SET_ALLOCATED(element);
     TAILQ_INSERT_TAIL(&stream->queued_list, element, node);
+    if (type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        stream->sequence++;
+    }
     portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
 
     if (video->ops->notify) {
         video->ops->notify(video, ESP_VIDEO_BUFFER_VALID, element);
     }
 
+    if (video->caps & V4L2_CAP_VIDEO_M2M) {
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+        esp_video_m2m_worker_wakeup(video);
+#endif
+        esp_video_vfs_select_notify(video);
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Set valid data size of output stream buffer element which is going to be queued.
+ *
+ * @param video     Video object
+ * @param stream    Video stream object
+ * @param element   Video buffer element object
+ * @param bytesused Valid data size, 0 means the whole buffer
+ * @param size      Buffer size
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+static esp_err_t esp_video_set_output_element_size(struct esp_video *video, struct esp_video_stream *stream,
+        struct esp_video_buffer_element *element, uint32_t bytesused, uint32_t size)
+{
+    uint32_t valid_size = bytesused ? bytesused : size;
+
+    if (!ELEMENT_IS_FREE(element) || (valid_size > size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Fixed-size input M2M video device must get a whole frame */
+
+    if ((video->caps & V4L2_CAP_VIDEO_M2M) && !video->ops->m2m_variable_input &&
+            (valid_size < esp_video_get_stream_frame_size(stream))) {
+        ESP_LOGE(TAG, "bytesused=%" PRIu32 " is less than frame size", valid_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    element->valid_size = valid_size;
+
     return ESP_OK;
 }
 
 /**
  * @brief Put buffer element index into queued list.
  *
- * @param video   Video object
- * @param type    Video stream type
- * @param index   Video buffer element index
+ * @param video     Video object
+ * @param type      Video stream type
+ * @param index     Video buffer element index
+ * @param bytesused Output stream buffer valid data size, 0 means the whole buffer, it is ignored by capture stream
  *
  * @return
  *      - ESP_OK on success
  *      - Others if failed
  */
-esp_err_t esp_video_queue_element_index(struct esp_video *video, uint32_t type, int index)
+esp_err_t esp_video_queue_element_index(struct esp_video *video, uint32_t type, int index, uint32_t bytesused)
 {
     esp_err_t ret;
     struct esp_video_stream *stream;
@@ -1133,6 +1864,19 @@ esp_err_t esp_video_queue_element_index(struct esp_video *video, uint32_t type,
 
     element = ESP_VIDEO_BUFFER_ELEMENT(stream->buffer, index);
 
+    /* Exported buffer is put back into queued list by its importer */
+
+    if (esp_video_buffer_element_is_imported(element)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        ret = esp_video_set_output_element_size(video, stream, element, bytesused, ELEMENT_SIZE(element));
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
     ret = esp_video_queue_element(video, type, element);
 
     return ret;
@@ -1141,19 +1885,21 @@ esp_err_t esp_video_queue_element_index(struct esp_video *video, uint32_t type,
 /**
  * @brief Put buffer element index into queued list.
  *
- * @param video   Video object
- * @param type    Video stream type
- * @param index   Video buffer element index
- * @param buffer  Receive buffer pointer from user space
- * @param size    Receive buffer size
+ * @param video     Video object
+ * @param type      Video stream type
+ * @param index     Video buffer element index
+ * @param buffer    Receive buffer pointer from user space
+ * @param size      Receive buffer size
+ * @param bytesused Output stream buffer valid data size, 0 means the whole buffer, it is ignored by capture stream
  *
  * @return
  *      - ESP_OK on success
  *      - Others if failed
  */
-esp_err_t esp_video_queue_element_index_buffer(struct esp_video *video, uint32_t type, int index, uint8_t *buffer, uint32_t size)
+esp_err_t esp_video_queue_element_index_buffer(struct esp_video *video, uint32_t type, int index, uint8_t *buffer, uint32_t size, uint32_t bytesused)
 {
     esp_err_t ret;
+    uint32_t min_size;
     struct esp_video_stream *stream;
     struct esp_video_buffer_info *info;
     struct esp_video_buffer_element *element;
@@ -1166,9 +1912,17 @@ esp_err_t esp_video_queue_element_index_buffer(struct esp_video *video, uint32_t
     element = ESP_VIDEO_BUFFER_ELEMENT(stream->buffer, index);
     info = &stream->buffer->info;
 
+    /* Variable-size input buffer only needs to hold its valid data */
+
+    if ((type == V4L2_BUF_TYPE_VIDEO_OUTPUT) && video->ops->m2m_variable_input) {
+        min_size = 1;
+    } else {
+        min_size = info->size;
+    }
+
     if ((info->memory_type != V4L2_MEMORY_USERPTR) ||
             (((uintptr_t)buffer) % info->align_size) ||
-            (size < info->size)) {
+            (size < min_size)) {
         return ESP_ERR_INVALID_ARG;
     }
 
@@ -1182,14 +1936,185 @@ esp_err_t esp_video_queue_element_index_buffer(struct esp_video *video, uint32_t
         }
     }
 
+    if (type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        ret = esp_video_set_output_element_size(video, stream, element, bytesused, size);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    } else {
+        element->valid_size = size;
+    }
+
     element->buffer = buffer;
-    element->valid_size = size;
 
     ret = esp_video_queue_element(video, type, element);
 
     return ret;
 }
 
+/**
+ * @brief Exported DMABUF release callback, it puts the capture buffer element back into queued list.
+ *
+ * @note This runs in the importer's context and in the DMABUF lock, which keeps the exporter
+ *       from destroying the element. With lock-free buffer queue, the element is marked in
+ *       "released_mask" so that QBUF stays the only producer of the queued ring.
+ *
+ * @param element Exported buffer element
+ * @param arg     Video object which exports the buffer
+ *
+ * @return None
+ */
+static void esp_video_dmabuf_release(struct esp_video_buffer_element *element, void *arg)
+{
+    struct esp_video *video = (struct esp_video *)arg;
+    struct esp_video_stream *stream = esp_video_get_stream(video, V4L2_BUF_TYPE_VIDEO_CAPTURE);
+
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    if (ELEMENT_IS_FREE(element)) {
+        ELEMENT_SET_ALLOCATED(element);
+        atomic_fetch_or_explicit(&stream->released_mask, 1U << element->index, memory_order_release);
+    }
+#else
+    portENTER_CRITICAL_SAFE(&video->stream_lock);
+    if (ELEMENT_IS_FREE(element)) {
+        ELEMENT_SET_ALLOCATED(element);
+        TAILQ_INSERT_TAIL(&stream->queued_list, element, node);
+    }
+    portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
+}
+
+/**
+ * @brief Exported DMABUF notify callback, it wakes up the exporter whose buffer has been released.
+ *
+ * @param arg Video object which exports the buffer
+ *
+ * @return None
+ */
+static void esp_video_dmabuf_notify(void *arg)
+{
+    struct esp_video *video = (struct esp_video *)arg;
+
+    /* The released element may be taken by the driver already, so it is not given here */
+
+    if (video->ops->notify) {
+        video->ops->notify(video, ESP_VIDEO_BUFFER_VALID, NULL);
+    }
+
+    if (video->caps & V4L2_CAP_VIDEO_M2M) {
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+        esp_video_m2m_worker_wakeup(video);
+#endif
+        esp_video_vfs_select_notify(video);
+    }
+}
+
+/**
+ * @brief Export buffer element index as DMABUF.
+ *
+ * @note The buffer element is put back into queued list automatically when the
+ *       importer finishes processing it.
+ *
+ * @param video Video object
+ * @param type  Video stream type, only V4L2_BUF_TYPE_VIDEO_CAPTURE is supported
+ * @param index Video buffer element index
+ * @param fd    DMABUF handle buffer pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_export_element_index(struct esp_video *video, uint32_t type, int index, int *fd)
+{
+    struct esp_video_stream *stream;
+    struct esp_video_dmabuf *dmabuf;
+    struct esp_video_buffer_element *element;
+
+    if (type != V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    stream = esp_video_get_stream(video, type);
+    if (!stream || !stream->buffer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if ((stream->buffer->info.memory_type != V4L2_MEMORY_MMAP) ||
+            (index >= stream->buffer->info.count)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    element = ESP_VIDEO_BUFFER_ELEMENT(stream->buffer, index);
+    dmabuf = esp_video_buffer_export_element(element, esp_video_dmabuf_release, esp_video_dmabuf_notify, video);
+    if (!dmabuf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    *fd = dmabuf->fd;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Put buffer element index into queued list, its buffer is an imported DMABUF.
+ *
+ * @param video     Video object
+ * @param type      Video stream type
+ * @param index     Video buffer element index
+ * @param fd        DMABUF handle
+ * @param bytesused Output stream buffer valid data size, 0 means the exporter buffer valid data size
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_queue_element_index_dmabuf(struct esp_video *video, uint32_t type, int index, int fd, uint32_t bytesused)
+{
+    esp_err_t ret;
+    struct esp_video_stream *stream;
+    struct esp_video_buffer_element *element;
+
+    stream = esp_video_get_stream(video, type);
+    if (!stream) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!stream->buffer) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (stream->buffer->info.memory_type != V4L2_MEMORY_DMABUF) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    element = ESP_VIDEO_BUFFER_ELEMENT(stream->buffer, index);
+    if (!ELEMENT_IS_FREE(element)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ret = esp_video_buffer_element_import_dmabuf(element, fd);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
+        ret = esp_video_set_output_element_size(video, stream, element,
+                                                bytesused ? bytesused : element->valid_size,
+                                                element->dmabuf->size);
+    }
+
+    if (ret == ESP_OK) {
+        ret = esp_video_queue_element(video, type, element);
+    }
+    if (ret != ESP_OK) {
+        /* The element is not queued, so the exporter must not be notified to reuse its buffer */
+
+        esp_video_buffer_element_cancel_dmabuf(element);
+    }
+
+    return ret;
+}
+
 /**
  * @brief Get buffer element payload.
  *
@@ -1239,13 +2164,22 @@ struct esp_video_buffer_element *esp_video_recv_element(struct esp_video *video,
         return NULL;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_M2M_WORKER
+    /* M2M worker task processes the data when buffers are queued */
+
+    if ((video->device_caps & V4L2_CAP_VIDEO_M2M) && !video->m2m_worker) {
+#else
     if (video->device_caps & V4L2_CAP_VIDEO_M2M) {
+#endif
         /**
          * Software M2M device: this callback call can do real codec process.
          * Hardware M2M device: this callback call can start hardware if necessary.
+         * The job runs in the device lock, so that it doesn't race with format and control changes.
          */
 
+        xSemaphoreTake(video->mutex, portMAX_DELAY);
         ret = video->ops->notify(video, ESP_VIDEO_M2M_TRIGGER, &val);
+        xSemaphoreGive(video->mutex);
         if (ret != ESP_OK) {
             return NULL;
         }
@@ -1264,6 +2198,9 @@ struct esp_video_buffer_element *esp_video_recv_element(struct esp_video *video,
 #endif
 
     element = esp_video_get_done_element(video, type);
+    if (element) {
+        esp_video_stream_stats_dequeue(video, stream, element);
+    }
 
     return element;
 }
@@ -1300,6 +2237,26 @@ esp_err_t esp_video_queue_m2m_elements(struct esp_video *video,
         return ESP_ERR_INVALID_ARG;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    /* The caller is QBUF, which is the only producer of the queued rings */
+
+    if (ELEMENT_IS_FREE(src_element) && ELEMENT_IS_FREE(dst_element)) {
+        /**
+         * Put the destination element first, so that a consumer which finds
+         * the source element can always find its destination pair.
+         */
+
+        ELEMENT_SET_ALLOCATED(dst_element);
+        esp_video_ring_push(&stream[1]->queued_ring, dst_element->index);
+
+        ELEMENT_SET_ALLOCATED(src_element);
+        esp_video_ring_push(&stream[0]->queued_ring, src_element->index);
+
+        ret = ESP_OK;
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+#else
     portENTER_CRITICAL_SAFE(&video->stream_lock);
     if (ELEMENT_IS_FREE(src_element) && ELEMENT_IS_FREE(dst_element)) {
         ELEMENT_SET_ALLOCATED(src_element);
@@ -1313,6 +2270,7 @@ esp_err_t esp_video_queue_m2m_elements(struct esp_video *video,
         ret = ESP_ERR_INVALID_STATE;
     }
     portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
 
     return ret;
 }
@@ -1350,19 +2308,43 @@ esp_err_t esp_video_done_m2m_elements(struct esp_video *video,
         return ESP_ERR_INVALID_ARG;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    if (ELEMENT_IS_FREE(src_element) && ELEMENT_IS_FREE(dst_element)) {
+        /**
+         * Put the destination element first, so that a consumer which finds
+         * the source element can always find its destination pair.
+         */
+
+        ELEMENT_SET_ALLOCATED(dst_element);
+        esp_video_ring_push(&stream[1]->done_ring, dst_element->index);
+
+        ELEMENT_SET_ALLOCATED(src_element);
+        esp_video_ring_push(&stream[0]->done_ring, src_element->index);
+
+        esp_video_stream_stats_done(stream[1]);
+        esp_video_stream_stats_done(stream[0]);
+
+        ret = ESP_OK;
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+#else
     portENTER_CRITICAL_SAFE(&video->stream_lock);
     if (ELEMENT_IS_FREE(src_element) && ELEMENT_IS_FREE(dst_element)) {
         ELEMENT_SET_ALLOCATED(src_element);
         TAILQ_INSERT_TAIL(&stream[0]->done_list, src_element, node);
+        esp_video_stream_stats_done(stream[0]);
 
         ELEMENT_SET_ALLOCATED(dst_element);
         TAILQ_INSERT_TAIL(&stream[1]->done_list, dst_element, node);
+        esp_video_stream_stats_done(stream[1]);
 
         ret = ESP_OK;
     } else {
         ret = ESP_ERR_INVALID_STATE;
     }
     portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
 
     if (ret == ESP_OK && user_node) {
         if (xPortInIsrContext()) {
@@ -1381,6 +2363,8 @@ esp_err_t esp_video_done_m2m_elements(struct esp_video *video,
             xSemaphoreGive(stream[0]->ready_sem);
             xSemaphoreGive(stream[1]->ready_sem);
         }
+
+        esp_video_vfs_select_notify(video);
     }
 
     return ret;
@@ -1418,6 +2402,24 @@ esp_err_t esp_video_get_m2m_queued_elements(struct esp_video *video,
         return ESP_ERR_INVALID_ARG;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    uint8_t src_index;
+    uint8_t dst_index;
+
+    if (esp_video_stream_queued_count(stream[0]) && esp_video_stream_queued_count(stream[1])) {
+        esp_video_stream_pop_queued(stream[0], &src_index);
+        *src_element = ESP_VIDEO_BUFFER_ELEMENT(stream[0]->buffer, src_index);
+        ELEMENT_SET_FREE(*src_element);
+
+        esp_video_stream_pop_queued(stream[1], &dst_index);
+        *dst_element = ESP_VIDEO_BUFFER_ELEMENT(stream[1]->buffer, dst_index);
+        ELEMENT_SET_FREE(*dst_element);
+
+        ret = ESP_OK;
+    } else {
+        ret = ESP_ERR_NO_MEM;
+    }
+#else
     portENTER_CRITICAL_SAFE(&video->stream_lock);
     if (!TAILQ_EMPTY(&stream[0]->queued_list) && !TAILQ_EMPTY(&stream[1]->queued_list)) {
         *src_element = TAILQ_FIRST(&stream[0]->queued_list);
@@ -1433,6 +2435,7 @@ esp_err_t esp_video_get_m2m_queued_elements(struct esp_video *video,
         ret = ESP_ERR_NO_MEM;
     }
     portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
 
     return ret;
 }
@@ -1455,6 +2458,10 @@ struct esp_video_buffer_element *esp_video_clone_element(struct esp_video *video
     new_element = esp_video_get_done_element(video, type);
     if (new_element) {
         new_element->valid_size = element->valid_size;
+        new_element->timestamp = element->timestamp;
+        new_element->sequence = element->sequence;
+        new_element->flags = element->flags;
+        new_element->metadata = element->metadata;
         memcpy(new_element->buffer, element->buffer, element->valid_size);
     }
 
@@ -1610,7 +2617,11 @@ esp_err_t esp_video_query_ext_control(struct esp_video *video, struct v4l2_query
 esp_err_t esp_video_m2m_process(struct esp_video *video, uint32_t src_type, uint32_t dst_type, esp_video_m2m_process_t proc)
 {
     esp_err_t ret;
+    int64_t start_us;
+    uint32_t src_size;
+    uint32_t process_us;
     uint32_t dst_out_size;
+    struct esp_video_m2m_stats *stats = &video->m2m_stats;
     struct esp_video_buffer_element *dst_element;
     struct esp_video_buffer_element *src_element;
 
@@ -1624,13 +2635,50 @@ esp_err_t esp_video_m2m_process(struct esp_video *video, uint32_t src_type, uint
         return ret;
     }
 
-    ret = proc(video, ELEMENT_BUFFER(src_element), ELEMENT_SIZE(src_element),
-               ELEMENT_BUFFER(dst_element), ELEMENT_SIZE(dst_element), &dst_out_size);
+    /**
+     * Variable-size input M2M video device processes the data of "bytesused" size,
+     * and fixed-size input M2M video device processes one frame.
+     */
+
+    if (video->ops->m2m_variable_input) {
+        src_size = src_element->valid_size;
+    } else {
+        src_size = esp_video_get_stream_frame_size(esp_video_get_stream(video, src_type));
+    }
+
+    dst_element->flags = 0;
+    dst_element->metadata = 0;
+    start_us = esp_timer_get_time();
+    ret = proc(video, ELEMENT_BUFFER(src_element), src_size,
+               ELEMENT_BUFFER(dst_element), ELEMENT_SIZE(dst_element), &dst_out_size,
+               &dst_element->flags, &dst_element->metadata);
+    process_us = esp_timer_get_time() - start_us;
     if (ret != ESP_OK) {
         dst_element->valid_size = 0;
     } else {
         dst_element->valid_size = dst_out_size;
     }
+
+    portENTER_CRITICAL_SAFE(&video->stream_lock);
+    stats->jobs++;
+    if (ret != ESP_OK) {
+        stats->failed_jobs++;
+    }
+    stats->last_wait_us = start_us - src_element->timestamp;
+    stats->last_process_us = process_us;
+    if (process_us > stats->max_process_us) {
+        stats->max_process_us = process_us;
+    }
+    stats->total_process_us += process_us;
+    portEXIT_CRITICAL_SAFE(&video->stream_lock);
+
+    dst_element->timestamp = src_element->timestamp;
+    dst_element->sequence = src_element->sequence;
+
+    /* Source buffer is not used anymore, so the exporter can reuse it */
+
+    esp_video_buffer_element_release_dmabuf(src_element);
+
     ret = esp_video_done_m2m_elements(video, src_type, src_element, dst_type, dst_element);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "failed to put elements back into done list");
@@ -1640,6 +2688,104 @@ esp_err_t esp_video_m2m_process(struct esp_video *video, uint32_t src_type, uint
     return ESP_OK;
 }
 
+/**
+ * @brief Get M2M video device job statistics.
+ *
+ * @param video Video object
+ * @param stats M2M job statistics buffer pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_get_m2m_stats(struct esp_video *video, struct esp_video_m2m_stats *stats)
+{
+    CHECK_VIDEO_OBJ(video);
+
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!(video->caps & V4L2_CAP_VIDEO_M2M)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    portENTER_CRITICAL_SAFE(&video->stream_lock);
+    *stats = video->m2m_stats;
+    portEXIT_CRITICAL_SAFE(&video->stream_lock);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Get frame metadata of the buffer which is dequeued last from a video stream.
+ *
+ * @param video Video object
+ * @param type  Video stream type
+ *
+ * @return Frame metadata set by the device, 0 if no buffer is dequeued after the stream starts
+ */
+uint32_t esp_video_get_dqbuf_metadata(struct esp_video *video, uint32_t type)
+{
+    uint32_t metadata;
+    struct esp_video_stream *stream;
+
+    stream = esp_video_get_stream(video, type);
+    if (!stream) {
+        return 0;
+    }
+
+    metadata = atomic_load(&stream->dqbuf_metadata);
+
+    return metadata;
+}
+
+/**
+ * @brief Get video stream statistics.
+ *
+ * @param video Video object
+ * @param stats Video stream statistics buffer pointer, "type" and "flags" are set by caller
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_get_stream_stats(struct esp_video *video, struct esp_video_stream_stats *stats)
+{
+    uint32_t type;
+    uint32_t flags;
+    struct esp_video_stream *stream;
+
+    CHECK_VIDEO_OBJ(video);
+
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    type = stats->type;
+    flags = stats->flags;
+
+    stream = esp_video_get_stream(video, type);
+    if (!stream) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /**
+     * Counters are not written here, so that each of them keeps one writer. Resetting
+     * statistics records the current counter values as the base of the next reading,
+     * and the maximum values are cleared by exchange, the device lock serializes readers.
+     */
+
+    xSemaphoreTake(video->mutex, portMAX_DELAY);
+    esp_video_stream_stats_read(stream, stats, flags & ESP_VIDEO_STREAM_STATS_FLAG_RESET);
+    xSemaphoreGive(video->mutex);
+
+    stats->type = type;
+    stats->flags = flags;
+
+    return ESP_OK;
+}
+
 /**
  * @brief Set format to sensor
  *
@@ -1919,7 +3065,9 @@ esp_err_t esp_video_set_parm(struct esp_video *video, struct v4l2_streamparm *st
     }
 
     if (video->ops->set_parm) {
+        xSemaphoreTake(video->mutex, portMAX_DELAY);
         ret = video->ops->set_parm(video, stream_parm, stream);
+        xSemaphoreGive(video->mutex);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "video->ops->set_parm=%x", ret);
             return ret;
@@ -1971,6 +3119,31 @@ esp_err_t esp_video_get_parm(struct esp_video *video, struct v4l2_streamparm *st
     return ESP_OK;
 }
 
+/**
+ * @brief Put a buffer element, which is taken by the driver, back to the head of the queued list,
+ *        so that it receives the next frame.
+ *
+ * @param video   Video object
+ * @param stream  Video stream object
+ * @param element Video buffer element object
+ *
+ * @return None
+ */
+static void IRAM_ATTR esp_video_requeue_element(struct esp_video *video, struct esp_video_stream *stream, struct esp_video_buffer_element *element)
+{
+#if CONFIG_ESP_VIDEO_ENABLE_LOCKLESS_BUFFER_QUEUE
+    /* The driver is the consumer of the queued ring, so it can put the element back to the head */
+
+    ELEMENT_SET_ALLOCATED(element);
+    esp_video_ring_unget(&stream->queued_ring, element->index);
+#else
+    portENTER_CRITICAL_SAFE(&video->stream_lock);
+    ELEMENT_SET_ALLOCATED(element);
+    TAILQ_INSERT_HEAD(&stream->queued_list, element, node);
+    portEXIT_CRITICAL_SAFE(&video->stream_lock);
+#endif
+}
+
 /**
  * @brief Skip video buffer
  *
@@ -1989,10 +3162,58 @@ void IRAM_ATTR esp_video_skip_buffer(struct esp_video *video, uint32_t type, uin
 
     element = esp_video_buffer_get_element_by_buffer(stream->buffer, buffer);
 
-    portENTER_CRITICAL_SAFE(&video->stream_lock);
-    ELEMENT_SET_ALLOCATED(element);
-    TAILQ_INSERT_HEAD(&stream->queued_list, element, node);
-    portEXIT_CRITICAL_SAFE(&video->stream_lock);
+    /* The skipped frame still consumes a sequence number, so that the application can find the gap */
+    stream->sequence++;
+    STREAM_STATS_INC(stream->stats.skipped);
+
+    esp_video_requeue_element(video, stream, element);
+}
+
+/**
+ * @brief Drop a video frame which is received by a buffer but is broken, e.g. it overflows the
+ *        buffer, and put the buffer back to receive the next frame
+ *
+ * @param video  Video object
+ * @param type   Video stream type
+ * @param buffer Video buffer pointer, it may be a driver internal buffer which is not in the stream
+ *
+ * @return None
+ */
+void IRAM_ATTR esp_video_drop_buffer(struct esp_video *video, uint32_t type, uint8_t *buffer)
+{
+    struct esp_video_stream *stream;
+    struct esp_video_buffer_element *element;
+
+    esp_video_drop_frame(video, type);
+
+    stream = esp_video_get_stream(video, type);
+    if (!stream || !stream->buffer) {
+        return;
+    }
+
+    element = esp_video_buffer_get_element_by_buffer(stream->buffer, buffer);
+    if (element) {
+        esp_video_requeue_element(video, stream, element);
+    }
+}
+
+/**
+ * @brief Drop a video frame which has no buffer to receive it
+ *
+ * @param video  Video object
+ * @param type   Video stream type
+ *
+ * @return None
+ */
+void IRAM_ATTR esp_video_drop_frame(struct esp_video *video, uint32_t type)
+{
+    struct esp_video_stream *stream;
+
+    stream = esp_video_get_stream(video, type);
+    if (stream) {
+        stream->sequence++;
+        STREAM_STATS_INC(stream->stats.dropped);
+    }
 }
 
 /**
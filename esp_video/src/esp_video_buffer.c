@@ -1,11 +1,12 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
 
 #include <stdio.h>
 #include <string.h>
+#include <inttypes.h>
 #include <sys/lock.h>
 #include "linux/videodev2.h"
 #include "esp_log.h"
@@ -15,6 +16,67 @@
 
 static const char *TAG = "esp_video_buffer";
 
+static SLIST_HEAD(esp_video_dmabuf_list, esp_video_dmabuf) s_dmabuf_list = SLIST_HEAD_INITIALIZER(s_dmabuf_list);
+static portMUX_TYPE s_dmabuf_lock = portMUX_INITIALIZER_UNLOCKED;
+static int s_dmabuf_fd;
+
+/**
+ * @brief Decrease DMABUF reference count and free it if no one references it.
+ *
+ * @param dmabuf DMABUF object
+ *
+ * @return None
+ */
+static void esp_video_dmabuf_put(struct esp_video_dmabuf *dmabuf)
+{
+    bool free_dmabuf = false;
+
+    portENTER_CRITICAL(&s_dmabuf_lock);
+    assert(dmabuf->refcount > 0);
+    dmabuf->refcount--;
+    if (!dmabuf->refcount) {
+        SLIST_REMOVE(&s_dmabuf_list, dmabuf, esp_video_dmabuf, node);
+        free_dmabuf = true;
+    }
+    portEXIT_CRITICAL(&s_dmabuf_lock);
+
+    if (free_dmabuf) {
+        if (dmabuf->owns_buffer) {
+            heap_caps_free(dmabuf->buffer);
+        }
+
+        heap_caps_free(dmabuf);
+    }
+}
+
+/**
+ * @brief Remove exported DMABUF from its exporter element.
+ *
+ * @note If importers still reference the DMABUF, buffer space is handed over to it.
+ *
+ * @param element Video buffer element object
+ *
+ * @return
+ *      - true if buffer space is handed over to DMABUF
+ *      - false if not
+ */
+static bool esp_video_dmabuf_unexport(struct esp_video_buffer_element *element)
+{
+    bool handed_over;
+    struct esp_video_dmabuf *dmabuf = element->dmabuf;
+
+    portENTER_CRITICAL(&s_dmabuf_lock);
+    dmabuf->element = NULL;
+    handed_over = dmabuf->refcount > 1;
+    dmabuf->owns_buffer = handed_over;
+    portEXIT_CRITICAL(&s_dmabuf_lock);
+
+    element->dmabuf = NULL;
+    esp_video_dmabuf_put(dmabuf);
+
+    return handed_over;
+}
+
 /**
  * @brief Create video buffer object.
  *
@@ -109,7 +171,17 @@ esp_err_t esp_video_buffer_destroy(struct esp_video_buffer *buffer)
 {
     if (buffer->info.memory_type == V4L2_MEMORY_MMAP) {
         for (int i = 0; i < buffer->info.count; i++) {
-            heap_caps_free(buffer->element[i].buffer);
+            struct esp_video_buffer_element *element = &buffer->element[i];
+
+            if (element->dmabuf && esp_video_dmabuf_unexport(element)) {
+                continue;
+            }
+
+            heap_caps_free(element->buffer);
+        }
+    } else if (buffer->info.memory_type == V4L2_MEMORY_DMABUF) {
+        for (int i = 0; i < buffer->info.count; i++) {
+            esp_video_buffer_element_detach_dmabuf(&buffer->element[i]);
         }
     }
 
@@ -118,6 +190,247 @@ esp_err_t esp_video_buffer_destroy(struct esp_video_buffer *buffer)
     return ESP_OK;
 }
 
+/**
+ * @brief Export buffer element as DMABUF, the same object is returned if the element has been exported.
+ *
+ * @param element Video buffer element object, its buffer memory type must be V4L2_MEMORY_MMAP
+ * @param release Release callback, it is called when the last importer finishes using the buffer
+ * @param notify  Notify callback, it is called after the release callback, it can be NULL
+ * @param arg     Release and notify callback argument
+ *
+ * @return
+ *      - DMABUF object pointer on success
+ *      - NULL if failed
+ */
+struct esp_video_dmabuf *esp_video_buffer_export_element(struct esp_video_buffer_element *element,
+        esp_video_dmabuf_release_t release,
+        esp_video_dmabuf_notify_t notify,
+        void *arg)
+{
+    struct esp_video_dmabuf *dmabuf;
+    const struct esp_video_buffer_info *info = &element->video_buffer->info;
+
+    if (info->memory_type != V4L2_MEMORY_MMAP) {
+        return NULL;
+    }
+
+    if (element->dmabuf) {
+        return element->dmabuf;
+    }
+
+    dmabuf = heap_caps_calloc(1, sizeof(struct esp_video_dmabuf), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    if (!dmabuf) {
+        ESP_LOGE(TAG, "Failed to malloc for DMABUF");
+        return NULL;
+    }
+
+    dmabuf->refcount    = 1;
+    dmabuf->element     = element;
+    dmabuf->buffer      = element->buffer;
+    dmabuf->size        = info->size;
+    dmabuf->caps        = info->caps;
+    dmabuf->release     = release;
+    dmabuf->notify      = notify;
+    dmabuf->release_arg = arg;
+
+    portENTER_CRITICAL(&s_dmabuf_lock);
+    dmabuf->fd = ++s_dmabuf_fd;
+    SLIST_INSERT_HEAD(&s_dmabuf_list, dmabuf, node);
+    portEXIT_CRITICAL(&s_dmabuf_lock);
+
+    element->dmabuf = dmabuf;
+
+    return dmabuf;
+}
+
+/**
+ * @brief Import DMABUF into buffer element and mark it busy, previous imported DMABUF is detached.
+ *
+ * @param element Video buffer element object, its buffer memory type must be V4L2_MEMORY_DMABUF
+ * @param fd      DMABUF handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_buffer_element_import_dmabuf(struct esp_video_buffer_element *element, int fd)
+{
+    struct esp_video_dmabuf *dmabuf;
+    const struct esp_video_buffer_info *info = &element->video_buffer->info;
+
+    if (info->memory_type != V4L2_MEMORY_DMABUF) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (element->dmabuf && element->dmabuf->fd != fd) {
+        esp_video_buffer_element_detach_dmabuf(element);
+    }
+
+    portENTER_CRITICAL(&s_dmabuf_lock);
+    if (element->dmabuf) {
+        dmabuf = element->dmabuf;
+    } else {
+        SLIST_FOREACH(dmabuf, &s_dmabuf_list, node) {
+            if (dmabuf->fd == fd) {
+                dmabuf->refcount++;
+                break;
+            }
+        }
+    }
+
+    if (dmabuf && !element->dmabuf_busy) {
+        dmabuf->users++;
+        element->dmabuf_busy = true;
+    }
+    portEXIT_CRITICAL(&s_dmabuf_lock);
+
+    if (!dmabuf) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /**
+     * The buffer capabilities and alignment are checked only when the DMABUF is
+     * imported into this element for the first time.
+     */
+
+    if (!element->dmabuf) {
+        if ((dmabuf->size < info->size) ||
+                (((uintptr_t)dmabuf->buffer) % info->align_size) ||
+                ((info->caps & MALLOC_CAP_SPIRAM) && !(dmabuf->caps & MALLOC_CAP_SPIRAM)) ||
+                ((info->caps & MALLOC_CAP_INTERNAL) && !(dmabuf->caps & MALLOC_CAP_INTERNAL))) {
+            ESP_LOGE(TAG, "DMABUF fd=%d doesn't match buffer size=%" PRIu32 " caps=%" PRIx32, fd, info->size, info->caps);
+
+            /* Undo the reference and busy mark only, the exporter element has not been handed to this importer */
+
+            portENTER_CRITICAL(&s_dmabuf_lock);
+            element->dmabuf_busy = false;
+            dmabuf->users--;
+            portEXIT_CRITICAL(&s_dmabuf_lock);
+            esp_video_dmabuf_put(dmabuf);
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        element->dmabuf = dmabuf;
+        element->buffer = dmabuf->buffer;
+    }
+
+    portENTER_CRITICAL(&s_dmabuf_lock);
+    element->valid_size = dmabuf->element ? dmabuf->element->valid_size : dmabuf->size;
+    portEXIT_CRITICAL(&s_dmabuf_lock);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Check if the exported DMABUF of buffer element is used by any importer.
+ *
+ * @param element Video buffer element object, its buffer memory type must be V4L2_MEMORY_MMAP
+ *
+ * @return true if the buffer is used by an importer
+ */
+bool esp_video_buffer_element_is_imported(struct esp_video_buffer_element *element)
+{
+    bool imported;
+
+    if (!element->dmabuf) {
+        return false;
+    }
+
+    /**
+     * The release callback marks the element allocated in the same lock in which "users"
+     * drops to 0, so the caller sees the allocated mark once it gets false here.
+     */
+
+    portENTER_CRITICAL(&s_dmabuf_lock);
+    imported = element->dmabuf->users != 0;
+    portEXIT_CRITICAL(&s_dmabuf_lock);
+
+    return imported;
+}
+
+/**
+ * @brief Importer finishes using the DMABUF of buffer element.
+ *
+ * @param element Video buffer element object
+ *
+ * @return None
+ */
+void esp_video_buffer_element_release_dmabuf(struct esp_video_buffer_element *element)
+{
+    esp_video_dmabuf_notify_t notify = NULL;
+    struct esp_video_dmabuf *dmabuf = element->dmabuf;
+
+    if (!dmabuf || !element->dmabuf_busy) {
+        return;
+    }
+
+    /**
+     * The exporter clears "dmabuf->element" in this lock before destroying its buffer,
+     * so the exported element is only touched by the release callback in the lock.
+     */
+
+    portENTER_CRITICAL(&s_dmabuf_lock);
+    element->dmabuf_busy = false;
+    dmabuf->users--;
+    if (!dmabuf->users && dmabuf->element && dmabuf->release) {
+        dmabuf->release(dmabuf->element, dmabuf->release_arg);
+        notify = dmabuf->notify;
+    }
+    portEXIT_CRITICAL(&s_dmabuf_lock);
+
+    if (notify) {
+        notify(dmabuf->release_arg);
+    }
+}
+
+/**
+ * @brief Cancel the busy mark set by "esp_video_buffer_element_import_dmabuf" when the
+ *        element fails to be queued, the exporter is not notified and the DMABUF stays attached.
+ *
+ * @param element Video buffer element object
+ *
+ * @return None
+ */
+void esp_video_buffer_element_cancel_dmabuf(struct esp_video_buffer_element *element)
+{
+    struct esp_video_dmabuf *dmabuf = element->dmabuf;
+
+    if (!dmabuf || !element->dmabuf_busy) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_dmabuf_lock);
+    element->dmabuf_busy = false;
+    dmabuf->users--;
+    portEXIT_CRITICAL(&s_dmabuf_lock);
+}
+
+/**
+ * @brief Detach the imported DMABUF from buffer element.
+ *
+ * @param element Video buffer element object
+ *
+ * @return DMABUF handle which has been detached, or -1 if no DMABUF is imported
+ */
+int esp_video_buffer_element_detach_dmabuf(struct esp_video_buffer_element *element)
+{
+    int fd;
+    struct esp_video_dmabuf *dmabuf = element->dmabuf;
+
+    if (!dmabuf) {
+        return -1;
+    }
+
+    esp_video_buffer_element_release_dmabuf(element);
+
+    fd = dmabuf->fd;
+    element->dmabuf = NULL;
+    element->buffer = NULL;
+    esp_video_dmabuf_put(dmabuf);
+
+    return fd;
+}
+
 /**
  * @brief Get element object pointer by buffer
  *
@@ -150,7 +463,13 @@ struct esp_video_buffer_element *IRAM_ATTR esp_video_buffer_get_element_by_buffe
 void esp_video_buffer_reset(struct esp_video_buffer *buffer)
 {
     for (int i = 0; i < buffer->info.count; i++) {
+        if (buffer->info.memory_type == V4L2_MEMORY_DMABUF) {
+            esp_video_buffer_element_detach_dmabuf(&buffer->element[i]);
+        }
+
         ELEMENT_SET_FREE(&buffer->element[i]);
         buffer->element[i].valid_size = 0;
+        buffer->element[i].flags = 0;
+        buffer->element[i].metadata = 0;
     }
 }
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -262,17 +262,109 @@ static esp_err_t get_opt_value_desc(esp_video_cam_t *cam, const struct v4l2_ext_
     return ESP_OK;
 }
 
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
 /**
- * @brief Set control value to camera device
+ * @brief Check if all controls can be written at frame start
  *
  * @param cam      Camera device pointer
  * @param controls V4L2 external controls pointer
  *
  * @return
+ *      - true if all controls are exposure or gain controls
+ *      - false if not
+ */
+static bool can_defer_ext_ctrls(esp_video_cam_t *cam, const struct v4l2_ext_controls *controls)
+{
+    if (!cam->defer_ctrl || (controls->ctrl_class == V4L2_CTRL_CLASS_ESP_CAM_IOCTL)) {
+        return false;
+    }
+
+    for (int i = 0; i < controls->count; i++) {
+        switch (controls->controls[i].id) {
+        case V4L2_CID_GAIN:
+        case V4L2_CID_EXPOSURE:
+        case V4L2_CID_EXPOSURE_ABSOLUTE:
+        case V4L2_CID_CAMERA_GROUP:
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void cam_defer_ctrl_done(esp_sccb_io_handle_t io_handle, uint32_t sequence, esp_err_t status, void *user_data)
+{
+    esp_video_cam_t *cam = (esp_video_cam_t *)user_data;
+
+    if (status == ESP_OK) {
+        cam->ctrl_sequence = sequence + CONFIG_ESP_VIDEO_DEFERRED_CAMERA_CTRL_DELAY_FRAMES;
+    }
+}
+
+/**
+ * @brief Start writing exposure and gain controls of camera device at frame start
+ *
+ * @param cam      Camera device pointer
+ *
+ * @return
  *      - ESP_OK on success
  *      - Others if failed
  */
-esp_err_t esp_video_cam_set_ext_ctrls(esp_video_cam_t *cam, const struct v4l2_ext_controls *controls)
+esp_err_t esp_video_cam_start_defer_ctrl(esp_video_cam_t *cam)
+{
+    esp_err_t ret;
+    esp_sccb_defer_config_t config = {
+        .on_done = cam_defer_ctrl_done,
+        .user_data = cam,
+    };
+
+    ret = esp_sccb_defer_enable(cam->sensor->sccb_handle, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to enable deferred write");
+        return ret;
+    }
+
+    cam->ctrl_sequence = 0;
+    cam->defer_ctrl = true;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop writing exposure and gain controls of camera device at frame start, the controls
+ *        which are not written yet are dropped
+ *
+ * @param cam      Camera device pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_cam_stop_defer_ctrl(esp_video_cam_t *cam)
+{
+    if (!cam->defer_ctrl) {
+        return ESP_OK;
+    }
+
+    cam->defer_ctrl = false;
+
+    return esp_sccb_defer_disable(cam->sensor->sccb_handle);
+}
+#endif
+
+/**
+ * @brief Write control values to camera device
+ *
+ * @param cam      Camera device pointer
+ * @param controls V4L2 external controls pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+static esp_err_t set_ext_ctrls(esp_video_cam_t *cam, const struct v4l2_ext_controls *controls)
 {
     esp_err_t ret = ESP_ERR_INVALID_ARG;
 
@@ -364,6 +456,38 @@ esp_err_t esp_video_cam_set_ext_ctrls(esp_video_cam_t *cam, const struct v4l2_ex
     return ret;
 }
 
+/**
+ * @brief Set control value to camera device
+ *
+ * @param cam      Camera device pointer
+ * @param controls V4L2 external controls pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_cam_set_ext_ctrls(esp_video_cam_t *cam, const struct v4l2_ext_controls *controls)
+{
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+    if (can_defer_ext_ctrls(cam, controls) && (esp_sccb_defer_begin(cam->sensor->sccb_handle) == ESP_OK)) {
+        esp_err_t ret = set_ext_ctrls(cam, controls);
+
+        esp_sccb_defer_end(cam->sensor->sccb_handle);
+        if (ret != ESP_ERR_NO_MEM) {
+            return ret;
+        }
+
+        /**
+         * The deferred queue is full and the writes of these controls have been dropped, while the
+         * sensor driver may have recorded some of the values, so set them again directly.
+         */
+        ESP_LOGW(TAG, "deferred write queue is full, set controls directly");
+    }
+#endif
+
+    return set_ext_ctrls(cam, controls);
+}
+
 /**
  * @brief Get control value from camera device
  *
@@ -386,6 +510,14 @@ esp_err_t esp_video_cam_get_ext_ctrls(esp_video_cam_t *cam, struct v4l2_ext_cont
         esp_cam_sensor_param_desc_t qdesc;
         struct v4l2_ext_control *ctrl = &controls->controls[i];
 
+#if CONFIG_ESP_VIDEO_ENABLE_DEFERRED_CAMERA_CTRL
+        if ((ctrl->id == V4L2_CID_CAMERA_CTRL_SEQUENCE) && (controls->ctrl_class != V4L2_CTRL_CLASS_ESP_CAM_IOCTL)) {
+            ctrl->value = cam->ctrl_sequence;
+            ret = ESP_OK;
+            continue;
+        }
+#endif
+
         ret = get_opt_value_desc(cam, controls, ctrl, &qdesc, &value_ptr, &value_size, &ioctl, &dev_type);
         if (ret != ESP_OK) {
             break;
@@ -624,3 +756,55 @@ esp_err_t esp_video_cam_query_menu(esp_video_cam_t *cam, struct v4l2_querymenu *
 
     return ESP_OK;
 }
+
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY
+/**
+ * @brief Put camera sensor into software standby when the video device is closed
+ *
+ * @param cam      Camera device pointer
+ *
+ * @return
+ *      - ESP_OK on success, including the case that the camera sensor does not support standby
+ *      - Others if failed
+ */
+esp_err_t esp_video_cam_standby(esp_video_cam_t *cam)
+{
+    esp_err_t ret = esp_cam_sensor_standby(cam->sensor);
+
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGD(TAG, "sensor %s does not support standby", esp_cam_sensor_get_name(cam->sensor));
+        return ESP_OK;
+    } else if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to put sensor into standby");
+        return ret;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Make camera sensor leave software standby when the video device is opened
+ *
+ * @param cam      Camera device pointer
+ *
+ * @return
+ *      - ESP_OK on success, including the case that the camera sensor is not in standby
+ *      - Others if failed
+ */
+esp_err_t esp_video_cam_resume(esp_video_cam_t *cam)
+{
+    esp_err_t ret;
+
+    if (!cam->sensor->standby_status) {
+        return ESP_OK;
+    }
+
+    ret = esp_cam_sensor_resume(cam->sensor);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to resume sensor from standby");
+        return ret;
+    }
+
+    return ESP_OK;
+}
+#endif
@@ -16,6 +16,7 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 #if CONFIG_ESP_VIDEO_ENABLE_USB_UVC_VIDEO_DEVICE
 #include "usb/usb_host.h"
 #endif
@@ -35,6 +36,17 @@
 #if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
 #include "esp_video_pipeline_isp.h"
 #endif
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_DETECT_CACHE
+#include "nvs.h"
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+#define H264_VIDEO_DEVICE_HW_CODEC  true
+#define H264_VIDEO_DEVICE_CODEC_STR "hardware"
+#else
+#define H264_VIDEO_DEVICE_HW_CODEC  false
+#define H264_VIDEO_DEVICE_CODEC_STR "software"
+#endif
 
 #if ESP_VIDEO_ENABLE_SCCB_DEVICE
 typedef esp_err_t (*esp_video_create_device_fn_t)(esp_cam_sensor_device_t *cam, void *priv);
@@ -76,6 +88,7 @@ typedef struct video_device_init_config {
     void *clk_priv;
 
     uint8_t *device_inited;
+    const char **sensor_name;
 } video_device_init_config_t;
 
 #if CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE
@@ -119,6 +132,11 @@ static uint32_t s_video_device_inited_flags = 0;
 static _lock_t s_init_lock;
 static const char *TAG = "esp_video_init";
 
+#if ESP_VIDEO_ENABLE_SCCB_DEVICE
+#define SENSOR_DETECT_PORT_NUM          3   /* MIPI-CSI, DVP and SPI */
+#define SENSOR_DETECT_NVS_NAMESPACE     "esp_video"
+#endif
+
 #if ESP_VIDEO_ENABLE_SCCB_DEVICE
 static esp_err_t destroy_cam_device(esp_cam_sensor_device_t *cam)
 {
@@ -271,6 +289,9 @@ static esp_err_t esp_video_init_sensor_and_video_device(const video_device_init_
     if (config->device_inited) {
         *config->device_inited = 1;
     }
+    if (config->sensor_name) {
+        *config->sensor_name = esp_cam_sensor_get_name(cam_dev);
+    }
 
     return ESP_OK;
 
@@ -557,6 +578,550 @@ static esp_err_t destroy_dvp_video_device(void)
     return ESP_OK;
 }
 #endif /* CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE */
+
+/**
+ * @brief Camera sensor detection state of one port
+ */
+typedef struct sensor_detect_port {
+    esp_cam_sensor_port_t port;                             /*!< Camera sensor port */
+    uint32_t flag;                                          /*!< ESP_VIDEO_INIT_FLAGS_XXX of the port */
+    const esp_video_init_sccb_config_t *sccb_config;        /*!< SCCB configuration of the port */
+    esp_err_t ret;                                          /*!< Detection result */
+    uint8_t device_inited;                                  /*!< 1 if a camera sensor is detected and its video device is created */
+} sensor_detect_port_t;
+
+#if CONFIG_ESP_VIDEO_ENABLE_PARALLEL_SENSOR_DETECT
+/**
+ * @brief Ports detected one after another by one task, they share the same SCCB bus
+ */
+typedef struct sensor_detect_group {
+    const esp_video_init_config_t *config;                  /*!< Video initialization configuration */
+    sensor_detect_port_t *ports[SENSOR_DETECT_PORT_NUM];    /*!< Ports of the group */
+    int port_num;                                           /*!< Number of ports of the group */
+    int bus_id[2];                                          /*!< I2C ports of SCCB buses of the group, -1 if unknown */
+    SemaphoreHandle_t done_sem;                             /*!< Given when the group is done */
+} sensor_detect_group_t;
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_DETECT_CACHE
+/**
+ * @brief Last-known-good camera sensor of one port, stored in NVS
+ */
+typedef struct sensor_detect_record {
+    uint16_t index;                                         /*!< Index of the detect function in the detect function array */
+    uint16_t sccb_addr;                                     /*!< Camera sensor SCCB address */
+    char name[16];                                          /*!< Camera sensor name */
+} sensor_detect_record_t;
+
+static void sensor_detect_record_key(esp_cam_sensor_port_t port, char *key, size_t size)
+{
+    snprintf(key, size, "detect_port%d", (int)port);
+}
+
+static esp_err_t sensor_detect_record_load(esp_cam_sensor_port_t port, sensor_detect_record_t *record)
+{
+    esp_err_t ret;
+    char key[16];
+    nvs_handle_t handle;
+    size_t size = sizeof(sensor_detect_record_t);
+
+    sensor_detect_record_key(port, key, sizeof(key));
+    ret = nvs_open(SENSOR_DETECT_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        /* The namespace is created by the first record saved */
+        return ret;
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "failed to open NVS namespace");
+    ret = nvs_get_blob(handle, key, record, &size);
+    nvs_close(handle);
+    if (ret == ESP_OK && size != sizeof(sensor_detect_record_t)) {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Get the detect function of the last-known-good camera sensor of the port
+ *
+ * @param port Camera sensor port
+ *
+ * @return
+ *      - Detect function pointer on success
+ *      - NULL if there is no valid record
+ */
+static esp_cam_sensor_detect_fn_t *sensor_detect_cache_get(esp_cam_sensor_port_t port)
+{
+    esp_cam_sensor_detect_fn_t *p;
+    sensor_detect_record_t record;
+    size_t num = &__esp_cam_sensor_detect_fn_array_end - &__esp_cam_sensor_detect_fn_array_start;
+
+    if (sensor_detect_record_load(port, &record) != ESP_OK) {
+        ESP_LOGD(TAG, "port %d: no last-known-good camera sensor", port);
+        return NULL;
+    }
+
+    /* The detect function array changes with the firmware, so check the record before using it */
+    p = &__esp_cam_sensor_detect_fn_array_start + record.index;
+    if (record.index >= num || p->port != port || p->sccb_addr != record.sccb_addr) {
+        ESP_LOGD(TAG, "port %d: last-known-good camera sensor %.*s is not in this firmware",
+                 port, (int)sizeof(record.name), record.name);
+        return NULL;
+    }
+
+    return p;
+}
+
+/**
+ * @brief Save the detected camera sensor of the port as the last-known-good one
+ *
+ * @param port Camera sensor port
+ * @param p    Detect function of the camera sensor
+ * @param name Camera sensor name
+ *
+ * @return None
+ */
+static void sensor_detect_cache_set(esp_cam_sensor_port_t port, esp_cam_sensor_detect_fn_t *p, const char *name)
+{
+    esp_err_t ret;
+    char key[16];
+    nvs_handle_t handle;
+    sensor_detect_record_t record = {0};
+    sensor_detect_record_t old_record;
+
+    record.index = p - &__esp_cam_sensor_detect_fn_array_start;
+    record.sccb_addr = p->sccb_addr;
+    if (name) {
+        strncpy(record.name, name, sizeof(record.name));
+    }
+
+    /* Avoid wearing the flash by writing the same record on every boot */
+    if (sensor_detect_record_load(port, &old_record) == ESP_OK && !memcmp(&old_record, &record, sizeof(record))) {
+        return;
+    }
+
+    sensor_detect_record_key(port, key, sizeof(key));
+    ret = nvs_open(SENSOR_DETECT_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, key, &record, sizeof(record));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "port %d: failed to save last-known-good camera sensor: %s", port, esp_err_to_name(ret));
+    }
+}
+
+/**
+ * @brief Remove the last-known-good camera sensor record of the port
+ *
+ * @param port Camera sensor port
+ *
+ * @return None
+ */
+static void sensor_detect_cache_invalidate(esp_cam_sensor_port_t port)
+{
+    esp_err_t ret;
+    char key[16];
+    nvs_handle_t handle;
+
+    sensor_detect_record_key(port, key, sizeof(key));
+    ret = nvs_open(SENSOR_DETECT_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_erase_key(handle, key);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(handle);
+        } else if (ret == ESP_ERR_NVS_NOT_FOUND) {
+            ret = ESP_OK;
+        }
+        nvs_close(handle);
+    }
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "port %d: failed to remove last-known-good camera sensor: %s", port, esp_err_to_name(ret));
+    }
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_SENSOR_DETECT_CACHE */
+
+/**
+ * @brief Probe one camera sensor, and create the video device if it is detected
+ *
+ * @param config        video hardware configuration
+ * @param p             Detect function of the camera sensor
+ * @param device_inited Set to 1 if the camera sensor is detected and the video device is created
+ * @param sensor_name   Camera sensor name buffer pointer, set if the camera sensor is detected
+ *
+ * @return
+ *      - ESP_OK on success, including the case that the camera sensor is not detected
+ *      - Others if failed
+ */
+static esp_err_t probe_sensor(const esp_video_init_config_t *config, esp_cam_sensor_detect_fn_t *p,
+                              uint8_t *device_inited, const char **sensor_name)
+{
+    int64_t start_us = esp_timer_get_time();
+
+    switch (p->port) {
+#if CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE
+    case ESP_CAM_SENSOR_MIPI_CSI: {
+        const esp_video_init_csi_config_t *csi = config->csi;
+        video_device_init_config_t csi_init_config = {
+            .sccb_config = &csi->sccb_config,
+            .sensor_cfg = {
+                .reset_pin = csi->reset_pin,
+                .pwdn_pin = csi->pwdn_pin,
+                .detect = p,
+            },
+            .create_func = create_csi_video_device,
+            .create_priv = (void *)config,
+            .device_inited = device_inited,
+            .sensor_name = sensor_name,
+        };
+
+        ESP_RETURN_ON_ERROR(esp_video_init_sensor_and_video_device(&csi_init_config),
+                            TAG, "Failed to initialize MIPI CSI video device");
+        break;
+    }
+#endif /* CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE */
+#if CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE
+    case ESP_CAM_SENSOR_DVP: {
+        const esp_video_init_dvp_config_t *dvp = config->dvp;
+        video_device_init_config_t dvp_init_config = {
+            .sccb_config = &dvp->sccb_config,
+            .sensor_cfg = {
+                .reset_pin = dvp->reset_pin,
+                .pwdn_pin = dvp->pwdn_pin,
+                .detect = p,
+            },
+            .create_func = create_dvp_video_device,
+            .create_priv = (void *)dvp,
+            .init_clk_func = init_dvp_clk_func,
+            .deinit_clk_func = deinit_dvp_clk_func,
+            .clk_priv = (void *)dvp,
+            .device_inited = device_inited,
+            .sensor_name = sensor_name,
+        };
+
+        ESP_RETURN_ON_ERROR(esp_video_init_sensor_and_video_device(&dvp_init_config),
+                            TAG, "Failed to initialize DVP video device");
+        break;
+    }
+#endif /* CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE */
+#if CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE
+    case ESP_CAM_SENSOR_SPI: {
+        const esp_video_init_spi_config_t *spi = config->spi;
+        int index = -1;
+        for (int i = 0; i < ESP_VIDEO_SPI_DEVICE_NUM; i++) {
+            if (s_spi_dev[i].xclk_handle == NULL) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            ESP_LOGE(TAG, "No available SPI device slot");
+            return ESP_OK;
+        }
+        spi_video_device_init_clk_config_t spi_clk_common_config = {
+            .index = index,
+            .xclk_pin = spi->xclk_pin,
+            .xclk_freq_hz = spi->xclk_freq,
+            .xclk_source = spi->xclk_source,
+#if CONFIG_CAMERA_XCLK_USE_LEDC
+            .xclk_ledc_cfg = {
+                .timer = spi->xclk_ledc_cfg.timer,
+                .clk_cfg = spi->xclk_ledc_cfg.clk_cfg,
+                .channel = spi->xclk_ledc_cfg.channel,
+            }
+#endif
+        };
+        spi_video_device_init_config_t spi_device_init_config = {
+            .index = index,
+            .spi_config = spi,
+        };
+        video_device_init_config_t spi_init_config = {
+            .sensor_cfg = {
+                .reset_pin = spi->reset_pin,
+                .pwdn_pin = spi->pwdn_pin,
+                .detect = p,
+            },
+            .sccb_config = &spi->sccb_config,
+            .create_func = create_spi_video_device,
+            .create_priv = &spi_device_init_config,
+            .init_clk_func = init_spi_clk_func,
+            .deinit_clk_func = deinit_spi_clk_func,
+            .clk_priv = &spi_clk_common_config,
+            .device_inited = device_inited,
+            .sensor_name = sensor_name,
+        };
+
+        ESP_RETURN_ON_ERROR(esp_video_init_sensor_and_video_device(&spi_init_config),
+                            TAG, "Failed to initialize SPI video device");
+        break;
+    }
+#endif /* CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE */
+    default:
+        return ESP_OK;
+    }
+
+    ESP_LOGD(TAG, "port %d: probe address=0x%x %s in %" PRId64 " us", p->port, p->sccb_addr,
+             *device_inited ? "detected" : "not detected", esp_timer_get_time() - start_us);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Detect the camera sensor of one port, the last-known-good camera sensor is probed first if enabled
+ *
+ * @param config      video hardware configuration
+ * @param detect_port Camera sensor detection state of the port
+ *
+ * @return None
+ */
+static void detect_port_sensor(const esp_video_init_config_t *config, sensor_detect_port_t *detect_port)
+{
+    const char *sensor_name = NULL;
+    esp_cam_sensor_detect_fn_t *cached = NULL;
+    esp_cam_sensor_detect_fn_t *p = NULL;
+    int64_t start_us = esp_timer_get_time();
+
+    detect_port->ret = ESP_OK;
+    detect_port->device_inited = 0;
+
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_DETECT_CACHE
+    cached = sensor_detect_cache_get(detect_port->port);
+    if (cached) {
+        p = cached;
+        detect_port->ret = probe_sensor(config, p, &detect_port->device_inited, &sensor_name);
+        if (detect_port->ret != ESP_OK || !detect_port->device_inited) {
+            ESP_LOGW(TAG, "port %d: last-known-good camera sensor is not detected: %s, scan all camera sensors",
+                     detect_port->port, esp_err_to_name(detect_port->ret));
+            sensor_detect_cache_invalidate(detect_port->port);
+
+            /* A probe which fails with an error may be a transient failure, so the scan retries it */
+            if (detect_port->ret != ESP_OK) {
+                cached = NULL;
+            }
+            detect_port->ret = ESP_OK;
+        }
+    }
+#endif
+
+    if (!detect_port->device_inited) {
+        for (p = &__esp_cam_sensor_detect_fn_array_start; p < &__esp_cam_sensor_detect_fn_array_end; ++p) {
+            if (p->port != detect_port->port || p == cached) {
+                continue;
+            }
+
+            detect_port->ret = probe_sensor(config, p, &detect_port->device_inited, &sensor_name);
+            if (detect_port->ret != ESP_OK || detect_port->device_inited) {
+                break;
+            }
+        }
+    }
+
+    if (detect_port->device_inited) {
+        ESP_LOGI(TAG, "port %d: camera sensor %s detected in %" PRId64 " us%s", detect_port->port,
+                 sensor_name ? sensor_name : "", esp_timer_get_time() - start_us,
+                 (cached && p == cached) ? " (last-known-good)" : "");
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_DETECT_CACHE
+        sensor_detect_cache_set(detect_port->port, p, sensor_name);
+#endif
+    } else {
+        ESP_LOGI(TAG, "port %d: no camera sensor detected in %" PRId64 " us", detect_port->port, esp_timer_get_time() - start_us);
+    }
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_PARALLEL_SENSOR_DETECT
+/**
+ * @brief Get the I2C port of the SCCB bus, or -1 if it is unknown
+ */
+static int sensor_detect_bus_id(const esp_video_init_sccb_config_t *sccb_config)
+{
+    if (sccb_config->init_sccb) {
+        return sccb_config->i2c_config.port;
+    }
+
+    for (int i = 0; i < I2C_NUM_MAX; i++) {
+        i2c_master_bus_handle_t i2c_handle;
+
+        if (i2c_master_get_bus_handle(i, &i2c_handle) == ESP_OK && i2c_handle == sccb_config->i2c_handle) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static bool sensor_detect_bus_match(int bus_id, int other_bus_id)
+{
+    return bus_id < 0 || other_bus_id < 0 || bus_id == other_bus_id;
+}
+
+/**
+ * @brief Get SCCB buses used when detecting the camera sensor of the port, the second one is
+ *        the camera motor bus of MIPI-CSI, or the same as the first one
+ */
+static void sensor_detect_port_bus_id(const esp_video_init_config_t *config, const sensor_detect_port_t *port, int *bus_id)
+{
+    bus_id[0] = sensor_detect_bus_id(port->sccb_config);
+    bus_id[1] = bus_id[0];
+#if CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE && CONFIG_ESP_VIDEO_ENABLE_CAMERA_MOTOR_CONTROLLER
+    if (port->port == ESP_CAM_SENSOR_MIPI_CSI && config->cam_motor) {
+        bus_id[1] = sensor_detect_bus_id(&config->cam_motor->sccb_config);
+    }
+#endif
+}
+
+static void detect_group_sensor(sensor_detect_group_t *group)
+{
+    for (int i = 0; i < group->port_num; i++) {
+        detect_port_sensor(group->config, group->ports[i]);
+    }
+}
+
+static void sensor_detect_task(void *arg)
+{
+    sensor_detect_group_t *group = (sensor_detect_group_t *)arg;
+
+    detect_group_sensor(group);
+    xSemaphoreGive(group->done_sem);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Detect camera sensors of ports on different SCCB buses concurrently
+ *
+ * @param config   video hardware configuration
+ * @param ports    Camera sensor detection state array
+ * @param port_num Number of ports
+ *
+ * @return None
+ */
+static void detect_sensors_parallel(const esp_video_init_config_t *config, sensor_detect_port_t *ports, int port_num)
+{
+    int group_num = 0;
+    int task_num = 0;
+    SemaphoreHandle_t done_sem;
+    sensor_detect_group_t groups[SENSOR_DETECT_PORT_NUM] = {0};
+
+    /* Ports sharing any SCCB bus, or using an unknown one, are detected one after another in the same group */
+    for (int i = 0; i < port_num; i++) {
+        int bus_id[2];
+        int j;
+
+        sensor_detect_port_bus_id(config, &ports[i], bus_id);
+        for (j = 0; j < group_num; j++) {
+            if (sensor_detect_bus_match(groups[j].bus_id[0], bus_id[0]) || sensor_detect_bus_match(groups[j].bus_id[0], bus_id[1]) ||
+                    sensor_detect_bus_match(groups[j].bus_id[1], bus_id[0]) || sensor_detect_bus_match(groups[j].bus_id[1], bus_id[1])) {
+                break;
+            }
+        }
+        if (j == group_num) {
+            groups[group_num].config = config;
+            groups[group_num].bus_id[0] = bus_id[0];
+            groups[group_num].bus_id[1] = bus_id[1];
+            group_num++;
+        }
+
+        groups[j].ports[groups[j].port_num++] = &ports[i];
+    }
+
+    done_sem = group_num > 1 ? xSemaphoreCreateCounting(group_num, 0) : NULL;
+
+    /*
+     * The first group, which has MIPI-CSI if it is requested, runs in the current task, because
+     * creating MIPI-CSI video device also initializes the camera motor and updates global flags.
+     * Other groups run in new tasks if possible.
+     */
+    for (int i = 1; done_sem && i < group_num; i++) {
+        groups[i].done_sem = done_sem;
+        if (xTaskCreate(sensor_detect_task, "sensor_detect", CONFIG_ESP_VIDEO_SENSOR_DETECT_TASK_STACK_SIZE,
+                        &groups[i], CONFIG_ESP_VIDEO_SENSOR_DETECT_TASK_PRIORITY, NULL) == pdPASS) {
+            task_num++;
+        } else {
+            ESP_LOGW(TAG, "failed to create sensor detection task, detect in current task");
+            groups[i].done_sem = NULL;
+        }
+    }
+
+    for (int i = 0; i < group_num; i++) {
+        if (!groups[i].done_sem) {
+            detect_group_sensor(&groups[i]);
+        }
+    }
+
+    for (int i = 0; i < task_num; i++) {
+        xSemaphoreTake(done_sem, portMAX_DELAY);
+    }
+
+    if (done_sem) {
+        vSemaphoreDelete(done_sem);
+    }
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_PARALLEL_SENSOR_DETECT */
+
+/**
+ * @brief Detect camera sensors of all requested ports and create their video devices
+ *
+ * @param config video hardware configuration
+ * @param flags  video device flags, which can be a combination of ESP_VIDEO_INIT_FLAGS_XXX
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+static esp_err_t detect_sensors(const esp_video_init_config_t *config, uint32_t flags)
+{
+    esp_err_t ret = ESP_OK;
+    int port_num = 0;
+    sensor_detect_port_t ports[SENSOR_DETECT_PORT_NUM];
+
+#if CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE
+    if ((flags & ESP_VIDEO_INIT_FLAGS_MIPI_CSI) && !(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_MIPI_CSI) && config->csi != NULL) {
+        ports[port_num].port = ESP_CAM_SENSOR_MIPI_CSI;
+        ports[port_num].flag = ESP_VIDEO_INIT_FLAGS_MIPI_CSI;
+        ports[port_num].sccb_config = &config->csi->sccb_config;
+        port_num++;
+    }
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE
+    if ((flags & ESP_VIDEO_INIT_FLAGS_DVP) && !(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_DVP) && config->dvp != NULL) {
+        ports[port_num].port = ESP_CAM_SENSOR_DVP;
+        ports[port_num].flag = ESP_VIDEO_INIT_FLAGS_DVP;
+        ports[port_num].sccb_config = &config->dvp->sccb_config;
+        port_num++;
+    }
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE
+    if ((flags & ESP_VIDEO_INIT_FLAGS_SPI) && !(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_SPI) && config->spi != NULL) {
+        ports[port_num].port = ESP_CAM_SENSOR_SPI;
+        ports[port_num].flag = ESP_VIDEO_INIT_FLAGS_SPI;
+        ports[port_num].sccb_config = &config->spi->sccb_config;
+        port_num++;
+    }
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_PARALLEL_SENSOR_DETECT
+    detect_sensors_parallel(config, ports, port_num);
+#else
+    for (int i = 0; i < port_num; i++) {
+        detect_port_sensor(config, &ports[i]);
+    }
+#endif
+
+    for (int i = 0; i < port_num; i++) {
+        if (ports[i].device_inited) {
+            s_video_device_inited_flags |= ports[i].flag;
+        }
+        if (ret == ESP_OK) {
+            ret = ports[i].ret;
+        }
+    }
+
+    return ret;
+}
 #endif /* CONFIG_ESP_VIDEO_ENABLE_SCCB_DEVICE */
 
 #if CONFIG_ESP_VIDEO_ENABLE_USB_UVC_VIDEO_DEVICE
@@ -665,7 +1230,7 @@ static esp_err_t create_usb_uvc_video_device(const esp_video_init_usb_uvc_config
  *      - ESP_OK on success
  *      - Others if failed
  *
- * @note This function will deinitialize the video hardware and software in the order of JPEG, H.264, MIPI CSI, DVP, SPI, USB UVC, ISP.
+ * @note This function will deinitialize the video hardware and software in the order of JPEG, software JPEG, H.264, MIPI CSI, DVP, SPI, USB UVC, ISP, virtual test pattern.
  */
 esp_err_t esp_video_deinit_with_flags(uint32_t flags)
 {
@@ -684,13 +1249,35 @@ esp_err_t esp_video_deinit_with_flags(uint32_t flags)
     }
 #endif
 
-#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+#if CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_VIDEO_DEVICE
+    if (flags & ESP_VIDEO_INIT_FLAGS_SW_JPEG) {
+        if (s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_SW_JPEG) {
+            ESP_GOTO_ON_ERROR(esp_video_destroy_sw_jpeg_video_device(), fail0, TAG, "Failed to deinitialize software JPEG video device");
+            s_video_device_inited_flags &= ~ESP_VIDEO_INIT_FLAGS_SW_JPEG;
+        } else {
+            ESP_LOGD(TAG, "software JPEG video device is not initialized");
+        }
+    }
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_DEC_VIDEO_DEVICE
+    if (flags & ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC) {
+        if (s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC) {
+            ESP_GOTO_ON_ERROR(esp_video_destroy_sw_jpeg_dec_video_device(), fail0, TAG, "Failed to deinitialize software JPEG decoder video device");
+            s_video_device_inited_flags &= ~ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC;
+        } else {
+            ESP_LOGD(TAG, "software JPEG decoder video device is not initialized");
+        }
+    }
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_H264_VIDEO_DEVICE
     if (flags & ESP_VIDEO_INIT_FLAGS_H264) {
         if (s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_H264) {
-            ESP_GOTO_ON_ERROR(esp_video_destroy_h264_video_device(true), fail0, TAG, "Failed to deinitialize hardware H.264 video device");
+            ESP_GOTO_ON_ERROR(esp_video_destroy_h264_video_device(H264_VIDEO_DEVICE_HW_CODEC), fail0, TAG, "Failed to deinitialize " H264_VIDEO_DEVICE_CODEC_STR " H.264 video device");
             s_video_device_inited_flags &= ~ESP_VIDEO_INIT_FLAGS_H264;
         } else {
-            ESP_LOGD(TAG, "hardware H.264 video device is not initialized");
+            ESP_LOGD(TAG, H264_VIDEO_DEVICE_CODEC_STR " H.264 video device is not initialized");
         }
     }
 #endif
@@ -755,6 +1342,17 @@ esp_err_t esp_video_deinit_with_flags(uint32_t flags)
     }
 #endif
 
+#if CONFIG_ESP_VIDEO_ENABLE_VIVID_VIDEO_DEVICE
+    if (flags & ESP_VIDEO_INIT_FLAGS_VIVID) {
+        if (s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_VIVID) {
+            ESP_GOTO_ON_ERROR(esp_video_destroy_vivid_video_device(), fail0, TAG, "Failed to deinitialize virtual test pattern video device");
+            s_video_device_inited_flags &= ~ESP_VIDEO_INIT_FLAGS_VIVID;
+        } else {
+            ESP_LOGD(TAG, "virtual test pattern video device is not initialized");
+        }
+    }
+#endif
+
 fail0:
 #if ESP_VIDEO_ENABLE_SCCB_DEVICE
     /**
@@ -827,122 +1425,14 @@ esp_err_t esp_video_init_with_flags(const esp_video_init_config_t *config, uint3
     }
 #endif
 
-    for (esp_cam_sensor_detect_fn_t *p = &__esp_cam_sensor_detect_fn_array_start; p < &__esp_cam_sensor_detect_fn_array_end; ++p) {
-#if CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE
-        if (flags & ESP_VIDEO_INIT_FLAGS_MIPI_CSI) {
-            if (!(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_MIPI_CSI) && p->port == ESP_CAM_SENSOR_MIPI_CSI && config->csi != NULL) {
-                uint8_t device_inited = 0;
-                const esp_video_init_csi_config_t *csi = config->csi;
-                video_device_init_config_t csi_init_config = {
-                    .sccb_config = &csi->sccb_config,
-                    .sensor_cfg = {
-                        .reset_pin = csi->reset_pin,
-                        .pwdn_pin = csi->pwdn_pin,
-                        .detect = p,
-                    },
-                    .create_func = create_csi_video_device,
-                    .create_priv = (void *)config,
-                    .device_inited = &device_inited,
-                };
-
-                ESP_GOTO_ON_ERROR(esp_video_init_sensor_and_video_device(&csi_init_config),
-                                  fail1, TAG, "Failed to initialize MIPI CSI video device");
-                if (device_inited) {
-                    s_video_device_inited_flags |= ESP_VIDEO_INIT_FLAGS_MIPI_CSI;
-                }
-            }
-        }
-#endif /* CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE */
-#if CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE
-        if (flags & ESP_VIDEO_INIT_FLAGS_DVP) {
-            if (!(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_DVP) && p->port == ESP_CAM_SENSOR_DVP && config->dvp != NULL) {
-                uint8_t device_inited = 0;
-                const esp_video_init_dvp_config_t *dvp = config->dvp;
-                video_device_init_config_t dvp_init_config = {
-                    .sccb_config = &dvp->sccb_config,
-                    .sensor_cfg = {
-                        .reset_pin = dvp->reset_pin,
-                        .pwdn_pin = dvp->pwdn_pin,
-                        .detect = p,
-                    },
-                    .create_func = create_dvp_video_device,
-                    .create_priv = (void *)dvp,
-                    .init_clk_func = init_dvp_clk_func,
-                    .deinit_clk_func = deinit_dvp_clk_func,
-                    .clk_priv = (void *)dvp,
-                    .device_inited = &device_inited,
-                };
-
-                ESP_GOTO_ON_ERROR(esp_video_init_sensor_and_video_device(&dvp_init_config),
-                                  fail1, TAG, "Failed to initialize DVP video device");
-                if (device_inited) {
-                    s_video_device_inited_flags |= ESP_VIDEO_INIT_FLAGS_DVP;
-                }
-            }
-        }
-#endif /* CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE */
-#if CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE
-        if (flags & ESP_VIDEO_INIT_FLAGS_SPI) {
-            if (!(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_SPI) && p->port == ESP_CAM_SENSOR_SPI && config->spi != NULL) {
-                uint8_t device_inited = 0;
-                const esp_video_init_spi_config_t *spi = config->spi;
-                int index = -1;
-                for (int i = 0; i < ESP_VIDEO_SPI_DEVICE_NUM; i++) {
-                    if (s_spi_dev[i].xclk_handle == NULL) {
-                        index = i;
-                        break;
-                    }
-                }
-                if (index < 0) {
-                    ESP_LOGE(TAG, "No available SPI device slot");
-                    continue;
-                }
-                spi_video_device_init_clk_config_t spi_clk_common_config = {
-                    .index = index,
-                    .xclk_pin = spi->xclk_pin,
-                    .xclk_freq_hz = spi->xclk_freq,
-                    .xclk_source = spi->xclk_source,
-#if CONFIG_CAMERA_XCLK_USE_LEDC
-                    .xclk_ledc_cfg = {
-                        .timer = spi->xclk_ledc_cfg.timer,
-                        .clk_cfg = spi->xclk_ledc_cfg.clk_cfg,
-                        .channel = spi->xclk_ledc_cfg.channel,
-                    }
-#endif
-                };
-                spi_video_device_init_config_t spi_device_init_config = {
-                    .index = index,
-                    .spi_config = spi,
-                };
-                video_device_init_config_t spi_init_config = {
-                    .sensor_cfg = {
-                        .reset_pin = spi->reset_pin,
-                        .pwdn_pin = spi->pwdn_pin,
-                        .detect = p,
-                    },
-                    .sccb_config = &spi->sccb_config,
-                    .create_func = create_spi_video_device,
-                    .create_priv = &spi_device_init_config,
-                    .init_clk_func = init_spi_clk_func,
-                    .deinit_clk_func = deinit_spi_clk_func,
-                    .clk_priv = &spi_clk_common_config,
-                    .device_inited = &device_inited,
-                };
-
-                ESP_GOTO_ON_ERROR(esp_video_init_sensor_and_video_device(&spi_init_config),
-                                  fail1, TAG, "Failed to initialize SPI video device");
-                if (device_inited) {
-                    s_video_device_inited_flags |= ESP_VIDEO_INIT_FLAGS_SPI;
-                }
-            }
-        }
-#endif /* CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE */
-    }
+#if ESP_VIDEO_ENABLE_SCCB_DEVICE
+    ESP_GOTO_ON_ERROR(detect_sensors(config, flags), fail1, TAG, "Failed to detect camera sensors");
+#endif
 
-#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+#if CONFIG_ESP_VIDEO_ENABLE_H264_VIDEO_DEVICE
     if (flags & ESP_VIDEO_INIT_FLAGS_H264) {
         if (!(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_H264)) {
-            ESP_GOTO_ON_ERROR(esp_video_create_h264_video_device(true), fail1, TAG, "Failed to create hardware H.264 video device");
+            ESP_GOTO_ON_ERROR(esp_video_create_h264_video_device(H264_VIDEO_DEVICE_HW_CODEC), fail1, TAG, "Failed to create " H264_VIDEO_DEVICE_CODEC_STR " H.264 video device");
             s_video_device_inited_flags |= ESP_VIDEO_INIT_FLAGS_H264;
         } else {
             ESP_LOGW(TAG, "H.264 video device is already initialized");
@@ -963,6 +1453,39 @@ esp_err_t esp_video_init_with_flags(const esp_video_init_config_t *config, uint3
     }
 #endif
 
+#if CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_VIDEO_DEVICE
+    if (flags & ESP_VIDEO_INIT_FLAGS_SW_JPEG) {
+        if (!(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_SW_JPEG)) {
+            ESP_GOTO_ON_ERROR(esp_video_create_sw_jpeg_video_device(), fail1, TAG, "Failed to create software JPEG video device");
+            s_video_device_inited_flags |= ESP_VIDEO_INIT_FLAGS_SW_JPEG;
+        } else {
+            ESP_LOGW(TAG, "software JPEG video device is already initialized");
+        }
+    }
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_DEC_VIDEO_DEVICE
+    if (flags & ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC) {
+        if (!(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC)) {
+            ESP_GOTO_ON_ERROR(esp_video_create_sw_jpeg_dec_video_device(), fail1, TAG, "Failed to create software JPEG decoder video device");
+            s_video_device_inited_flags |= ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC;
+        } else {
+            ESP_LOGW(TAG, "software JPEG decoder video device is already initialized");
+        }
+    }
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_VIVID_VIDEO_DEVICE
+    if (flags & ESP_VIDEO_INIT_FLAGS_VIVID) {
+        if (!(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_VIVID)) {
+            ESP_GOTO_ON_ERROR(esp_video_create_vivid_video_device(config->vivid), fail1, TAG, "Failed to create virtual test pattern video device");
+            s_video_device_inited_flags |= ESP_VIDEO_INIT_FLAGS_VIVID;
+        } else {
+            ESP_LOGW(TAG, "virtual test pattern video device is already initialized");
+        }
+    }
+#endif
+
     _lock_release_recursive(&s_init_lock);
     return ESP_OK;
 
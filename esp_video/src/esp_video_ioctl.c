@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
 #include <sys/lock.h>
 #include "esp_heap_caps.h"
 #include "esp_video.h"
@@ -83,10 +84,18 @@ static esp_err_t esp_video_ioctl_reqbufs(struct esp_video *video, struct v4l2_re
     esp_err_t ret;
 
     if ((req_bufs->memory != V4L2_MEMORY_MMAP) &&
-            (req_bufs->memory != V4L2_MEMORY_USERPTR) ) {
+            (req_bufs->memory != V4L2_MEMORY_USERPTR) &&
+            (req_bufs->memory != V4L2_MEMORY_DMABUF)) {
         return ESP_ERR_INVALID_ARG;
     }
 
+    /* Only M2M device input stream can import buffers exported by other video devices */
+
+    if ((req_bufs->memory == V4L2_MEMORY_DMABUF) &&
+            (req_bufs->type != V4L2_BUF_TYPE_VIDEO_OUTPUT)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
     if (req_bufs->count == 0) {
         return ESP_ERR_INVALID_ARG;
     }
@@ -164,20 +173,22 @@ static esp_err_t esp_video_ioctl_qbuf(struct esp_video *video, struct v4l2_buffe
     }
 
     if (info.memory_type == V4L2_MEMORY_MMAP) {
-        ret = esp_video_queue_element_index(video, vbuf->type, vbuf->index);
+        ret = esp_video_queue_element_index(video, vbuf->type, vbuf->index, vbuf->bytesused);
+    } else if (info.memory_type == V4L2_MEMORY_DMABUF) {
+        ret = esp_video_queue_element_index_dmabuf(video, vbuf->type, vbuf->index, vbuf->m.fd, vbuf->bytesused);
     } else {
-        ret = esp_video_queue_element_index_buffer(video, vbuf->type, vbuf->index, (uint8_t *)vbuf->m.userptr, vbuf->length);
+        ret = esp_video_queue_element_index_buffer(video, vbuf->type, vbuf->index, (uint8_t *)vbuf->m.userptr, vbuf->length, vbuf->bytesused);
     }
 
     return ret;
 }
 
-static esp_err_t esp_video_ioctl_dqbuf(struct esp_video *video, struct v4l2_buffer *vbuf)
+static esp_err_t esp_video_ioctl_dqbuf(struct esp_video *video, bool nonblock, struct v4l2_buffer *vbuf)
 {
     esp_err_t ret;
     struct esp_video_buffer_info info;
     struct esp_video_buffer_element *element;
-    uint32_t ticks = video->dqbuf_timeout_ticks;
+    uint32_t ticks = nonblock ? 0 : video->dqbuf_timeout_ticks;
 
     ret = esp_video_get_buffer_info(video, vbuf->type, &info);
     if (ret != ESP_OK) {
@@ -190,18 +201,26 @@ static esp_err_t esp_video_ioctl_dqbuf(struct esp_video *video, struct v4l2_buff
 
     element = esp_video_recv_element(video, vbuf->type, ticks);
     if (!element) {
-        return ESP_FAIL;
+        return nonblock ? ESP_ERR_NOT_FINISHED : ESP_FAIL;
     }
 
-    vbuf->flags     = 0;
+    vbuf->flags     = V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC | element->flags;
     vbuf->index     = element->index;
     vbuf->bytesused = element->valid_size;
+    vbuf->sequence  = element->sequence;
+    vbuf->timestamp.tv_sec  = element->timestamp / 1000000;
+    vbuf->timestamp.tv_usec = element->timestamp % 1000000;
     if (!vbuf->bytesused) {
         vbuf->flags |= V4L2_BUF_FLAG_ERROR;
     } else {
         vbuf->flags |= V4L2_BUF_FLAG_DONE;
     }
-    if (vbuf->memory != V4L2_MEMORY_USERPTR) {
+    if (vbuf->memory == V4L2_MEMORY_DMABUF) {
+        /* Keep the DMABUF attached, so that QBUF of the same fd doesn't import and check it again */
+
+        vbuf->m.fd = element->dmabuf ? element->dmabuf->fd : -1;
+        esp_video_buffer_element_release_dmabuf(element);
+    } else if (vbuf->memory != V4L2_MEMORY_USERPTR) {
         vbuf->m.userptr = (unsigned long)element->buffer;
         vbuf->flags |= V4L2_BUF_FLAG_MAPPED;
     }
@@ -209,6 +228,15 @@ static esp_err_t esp_video_ioctl_dqbuf(struct esp_video *video, struct v4l2_buff
     return ESP_OK;
 }
 
+static esp_err_t esp_video_ioctl_expbuf(struct esp_video *video, struct v4l2_exportbuffer *expbuf)
+{
+    if (expbuf->plane) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return esp_video_export_element_index(video, expbuf->type, expbuf->index, &expbuf->fd);
+}
+
 static inline esp_err_t esp_video_ioctl_set_ext_ctrls(struct esp_video *video, const struct v4l2_ext_controls *controls)
 {
     return esp_video_set_ext_controls(video, controls);
@@ -296,7 +324,17 @@ static inline esp_err_t esp_video_ioctl_get_dqbuf_timeout(struct esp_video *vide
     return esp_video_get_dqbuf_timeout(video, timeout);
 }
 
-esp_err_t esp_video_ioctl(struct esp_video *video, int cmd, va_list args)
+static inline esp_err_t esp_video_ioctl_get_m2m_stats(struct esp_video *video, struct esp_video_m2m_stats *stats)
+{
+    return esp_video_get_m2m_stats(video, stats);
+}
+
+static inline esp_err_t esp_video_ioctl_get_stream_stats(struct esp_video *video, struct esp_video_stream_stats *stats)
+{
+    return esp_video_get_stream_stats(video, stats);
+}
+
+esp_err_t esp_video_ioctl(struct esp_video *video, int flags, int cmd, va_list args)
 {
     esp_err_t ret = ESP_OK;
     void *arg_ptr;
@@ -313,7 +351,10 @@ esp_err_t esp_video_ioctl(struct esp_video *video, int cmd, va_list args)
         ret = esp_video_ioctl_qbuf(video, (struct v4l2_buffer *)arg_ptr);
         break;
     case VIDIOC_DQBUF:
-        ret = esp_video_ioctl_dqbuf(video, (struct v4l2_buffer *)arg_ptr);
+        ret = esp_video_ioctl_dqbuf(video, flags & O_NONBLOCK, (struct v4l2_buffer *)arg_ptr);
+        break;
+    case VIDIOC_EXPBUF:
+        ret = esp_video_ioctl_expbuf(video, (struct v4l2_exportbuffer *)arg_ptr);
         break;
     case VIDIOC_QUERYCAP:
         ret = esp_video_ioctl_querycap(video, (struct v4l2_capability *)arg_ptr);
@@ -395,6 +436,12 @@ esp_err_t esp_video_ioctl(struct esp_video *video, int cmd, va_list args)
     case VIDIOC_G_DQBUF_TIMEOUT:
         ret = esp_video_ioctl_get_dqbuf_timeout(video, (struct timeval *)arg_ptr);
         break;
+    case VIDIOC_G_M2M_STATS:
+        ret = esp_video_ioctl_get_m2m_stats(video, (struct esp_video_m2m_stats *)arg_ptr);
+        break;
+    case VIDIOC_G_STREAM_STATS:
+        ret = esp_video_ioctl_get_stream_stats(video, (struct esp_video_stream_stats *)arg_ptr);
+        break;
     default:
         ret = ESP_ERR_INVALID_ARG;
         break;
@@ -9,6 +9,7 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
@@ -28,17 +29,87 @@
 #include "esp_video_device_internal.h"
 #include "esp_ipa.h"
 #include "esp_cam_sensor.h"
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE
+#include "nvs.h"
+#endif
 
 #define ISP_METADATA_BUFFER_COUNT   2
 #define ISP_TASK_PRIORITY           11
 #define ISP_TASK_STACK_SIZE         4096
 #define ISP_TASK_NAME               "isp_task"
 
+/* Flash writes of the 3A state must not delay the per-frame 3A task */
+#define ISP_3A_SAVE_TASK_PRIORITY   1
+#define ISP_3A_SAVE_TASK_STACK_SIZE 3072
+#define ISP_3A_SAVE_TASK_NAME       "isp_3a_save"
+
 #define UNUSED(x)                   (void)(x)
 
+/* 3A is converged when the IPA leaves exposure, gain and white balance unchanged for this many frames */
+#define ISP_3A_STABLE_FRAMES        4
+
+#define ISP_3A_STATE_NVS_NAMESPACE  "esp_video"
+#define ISP_3A_STATE_NVS_KEY        "isp_3a_state"
+#define ISP_3A_STATE_VERSION        1
+
+#define ISP_3A_STATE_FLAG_AE        (1 << 0)
+#define ISP_3A_STATE_FLAG_WB        (1 << 1)
+#define ISP_3A_STATE_FLAG_CCM       (1 << 2)
+
+/* Minimum interval between two retries of a failed sensor control cache refresh */
+#define ISP_CTRL_CACHE_RETRY_MS     1000
+
 #define TLINE_NS_UNIT               1000
 #define REG_TO_US(reg, isp)         ((reg) * (isp)->sensor_tline_ns / TLINE_NS_UNIT)
 
+/**
+ * @brief Sensor gain menu entry
+ */
+typedef struct esp_video_isp_gain_entry {
+    int64_t value;                              /*!< Gain menu value */
+    uint32_t index;                             /*!< Gain menu index */
+} esp_video_isp_gain_entry_t;
+
+/**
+ * @brief Sensor control snapshot used by the AE loop, it is refreshed only when the sensor format changes
+ */
+typedef struct esp_video_isp_ctrl_cache {
+    esp_video_isp_gain_entry_t *gain_table;     /*!< Gain menu sorted by value, NULL if gain is an integer control */
+    uint32_t gain_count;                        /*!< Gain menu entry count */
+    int64_t gain_base;                          /*!< Gain value of the minimum index, it means gain 1.0x */
+    int64_t gain_min;                           /*!< Gain control minimum value */
+    int64_t gain_max;                           /*!< Gain control maximum value */
+    uint64_t gain_step;                         /*!< Gain control step */
+
+    int64_t exposure_min;                       /*!< Exposure control minimum value */
+    int64_t exposure_max;                       /*!< Exposure control maximum value */
+    uint64_t exposure_step;                     /*!< Exposure control step */
+
+    uint32_t width;                             /*!< Capture format width when the cache was taken */
+    uint32_t height;                            /*!< Capture format height when the cache was taken */
+    uint32_t pixelformat;                       /*!< Capture format pixel format when the cache was taken */
+
+    bool valid;                                 /*!< All fields above are valid */
+    TickType_t retry_tick;                      /*!< Tick after which a failed refresh may be retried */
+} esp_video_isp_ctrl_cache_t;
+
+/**
+ * @brief Converged 3A state, it is persisted to seed the IPA and the sensor at the next start
+ */
+typedef struct esp_video_isp_3a_state {
+    uint32_t version;                           /*!< Record version, ISP_3A_STATE_VERSION */
+    uint32_t flags;                             /*!< ISP_3A_STATE_FLAG_x of the valid fields */
+
+    uint32_t exposure;                          /*!< Exposure, unit is micro second */
+    float gain;                                 /*!< Sensor gain */
+
+    float red_gain;                             /*!< White balance red gain */
+    float blue_gain;                            /*!< White balance blue gain */
+
+    esp_ipa_ccm_t ccm;                          /*!< Color correction matrix */
+    uint32_t color_temp;                        /*!< Color temperature of the nearest CCM table entry, 0 if unknown */
+} esp_video_isp_3a_state_t;
+
 typedef struct esp_video_isp {
     int isp_fd;
     esp_video_isp_stats_t *isp_stats[ISP_METADATA_BUFFER_COUNT];
@@ -62,6 +133,25 @@ typedef struct esp_video_isp {
     uint32_t prev_exposure_val;
     uint32_t sensor_tline_ns;
 
+    esp_video_isp_ctrl_cache_t ctrl_cache;
+
+    uint32_t frame_ioctls;
+    esp_video_isp_ioctl_stats_t ioctl_stats;
+
+    const esp_ipa_config_t *ipa_config;
+    esp_video_isp_3a_state_t state;
+    esp_video_isp_3a_stats_t state_stats;
+    uint32_t stable_frames;
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE
+    esp_video_isp_3a_state_t saved_state;
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_3A_STATE_SAVE_INTERVAL
+    TaskHandle_t save_task;
+    TaskHandle_t save_exit_waiter;
+    portMUX_TYPE save_lock;
+    esp_video_isp_3a_state_t save_state;
+#endif
+#endif
+
     struct {
         uint8_t gain        : 1;
         uint8_t exposure    : 1;
@@ -215,6 +305,241 @@ static void print_dev_info(int fd)
 #endif
 }
 
+/**
+ * @brief Issue an ioctl command and account it in the per-frame ioctl counter
+ *
+ * @param isp ISP pipeline controller object
+ * @param fd  Video device file description
+ * @param cmd ioctl command
+ * @param arg ioctl argument pointer
+ *
+ * @return Result of ioctl
+ */
+static int isp_ioctl(esp_video_isp_t *isp, int fd, int cmd, void *arg)
+{
+    isp->frame_ioctls++;
+
+    return ioctl(fd, cmd, arg);
+}
+
+/**
+ * @brief Close the ioctl accounting of the last processed frame
+ *
+ * @param isp ISP pipeline controller object
+ *
+ * @return None
+ */
+static void commit_frame_ioctls(esp_video_isp_t *isp)
+{
+    esp_video_isp_ioctl_stats_t *stats = &isp->ioctl_stats;
+
+    if (!isp->frame_ioctls) {
+        return;
+    }
+
+    stats->frames++;
+    stats->last_frame_ioctls = isp->frame_ioctls;
+    stats->max_frame_ioctls = MAX(stats->max_frame_ioctls, isp->frame_ioctls);
+    stats->total_ioctls += isp->frame_ioctls;
+    isp->frame_ioctls = 0;
+}
+
+static int gain_entry_compare(const void *a, const void *b)
+{
+    const esp_video_isp_gain_entry_t *ea = (const esp_video_isp_gain_entry_t *)a;
+    const esp_video_isp_gain_entry_t *eb = (const esp_video_isp_gain_entry_t *)b;
+
+    if (ea->value < eb->value) {
+        return -1;
+    } else if (ea->value > eb->value) {
+        return 1;
+    }
+
+    return 0;
+}
+
+static void free_ctrl_cache(esp_video_isp_t *isp)
+{
+    esp_video_isp_ctrl_cache_t *cache = &isp->ctrl_cache;
+    TickType_t retry_tick = cache->retry_tick;
+
+    /* Invalidate all fields, so that no stale gain base or range is used with a freed gain table */
+    free(cache->gain_table);
+    memset(cache, 0, sizeof(esp_video_isp_ctrl_cache_t));
+    cache->retry_tick = retry_tick;
+}
+
+/**
+ * @brief Snapshot the sensor gain menu, exposure range and exposure step
+ *
+ * @note This issues one VIDIOC_QUERYMENU per gain menu entry, so call it only
+ *       when the pipeline starts or the sensor format changes.
+ *
+ * @param isp ISP pipeline controller object
+ * @param fd  Camera video device file description
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+static esp_err_t refresh_ctrl_cache(esp_video_isp_t *isp, int fd)
+{
+    int ret;
+    struct v4l2_format format;
+    struct v4l2_query_ext_ctrl qctrl;
+    esp_video_isp_ctrl_cache_t *cache = &isp->ctrl_cache;
+
+    free_ctrl_cache(isp);
+
+    if (isp->sensor_attr.gain) {
+        qctrl.id = V4L2_CID_GAIN;
+        ret = isp_ioctl(isp, fd, VIDIOC_QUERY_EXT_CTRL, &qctrl);
+        ESP_RETURN_ON_FALSE(ret == 0, ESP_ERR_NOT_SUPPORTED, TAG, "failed to query gain");
+
+        cache->gain_min = qctrl.minimum;
+        cache->gain_max = qctrl.maximum;
+        cache->gain_step = qctrl.step ? qctrl.step : 1;
+
+        if (qctrl.type == V4L2_CTRL_TYPE_INTEGER_MENU) {
+            uint32_t count = qctrl.maximum - qctrl.minimum + 1;
+            esp_video_isp_gain_entry_t *table;
+
+            table = calloc(count, sizeof(esp_video_isp_gain_entry_t));
+            ESP_RETURN_ON_FALSE(table, ESP_ERR_NO_MEM, TAG, "failed to malloc gain table");
+
+            for (uint32_t i = 0; i < count; i++) {
+                struct v4l2_querymenu qmenu;
+
+                qmenu.id = V4L2_CID_GAIN;
+                qmenu.index = qctrl.minimum + i;
+                if (isp_ioctl(isp, fd, VIDIOC_QUERYMENU, &qmenu)) {
+                    ESP_LOGE(TAG, "failed to query gain menu index=%"PRIu32, qmenu.index);
+                    free(table);
+                    return ESP_ERR_NOT_SUPPORTED;
+                }
+
+                table[i].value = qmenu.value;
+                table[i].index = qmenu.index;
+            }
+
+            cache->gain_base = table[0].value;
+            qsort(table, count, sizeof(esp_video_isp_gain_entry_t), gain_entry_compare);
+
+            cache->gain_table = table;
+            cache->gain_count = count;
+            isp->sensor.max_gain = (float)table[count - 1].value / cache->gain_base;
+        } else {
+            cache->gain_base = qctrl.minimum;
+            isp->sensor.max_gain = (float)qctrl.maximum / qctrl.minimum;
+        }
+    }
+
+    if (isp->sensor_attr.exposure) {
+        esp_cam_sensor_format_t sensor_format;
+
+        qctrl.id = V4L2_CID_EXPOSURE;
+        ret = isp_ioctl(isp, fd, VIDIOC_QUERY_EXT_CTRL, &qctrl);
+        ESP_GOTO_ON_FALSE(ret == 0, ESP_ERR_NOT_SUPPORTED, fail_0, TAG, "failed to query exposure");
+
+        ret = isp_ioctl(isp, fd, VIDIOC_G_SENSOR_FMT, &sensor_format);
+        ESP_GOTO_ON_FALSE(ret == 0, ESP_ERR_NOT_SUPPORTED, fail_0, TAG, "failed to get sensor format");
+
+        cache->exposure_min = qctrl.minimum;
+        cache->exposure_max = qctrl.maximum;
+        cache->exposure_step = qctrl.step ? qctrl.step : 1;
+
+        isp->sensor_tline_ns = sensor_format.isp_info->isp_v1_info.tline_ns;
+        isp->sensor.min_exposure = REG_TO_US(qctrl.minimum, isp);
+        isp->sensor.max_exposure = REG_TO_US(qctrl.maximum, isp);
+        isp->sensor.step_exposure = REG_TO_US(qctrl.step, isp);
+    }
+
+    memset(&format, 0, sizeof(struct v4l2_format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = isp_ioctl(isp, fd, VIDIOC_G_FMT, &format);
+    ESP_GOTO_ON_FALSE(ret == 0, ESP_ERR_NOT_SUPPORTED, fail_0, TAG, "failed to get format");
+
+    cache->width = format.fmt.pix.width;
+    cache->height = format.fmt.pix.height;
+    cache->pixelformat = format.fmt.pix.pixelformat;
+    cache->valid = true;
+    isp->ioctl_stats.cache_refreshes++;
+
+    ESP_LOGD(TAG, "Sensor control cache: gain entries=%"PRIu32", exposure=[%"PRIi64", %"PRIi64"]/%"PRIu64,
+             cache->gain_count, cache->exposure_min, cache->exposure_max, cache->exposure_step);
+
+    return ESP_OK;
+
+fail_0:
+    free_ctrl_cache(isp);
+    return ret;
+}
+
+/**
+ * @brief Map IPA gain to the nearest sensor gain index by the cached gain menu
+ *
+ * @param isp         ISP pipeline controller object
+ * @param gain        IPA gain, 1.0 means the sensor minimum gain
+ * @param target_gain Actual gain of the returned index
+ *
+ * @return Sensor gain index, or -1 if failed
+ */
+static int32_t lookup_gain_index(esp_video_isp_t *isp, float gain, float *target_gain)
+{
+    const esp_video_isp_ctrl_cache_t *cache = &isp->ctrl_cache;
+    int64_t gain_value = (int64_t)(cache->gain_base * gain);
+
+    if (!cache->valid) {
+        return -1;
+    }
+
+    if (!cache->gain_table) {
+        if (!cache->gain_base) {
+            return -1;
+        }
+
+        gain_value = gain_value / (int64_t)cache->gain_step * (int64_t)cache->gain_step;
+        gain_value = MAX(gain_value, cache->gain_min);
+        gain_value = MIN(gain_value, cache->gain_max);
+        *target_gain = (float)gain_value / cache->gain_base;
+
+        return (int32_t)gain_value;
+    }
+
+    const esp_video_isp_gain_entry_t *table = cache->gain_table;
+    uint32_t left = 0;
+    uint32_t right = cache->gain_count;
+
+    /* Find the first entry whose value is not less than the target value */
+    while (left < right) {
+        uint32_t mid = left + (right - left) / 2;
+
+        if (table[mid].value < gain_value) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    const esp_video_isp_gain_entry_t *entry;
+    if (left == 0) {
+        entry = &table[0];
+    } else if (left == cache->gain_count) {
+        entry = &table[cache->gain_count - 1];
+    } else if (table[left].value == gain_value) {
+        entry = &table[left];
+    } else {
+        int64_t left_len = gain_value - table[left - 1].value;
+        int64_t right_len = table[left].value - gain_value;
+
+        entry = left_len > right_len ? &table[left] : &table[left - 1];
+    }
+
+    *target_gain = (float)entry->value / cache->gain_base;
+
+    return (int32_t)entry->index;
+}
+
 static void config_white_balance(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
     struct v4l2_ext_controls controls;
@@ -234,7 +559,7 @@ static void config_white_balance(esp_video_isp_t *isp, esp_ipa_metadata_t *metad
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_WB;
         control[0].p_u8     = (uint8_t *)&wb;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set white balance");
         }
     } else if (rc) {
@@ -243,7 +568,7 @@ static void config_white_balance(esp_video_isp_t *isp, esp_ipa_metadata_t *metad
         controls.controls   = control;
         control[0].id       = V4L2_CID_RED_BALANCE;
         control[0].value    = metadata->red_gain * V4L2_CID_RED_BALANCE_DEN;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set red balance");
         }
     } else if (bg) {
@@ -252,7 +577,7 @@ static void config_white_balance(esp_video_isp_t *isp, esp_ipa_metadata_t *metad
         controls.controls   = control;
         control[0].id       = V4L2_CID_BLUE_BALANCE;
         control[0].value    = metadata->blue_gain * V4L2_CID_BLUE_BALANCE_DEN;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set blue balance");
         }
     }
@@ -278,7 +603,7 @@ static void config_bayer_filter(esp_video_isp_t *isp, esp_ipa_metadata_t *metada
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_BF;
         control[0].p_u8     = (uint8_t *)&bf;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set bayer filter");
         }
     }
@@ -299,7 +624,7 @@ static void config_demosaic(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_DEMOSAIC;
         control[0].p_u8     = (uint8_t *)&demosaic;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set demosaic");
         }
     }
@@ -328,7 +653,7 @@ static void config_sharpen(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_SHARPEN;
         control[0].p_u8     = (uint8_t *)&sharpen;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set sharpen");
         }
     }
@@ -370,7 +695,7 @@ static void config_gamma(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_GAMMA_EXT;
         control[0].p_u8     = (uint8_t *)&gamma;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set GAMMA");
         }
     }
@@ -395,7 +720,7 @@ static void config_ccm(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_CCM;
         control[0].p_u8     = (uint8_t *)&ccm;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set CCM");
         }
     }
@@ -412,7 +737,7 @@ static void config_color(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_BRIGHTNESS;
         control[0].value    = metadata->brightness;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set brightness");
         }
     }
@@ -423,7 +748,7 @@ static void config_color(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_CONTRAST;
         control[0].value    = metadata->contrast;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set contrast");
         }
     }
@@ -434,7 +759,7 @@ static void config_color(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_SATURATION;
         control[0].value    = metadata->saturation;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set saturation");
         }
     }
@@ -445,7 +770,7 @@ static void config_color(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_HUE;
         control[0].value    = metadata->hue;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set hue");
         }
     }
@@ -470,113 +795,13 @@ static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *m
         metadata->flags &= ~IPA_METADATA_FLAGS_ET;
     }
 
-    if (metadata->flags & IPA_METADATA_FLAGS_GN) {
-        int ret;
-        int32_t base_gain;
-        int32_t gain_value;
-        uint32_t cur_index;
-        uint32_t left_index;
-        uint32_t right_index;
-        struct v4l2_querymenu qmenu;
-        struct v4l2_query_ext_ctrl qctrl;
-
-        qctrl.id = V4L2_CID_GAIN;
-        ret = ioctl(isp->cam_fd, VIDIOC_QUERY_EXT_CTRL, &qctrl);
-        if (ret) {
-            ESP_LOGE(TAG, "failed to query gain");
-            return;
-        }
-
-        qmenu.id = V4L2_CID_GAIN;
-        qmenu.index = qctrl.minimum;
-        ret = ioctl(isp->cam_fd, VIDIOC_QUERYMENU, &qmenu);
-        if (ret) {
-            ESP_LOGE(TAG, "failed to query gain min menu");
-            return;
-        }
-
-        gain_value = qmenu.value * metadata->gain;
-        base_gain = qmenu.value;
-        left_index = qctrl.minimum;
-        right_index = qctrl.maximum;
-        cur_index = (left_index + right_index) / 2;
-
-        int max_inter = qctrl.maximum - qctrl.minimum;
-        do {
-            if (max_inter-- <= 0) {
-                ESP_LOGE(TAG, "failed to search target gain");
-                break;
-            }
-
-            ESP_LOGD(TAG, "index:%"PRIu32", left:%"PRIu32", right:%"PRIu32"", cur_index, left_index, right_index);
-
-            qmenu.id = V4L2_CID_GAIN;
-            qmenu.index = cur_index;
-            if (ioctl(isp->cam_fd, VIDIOC_QUERYMENU, &qmenu)) {
-                ESP_LOGE(TAG, "failed to query gain min menu");
-                return;
-            }
-
-            if (gain_value > qmenu.value) {
-                left_index = cur_index;
-                cur_index = (cur_index + right_index) / 2;
-            } else if (gain_value < qmenu.value) {
-                right_index = cur_index;
-                cur_index = (cur_index + left_index) / 2;
-            } else {
-                gain_index = cur_index;
-                target_gain = (float)qmenu.value / base_gain;
-                break;
-            }
-
-            int index_diff = right_index - left_index;
-            if (index_diff == 1) {
-                uint32_t left_gain;
-                uint32_t right_gain;
-                uint32_t left_len;
-                uint32_t right_len;
-
-                qmenu.id = V4L2_CID_GAIN;
-                qmenu.index = left_index;
-                if (ioctl(isp->cam_fd, VIDIOC_QUERYMENU, &qmenu)) {
-                    ESP_LOGE(TAG, "failed to query gain min menu");
-                    return;
-                }
-                left_gain = qmenu.value;
-
-                qmenu.id = V4L2_CID_GAIN;
-                qmenu.index = right_index;
-                if (ioctl(isp->cam_fd, VIDIOC_QUERYMENU, &qmenu)) {
-                    ESP_LOGE(TAG, "failed to query gain min menu");
-                    return;
-                }
-                right_gain = qmenu.value;
-
-                left_len = gain_value - left_gain;
-                right_len = right_gain - gain_value;
-                if (left_len > right_len) {
-                    gain_index = right_index;
-                    target_gain = (float)right_gain / base_gain;
-                } else {
-                    gain_index = left_index;
-                    target_gain = (float)left_gain / base_gain;
-                }
-
-                break;
-            } else if (index_diff == 0) {
-                qmenu.id = V4L2_CID_GAIN;
-                qmenu.index = left_index;
-                if (ioctl(isp->cam_fd, VIDIOC_QUERYMENU, &qmenu)) {
-                    ESP_LOGE(TAG, "failed to query gain min menu");
-                    return;
-                }
-
-                gain_index = left_index;
-                target_gain = (float)qmenu.value / base_gain;
-                break;
-            }
-        } while (1);
+    /* Sensor control cache refresh failed, skip gain and exposure until it is refreshed */
+    if (!isp->ctrl_cache.valid) {
+        metadata->flags &= ~(IPA_METADATA_FLAGS_GN | IPA_METADATA_FLAGS_ET);
+    }
 
+    if (metadata->flags & IPA_METADATA_FLAGS_GN) {
+        gain_index = lookup_gain_index(isp, metadata->gain, &target_gain);
         if (gain_index < 0) {
             ESP_LOGE(TAG, "failed to find gain=%0.4f", metadata->gain);
             return;
@@ -587,23 +812,17 @@ static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *m
 
     uint32_t exposure_val = 0;
     if (metadata->flags & IPA_METADATA_FLAGS_ET) {
-        struct v4l2_query_ext_ctrl qctrl;
+        const esp_video_isp_ctrl_cache_t *cache = &isp->ctrl_cache;
 
-        qctrl.id = V4L2_CID_EXPOSURE;
-        if (ioctl(isp->cam_fd, VIDIOC_QUERY_EXT_CTRL, &qctrl)) {
-            ESP_LOGE(TAG, "failed to query exposure");
+        exposure_val = (uint32_t)((double)metadata->exposure * TLINE_NS_UNIT / isp->sensor_tline_ns + 0.5);
+        exposure_val = exposure_val / cache->exposure_step * cache->exposure_step;
+        exposure_val = MAX(exposure_val, cache->exposure_min);
+        exposure_val = MIN(exposure_val, cache->exposure_max);
+
+        if (exposure_val == isp->prev_exposure_val) {
             metadata->flags &= ~IPA_METADATA_FLAGS_ET;
         } else {
-            exposure_val = (uint32_t)((double)metadata->exposure * TLINE_NS_UNIT / isp->sensor_tline_ns + 0.5);
-            exposure_val = exposure_val / qctrl.step * qctrl.step;
-            exposure_val = MAX(exposure_val, qctrl.minimum);
-            exposure_val = MIN(exposure_val, qctrl.maximum);
-
-            if (exposure_val == isp->prev_exposure_val) {
-                metadata->flags &= ~IPA_METADATA_FLAGS_ET;
-            } else {
-                ESP_LOGD(TAG, "Exposure time: %"PRIu32 " value: %"PRIi32, metadata->exposure, exposure_val);
-            }
+            ESP_LOGD(TAG, "Exposure time: %"PRIu32 " value: %"PRIi32, metadata->exposure, exposure_val);
         }
     }
 
@@ -622,7 +841,7 @@ static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *m
         control[0].id       = V4L2_CID_CAMERA_GROUP;
         control[0].p_u8     = (uint8_t *)&group;
         control[0].size     = sizeof(esp_cam_sensor_gh_exp_gain_t);
-        if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set group");
         } else {
             isp->sensor.cur_exposure = REG_TO_US(exposure_val, isp);
@@ -637,7 +856,7 @@ static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *m
             controls.controls   = control;
             control[0].id       = V4L2_CID_EXPOSURE;
             control[0].value    = exposure_val;
-            if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+            if (isp_ioctl(isp, isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
                 ESP_LOGE(TAG, "failed to set exposure time");
             } else {
                 isp->sensor.cur_exposure = REG_TO_US(exposure_val, isp);
@@ -651,7 +870,7 @@ static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *m
             controls.controls   = control;
             control[0].id       = V4L2_CID_GAIN;
             control[0].value    = gain_index;
-            if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+            if (isp_ioctl(isp, isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
                 ESP_LOGE(TAG, "failed to set pixel gain");
             } else {
                 isp->sensor.cur_gain = target_gain;
@@ -681,7 +900,7 @@ static void config_lsc(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_LSC;
         control[0].p_u8     = (uint8_t *)&lsc;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set LSC");
         }
     }
@@ -700,7 +919,7 @@ static void config_sensor_ae_target_level(esp_video_isp_t *isp, esp_ipa_metadata
         controls.controls   = control;
         control[0].id       = V4L2_CID_CAMERA_AE_LEVEL;
         control[0].value    = metadata->ae_target_level;
-        if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set sensor AE target level");
         } else {
             isp->sensor.cur_ae_target_level = metadata->ae_target_level;
@@ -730,7 +949,7 @@ static void config_awb(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_AWB;
         control[0].p_u8     = (uint8_t *)&awb;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set AWB");
         }
     }
@@ -748,7 +967,7 @@ static void config_statistics_region(esp_video_isp_t *isp, esp_ipa_metadata_t *m
         selection.r.width = sr->width;
         selection.r.top = sr->top;
         selection.r.height = sr->height;
-        if (ioctl(isp->isp_fd, VIDIOC_S_SELECTION, &selection) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_SELECTION, &selection) != 0) {
             ESP_LOGE(TAG, "failed to set selection");
         }
     }
@@ -772,7 +991,7 @@ static void config_af(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_AF;
         control[0].p_u8     = (uint8_t *)&af;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set AF");
         }
     }
@@ -790,7 +1009,7 @@ static void config_motor_position(esp_video_isp_t *isp, esp_ipa_metadata_t *meta
         controls.controls   = control;
         control[0].id       = V4L2_CID_FOCUS_ABSOLUTE;
         control[0].value    = metadata->focus_pos;
-        if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set motor position");
             isp->focus_info.start_time = 0;
         } else {
@@ -802,7 +1021,7 @@ static void config_motor_position(esp_video_isp_t *isp, esp_ipa_metadata_t *meta
             control[0].id       = V4L2_CID_MOTOR_START_TIME;
             control[0].p_u8     = (uint8_t *)&strat_time;
             control[0].size     = sizeof(strat_time);
-            if (ioctl(isp->cam_fd, VIDIOC_G_EXT_CTRLS, &controls) != 0) {
+            if (isp_ioctl(isp, isp->cam_fd, VIDIOC_G_EXT_CTRLS, &controls) != 0) {
                 ESP_LOGE(TAG, "failed to get motor start time");
                 isp->focus_info.start_time = 0;
             } else {
@@ -835,7 +1054,7 @@ static void config_blc(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
         controls.controls   = control;
         control[0].id       = V4L2_CID_USER_ESP_ISP_BLC;
         control[0].p_u8     = (uint8_t *)&blc;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set BLC");
         }
     }
@@ -871,6 +1090,345 @@ static void config_isp_and_camera(esp_video_isp_t *isp, esp_ipa_metadata_t *meta
 #endif
 }
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE
+/**
+ * @brief Get the color temperature of the CCM table entry nearest to the CCM
+ *
+ * @param isp ISP pipeline controller object
+ * @param ccm Color correction matrix
+ *
+ * @return Color temperature, 0 if there is no CCM table
+ */
+static uint32_t lookup_color_temp(esp_video_isp_t *isp, const esp_ipa_ccm_t *ccm)
+{
+    uint32_t color_temp = 0;
+    float min_dist = INFINITY;
+    const esp_ipa_acc_config_t *acc = isp->ipa_config->acc;
+
+    if (!acc || !acc->ccm || !acc->ccm->ccm_table) {
+        return 0;
+    }
+
+    for (uint32_t n = 0; n < acc->ccm->ccm_table_size; n++) {
+        const esp_ipa_acc_ccm_unit_t *unit = &acc->ccm->ccm_table[n];
+        float dist = 0.0;
+
+        for (int i = 0; i < ISP_CCM_DIMENSION; i++) {
+            for (int j = 0; j < ISP_CCM_DIMENSION; j++) {
+                float d = unit->ccm.matrix[i][j] - ccm->matrix[i][j];
+
+                dist += d * d;
+            }
+        }
+
+        if (dist < min_dist) {
+            min_dist = dist;
+            color_temp = unit->color_temp;
+        }
+    }
+
+    return color_temp;
+}
+
+/**
+ * @brief Load the 3A state persisted by the last run
+ *
+ * @param state 3A state buffer pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if there is no valid 3A state
+ */
+static esp_err_t load_3a_state(esp_video_isp_3a_state_t *state)
+{
+    esp_err_t ret;
+    nvs_handle_t handle;
+    size_t size = sizeof(esp_video_isp_3a_state_t);
+
+    ret = nvs_open(ISP_3A_STATE_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        /* The namespace is created by the first save */
+        return ret;
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "failed to open NVS namespace");
+    ret = nvs_get_blob(handle, ISP_3A_STATE_NVS_KEY, state, &size);
+    nvs_close(handle);
+    if (ret == ESP_OK && (size != sizeof(esp_video_isp_3a_state_t) || state->version != ISP_3A_STATE_VERSION)) {
+        ret = ESP_ERR_INVALID_VERSION;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Check if the 3A state is worth persisting
+ *
+ * @param isp ISP pipeline controller object
+ *
+ * @return true if 3A has converged and the state has valid fields
+ */
+static bool is_3a_state_savable(const esp_video_isp_t *isp)
+{
+    /* A state in the middle of converging is a worse seed than the one of the last run */
+    return isp->state_stats.converge_frames && isp->state.flags;
+}
+
+/**
+ * @brief Persist the 3A state, the state is not written if it has not changed since the last write
+ *
+ * @param isp   ISP pipeline controller object
+ * @param state 3A state to persist, its color temperature is updated
+ *
+ * @return None
+ */
+static void save_3a_state(esp_video_isp_t *isp, esp_video_isp_3a_state_t *state)
+{
+    esp_err_t ret;
+    nvs_handle_t handle;
+
+    if (state->flags & ISP_3A_STATE_FLAG_CCM) {
+        state->color_temp = lookup_color_temp(isp, &state->ccm);
+    }
+
+    /* Avoid wearing the flash by writing the same state */
+    if (!memcmp(&isp->saved_state, state, sizeof(esp_video_isp_3a_state_t))) {
+        return;
+    }
+
+    ret = nvs_open(ISP_3A_STATE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, ISP_3A_STATE_NVS_KEY, state, sizeof(esp_video_isp_3a_state_t));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+
+    if (ret == ESP_OK) {
+        memcpy(&isp->saved_state, state, sizeof(esp_video_isp_3a_state_t));
+        isp->state_stats.saves++;
+        ESP_LOGD(TAG, "3A state saved: exposure=%"PRIu32" gain=%0.4f R=%0.4f B=%0.4f CT=%"PRIu32,
+                 state->exposure, state->gain, state->red_gain, state->blue_gain, state->color_temp);
+    } else {
+        ESP_LOGW(TAG, "failed to save 3A state: %s", esp_err_to_name(ret));
+    }
+}
+
+/**
+ * @brief Seed the sensor information given to the IPA with the 3A state persisted by the last run
+ *
+ * @param isp ISP pipeline controller object
+ *
+ * @return None
+ */
+static void restore_3a_state(esp_video_isp_t *isp)
+{
+    esp_video_isp_3a_state_t *state = &isp->saved_state;
+
+    esp_err_t ret = load_3a_state(state);
+    if (ret != ESP_OK) {
+        if (ret == ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGD(TAG, "no 3A state to restore");
+        } else {
+            ESP_LOGW(TAG, "failed to restore 3A state: %s", esp_err_to_name(ret));
+        }
+        memset(state, 0, sizeof(esp_video_isp_3a_state_t));
+        return;
+    }
+
+    /* The sensor may be different from the last run, keep the seed in the range of this sensor */
+    if (state->flags & ISP_3A_STATE_FLAG_AE) {
+        if (isp->sensor_attr.exposure) {
+            isp->sensor.cur_exposure = MIN(MAX(state->exposure, isp->sensor.min_exposure), isp->sensor.max_exposure);
+        }
+        if (isp->sensor_attr.gain) {
+            isp->sensor.cur_gain = MIN(MAX(state->gain, isp->sensor.min_gain), isp->sensor.max_gain);
+        }
+    }
+
+    isp->state_stats.restored = true;
+    ESP_LOGI(TAG, "3A state restored: exposure=%"PRIu32" gain=%0.4f R=%0.4f B=%0.4f CT=%"PRIu32,
+             isp->sensor.cur_exposure, isp->sensor.cur_gain, state->red_gain, state->blue_gain, state->color_temp);
+}
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_3A_STATE_SAVE_INTERVAL
+/**
+ * @brief Persist the 3A state snapshots taken by the 3A task, in a low priority task
+ *
+ * @param p ISP pipeline controller object
+ *
+ * @return None
+ */
+static void isp_3a_save_task(void *p)
+{
+    esp_video_isp_t *isp = (esp_video_isp_t *)p;
+    esp_video_isp_3a_state_t state;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (isp->save_exit_waiter) {
+            break;
+        }
+
+        portENTER_CRITICAL(&isp->save_lock);
+        memcpy(&state, &isp->save_state, sizeof(esp_video_isp_3a_state_t));
+        portEXIT_CRITICAL(&isp->save_lock);
+
+        save_3a_state(isp, &state);
+    }
+
+    xTaskNotifyGive(isp->save_exit_waiter);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Hand a snapshot of the 3A state to the save task, the 3A task never waits for the flash write
+ *
+ * @param isp ISP pipeline controller object
+ *
+ * @return None
+ */
+static void request_3a_state_save(esp_video_isp_t *isp)
+{
+    if (!isp->save_task || !is_3a_state_savable(isp)) {
+        return;
+    }
+
+    portENTER_CRITICAL(&isp->save_lock);
+    memcpy(&isp->save_state, &isp->state, sizeof(esp_video_isp_3a_state_t));
+    portEXIT_CRITICAL(&isp->save_lock);
+
+    xTaskNotifyGive(isp->save_task);
+}
+
+/**
+ * @brief Stop the save task, a save in progress is completed first
+ *
+ * @param isp ISP pipeline controller object
+ *
+ * @return None
+ */
+static void stop_3a_save_task(esp_video_isp_t *isp)
+{
+    if (!isp->save_task) {
+        return;
+    }
+
+    isp->save_exit_waiter = xTaskGetCurrentTaskHandle();
+    xTaskNotifyGive(isp->save_task);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    isp->save_task = NULL;
+}
+#endif /* CONFIG_ESP_VIDEO_ISP_PIPELINE_3A_STATE_SAVE_INTERVAL */
+
+/**
+ * @brief Replace the initialization meta data of the IPA with the restored 3A state
+ *
+ * @note The IPA has no interface to seed its internal AWB state, so the restored white balance
+ *       gains and CCM only apply to the frames before the IPA outputs its own white balance.
+ *       The restored exposure and gain seed AE through the sensor information instead.
+ *
+ * @param isp      ISP pipeline controller object
+ * @param metadata Initialization meta data calculated by the IPA
+ *
+ * @return None
+ */
+static void seed_3a_metadata(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+{
+    const esp_video_isp_3a_state_t *state = &isp->saved_state;
+
+    if (!isp->state_stats.restored) {
+        return;
+    }
+
+    if (state->flags & ISP_3A_STATE_FLAG_AE) {
+        metadata->exposure = isp->sensor.cur_exposure;
+        metadata->gain = isp->sensor.cur_gain;
+        metadata->flags |= IPA_METADATA_FLAGS_ET | IPA_METADATA_FLAGS_GN;
+    }
+
+    if (state->flags & ISP_3A_STATE_FLAG_WB) {
+        metadata->red_gain = state->red_gain;
+        metadata->blue_gain = state->blue_gain;
+        metadata->flags |= IPA_METADATA_FLAGS_RG | IPA_METADATA_FLAGS_BG;
+    }
+
+    if (state->flags & ISP_3A_STATE_FLAG_CCM) {
+        memcpy(&metadata->ccm, &state->ccm, sizeof(esp_ipa_ccm_t));
+        metadata->flags |= IPA_METADATA_FLAGS_CCM;
+    }
+}
+#endif /* CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE */
+
+/**
+ * @brief Update the 3A state with the meta data applied to the ISP and the sensor
+ *
+ * @param isp      ISP pipeline controller object
+ * @param metadata Meta data applied by config_isp_and_camera
+ *
+ * @return None
+ */
+static void update_3a_state(esp_video_isp_t *isp, const esp_ipa_metadata_t *metadata)
+{
+    esp_video_isp_3a_state_t *state = &isp->state;
+
+    if (isp->sensor_attr.exposure || isp->sensor_attr.gain) {
+        state->exposure = isp->sensor.cur_exposure;
+        state->gain = isp->sensor.cur_gain;
+        state->flags |= ISP_3A_STATE_FLAG_AE;
+    }
+
+    /* White balance of the sensor with built-in ISP is not applied by the controller */
+    if (!isp->sensor_attr.awb) {
+        if (metadata->flags & IPA_METADATA_FLAGS_RG) {
+            state->red_gain = metadata->red_gain;
+        }
+        if (metadata->flags & IPA_METADATA_FLAGS_BG) {
+            state->blue_gain = metadata->blue_gain;
+        }
+        if ((metadata->flags & IPA_METADATA_FLAGS_RG) && (metadata->flags & IPA_METADATA_FLAGS_BG)) {
+            state->flags |= ISP_3A_STATE_FLAG_WB;
+        }
+    }
+
+    if (metadata->flags & IPA_METADATA_FLAGS_CCM) {
+        memcpy(&state->ccm, &metadata->ccm, sizeof(esp_ipa_ccm_t));
+        state->flags |= ISP_3A_STATE_FLAG_CCM;
+    }
+}
+
+/**
+ * @brief Count the frames to 3A convergence
+ *
+ * @param isp      ISP pipeline controller object
+ * @param metadata Meta data applied by config_isp_and_camera
+ *
+ * @return None
+ */
+static void check_3a_convergence(esp_video_isp_t *isp, const esp_ipa_metadata_t *metadata)
+{
+    esp_video_isp_3a_stats_t *stats = &isp->state_stats;
+    uint32_t changes = IPA_METADATA_FLAGS_ET | IPA_METADATA_FLAGS_GN;
+
+    stats->frames++;
+    if (stats->converge_frames) {
+        return;
+    }
+
+    if (!isp->sensor_attr.awb) {
+        changes |= IPA_METADATA_FLAGS_RG | IPA_METADATA_FLAGS_BG;
+    }
+
+    /* config_exposure_and_gain clears the exposure and gain flags if the sensor registers are not changed */
+    if (metadata->flags & changes) {
+        isp->stable_frames = 0;
+    } else if (++isp->stable_frames >= ISP_3A_STABLE_FRAMES) {
+        stats->converge_frames = stats->frames - ISP_3A_STABLE_FRAMES + 1;
+        ESP_LOGI(TAG, "3A converged in %"PRIu32" frames from %s state", stats->converge_frames,
+                 stats->restored ? "restored" : "default");
+    }
+}
+
 static void isp_stats_to_ipa_stats(esp_video_isp_stats_t *isp_stat, esp_ipa_stats_t *ipa_stats)
 {
     ipa_stats->flags = 0;
@@ -958,10 +1516,26 @@ static void get_sensor_state(esp_video_isp_t *isp, int index)
 
     memset(&format, 0, sizeof(struct v4l2_format));
     format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    ret = ioctl(isp->cam_fd, VIDIOC_G_FMT, &format);
+    ret = isp_ioctl(isp, isp->cam_fd, VIDIOC_G_FMT, &format);
     if (ret == 0) {
+        const esp_video_isp_ctrl_cache_t *cache = &isp->ctrl_cache;
+
         isp->sensor.width = format.fmt.pix.width;
         isp->sensor.height = format.fmt.pix.height;
+
+        bool changed = !cache->valid ||
+                       (cache->width != format.fmt.pix.width) ||
+                       (cache->height != format.fmt.pix.height) ||
+                       (cache->pixelformat != format.fmt.pix.pixelformat);
+
+        /* Retry a failed refresh at most once per ISP_CTRL_CACHE_RETRY_MS instead of every frame */
+        if (changed && ((int32_t)(xTaskGetTickCount() - cache->retry_tick) >= 0)) {
+            ESP_LOGD(TAG, "sensor format changed, refresh control cache");
+            if (refresh_ctrl_cache(isp, isp->cam_fd) != ESP_OK) {
+                ESP_LOGE(TAG, "failed to refresh sensor control cache");
+                isp->ctrl_cache.retry_tick = xTaskGetTickCount() + pdMS_TO_TICKS(ISP_CTRL_CACHE_RETRY_MS);
+            }
+        }
     }
 
     if (isp->sensor_attr.stats) {
@@ -975,7 +1549,7 @@ static void get_sensor_state(esp_video_isp_t *isp, int index)
         control[0].id       = V4L2_CID_CAMERA_STATS;
         control[0].p_u8     = (uint8_t *)&sensor_stats;
         control[0].size     = sizeof(sensor_stats);
-        ret = ioctl(isp->cam_fd, VIDIOC_G_EXT_CTRLS, &controls);
+        ret = isp_ioctl(isp, isp->cam_fd, VIDIOC_G_EXT_CTRLS, &controls);
         if (ret == 0) {
             if (isp->sensor_stats_seq != sensor_stats.seq) {
                 if (sensor_stats.flags & ESP_CAM_SENSOR_STATS_FLAG_AGC_GAIN) {
@@ -1012,10 +1586,12 @@ static void isp_task(void *p)
     esp_video_isp_t *isp = (esp_video_isp_t *)p;
 
     while (1) {
+        commit_frame_ioctls(isp);
+
         memset(&buf, 0, sizeof(buf));
         buf.type   = V4L2_BUF_TYPE_META_CAPTURE;
         buf.memory = V4L2_MEMORY_MMAP;
-        if (ioctl(isp->isp_fd, VIDIOC_DQBUF, &buf) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_DQBUF, &buf) != 0) {
             ESP_LOGE(TAG, "failed to receive video frame");
             continue;
         }
@@ -1023,7 +1599,7 @@ static void isp_task(void *p)
         get_sensor_state(isp, buf.index);
 
         isp_stats_to_ipa_stats(isp->isp_stats[buf.index], &isp->ipa_stats);
-        if (ioctl(isp->isp_fd, VIDIOC_QBUF, &buf) != 0) {
+        if (isp_ioctl(isp, isp->isp_fd, VIDIOC_QBUF, &buf) != 0) {
             ESP_LOGE(TAG, "failed to queue video frame");
         }
         print_stats_info(&isp->ipa_stats);
@@ -1036,6 +1612,14 @@ static void isp_task(void *p)
         }
 
         config_isp_and_camera(isp, &isp->metadata);
+        update_3a_state(isp, &isp->metadata);
+        check_3a_convergence(isp, &isp->metadata);
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE && CONFIG_ESP_VIDEO_ISP_PIPELINE_3A_STATE_SAVE_INTERVAL
+        if (!(isp->state_stats.frames % CONFIG_ESP_VIDEO_ISP_PIPELINE_3A_STATE_SAVE_INTERVAL)) {
+            request_3a_state_save(isp);
+        }
+#endif
     }
 
     vTaskDelete(NULL);
@@ -1282,6 +1866,8 @@ static esp_err_t init_cam_dev(const esp_video_isp_config_t *config, esp_video_is
         isp->sensor.height = format.fmt.pix.height;
     }
 
+    ESP_GOTO_ON_ERROR(refresh_ctrl_cache(isp, fd), fail_0, TAG, "failed to cache sensor controls");
+
     isp->cam_fd = fd;
 
     return ESP_OK;
@@ -1373,10 +1959,23 @@ esp_err_t esp_video_isp_pipeline_init(const esp_video_isp_config_t *config)
     ESP_GOTO_ON_ERROR(init_cam_dev(config, isp), fail_1, TAG, "failed to initialize camera device");
     ESP_GOTO_ON_ERROR(init_isp_dev(config, isp), fail_2, TAG, "failed to initialize ISP device");
 
+    isp->ipa_config = config->ipa_config;
+    isp->state.version = ISP_3A_STATE_VERSION;
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE
+    restore_3a_state(isp);
+#endif
+
     metadata.flags = 0;
     ESP_GOTO_ON_ERROR(esp_ipa_pipeline_init(isp->ipa_pipeline, &isp->sensor, &metadata),
                       fail_3, TAG, "failed to initialize IPA pipeline");
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE
+    seed_3a_metadata(isp, &metadata);
+#endif
     config_isp_and_camera(isp, &metadata);
+    update_3a_state(isp, &metadata);
+
+    /* Only account ioctls issued by the per-frame path */
+    isp->frame_ioctls = 0;
 
     /**
      * If CONFIG_ISP_PIPELINE_CONTROLLER_TASK_STACK_USE_PSRAM is enabled, the ISP controller task stack
@@ -1402,6 +2001,15 @@ esp_err_t esp_video_isp_pipeline_init(const esp_video_isp_config_t *config)
                       ESP_ERR_NO_MEM, fail_3, TAG, "failed to create ISP task");
 #endif
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE && CONFIG_ESP_VIDEO_ISP_PIPELINE_3A_STATE_SAVE_INTERVAL
+    portMUX_INITIALIZE(&isp->save_lock);
+    if (xTaskCreate(isp_3a_save_task, ISP_3A_SAVE_TASK_NAME, ISP_3A_SAVE_TASK_STACK_SIZE, isp,
+                    ISP_3A_SAVE_TASK_PRIORITY, &isp->save_task) != pdPASS) {
+        ESP_LOGW(TAG, "failed to create 3A state save task, only save 3A state when stopping");
+        isp->save_task = NULL;
+    }
+#endif
+
     s_esp_video_isp = isp;
     return ESP_OK;
 
@@ -1414,6 +2022,7 @@ fail_4:
 fail_3:
     close(isp->isp_fd);
 fail_2:
+    free_ctrl_cache(isp);
     close(isp->cam_fd);
 fail_1:
     esp_ipa_pipeline_destroy(isp->ipa_pipeline);
@@ -1450,9 +2059,19 @@ esp_err_t esp_video_isp_pipeline_deinit(void)
     heap_caps_free(isp->task_stack_ptr);
 #endif
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_3A_STATE_SAVE_INTERVAL
+    stop_3a_save_task(isp);
+#endif
+    if (is_3a_state_savable(isp)) {
+        save_3a_state(isp, &isp->state);
+    }
+#endif
+
     ESP_RETURN_ON_FALSE(close(isp->isp_fd) == 0, ESP_FAIL, TAG, "failed to close ISP");
     ESP_RETURN_ON_FALSE(close(isp->cam_fd) == 0, ESP_FAIL, TAG, "failed to close camera sensor");
     ESP_RETURN_ON_ERROR(esp_ipa_pipeline_destroy(isp->ipa_pipeline), TAG, "failed to destroy pipeline");
+    free_ctrl_cache(isp);
     free(isp);
     s_esp_video_isp = NULL;
 
@@ -1470,3 +2089,41 @@ bool esp_video_isp_pipeline_is_initialized(void)
 {
     return s_esp_video_isp != NULL;
 }
+
+/**
+ * @brief Get ISP pipeline controller ioctl statistics.
+ *
+ * @param stats ISP pipeline controller ioctl statistics buffer pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_get_ioctl_stats(esp_video_isp_ioctl_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "stats is NULL");
+    ESP_RETURN_ON_FALSE(s_esp_video_isp, ESP_ERR_INVALID_STATE, TAG, "ISP controller is not initialized");
+
+    memcpy(stats, &s_esp_video_isp->ioctl_stats, sizeof(esp_video_isp_ioctl_stats_t));
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Get ISP pipeline controller 3A convergence statistics.
+ *
+ * @param stats ISP pipeline controller 3A convergence statistics buffer pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_get_3a_stats(esp_video_isp_3a_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "stats is NULL");
+    ESP_RETURN_ON_FALSE(s_esp_video_isp, ESP_ERR_INVALID_STATE, TAG, "ISP controller is not initialized");
+
+    memcpy(stats, &s_esp_video_isp->state_stats, sizeof(esp_video_isp_3a_stats_t));
+
+    return ESP_OK;
+}
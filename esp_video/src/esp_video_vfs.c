@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -13,13 +13,53 @@
 #include <sys/lock.h>
 #include <sys/errno.h>
 #include <sys/param.h>
+#include <sys/queue.h>
 #include "linux/videodev2.h"
 #include "esp_log.h"
+#include "esp_attr.h"
 #include "esp_vfs.h"
 #include "esp_vfs_dev.h"
 #include "esp_video_vfs.h"
 #include "esp_video_ioctl_internal.h"
 
+/**
+ * @brief Video device file description, one is taken by every open() call.
+ */
+typedef struct esp_video_file {
+    struct esp_video *video;                    /*!< Video object, NULL if the file description is free */
+    int flags;                                  /*!< File status flags, only O_NONBLOCK is kept */
+} esp_video_file_t;
+
+/**
+ * All video devices share one file description table, so that the local file description of
+ * a video device file is unique, and select() can find the video object by it.
+ */
+static esp_video_file_t s_video_files[CONFIG_ESP_VIDEO_VFS_MAX_FILES];
+static portMUX_TYPE s_file_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+/**
+ * @brief Video device select() context, one is created for every select() call.
+ */
+typedef struct esp_video_select_args {
+    SLIST_ENTRY(esp_video_select_args) node;    /*!< List node */
+
+    esp_vfs_select_sem_t sem;                   /*!< Semaphore to wake up select() */
+    bool triggered;                             /*!< select() has been woken up */
+
+    fd_set *readfds;                            /*!< Returned readable file descriptions */
+    fd_set *writefds;                           /*!< Returned writable file descriptions */
+    fd_set *errorfds;                           /*!< Returned error file descriptions */
+
+    fd_set readfds_orig;                        /*!< File descriptions to wait for readable */
+    fd_set writefds_orig;                       /*!< File descriptions to wait for writable */
+    fd_set errorfds_orig;                       /*!< File descriptions to wait for error */
+} esp_video_select_args_t;
+
+static SLIST_HEAD(esp_video_select_list, esp_video_select_args) s_select_list = SLIST_HEAD_INITIALIZER(s_select_list);
+static portMUX_TYPE s_select_lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
 static int esp_err_to_errno(esp_err_t err)
 {
     switch (err) {
@@ -33,9 +73,11 @@ static int esp_err_to_errno(esp_err_t err)
         errno = EINVAL;
         return -1;
     case ESP_ERR_INVALID_STATE:
-    case ESP_ERR_NOT_FINISHED:
         errno = EBUSY;
         return -1;
+    case ESP_ERR_NOT_FINISHED:
+        errno = EAGAIN;
+        return -1;
     case ESP_ERR_NOT_FOUND:
         errno = ENODEV;
         return -1;
@@ -51,8 +93,25 @@ static int esp_err_to_errno(esp_err_t err)
     }
 }
 
+/**
+ * @brief Get the video device file by its local file description.
+ *
+ * @param fd Local file description
+ *
+ * @return Video device file pointer, NULL if the file description is not open
+ */
+static inline esp_video_file_t *esp_video_vfs_get_file(int fd)
+{
+    if ((fd < 0) || (fd >= CONFIG_ESP_VIDEO_VFS_MAX_FILES) || !s_video_files[fd].video) {
+        return NULL;
+    }
+
+    return &s_video_files[fd];
+}
+
 static int esp_video_vfs_open(void *ctx, const char *path, int flags, int mode)
 {
+    int fd = -1;
     esp_err_t ret;
     struct esp_video *video = (struct esp_video *)ctx;
 
@@ -63,7 +122,24 @@ static int esp_video_vfs_open(void *ctx, const char *path, int flags, int mode)
         return esp_err_to_errno(ret);
     }
 
-    return video->id;
+    portENTER_CRITICAL(&s_file_lock);
+    for (int i = 0; i < CONFIG_ESP_VIDEO_VFS_MAX_FILES; i++) {
+        if (!s_video_files[i].video) {
+            s_video_files[i].video = video;
+            s_video_files[i].flags = flags & O_NONBLOCK;
+            fd = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_file_lock);
+
+    if (fd < 0) {
+        esp_video_close(video);
+        errno = ENFILE;
+        return -1;
+    }
+
+    return fd;
 }
 
 static ssize_t esp_video_vfs_write(void *ctx, int fd, const void *data, size_t size)
@@ -106,12 +182,22 @@ static int esp_video_vfs_close(void *ctx, int fd)
 {
     esp_err_t ret;
     struct esp_video *video = (struct esp_video *)ctx;
+    esp_video_file_t *file = esp_video_vfs_get_file(fd);
 
-    assert(fd >= 0);
     assert(video);
 
+    if (!file) {
+        errno = EBADF;
+        return -1;
+    }
+
     ret = esp_video_close(video);
 
+    portENTER_CRITICAL(&s_file_lock);
+    file->video = NULL;
+    file->flags = 0;
+    portEXIT_CRITICAL(&s_file_lock);
+
     return esp_err_to_errno(ret);
 }
 
@@ -119,13 +205,22 @@ static int esp_video_vfs_fcntl(void *ctx, int fd, int cmd, int arg)
 {
     int ret;
     struct esp_video *video = (struct esp_video *)ctx;
+    esp_video_file_t *file = esp_video_vfs_get_file(fd);
 
-    assert(fd >= 0);
     assert(video);
 
+    if (!file) {
+        errno = EBADF;
+        return -1;
+    }
+
     switch (cmd) {
     case F_GETFL:
-        ret = O_RDONLY;
+        ret = O_RDONLY | file->flags;
+        break;
+    case F_SETFL:
+        file->flags = arg & O_NONBLOCK;
+        ret = 0;
         break;
     default:
         ret = -1;
@@ -150,15 +245,204 @@ static int esp_video_vfs_ioctl(void *ctx, int fd, int cmd, va_list args)
 {
     esp_err_t ret;
     struct esp_video *video = (struct esp_video *)ctx;
+    esp_video_file_t *file = esp_video_vfs_get_file(fd);
 
-    assert(fd >= 0);
     assert(video);
 
-    ret = esp_video_ioctl(video, cmd, args);
+    if (!file) {
+        errno = EBADF;
+        return -1;
+    }
+
+    ret = esp_video_ioctl(video, file->flags, cmd, args);
 
     return esp_err_to_errno(ret);
 }
 
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+/**
+ * @brief Check the video device events which select() waits for, this must be called with s_select_lock held.
+ *
+ * @param args  Video device select() context
+ * @param fd    Local file description
+ * @param video Video object
+ *
+ * @return true if select() should be woken up
+ */
+static bool IRAM_ATTR esp_video_vfs_select_check_fd(esp_video_select_args_t *args, int fd, struct esp_video *video)
+{
+    bool ready = false;
+
+    if (FD_ISSET(fd, &args->readfds_orig) || FD_ISSET(fd, &args->writefds_orig)) {
+        uint32_t events = esp_video_poll(video);
+
+        if (FD_ISSET(fd, &args->readfds_orig) && (events & ESP_VIDEO_POLL_READABLE)) {
+            FD_SET(fd, args->readfds);
+            ready = true;
+        }
+
+        if (FD_ISSET(fd, &args->writefds_orig) && (events & ESP_VIDEO_POLL_WRITABLE)) {
+            FD_SET(fd, args->writefds);
+            ready = true;
+        }
+    }
+
+    return ready;
+}
+
+/**
+ * @brief Check the events of all files of a video device which select() waits for, this must be
+ *        called with s_select_lock held.
+ *
+ * @param args  Video device select() context
+ * @param video Video object
+ *
+ * @return true if select() should be woken up
+ */
+static bool IRAM_ATTR esp_video_vfs_select_check(esp_video_select_args_t *args, struct esp_video *video)
+{
+    bool ready = false;
+
+    for (int fd = 0; fd < CONFIG_ESP_VIDEO_VFS_MAX_FILES; fd++) {
+        if ((s_video_files[fd].video == video) && esp_video_vfs_select_check_fd(args, fd, video)) {
+            ready = true;
+        }
+    }
+
+    return ready;
+}
+
+/**
+ * @brief Wake up the select() calls which are waiting for the video device.
+ *
+ * @note This function can be called in ISR.
+ *
+ * @param video Video object
+ *
+ * @return None
+ */
+void IRAM_ATTR esp_video_vfs_select_notify(struct esp_video *video)
+{
+    bool in_isr = xPortInIsrContext();
+    BaseType_t wakeup = pdFALSE;
+
+    if (SLIST_EMPTY(&s_select_list)) {
+        return;
+    }
+
+    /**
+     * Semaphore can't be given in the critical section of a task, so wake
+     * up one select() call each time and mark it to skip it next time.
+     */
+
+    while (1) {
+        esp_video_select_args_t *args;
+        esp_video_select_args_t *ready_args = NULL;
+
+        portENTER_CRITICAL_SAFE(&s_select_lock);
+        SLIST_FOREACH(args, &s_select_list, node) {
+            if (!args->triggered && esp_video_vfs_select_check(args, video)) {
+                args->triggered = true;
+                ready_args = args;
+                break;
+            }
+        }
+        portEXIT_CRITICAL_SAFE(&s_select_lock);
+
+        if (!ready_args) {
+            break;
+        }
+
+        if (in_isr) {
+            esp_vfs_select_triggered_isr(ready_args->sem, &wakeup);
+        } else {
+            esp_vfs_select_triggered(ready_args->sem);
+        }
+    }
+
+    if (wakeup == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static esp_err_t esp_video_vfs_start_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
+        esp_vfs_select_sem_t select_sem, void **end_select_args)
+{
+    bool ready = false;
+    esp_video_select_args_t *args;
+
+    args = calloc(1, sizeof(esp_video_select_args_t));
+    if (!args) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    args->sem = select_sem;
+    args->readfds = readfds;
+    args->writefds = writefds;
+    args->errorfds = exceptfds;
+    args->readfds_orig = *readfds;
+    args->writefds_orig = *writefds;
+    args->errorfds_orig = *exceptfds;
+
+    /* All video devices share one file description table, so a local file description maps to one video object */
+
+    for (int fd = 0; fd < FD_SETSIZE; fd++) {
+        if (FD_ISSET(fd, readfds) || FD_ISSET(fd, writefds) || FD_ISSET(fd, exceptfds)) {
+            if (!esp_video_vfs_get_file(fd)) {
+                free(args);
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+
+    FD_ZERO(readfds);
+    FD_ZERO(writefds);
+    FD_ZERO(exceptfds);
+
+    portENTER_CRITICAL(&s_select_lock);
+    SLIST_INSERT_HEAD(&s_select_list, args, node);
+    portEXIT_CRITICAL(&s_select_lock);
+
+    /* Some events may already be pending before select() is called */
+
+    for (int fd = 0; fd < FD_SETSIZE; fd++) {
+        if (FD_ISSET(fd, &args->readfds_orig) || FD_ISSET(fd, &args->writefds_orig)) {
+            struct esp_video *video = s_video_files[fd].video;
+
+            portENTER_CRITICAL(&s_select_lock);
+            if (!args->triggered && esp_video_vfs_select_check_fd(args, fd, video)) {
+                args->triggered = true;
+                ready = true;
+            }
+            portEXIT_CRITICAL(&s_select_lock);
+        }
+    }
+
+    if (ready) {
+        esp_vfs_select_triggered(args->sem);
+    }
+
+    *end_select_args = args;
+
+    return ESP_OK;
+}
+
+static esp_err_t esp_video_vfs_end_select(void *end_select_args)
+{
+    esp_video_select_args_t *args = (esp_video_select_args_t *)end_select_args;
+
+    if (args) {
+        portENTER_CRITICAL(&s_select_lock);
+        SLIST_REMOVE(&s_select_list, args, esp_video_select_args, node);
+        portEXIT_CRITICAL(&s_select_lock);
+
+        free(args);
+    }
+
+    return ESP_OK;
+}
+#endif
+
 static const esp_vfs_t s_esp_video_vfs = {
     .flags   = ESP_VFS_FLAG_CONTEXT_PTR,
     .open_p  = esp_video_vfs_open,
@@ -168,7 +452,11 @@ static const esp_vfs_t s_esp_video_vfs = {
     .fcntl_p = esp_video_vfs_fcntl,
     .fsync_p = esp_video_vfs_fsync,
     .fstat_p = esp_video_vfs_fstat,
-    .ioctl_p = esp_video_vfs_ioctl
+    .ioctl_p = esp_video_vfs_ioctl,
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+    .start_select = esp_video_vfs_start_select,
+    .end_select   = esp_video_vfs_end_select,
+#endif
 };
 
 /**
@@ -0,0 +1,275 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/queue.h>
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "unity.h"
+
+#include "esp_video_ring.h"
+
+#define TEST_BUFFER_NUM             (ESP_VIDEO_RING_SIZE - 1)
+#define TEST_STRESS_FRAMES          200000
+#define TEST_STRESS_SKIP_INTERVAL   7
+#define TEST_BENCH_LOOPS            100000
+
+/**
+ * @brief Buffer element shared by the "application" and "driver" threads.
+ */
+typedef struct test_element {
+    uint32_t sequence;                      /*!< Sequence number written by the application */
+    uint32_t payload;                       /*!< Frame payload written by the driver */
+} test_element_t;
+
+/**
+ * @brief Stress test context, it models one capture stream.
+ */
+typedef struct test_stream {
+    struct esp_video_ring queued_ring;      /*!< Application -> driver */
+    struct esp_video_ring done_ring;        /*!< Driver -> application */
+    test_element_t element[TEST_BUFFER_NUM];
+
+    uint32_t driver_frames;
+    uint32_t driver_skips;
+    uint32_t driver_errors;
+    uint32_t app_frames;
+    uint32_t app_errors;
+} test_stream_t;
+
+static uint64_t get_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+TEST_CASE("Ring push/pop/peek/unget", "[ring]")
+{
+    uint8_t index;
+    struct esp_video_ring ring;
+
+    esp_video_ring_reset(&ring);
+    TEST_ASSERT_EQUAL_UINT32(0, esp_video_ring_count(&ring));
+    TEST_ASSERT_FALSE(esp_video_ring_pop(&ring, &index));
+    TEST_ASSERT_FALSE(esp_video_ring_peek(&ring, &index));
+
+    for (int i = 0; i < ESP_VIDEO_RING_SIZE; i++) {
+        TEST_ASSERT_TRUE(esp_video_ring_push(&ring, i));
+    }
+    TEST_ASSERT_FALSE(esp_video_ring_push(&ring, 0));
+    TEST_ASSERT_EQUAL_UINT32(ESP_VIDEO_RING_SIZE, esp_video_ring_count(&ring));
+
+    TEST_ASSERT_TRUE(esp_video_ring_peek(&ring, &index));
+    TEST_ASSERT_EQUAL_UINT8(0, index);
+    TEST_ASSERT_TRUE(esp_video_ring_pop(&ring, &index));
+    TEST_ASSERT_EQUAL_UINT8(0, index);
+    TEST_ASSERT_TRUE(esp_video_ring_pop(&ring, &index));
+    TEST_ASSERT_EQUAL_UINT8(1, index);
+
+    /* Element put back must be the next one to get, like TAILQ_INSERT_HEAD */
+    esp_video_ring_unget(&ring, 1);
+    TEST_ASSERT_TRUE(esp_video_ring_pop(&ring, &index));
+    TEST_ASSERT_EQUAL_UINT8(1, index);
+
+    for (int i = 2; i < ESP_VIDEO_RING_SIZE; i++) {
+        TEST_ASSERT_TRUE(esp_video_ring_pop(&ring, &index));
+        TEST_ASSERT_EQUAL_UINT8(i, index);
+    }
+    TEST_ASSERT_FALSE(esp_video_ring_pop(&ring, &index));
+
+    /* Wrap the 32-bit positions */
+    atomic_store(&ring.head, UINT32_MAX - 1);
+    atomic_store(&ring.tail, UINT32_MAX - 1);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(esp_video_ring_push(&ring, i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, esp_video_ring_count(&ring));
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(esp_video_ring_pop(&ring, &index));
+        TEST_ASSERT_EQUAL_UINT8(i, index);
+    }
+}
+
+static void *stress_driver_thread(void *arg)
+{
+    uint8_t index;
+    uint32_t last_sequence = 0;
+    test_stream_t *stream = (test_stream_t *)arg;
+
+    while (stream->driver_frames < TEST_STRESS_FRAMES) {
+        if (!esp_video_ring_pop(&stream->queued_ring, &index)) {
+            sched_yield();
+            continue;
+        }
+
+        test_element_t *element = &stream->element[index];
+
+        if (element->sequence <= last_sequence) {
+            stream->driver_errors++;
+        }
+
+        /* Skip some frames like the CSI driver does when the frame is broken */
+        if ((element->sequence % TEST_STRESS_SKIP_INTERVAL) == 0 && element->payload != UINT32_MAX) {
+            element->payload = UINT32_MAX;
+            esp_video_ring_unget(&stream->queued_ring, index);
+            stream->driver_skips++;
+            continue;
+        }
+
+        last_sequence = element->sequence;
+        element->payload = element->sequence ^ 0x5a5a5a5a;
+        while (!esp_video_ring_push(&stream->done_ring, index)) {
+            stream->driver_errors++;
+            sched_yield();
+        }
+
+        stream->driver_frames++;
+    }
+
+    return NULL;
+}
+
+TEST_CASE("Ring SPSC stress", "[ring]")
+{
+    uint8_t index;
+    pthread_t driver;
+    uint32_t sequence = 0;
+    uint32_t last_sequence = 0;
+    test_stream_t *stream;
+
+    stream = calloc(1, sizeof(test_stream_t));
+    TEST_ASSERT_NOT_NULL(stream);
+    esp_video_ring_reset(&stream->queued_ring);
+    esp_video_ring_reset(&stream->done_ring);
+
+    for (int i = 0; i < TEST_BUFFER_NUM; i++) {
+        stream->element[i].sequence = ++sequence;
+        TEST_ASSERT_TRUE(esp_video_ring_push(&stream->queued_ring, i));
+    }
+
+    TEST_ASSERT_EQUAL(0, pthread_create(&driver, NULL, stress_driver_thread, stream));
+
+    while (stream->app_frames < TEST_STRESS_FRAMES) {
+        if (!esp_video_ring_pop(&stream->done_ring, &index)) {
+            sched_yield();
+            continue;
+        }
+
+        test_element_t *element = &stream->element[index];
+
+        if (element->sequence <= last_sequence ||
+                element->payload != (element->sequence ^ 0x5a5a5a5a)) {
+            stream->app_errors++;
+        }
+        last_sequence = element->sequence;
+        stream->app_frames++;
+
+        element->sequence = ++sequence;
+        element->payload = 0;
+        if (!esp_video_ring_push(&stream->queued_ring, index)) {
+            stream->app_errors++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(0, pthread_join(driver, NULL));
+
+    printf("frames=%" PRIu32 " skips=%" PRIu32 "\n", stream->app_frames, stream->driver_skips);
+    TEST_ASSERT_EQUAL_UINT32(0, stream->driver_errors);
+    TEST_ASSERT_EQUAL_UINT32(0, stream->app_errors);
+    TEST_ASSERT_EQUAL_UINT32(TEST_STRESS_FRAMES, stream->driver_frames);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stream->driver_skips);
+
+    /* Every element is either queued or done when both sides stop */
+    TEST_ASSERT_EQUAL_UINT32(TEST_BUFFER_NUM, esp_video_ring_count(&stream->queued_ring) +
+                             esp_video_ring_count(&stream->done_ring));
+
+    free(stream);
+}
+
+struct bench_element {
+    TAILQ_ENTRY(bench_element) node;
+    uint32_t index;
+};
+
+TAILQ_HEAD(bench_list, bench_element);
+
+TEST_CASE("Ring vs critical section list benchmark", "[ring][bench]")
+{
+    uint8_t index;
+    uint64_t start;
+    uint64_t list_ns;
+    uint64_t ring_ns;
+    struct bench_list list;
+    struct esp_video_ring ring;
+    struct bench_element element[TEST_BUFFER_NUM];
+#if CONFIG_IDF_TARGET_LINUX
+    pthread_spinlock_t lock;
+
+    pthread_spin_init(&lock, PTHREAD_PROCESS_PRIVATE);
+#define BENCH_ENTER_CRITICAL()  pthread_spin_lock(&lock)
+#define BENCH_EXIT_CRITICAL()   pthread_spin_unlock(&lock)
+#else
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+#define BENCH_ENTER_CRITICAL()  portENTER_CRITICAL_SAFE(&lock)
+#define BENCH_EXIT_CRITICAL()   portEXIT_CRITICAL_SAFE(&lock)
+#endif
+
+    /* Baseline: the esp_video queued/done list hand-off */
+
+    TAILQ_INIT(&list);
+    for (int i = 0; i < TEST_BUFFER_NUM; i++) {
+        element[i].index = i;
+    }
+
+    start = get_time_ns();
+    for (int i = 0; i < TEST_BENCH_LOOPS; i++) {
+        struct bench_element *e = &element[i % TEST_BUFFER_NUM];
+
+        BENCH_ENTER_CRITICAL();
+        TAILQ_INSERT_TAIL(&list, e, node);
+        BENCH_EXIT_CRITICAL();
+
+        BENCH_ENTER_CRITICAL();
+        e = TAILQ_FIRST(&list);
+        TAILQ_REMOVE(&list, e, node);
+        BENCH_EXIT_CRITICAL();
+    }
+    list_ns = get_time_ns() - start;
+
+    esp_video_ring_reset(&ring);
+
+    start = get_time_ns();
+    for (int i = 0; i < TEST_BENCH_LOOPS; i++) {
+        esp_video_ring_push(&ring, i % TEST_BUFFER_NUM);
+        esp_video_ring_pop(&ring, &index);
+    }
+    ring_ns = get_time_ns() - start;
+
+#undef BENCH_ENTER_CRITICAL
+#undef BENCH_EXIT_CRITICAL
+
+    printf("queue+dequeue: critical section list %" PRIu64 " ns/op, lock-free ring %" PRIu64 " ns/op\n",
+           list_ns / TEST_BENCH_LOOPS, ring_ns / TEST_BENCH_LOOPS);
+    TEST_ASSERT_EQUAL_UINT32(0, esp_video_ring_count(&ring));
+}
+
+void app_main(void)
+{
+    printf("Video buffer queue test\n");
+
+    unity_run_menu();
+}
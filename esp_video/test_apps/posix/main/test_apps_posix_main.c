@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2025-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -7,9 +7,11 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <string.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/select.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -22,9 +24,14 @@
 #include "unity_test_utils_memory.h"
 #include "unity.h"
 #include "esp_log_buffer.h"
+#include "nvs.h"
+#include "nvs_flash.h"
 
 #include "example_video_common.h"
 #include "esp_video_isp_ioctl.h"
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_DETECT_CACHE
+#include "esp_cam_sensor_detect.h"
+#endif
 
 #define TEST_MEMORY_LEAK_THRESHOLD (-512)
 
@@ -195,6 +202,83 @@ TEST_CASE("V4L2 Video Buffer Sequence", "[video]")
     TEST_ESP_OK(example_video_deinit());
 }
 
+/**
+ * @brief Open the video device and capture one frame, return the time from open to the first frame
+ */
+static int64_t test_time_to_first_frame(void)
+{
+    int fd;
+    int val;
+    int64_t start_us;
+    int64_t first_frame_us;
+    struct v4l2_buffer buf;
+    struct v4l2_requestbuffers req;
+
+    start_us = esp_timer_get_time();
+
+    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = VIDEO_BUFFER_NUM;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_REQBUFS, &req));
+
+    for (int i = 0; i < VIDEO_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QUERYBUF, &buf));
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMON, &val));
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+
+    first_frame_us = esp_timer_get_time() - start_us;
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMOFF, &val));
+
+    TEST_ESP_OK(close(fd));
+
+    return first_frame_us;
+}
+
+TEST_CASE("V4L2 time to first frame", "[video]")
+{
+    int64_t cold_us;
+    int64_t resume_us;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    /* The first open configures the camera sensor from its reset state */
+    cold_us = test_time_to_first_frame();
+
+    /* Reopening resumes the camera sensor from standby if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY is enabled */
+    resume_us = test_time_to_first_frame();
+
+    printf("time to first frame: cold start %" PRId64 " us, resume %" PRId64 " us\n", cold_us, resume_us);
+
+    TEST_ASSERT_GREATER_THAN(0, cold_us);
+    TEST_ASSERT_GREATER_THAN(0, resume_us);
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_STANDBY
+    /* Resuming from standby skips the format register table, it must not be slower than a cold start */
+    TEST_ASSERT_LESS_OR_EQUAL(cold_us, resume_us);
+#endif
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
 #if CONFIG_ESP_VIDEO_ENABLE_JPEG_VIDEO_DEVICE
 TEST_CASE("V4L2 M2M device", "[video]")
 {
@@ -334,228 +418,1944 @@ TEST_CASE("V4L2 M2M device", "[video]")
 
     TEST_ESP_OK(example_video_deinit());
 }
-#endif /* CONFIG_ESP_VIDEO_ENABLE_JPEG_VIDEO_DEVICE */
 
-#if CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE
-TEST_CASE("V4L2 set/get selection", "[video]")
+TEST_CASE("V4L2 M2M device JPEG rate control", "[video]")
 {
     int fd;
-    struct v4l2_selection in_selection;
-    struct v4l2_selection out_selection;
+    int ret;
+    int val;
+    uint32_t size = 0;
+    uint32_t quality = 0;
+    uint16_t width = 320;
+    uint16_t height = 240;
+    const uint32_t target_size = 8000;
+    struct v4l2_buffer buf;
+    struct v4l2_format format;
+    struct v4l2_requestbuffers req;
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[2];
+    uint8_t *out_buf[VIDEO_BUFFER_NUM];
+    uint8_t *cap_buf[VIDEO_BUFFER_NUM];
 
     setUp();
 
     TEST_ESP_OK(example_video_init());
 
-    fd = open(ESP_VIDEO_ISP1_DEVICE_NAME, O_RDWR);
+    fd = open(ESP_VIDEO_JPEG_DEVICE_NAME, O_RDWR);
     TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
 
-    memset(&in_selection, 0, sizeof(in_selection));
-    in_selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    TEST_ASSERT_EQUAL_INT(-1, ioctl(fd, VIDIOC_G_SELECTION, &in_selection));
-
-    memset(&in_selection, 0, sizeof(in_selection));
-    in_selection.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
-    TEST_ASSERT_EQUAL_INT(-1, ioctl(fd, VIDIOC_S_SELECTION, &in_selection));
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB565;
+    ret = ioctl(fd, VIDIOC_S_FMT, &format);
+    TEST_ESP_OK(ret);
 
-    memset(&in_selection, 0, sizeof(in_selection));
-    in_selection.type = V4L2_BUF_TYPE_META_CAPTURE;
-    TEST_ESP_OK(ioctl(fd, VIDIOC_G_SELECTION, &in_selection));
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = VIDEO_BUFFER_NUM;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
 
-    memset(&in_selection, 0, sizeof(in_selection));
-    in_selection.type = V4L2_BUF_TYPE_META_CAPTURE;
-    in_selection.r.left = 0;
-    in_selection.r.width = 1080;
-    in_selection.r.top = 0;
-    in_selection.r.height = 720;
-    TEST_ESP_OK(ioctl(fd, VIDIOC_S_SELECTION, &in_selection));
+    for (int i = 0; i < VIDEO_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
+        TEST_ESP_OK(ret);
 
-    memset(&out_selection, 0, sizeof(out_selection));
-    out_selection.type = V4L2_BUF_TYPE_META_CAPTURE;
-    TEST_ESP_OK(ioctl(fd, VIDIOC_G_SELECTION, &out_selection));
+        out_buf[i] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd, buf.m.offset);
+        TEST_ASSERT_NOT_NULL(out_buf[i]);
 
-    TEST_ESP_OK(memcmp(&out_selection, &in_selection, sizeof(out_selection)));
+        /* Noise-like image, it is encoded much larger than the target size at default quality */
+        for (uint32_t j = 0; j < buf.length; j++) {
+            out_buf[i][j] = (j * 2654435761u) >> 24;
+        }
 
-    TEST_ESP_OK(close(fd));
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
 
-    TEST_ESP_OK(example_video_deinit());
-}
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_JPEG;
+    ret = ioctl(fd, VIDIOC_S_FMT, &format);
+    TEST_ESP_OK(ret);
 
-TEST_CASE("V4L2 set/get param", "[video]")
-{
-    int fd;
-    int fps;
-    int ret;
-    struct v4l2_buffer buf;
-    struct v4l2_streamparm sparm;
-    struct v4l2_captureparm *cparam = &sparm.parm.capture;
-    struct v4l2_fract *timeperframe = &cparam->timeperframe;
-    struct v4l2_requestbuffers req;
-    int buf_count = 3;
-    int capture_seconds = 3;
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = VIDEO_BUFFER_NUM;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
 
-    setUp();
+    for (int i = 0; i < VIDEO_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
+        TEST_ESP_OK(ret);
 
-    TEST_ESP_OK(example_video_init());
+        cap_buf[i] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd, buf.m.offset);
+        TEST_ASSERT_NOT_NULL(cap_buf[i]);
 
-    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
-    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
 
-    memset(&sparm, 0, sizeof(sparm));
-    sparm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    ret = ioctl(fd, VIDIOC_G_PARM, &sparm);
+    controls.ctrl_class = V4L2_CID_JPEG_CLASS;
+    controls.count      = 2;
+    controls.controls   = control;
+    control[0].id       = V4L2_CID_JPEG_TARGET_SIZE;
+    control[0].value    = target_size;
+    control[1].id       = V4L2_CID_JPEG_RC_REENCODE;
+    control[1].value    = 1;
+    ret = ioctl(fd, VIDIOC_S_EXT_CTRLS, &controls);
     TEST_ESP_OK(ret);
 
-    TEST_ASSERT_EQUAL_INT(cparam->capability, V4L2_CAP_TIMEPERFRAME);
-    TEST_ASSERT_GREATER_OR_EQUAL(1, timeperframe->numerator);
-    TEST_ASSERT_GREATER_OR_EQUAL(1, timeperframe->denominator);
-    printf("fps=%0.4f\n", (float)timeperframe->denominator / timeperframe->numerator);
-
-    fps = timeperframe->denominator / timeperframe->numerator;
-    for (int i = 2; i <= fps; i++) {
-        if (fps % i != 0) {
-            continue;
-        }
-        int div_fps = fps / i;
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    ret = ioctl(fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
 
-        memset(&sparm, 0, sizeof(sparm));
-        sparm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        cparam->capability = V4L2_CAP_TIMEPERFRAME;
-        timeperframe->numerator = 1;
-        timeperframe->denominator = div_fps;
-        ret = ioctl(fd, VIDIOC_S_PARM, &sparm);
-        TEST_ESP_OK(ret);
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
 
-        memset(&req, 0, sizeof(req));
-        req.count  = buf_count;
-        req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        req.memory = V4L2_MEMORY_MMAP;
-        ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    for (int i = 0; i < 30; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        ret = ioctl(fd, VIDIOC_DQBUF, &buf);
         TEST_ESP_OK(ret);
 
-        for (int i = 0; i < buf_count; i++) {
-            memset(&buf, 0, sizeof(buf));
-            buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buf.memory      = V4L2_MEMORY_MMAP;
-            buf.index       = i;
-            ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
-            TEST_ESP_OK(ret);
+        TEST_ASSERT_EQUAL_HEX8(0xff, cap_buf[buf.index][0]);
+        TEST_ASSERT_EQUAL_HEX8(0xd8, cap_buf[buf.index][1]);
 
-            ret = ioctl(fd, VIDIOC_QBUF, &buf);
-            TEST_ESP_OK(ret);
-        }
+        size = buf.bytesused;
 
-        int val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        ret = ioctl(fd, VIDIOC_STREAMON, &val);
+        controls.ctrl_class = V4L2_CID_JPEG_CLASS;
+        controls.count      = 1;
+        controls.controls   = control;
+        control[0].id       = V4L2_CID_JPEG_FRAME_QUALITY;
+        ret = ioctl(fd, VIDIOC_G_EXT_CTRLS, &controls);
         TEST_ESP_OK(ret);
+        quality = control[0].value;
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(1, quality);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(80, quality);
 
-        int frame_count = 0;
-        int64_t start_time_us = esp_timer_get_time();
-        while (esp_timer_get_time() - start_time_us < (capture_seconds * 1000 * 1000)) {
-            memset(&buf, 0, sizeof(buf));
-            buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buf.memory = V4L2_MEMORY_MMAP;
-            ret = ioctl(fd, VIDIOC_DQBUF, &buf);
-            TEST_ESP_OK(ret);
-
-            frame_count++;
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
 
-            ret = ioctl(fd, VIDIOC_QBUF, &buf);
-            TEST_ESP_OK(ret);
-        }
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory = V4L2_MEMORY_MMAP;
+        ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+        TEST_ESP_OK(ret);
 
-        val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
         TEST_ESP_OK(ret);
+    }
 
-        TEST_ASSERT_EQUAL_INT(div_fps, frame_count / capture_seconds);
+    printf("JPEG rate control: target=%" PRIu32 " size=%" PRIu32 " quality=%" PRIu32 "\n", target_size, size, quality);
 
-        memset(&sparm, 0, sizeof(sparm));
-        sparm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        ret = ioctl(fd, VIDIOC_G_PARM, &sparm);
-        TEST_ESP_OK(ret);
+    /* Rate control has converged, unless the target can't be reached even at the minimum quality */
+    TEST_ASSERT_TRUE((size <= target_size * 5 / 4) || (quality == 1));
 
-        TEST_ASSERT_EQUAL_INT(cparam->capability, V4L2_CAP_TIMEPERFRAME);
-        TEST_ASSERT_EQUAL_INT(timeperframe->numerator, 1);
-        TEST_ASSERT_EQUAL_INT(timeperframe->denominator, div_fps);
-    }
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
 
-    close(fd);
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
+
+    ret = close(fd);
+    TEST_ESP_OK(ret);
 
     TEST_ESP_OK(example_video_deinit());
 }
 
-TEST_CASE("V4L2 set/get GAMMA_EXT", "[video]")
+TEST_CASE("V4L2 DMABUF export and import", "[video]")
 {
-    int fd;
     int ret;
-    struct v4l2_ext_controls ctrls;
-    struct v4l2_ext_control ctrl[1];
-    esp_video_isp_gamma_ext_t gamma_set;
-    esp_video_isp_gamma_ext_t gamma_get;
-
-    setUp();
+    int val;
+    int cap_fd;
+    int m2m_fd;
+    int dmabuf_fd[VIDEO_BUFFER_NUM];
+    struct v4l2_buffer buf;
+    struct v4l2_buffer jpeg_buf;
+    struct v4l2_format format;
+    struct v4l2_exportbuffer expbuf;
+    struct v4l2_requestbuffers req;
+    uint8_t *jpeg_buf_ptr[VIDEO_BUFFER_NUM];
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    /* Export the capture buffers of the camera */
+
+    cap_fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, cap_fd);
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(cap_fd, VIDIOC_G_FMT, &format);
+    TEST_ESP_OK(ret);
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = VIDEO_BUFFER_NUM;
+    ret = ioctl(cap_fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < VIDEO_BUFFER_NUM; i++) {
+        memset(&expbuf, 0, sizeof(expbuf));
+        expbuf.type  = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        expbuf.index = i;
+        ret = ioctl(cap_fd, VIDIOC_EXPBUF, &expbuf);
+        TEST_ESP_OK(ret);
+        dmabuf_fd[i] = expbuf.fd;
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        ret = ioctl(cap_fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    /* Import them into the JPEG encoder input */
+
+    m2m_fd = open(ESP_VIDEO_JPEG_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, m2m_fd);
+
+    format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    ret = ioctl(m2m_fd, VIDIOC_S_FMT, &format);
+    if (ret != 0) {
+        close(m2m_fd);
+        close(cap_fd);
+        TEST_ESP_OK(example_video_deinit());
+        TEST_IGNORE_MESSAGE("JPEG encoder doesn't support the camera format");
+    }
+
+    /* DMABUF buffers can't be queued before REQBUFS */
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_DMABUF;
+    buf.index  = 0;
+    buf.m.fd   = dmabuf_fd[0];
+    TEST_ASSERT_EQUAL_INT(-1, ioctl(m2m_fd, VIDIOC_QBUF, &buf));
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = V4L2_MEMORY_DMABUF;
+    req.count  = VIDEO_BUFFER_NUM;
+    ret = ioctl(m2m_fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_JPEG;
+    ret = ioctl(m2m_fd, VIDIOC_S_FMT, &format);
+    TEST_ESP_OK(ret);
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = VIDEO_BUFFER_NUM;
+    ret = ioctl(m2m_fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < VIDEO_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        ret = ioctl(m2m_fd, VIDIOC_QUERYBUF, &buf);
+        TEST_ESP_OK(ret);
+
+        jpeg_buf_ptr[i] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, m2m_fd, buf.m.offset);
+        TEST_ASSERT_NOT_NULL(jpeg_buf_ptr[i]);
+
+        ret = ioctl(m2m_fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    ret = ioctl(m2m_fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(m2m_fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(cap_fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
+
+    /**
+     * The camera buffers are never queued by the application again, so more frames
+     * than buffers can only be captured if the importer releases them to the exporter.
+     */
+
+    for (int i = 0; i < VIDEO_BUFFER_NUM * 5; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        ret = ioctl(cap_fd, VIDIOC_DQBUF, &buf);
+        TEST_ESP_OK(ret);
+
+        int index = buf.index;
+        uint32_t bytesused = buf.bytesused;
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type      = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory    = V4L2_MEMORY_DMABUF;
+        buf.index     = index;
+        buf.m.fd      = dmabuf_fd[index];
+        buf.bytesused = bytesused;
+        ret = ioctl(m2m_fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+
+        memset(&jpeg_buf, 0, sizeof(jpeg_buf));
+        jpeg_buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        jpeg_buf.memory = V4L2_MEMORY_MMAP;
+        ret = ioctl(m2m_fd, VIDIOC_DQBUF, &jpeg_buf);
+        TEST_ESP_OK(ret);
+
+        TEST_ASSERT_EQUAL_HEX8(0xff, jpeg_buf_ptr[jpeg_buf.index][0]);
+        TEST_ASSERT_EQUAL_HEX8(0xd8, jpeg_buf_ptr[jpeg_buf.index][1]);
+
+        ret = ioctl(m2m_fd, VIDIOC_QBUF, &jpeg_buf);
+        TEST_ESP_OK(ret);
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory = V4L2_MEMORY_DMABUF;
+        ret = ioctl(m2m_fd, VIDIOC_DQBUF, &buf);
+        TEST_ESP_OK(ret);
+        TEST_ASSERT_EQUAL_INT(index, buf.index);
+        TEST_ASSERT_EQUAL_INT(dmabuf_fd[index], buf.m.fd);
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(cap_fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
+
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    ret = ioctl(m2m_fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(m2m_fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
+
+    /* The importer keeps the DMABUF referenced, so the exporter can be closed first */
+
+    ret = close(cap_fd);
+    TEST_ESP_OK(ret);
+
+    ret = close(m2m_fd);
+    TEST_ESP_OK(ret);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+#define TEST_M2M_JOB_NUM 4
+
+TEST_CASE("V4L2 M2M device queued jobs", "[video]")
+{
+    int fd;
+    int ret;
+    int val;
+    uint16_t width = 320;
+    uint16_t height = 240;
+    struct v4l2_buffer buf;
+    struct v4l2_format format;
+    struct v4l2_requestbuffers req;
+    uint8_t *cap_buf[TEST_M2M_JOB_NUM];
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    fd = open(ESP_VIDEO_JPEG_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB565;
+    ret = ioctl(fd, VIDIOC_S_FMT, &format);
+    TEST_ESP_OK(ret);
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = TEST_M2M_JOB_NUM;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_JPEG;
+    ret = ioctl(fd, VIDIOC_S_FMT, &format);
+    TEST_ESP_OK(ret);
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = TEST_M2M_JOB_NUM;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < TEST_M2M_JOB_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
+        TEST_ESP_OK(ret);
+
+        cap_buf[i] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd, buf.m.offset);
+        TEST_ASSERT_NOT_NULL(cap_buf[i]);
+
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    ret = ioctl(fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
+
+    for (int loop = 0; loop < 5; loop++) {
+        /* Queue all jobs before dequeuing any result, so that they wait in the queues together */
+
+        for (int i = 0; i < TEST_M2M_JOB_NUM; i++) {
+            memset(&buf, 0, sizeof(buf));
+            buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index  = i;
+            ret = ioctl(fd, VIDIOC_QBUF, &buf);
+            TEST_ESP_OK(ret);
+        }
+
+        /* Jobs complete in the order in which their buffers were queued */
+
+        for (int i = 0; i < TEST_M2M_JOB_NUM; i++) {
+            uint32_t sequence = loop * TEST_M2M_JOB_NUM + i;
+
+            memset(&buf, 0, sizeof(buf));
+            buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            TEST_ASSERT_EQUAL_INT(i, buf.index);
+            TEST_ASSERT_EQUAL_UINT32(sequence, buf.sequence);
+            TEST_ASSERT_EQUAL_HEX8(0xff, cap_buf[buf.index][0]);
+            TEST_ASSERT_EQUAL_HEX8(0xd8, cap_buf[buf.index][1]);
+
+            ret = ioctl(fd, VIDIOC_QBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            memset(&buf, 0, sizeof(buf));
+            buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+            buf.memory = V4L2_MEMORY_MMAP;
+            ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            TEST_ASSERT_EQUAL_INT(i, buf.index);
+            TEST_ASSERT_EQUAL_UINT32(sequence, buf.sequence);
+        }
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
+
+    ret = close(fd);
+    TEST_ESP_OK(ret);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_JPEG_VIDEO_DEVICE */
+
+#if CONFIG_ESP_VIDEO_ENABLE_H264_VIDEO_DEVICE
+#define TEST_H264_WIDTH     320
+#define TEST_H264_HEIGHT    240
+
+typedef struct test_h264 {
+    int fd;
+    uint8_t *out_buf[VIDEO_BUFFER_NUM];
+    uint8_t *cap_buf[VIDEO_BUFFER_NUM];
+} test_h264_t;
+
+/**
+ * @brief Open the H.264 M2M device and queue YUV420 input frames with a luma gradient
+ */
+static void test_h264_open(test_h264_t *h264)
+{
+    struct v4l2_buffer buf;
+    struct v4l2_format format;
+    struct v4l2_requestbuffers req;
+    const uint32_t line_size = TEST_H264_WIDTH * 3 / 2;
+
+    h264->fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, h264->fd);
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    format.fmt.pix.width = TEST_H264_WIDTH;
+    format.fmt.pix.height = TEST_H264_HEIGHT;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_YUV420;
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_S_FMT, &format));
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = VIDEO_BUFFER_NUM;
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_REQBUFS, &req));
+
+    for (int i = 0; i < VIDEO_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        TEST_ESP_OK(ioctl(h264->fd, VIDIOC_QUERYBUF, &buf));
+        TEST_ASSERT_EQUAL_INT(TEST_H264_WIDTH * TEST_H264_HEIGHT * 3 / 2, buf.length);
+
+        h264->out_buf[i] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, h264->fd, buf.m.offset);
+        TEST_ASSERT_NOT_NULL(h264->out_buf[i]);
+
+        /* Odd lines are UYY and even lines are VYY, chroma is neutral */
+        for (int y = 0; y < TEST_H264_HEIGHT; y++) {
+            uint8_t *line = h264->out_buf[i] + y * line_size;
+
+            for (int x = 0; x < TEST_H264_WIDTH / 2; x++) {
+                line[x * 3] = 0x80;
+                line[x * 3 + 1] = (uint8_t)(x * 2 + y + i * 16);
+                line[x * 3 + 2] = (uint8_t)(x * 2 + 1 + y + i * 16);
+            }
+        }
+
+        TEST_ESP_OK(ioctl(h264->fd, VIDIOC_QBUF, &buf));
+    }
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = TEST_H264_WIDTH;
+    format.fmt.pix.height = TEST_H264_HEIGHT;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_H264;
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_S_FMT, &format));
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = VIDEO_BUFFER_NUM;
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_REQBUFS, &req));
+
+    for (int i = 0; i < VIDEO_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        TEST_ESP_OK(ioctl(h264->fd, VIDIOC_QUERYBUF, &buf));
+
+        h264->cap_buf[i] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, h264->fd, buf.m.offset);
+        TEST_ASSERT_NOT_NULL(h264->cap_buf[i]);
+
+        TEST_ESP_OK(ioctl(h264->fd, VIDIOC_QBUF, &buf));
+    }
+}
+
+static void test_h264_stream(test_h264_t *h264, bool on)
+{
+    int val;
+
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ESP_OK(ioctl(h264->fd, on ? VIDIOC_STREAMON : VIDIOC_STREAMOFF, &val));
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(h264->fd, on ? VIDIOC_STREAMON : VIDIOC_STREAMOFF, &val));
+}
+
+/**
+ * @brief Dequeue one encoded frame, check its start code and requeue the buffers
+ *
+ * @return Flags of the capture buffer
+ */
+static uint32_t test_h264_encode_frame(test_h264_t *h264, uint32_t *bytesused)
+{
+    uint32_t flags;
+    struct v4l2_buffer buf;
+    const uint8_t start_code[] = {0x00, 0x00, 0x00, 0x01};
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_DQBUF, &buf));
+
+    TEST_ASSERT_GREATER_THAN(sizeof(start_code), buf.bytesused);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(start_code, h264->cap_buf[buf.index], sizeof(start_code));
+    flags = buf.flags;
+    if (bytesused) {
+        *bytesused = buf.bytesused;
+    }
+
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_QBUF, &buf));
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_DQBUF, &buf));
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_QBUF, &buf));
+
+    return flags;
+}
+
+TEST_CASE("V4L2 H.264 M2M device", "[video]")
+{
+    uint32_t flags;
+    test_h264_t h264;
+    struct v4l2_capability cap;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    test_h264_open(&h264);
+
+    memset(&cap, 0, sizeof(cap));
+    TEST_ESP_OK(ioctl(h264.fd, VIDIOC_QUERYCAP, &cap));
+    TEST_ASSERT_EQUAL_INT(V4L2_CAP_VIDEO_M2M, cap.capabilities & V4L2_CAP_VIDEO_M2M);
+
+    test_h264_stream(&h264, true);
+
+    /* The first frame is an IDR frame, and every frame is either a key frame or a P-frame */
+    for (int i = 0; i < 60; i++) {
+        flags = test_h264_encode_frame(&h264, NULL);
+        if (i == 0) {
+            TEST_ASSERT_EQUAL_HEX32(V4L2_BUF_FLAG_KEYFRAME, flags & V4L2_BUF_FLAG_KEYFRAME);
+        }
+        TEST_ASSERT_NOT_EQUAL(0, flags & (V4L2_BUF_FLAG_KEYFRAME | V4L2_BUF_FLAG_PFRAME));
+    }
+
+    test_h264_stream(&h264, false);
+    TEST_ESP_OK(close(h264.fd));
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+static void test_h264_set_ctrl(test_h264_t *h264, uint32_t id, int32_t value)
+{
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+
+    controls.ctrl_class = V4L2_CID_CODEC_CLASS;
+    controls.count      = 1;
+    controls.controls   = control;
+    control[0].id       = id;
+    control[0].value    = value;
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_S_EXT_CTRLS, &controls));
+}
+
+static int32_t test_h264_get_ctrl(test_h264_t *h264, uint32_t id)
+{
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+
+    controls.ctrl_class = V4L2_CID_CODEC_CLASS;
+    controls.count      = 1;
+    controls.controls   = control;
+    control[0].id       = id;
+    TEST_ESP_OK(ioctl(h264->fd, VIDIOC_G_EXT_CTRLS, &controls));
+
+    return control[0].value;
+}
+
+TEST_CASE("V4L2 H.264 M2M device frame type flags", "[video]")
+{
+    uint32_t flags;
+    int key_frames = 0;
+    const int gop = 10;
+    const int frames = gop * 3;
+    test_h264_t h264;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    test_h264_open(&h264);
+    test_h264_set_ctrl(&h264, V4L2_CID_MPEG_VIDEO_H264_I_PERIOD, gop);
+    test_h264_stream(&h264, true);
+
+    /* Every frame has exactly one of the key frame and P-frame flags, and there is one key frame per GOP */
+    for (int i = 0; i < frames; i++) {
+        flags = test_h264_encode_frame(&h264, NULL);
+        flags &= V4L2_BUF_FLAG_KEYFRAME | V4L2_BUF_FLAG_PFRAME;
+        TEST_ASSERT(flags == V4L2_BUF_FLAG_KEYFRAME || flags == V4L2_BUF_FLAG_PFRAME);
+        if (flags == V4L2_BUF_FLAG_KEYFRAME) {
+            key_frames++;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(frames / gop, key_frames);
+
+    test_h264_stream(&h264, false);
+    TEST_ESP_OK(close(h264.fd));
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+TEST_CASE("V4L2 H.264 M2M device force key frame", "[video]")
+{
+    uint32_t flags;
+    bool key_frame = false;
+    test_h264_t h264;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    test_h264_open(&h264);
+    test_h264_set_ctrl(&h264, V4L2_CID_MPEG_VIDEO_H264_I_PERIOD, 120);
+    test_h264_stream(&h264, true);
+
+    for (int i = 0; i < 10; i++) {
+        flags = test_h264_encode_frame(&h264, NULL);
+        if (i > 0) {
+            TEST_ASSERT_EQUAL_HEX32(V4L2_BUF_FLAG_PFRAME, flags & (V4L2_BUF_FLAG_KEYFRAME | V4L2_BUF_FLAG_PFRAME));
+        }
+    }
+
+    test_h264_set_ctrl(&h264, V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME, 0);
+
+    /* Frames queued before the request may have been encoded already */
+    for (int i = 0; i < VIDEO_BUFFER_NUM + 1; i++) {
+        flags = test_h264_encode_frame(&h264, NULL);
+        if (flags & V4L2_BUF_FLAG_KEYFRAME) {
+            key_frame = true;
+            break;
+        }
+    }
+    TEST_ASSERT_TRUE(key_frame);
+
+    /* The request is handled once */
+    for (int i = 0; i < 10; i++) {
+        flags = test_h264_encode_frame(&h264, NULL);
+        TEST_ASSERT_EQUAL_HEX32(V4L2_BUF_FLAG_PFRAME, flags & (V4L2_BUF_FLAG_KEYFRAME | V4L2_BUF_FLAG_PFRAME));
+    }
+
+    test_h264_stream(&h264, false);
+    TEST_ESP_OK(close(h264.fd));
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+/**
+ * @brief Encode frames until the rate control settles, then return the average size of the next frames
+ */
+static uint32_t test_h264_average_frame_size(test_h264_t *h264)
+{
+    uint32_t bytesused;
+    uint32_t total_bytes = 0;
+    const int settle_frames = 20;
+    const int frames = 40;
+
+    for (int i = 0; i < settle_frames + frames; i++) {
+        test_h264_encode_frame(h264, &bytesused);
+        if (i >= settle_frames) {
+            total_bytes += bytesused;
+        }
+    }
+
+    return total_bytes / frames;
+}
+
+TEST_CASE("V4L2 H.264 M2M device runtime bitrate", "[video]")
+{
+    uint32_t low_size;
+    uint32_t high_size;
+    const int32_t low_bitrate = 100000;
+    const int32_t high_bitrate = 4000000;
+    test_h264_t h264;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    test_h264_open(&h264);
+
+    /* Let rate control choose QP from the whole range, and make key frames dominate the stream size */
+    test_h264_set_ctrl(&h264, V4L2_CID_MPEG_VIDEO_H264_MIN_QP, 10);
+    test_h264_set_ctrl(&h264, V4L2_CID_MPEG_VIDEO_H264_MAX_QP, 51);
+    test_h264_set_ctrl(&h264, V4L2_CID_MPEG_VIDEO_H264_I_PERIOD, 5);
+    test_h264_set_ctrl(&h264, V4L2_CID_MPEG_VIDEO_BITRATE, low_bitrate);
+    test_h264_stream(&h264, true);
+
+    low_size = test_h264_average_frame_size(&h264);
+
+    /* The new bitrate applies to the running stream without STREAMOFF and STREAMON */
+    test_h264_set_ctrl(&h264, V4L2_CID_MPEG_VIDEO_BITRATE, high_bitrate);
+    TEST_ASSERT_EQUAL_INT32(high_bitrate, test_h264_get_ctrl(&h264, V4L2_CID_MPEG_VIDEO_BITRATE));
+
+    high_size = test_h264_average_frame_size(&h264);
+
+    printf("H.264 average frame size: %" PRIu32 " bytes at %" PRIi32 " bps, %" PRIu32 " bytes at %" PRIi32 " bps\n",
+           low_size, low_bitrate, high_size, high_bitrate);
+    TEST_ASSERT_GREATER_THAN(low_size, high_size);
+
+    test_h264_stream(&h264, false);
+    TEST_ESP_OK(close(h264.fd));
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+TEST_CASE("V4L2 H.264 M2M device set/get param", "[video]")
+{
+    test_h264_t h264;
+    struct v4l2_streamparm parm;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    test_h264_open(&h264);
+
+    /* The frame rate set by the output stream is reported by both streams */
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    parm.parm.output.timeperframe.numerator = 1;
+    parm.parm.output.timeperframe.denominator = 15;
+    TEST_ESP_OK(ioctl(h264.fd, VIDIOC_S_PARM, &parm));
+
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(h264.fd, VIDIOC_G_PARM, &parm));
+    TEST_ASSERT_EQUAL_HEX32(V4L2_CAP_TIMEPERFRAME, parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME);
+    TEST_ASSERT_EQUAL_UINT32(1, parm.parm.capture.timeperframe.numerator);
+    TEST_ASSERT_EQUAL_UINT32(15, parm.parm.capture.timeperframe.denominator);
+
+    /* Invalid frame rates are rejected and don't change the current one */
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ASSERT_NOT_EQUAL(0, ioctl(h264.fd, VIDIOC_S_PARM, &parm));
+
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = 1000;
+    TEST_ASSERT_NOT_EQUAL(0, ioctl(h264.fd, VIDIOC_S_PARM, &parm));
+
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ESP_OK(ioctl(h264.fd, VIDIOC_G_PARM, &parm));
+    TEST_ASSERT_EQUAL_UINT32(15, parm.parm.output.timeperframe.denominator);
+
+    /* The frame rate can be changed while streaming */
+    test_h264_stream(&h264, true);
+    for (int i = 0; i < 10; i++) {
+        test_h264_encode_frame(&h264, NULL);
+    }
+
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = 30;
+    TEST_ESP_OK(ioctl(h264.fd, VIDIOC_S_PARM, &parm));
+
+    for (int i = 0; i < 10; i++) {
+        test_h264_encode_frame(&h264, NULL);
+    }
+
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ESP_OK(ioctl(h264.fd, VIDIOC_G_PARM, &parm));
+    TEST_ASSERT_EQUAL_UINT32(30, parm.parm.output.timeperframe.denominator);
+
+    test_h264_stream(&h264, false);
+    TEST_ESP_OK(close(h264.fd));
+
+    TEST_ESP_OK(example_video_deinit());
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_H264_VIDEO_DEVICE */
+
+#if CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_VIDEO_DEVICE
+TEST_CASE("V4L2 software JPEG M2M device", "[video]")
+{
+    int fd;
+    int ret;
+    int val;
+    int64_t start_us;
+    uint32_t total_bytes;
+    uint16_t width = 320;
+    uint16_t height = 240;
+    struct v4l2_buffer buf;
+    struct v4l2_format format;
+    struct v4l2_requestbuffers req;
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+    uint8_t *out_buf[VIDEO_BUFFER_NUM];
+    uint8_t *cap_buf[VIDEO_BUFFER_NUM];
+    uint32_t out_buf_size[VIDEO_BUFFER_NUM];
+    const struct {
+        uint32_t pixel_format;
+        const char *name;
+    } test_formats[] = {
+        {V4L2_PIX_FMT_RGB565, "RGB565"},
+        {V4L2_PIX_FMT_RGB24, "RGB888"},
+        {V4L2_PIX_FMT_UYVY, "UYVY"},
+        {V4L2_PIX_FMT_YUV420, "YUV420"},
+        {V4L2_PIX_FMT_GREY, "GREY"},
+    };
+    const esp_video_init_config_t config = { 0 };
+
+    setUp();
+
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_SW_JPEG));
+
+    fd = open(ESP_VIDEO_SW_JPEG_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    for (int i = 0; i < sizeof(test_formats) / sizeof(test_formats[0]); i++) {
+        memset(&format, 0, sizeof(format));
+        format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        format.fmt.pix.width = width;
+        format.fmt.pix.height = height;
+        format.fmt.pix.pixelformat = test_formats[i].pixel_format;
+        ret = ioctl(fd, VIDIOC_S_FMT, &format);
+        TEST_ESP_OK(ret);
+
+        memset(&req, 0, sizeof(req));
+        req.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        req.memory = V4L2_MEMORY_MMAP;
+        req.count  = VIDEO_BUFFER_NUM;
+        ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+        TEST_ESP_OK(ret);
+
+        for (int j = 0; j < VIDEO_BUFFER_NUM; j++) {
+            memset(&buf, 0, sizeof(buf));
+            buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index  = j;
+            ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            out_buf[j] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE,
+                              MAP_SHARED, fd, buf.m.offset);
+            TEST_ASSERT_NOT_NULL(out_buf[j]);
+            out_buf_size[j] = buf.length;
+
+            /* Gradient image, it is more similar to a real scene than a flat image */
+            for (uint32_t k = 0; k < out_buf_size[j]; k++) {
+                out_buf[j][k] = (k * 7 + (k / width) * 3) & 0xff;
+            }
+
+            ret = ioctl(fd, VIDIOC_QBUF, &buf);
+            TEST_ESP_OK(ret);
+        }
+
+        memset(&format, 0, sizeof(format));
+        format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        format.fmt.pix.width = width;
+        format.fmt.pix.height = height;
+        format.fmt.pix.pixelformat = V4L2_PIX_FMT_JPEG;
+        ret = ioctl(fd, VIDIOC_S_FMT, &format);
+        TEST_ESP_OK(ret);
+
+        memset(&req, 0, sizeof(req));
+        req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        req.count  = VIDEO_BUFFER_NUM;
+        ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+        TEST_ESP_OK(ret);
+
+        for (int j = 0; j < VIDEO_BUFFER_NUM; j++) {
+            memset(&buf, 0, sizeof(buf));
+            buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index  = j;
+            ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            cap_buf[j] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE,
+                              MAP_SHARED, fd, buf.m.offset);
+            TEST_ASSERT_NOT_NULL(cap_buf[j]);
+
+            ret = ioctl(fd, VIDIOC_QBUF, &buf);
+            TEST_ESP_OK(ret);
+        }
+
+        controls.ctrl_class = V4L2_CID_JPEG_CLASS;
+        controls.count      = 1;
+        controls.controls   = control;
+        control[0].id       = V4L2_CID_JPEG_COMPRESSION_QUALITY;
+        control[0].value    = 60;
+        ret = ioctl(fd, VIDIOC_S_EXT_CTRLS, &controls);
+        TEST_ESP_OK(ret);
+
+        /* YUV420 input can only be encoded with 4:2:0 chroma subsampling */
+        control[0].id       = V4L2_CID_JPEG_CHROMA_SUBSAMPLING;
+        control[0].value    = V4L2_JPEG_CHROMA_SUBSAMPLING_444;
+        ret = ioctl(fd, VIDIOC_S_EXT_CTRLS, &controls);
+        if (test_formats[i].pixel_format == V4L2_PIX_FMT_RGB565 ||
+                test_formats[i].pixel_format == V4L2_PIX_FMT_RGB24) {
+            TEST_ESP_OK(ret);
+        } else {
+            TEST_ASSERT_NOT_EQUAL(0, ret);
+        }
+
+        val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        ret = ioctl(fd, VIDIOC_STREAMON, &val);
+        TEST_ESP_OK(ret);
+
+        val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        ret = ioctl(fd, VIDIOC_STREAMON, &val);
+        TEST_ESP_OK(ret);
+
+        total_bytes = 0;
+        start_us = esp_timer_get_time();
+        for (int j = 0; j < 20; j++) {
+            memset(&buf, 0, sizeof(buf));
+            buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            TEST_ASSERT_EQUAL_HEX8(0xff, cap_buf[buf.index][0]);
+            TEST_ASSERT_EQUAL_HEX8(0xd8, cap_buf[buf.index][1]);
+            TEST_ASSERT_EQUAL_HEX8(0xff, cap_buf[buf.index][buf.bytesused - 2]);
+            TEST_ASSERT_EQUAL_HEX8(0xd9, cap_buf[buf.index][buf.bytesused - 1]);
+            total_bytes += buf.bytesused;
+
+            ret = ioctl(fd, VIDIOC_QBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            memset(&buf, 0, sizeof(buf));
+            buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+            buf.memory = V4L2_MEMORY_MMAP;
+            ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            ret = ioctl(fd, VIDIOC_QBUF, &buf);
+            TEST_ESP_OK(ret);
+        }
+
+        printf("software JPEG %s %ux%u: %" PRIi64 " us/frame, %" PRIu32 " bytes/frame\n",
+               test_formats[i].name, width, height, (esp_timer_get_time() - start_us) / 20, total_bytes / 20);
+
+        val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+        TEST_ESP_OK(ret);
+
+        val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+        TEST_ESP_OK(ret);
+    }
+
+    ret = close(fd);
+    TEST_ESP_OK(ret);
+
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_SW_JPEG));
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_VIDEO_DEVICE */
+
+#if CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_VIDEO_DEVICE && CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_DEC_VIDEO_DEVICE
+#define TEST_SW_JPEG_DEC_COLOR  0x5aeb  /* RGB565: R=11, G=23, B=11 */
+
+static int test_sw_jpeg_dec_setup_stream(int fd, uint32_t type, uint16_t width, uint16_t height, uint32_t pixel_format, uint8_t **bufs)
+{
+    int ret;
+    struct v4l2_buffer buf;
+    struct v4l2_format format;
+    struct v4l2_requestbuffers req;
+
+    memset(&format, 0, sizeof(format));
+    format.type = type;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = pixel_format;
+    ret = ioctl(fd, VIDIOC_S_FMT, &format);
+    if (ret) {
+        return ret;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.type   = type;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = 1;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    if (ret) {
+        return ret;
+    }
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = type;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index  = 0;
+    ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
+    if (ret) {
+        return ret;
+    }
+
+    bufs[0] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+
+    return bufs[0] ? 0 : -1;
+}
+
+TEST_CASE("V4L2 software JPEG decoder M2M device", "[video]")
+{
+    int enc_fd;
+    int dec_fd;
+    int val;
+    uint32_t jpeg_size;
+    uint16_t width = 320;
+    uint16_t height = 240;
+    uint32_t frame_size = width * height * 2;
+    uint8_t *enc_out_buf[1];
+    uint8_t *enc_cap_buf[1];
+    uint8_t *dec_out_buf[1];
+    uint8_t *dec_cap_buf[1];
+    struct v4l2_buffer buf;
+    const esp_video_init_config_t config = { 0 };
+
+    setUp();
+
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_SW_JPEG | ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC));
+
+    /* Encode a flat RGB565 image to get a JPEG image which is much smaller than the buffer */
+
+    enc_fd = open(ESP_VIDEO_SW_JPEG_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, enc_fd);
+
+    TEST_ESP_OK(test_sw_jpeg_dec_setup_stream(enc_fd, V4L2_BUF_TYPE_VIDEO_OUTPUT, width, height, V4L2_PIX_FMT_RGB565, enc_out_buf));
+    TEST_ESP_OK(test_sw_jpeg_dec_setup_stream(enc_fd, V4L2_BUF_TYPE_VIDEO_CAPTURE, width, height, V4L2_PIX_FMT_JPEG, enc_cap_buf));
+
+    for (uint32_t i = 0; i < frame_size / 2; i++) {
+        ((uint16_t *)enc_out_buf[0])[i] = TEST_SW_JPEG_DEC_COLOR;
+    }
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index  = 0;
+    TEST_ESP_OK(ioctl(enc_fd, VIDIOC_QBUF, &buf));
+
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(enc_fd, VIDIOC_QBUF, &buf));
+
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ESP_OK(ioctl(enc_fd, VIDIOC_STREAMON, &val));
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(enc_fd, VIDIOC_STREAMON, &val));
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(enc_fd, VIDIOC_DQBUF, &buf));
+    jpeg_size = buf.bytesused;
+    TEST_ASSERT_LESS_THAN_UINT32(frame_size, jpeg_size);
+
+    /* Decode the JPEG image, "bytesused" is the JPEG image size instead of the buffer size */
+
+    dec_fd = open(ESP_VIDEO_SW_JPEG_DEC_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, dec_fd);
+
+    TEST_ESP_OK(test_sw_jpeg_dec_setup_stream(dec_fd, V4L2_BUF_TYPE_VIDEO_OUTPUT, width, height, V4L2_PIX_FMT_JPEG, dec_out_buf));
+    TEST_ESP_OK(test_sw_jpeg_dec_setup_stream(dec_fd, V4L2_BUF_TYPE_VIDEO_CAPTURE, width, height, V4L2_PIX_FMT_RGB565, dec_cap_buf));
+
+    memcpy(dec_out_buf[0], enc_cap_buf[0], jpeg_size);
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type      = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory    = V4L2_MEMORY_MMAP;
+    buf.index     = 0;
+    buf.bytesused = jpeg_size;
+    TEST_ESP_OK(ioctl(dec_fd, VIDIOC_QBUF, &buf));
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index  = 0;
+    TEST_ESP_OK(ioctl(dec_fd, VIDIOC_QBUF, &buf));
+
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ESP_OK(ioctl(dec_fd, VIDIOC_STREAMON, &val));
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(dec_fd, VIDIOC_STREAMON, &val));
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(dec_fd, VIDIOC_DQBUF, &buf));
+    TEST_ASSERT_EQUAL_UINT32(frame_size, buf.bytesused);
+
+    /* JPEG is lossy, so compare each color component with a small tolerance */
+
+    for (uint32_t i = 0; i < frame_size / 2; i += width + 1) {
+        uint16_t pixel = ((uint16_t *)dec_cap_buf[0])[i];
+
+        TEST_ASSERT_INT_WITHIN(2, (TEST_SW_JPEG_DEC_COLOR >> 11) & 0x1f, (pixel >> 11) & 0x1f);
+        TEST_ASSERT_INT_WITHIN(3, (TEST_SW_JPEG_DEC_COLOR >> 5) & 0x3f, (pixel >> 5) & 0x3f);
+        TEST_ASSERT_INT_WITHIN(2, TEST_SW_JPEG_DEC_COLOR & 0x1f, pixel & 0x1f);
+    }
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(dec_fd, VIDIOC_DQBUF, &buf));
+    TEST_ASSERT_EQUAL_UINT32(jpeg_size, buf.bytesused);
+
+    for (int i = 0; i < 2; i++) {
+        int fd = i ? dec_fd : enc_fd;
+
+        val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMOFF, &val));
+        val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMOFF, &val));
+        TEST_ESP_OK(close(fd));
+    }
+
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_SW_JPEG | ESP_VIDEO_INIT_FLAGS_SW_JPEG_DEC));
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_VIDEO_DEVICE && CONFIG_ESP_VIDEO_ENABLE_SW_JPEG_DEC_VIDEO_DEVICE */
+
+#if CONFIG_ESP_VIDEO_ENABLE_VIVID_VIDEO_DEVICE
+TEST_CASE("V4L2 virtual test pattern device", "[video]")
+{
+    int fd;
+    int ret;
+    int val;
+    uint32_t sequence;
+    uint16_t width = 64;
+    uint16_t height = 48;
+    struct v4l2_buffer buf;
+    struct v4l2_format format;
+    struct v4l2_requestbuffers req;
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+    uint8_t *cap_buf[VIDEO_BUFFER_NUM];
+    const struct {
+        uint32_t pixel_format;
+        uint32_t frame_size;
+    } test_formats[] = {
+        {V4L2_PIX_FMT_SBGGR8, width * height},
+        {V4L2_PIX_FMT_SBGGR10, width * height * 10 / 8},
+        {V4L2_PIX_FMT_RGB565, width * height * 2},
+        {V4L2_PIX_FMT_YUYV, width * height * 2},
+        {V4L2_PIX_FMT_JPEG, 0},
+    };
+    const esp_video_init_vivid_config_t vivid_config = {
+        .fps = 100,
+    };
+    const esp_video_init_config_t config = {
+        .vivid = &vivid_config,
+    };
+
+    setUp();
+
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_VIVID));
+
+    fd = open(ESP_VIDEO_VIVID_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    for (int i = 0; i < sizeof(test_formats) / sizeof(test_formats[0]); i++) {
+        for (int pattern = 0; pattern < ESP_VIDEO_VIVID_PATTERN_MAX; pattern++) {
+            controls.ctrl_class = V4L2_CTRL_CLASS_IMAGE_PROC;
+            controls.count      = 1;
+            controls.controls   = control;
+            control[0].id       = V4L2_CID_TEST_PATTERN;
+            control[0].value    = pattern;
+            ret = ioctl(fd, VIDIOC_S_EXT_CTRLS, &controls);
+            TEST_ESP_OK(ret);
+
+            memset(&format, 0, sizeof(format));
+            format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            format.fmt.pix.width = width;
+            format.fmt.pix.height = height;
+            format.fmt.pix.pixelformat = test_formats[i].pixel_format;
+            ret = ioctl(fd, VIDIOC_S_FMT, &format);
+            TEST_ESP_OK(ret);
+
+            memset(&req, 0, sizeof(req));
+            req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            req.memory = V4L2_MEMORY_MMAP;
+            req.count  = VIDEO_BUFFER_NUM;
+            ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+            TEST_ESP_OK(ret);
+
+            for (int j = 0; j < VIDEO_BUFFER_NUM; j++) {
+                memset(&buf, 0, sizeof(buf));
+                buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                buf.memory = V4L2_MEMORY_MMAP;
+                buf.index  = j;
+                ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
+                TEST_ESP_OK(ret);
+
+                cap_buf[j] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED, fd, buf.m.offset);
+                TEST_ASSERT_NOT_NULL(cap_buf[j]);
+
+                ret = ioctl(fd, VIDIOC_QBUF, &buf);
+                TEST_ESP_OK(ret);
+            }
+
+            val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            ret = ioctl(fd, VIDIOC_STREAMON, &val);
+            TEST_ESP_OK(ret);
+
+            sequence = 0;
+            for (int j = 0; j < 10; j++) {
+                memset(&buf, 0, sizeof(buf));
+                buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                buf.memory = V4L2_MEMORY_MMAP;
+                ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+                TEST_ESP_OK(ret);
+
+                if (j) {
+                    TEST_ASSERT_GREATER_THAN_UINT32(sequence, buf.sequence);
+                }
+                sequence = buf.sequence;
+
+                if (test_formats[i].pixel_format == V4L2_PIX_FMT_JPEG) {
+                    TEST_ASSERT_EQUAL_HEX8(0xff, cap_buf[buf.index][0]);
+                    TEST_ASSERT_EQUAL_HEX8(0xd8, cap_buf[buf.index][1]);
+                    TEST_ASSERT_EQUAL_HEX8(0xff, cap_buf[buf.index][buf.bytesused - 2]);
+                    TEST_ASSERT_EQUAL_HEX8(0xd9, cap_buf[buf.index][buf.bytesused - 1]);
+                } else {
+                    TEST_ASSERT_EQUAL_UINT32(test_formats[i].frame_size, buf.bytesused);
+                }
+
+                ret = ioctl(fd, VIDIOC_QBUF, &buf);
+                TEST_ESP_OK(ret);
+            }
+
+            val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+            TEST_ESP_OK(ret);
+        }
+    }
+
+    ret = close(fd);
+    TEST_ESP_OK(ret);
+
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_VIVID));
+}
+
+TEST_CASE("V4L2 stream statistics", "[video]")
+{
+    int fd;
+    int ret;
+    int val;
+    uint32_t latency_count;
+    struct v4l2_buffer buf;
+    struct v4l2_requestbuffers req;
+    struct esp_video_stream_stats stats;
+    const esp_video_init_vivid_config_t vivid_config = {
+        .width = 64,
+        .height = 48,
+        .fps = 100,
+    };
+    const esp_video_init_config_t config = {
+        .vivid = &vivid_config,
+    };
+
+    setUp();
+
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_VIVID));
+
+    fd = open(ESP_VIDEO_VIVID_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = VIDEO_BUFFER_NUM;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < VIDEO_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
+
+    /* Hold all buffers in done queue, the following frames have no buffer and are dropped */
+
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    for (int i = 0; i < 10; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+        TEST_ESP_OK(ret);
+
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    stats.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    stats.flags = ESP_VIDEO_STREAM_STATS_FLAG_RESET;
+    ret = ioctl(fd, VIDIOC_G_STREAM_STATS, &stats);
+    TEST_ESP_OK(ret);
+
+    TEST_ASSERT_EQUAL_UINT32(V4L2_BUF_TYPE_VIDEO_CAPTURE, stats.type);
+    TEST_ASSERT_EQUAL_UINT32(10, stats.dequeued);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(stats.dequeued, stats.completed);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(VIDEO_BUFFER_NUM, stats.done_high_water);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(50000, stats.max_latency_us);
+
+    latency_count = 0;
+    for (int i = 0; i < ESP_VIDEO_STREAM_LATENCY_HIST_NUM; i++) {
+        latency_count += stats.latency_hist[i];
+    }
+    TEST_ASSERT_EQUAL_UINT32(stats.dequeued, latency_count);
+
+    /* Statistics are reset after reading */
+
+    memset(&stats, 0, sizeof(stats));
+    stats.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_G_STREAM_STATS, &stats);
+    TEST_ESP_OK(ret);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dequeued);
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
+
+    ret = close(fd);
+    TEST_ESP_OK(ret);
+
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_VIVID));
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_VIVID_VIDEO_DEVICE */
+
+#if CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE
+TEST_CASE("V4L2 set/get selection", "[video]")
+{
+    int fd;
+    struct v4l2_selection in_selection;
+    struct v4l2_selection out_selection;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    fd = open(ESP_VIDEO_ISP1_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&in_selection, 0, sizeof(in_selection));
+    in_selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ASSERT_EQUAL_INT(-1, ioctl(fd, VIDIOC_G_SELECTION, &in_selection));
+
+    memset(&in_selection, 0, sizeof(in_selection));
+    in_selection.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ASSERT_EQUAL_INT(-1, ioctl(fd, VIDIOC_S_SELECTION, &in_selection));
+
+    memset(&in_selection, 0, sizeof(in_selection));
+    in_selection.type = V4L2_BUF_TYPE_META_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_G_SELECTION, &in_selection));
+
+    memset(&in_selection, 0, sizeof(in_selection));
+    in_selection.type = V4L2_BUF_TYPE_META_CAPTURE;
+    in_selection.r.left = 0;
+    in_selection.r.width = 1080;
+    in_selection.r.top = 0;
+    in_selection.r.height = 720;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_S_SELECTION, &in_selection));
+
+    memset(&out_selection, 0, sizeof(out_selection));
+    out_selection.type = V4L2_BUF_TYPE_META_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_G_SELECTION, &out_selection));
+
+    TEST_ESP_OK(memcmp(&out_selection, &in_selection, sizeof(out_selection)));
+
+    TEST_ESP_OK(close(fd));
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+TEST_CASE("V4L2 set/get param", "[video]")
+{
+    int fd;
+    int fps;
+    int ret;
+    struct v4l2_buffer buf;
+    struct v4l2_streamparm sparm;
+    struct v4l2_captureparm *cparam = &sparm.parm.capture;
+    struct v4l2_fract *timeperframe = &cparam->timeperframe;
+    struct v4l2_requestbuffers req;
+    int buf_count = 3;
+    int capture_seconds = 3;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&sparm, 0, sizeof(sparm));
+    sparm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_G_PARM, &sparm);
+    TEST_ESP_OK(ret);
+
+    TEST_ASSERT_EQUAL_INT(cparam->capability, V4L2_CAP_TIMEPERFRAME);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, timeperframe->numerator);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, timeperframe->denominator);
+    printf("fps=%0.4f\n", (float)timeperframe->denominator / timeperframe->numerator);
+
+    fps = timeperframe->denominator / timeperframe->numerator;
+    for (int i = 2; i <= fps; i++) {
+        if (fps % i != 0) {
+            continue;
+        }
+        int div_fps = fps / i;
+
+        memset(&sparm, 0, sizeof(sparm));
+        sparm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        cparam->capability = V4L2_CAP_TIMEPERFRAME;
+        timeperframe->numerator = 1;
+        timeperframe->denominator = div_fps;
+        ret = ioctl(fd, VIDIOC_S_PARM, &sparm);
+        TEST_ESP_OK(ret);
+
+        memset(&req, 0, sizeof(req));
+        req.count  = buf_count;
+        req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+        TEST_ESP_OK(ret);
+
+        for (int i = 0; i < buf_count; i++) {
+            memset(&buf, 0, sizeof(buf));
+            buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory      = V4L2_MEMORY_MMAP;
+            buf.index       = i;
+            ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            ret = ioctl(fd, VIDIOC_QBUF, &buf);
+            TEST_ESP_OK(ret);
+        }
+
+        int val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        ret = ioctl(fd, VIDIOC_STREAMON, &val);
+        TEST_ESP_OK(ret);
+
+        int frame_count = 0;
+        int64_t start_time_us = esp_timer_get_time();
+        while (esp_timer_get_time() - start_time_us < (capture_seconds * 1000 * 1000)) {
+            memset(&buf, 0, sizeof(buf));
+            buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+            TEST_ESP_OK(ret);
+
+            frame_count++;
+
+            ret = ioctl(fd, VIDIOC_QBUF, &buf);
+            TEST_ESP_OK(ret);
+        }
+
+        val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+        TEST_ESP_OK(ret);
+
+        TEST_ASSERT_EQUAL_INT(div_fps, frame_count / capture_seconds);
+
+        memset(&sparm, 0, sizeof(sparm));
+        sparm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        ret = ioctl(fd, VIDIOC_G_PARM, &sparm);
+        TEST_ESP_OK(ret);
+
+        TEST_ASSERT_EQUAL_INT(cparam->capability, V4L2_CAP_TIMEPERFRAME);
+        TEST_ASSERT_EQUAL_INT(timeperframe->numerator, 1);
+        TEST_ASSERT_EQUAL_INT(timeperframe->denominator, div_fps);
+    }
+
+    close(fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+TEST_CASE("V4L2 set/get GAMMA_EXT", "[video]")
+{
+    int fd;
+    int ret;
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl[1];
+    esp_video_isp_gamma_ext_t gamma_set;
+    esp_video_isp_gamma_ext_t gamma_get;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    fd = open(ESP_VIDEO_ISP1_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    /* Set GAMMA_EXT with distinct R/G/B channel points */
+    memset(&gamma_set, 0, sizeof(gamma_set));
+    gamma_set.enable = true;
+    for (int i = 0; i < ISP_GAMMA_CURVE_POINTS_NUM; i++) {
+        gamma_set.red_points[i].x   = (uint8_t)(i * 16);
+        gamma_set.red_points[i].y   = (uint8_t)(i * 2);
+        gamma_set.green_points[i].x = (uint8_t)(i * 16);
+        gamma_set.green_points[i].y = (uint8_t)(i * 4);
+        gamma_set.blue_points[i].x  = (uint8_t)(i * 16);
+        gamma_set.blue_points[i].y  = (uint8_t)(i * 8);
+    }
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    ctrls.ctrl_class = V4L2_CID_USER_CLASS;
+    ctrls.count      = 1;
+    ctrls.controls   = ctrl;
+    ctrl[0].id       = V4L2_CID_USER_ESP_ISP_GAMMA_EXT;
+    ctrl[0].size     = sizeof(esp_video_isp_gamma_ext_t);
+    ctrl[0].p_u8     = (uint8_t *)&gamma_set;
+
+    ret = ioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls);
+    TEST_ESP_OK(ret);
+
+    /* Get GAMMA_EXT and verify it matches what we set */
+    memset(&gamma_get, 0, sizeof(gamma_get));
+    ctrl[0].p_u8 = (uint8_t *)&gamma_get;
+
+    ret = ioctl(fd, VIDIOC_G_EXT_CTRLS, &ctrls);
+    TEST_ESP_OK(ret);
+
+    TEST_ASSERT_EQUAL(gamma_set.enable, gamma_get.enable);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(gamma_set.red_points, gamma_get.red_points,
+                                    sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(gamma_set.green_points, gamma_get.green_points,
+                                    sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(gamma_set.blue_points, gamma_get.blue_points,
+                                    sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM));
+
+    /* Set enable = false and verify get */
+    gamma_set.enable = false;
+    ctrl[0].p_u8 = (uint8_t *)&gamma_set;
+    ret = ioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls);
+    TEST_ESP_OK(ret);
+
+    memset(&gamma_get, 0, sizeof(gamma_get));
+    ctrl[0].p_u8 = (uint8_t *)&gamma_get;
+    ret = ioctl(fd, VIDIOC_G_EXT_CTRLS, &ctrls);
+    TEST_ESP_OK(ret);
+    TEST_ASSERT_FALSE(gamma_get.enable);
+
+    close(fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE */
+
+#if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER && CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE
+#define TEST_3A_STATE_NVS_NAMESPACE "esp_video"
+#define TEST_3A_STATE_NVS_KEY       "isp_3a_state"
+#define TEST_3A_CONVERGE_FRAMES     100
+
+/**
+ * @brief Capture frames to let the ISP pipeline controller run 3A
+ */
+static void test_capture_frames(int frames)
+{
+    int fd;
+    int val;
+    struct v4l2_buffer buf;
+    struct v4l2_requestbuffers req;
+
+    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = VIDEO_BUFFER_NUM;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_REQBUFS, &req));
+
+    for (int i = 0; i < VIDEO_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QUERYBUF, &buf));
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMON, &val));
+
+    for (int i = 0; i < frames; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMOFF, &val));
+
+    TEST_ESP_OK(close(fd));
+}
+
+static esp_err_t test_get_3a_state_size(size_t *size)
+{
+    esp_err_t ret;
+    nvs_handle_t handle;
+
+    *size = 0;
+    ret = nvs_open(TEST_3A_STATE_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_get_blob(handle, TEST_3A_STATE_NVS_KEY, NULL, size);
+        nvs_close(handle);
+    }
+
+    return ret;
+}
+
+TEST_CASE("V4L2 ISP 3A state persistence", "[video]")
+{
+    esp_err_t ret;
+    size_t size;
+    size_t saved_size;
+    nvs_handle_t handle;
+
+    setUp();
+
+    ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        TEST_ESP_OK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    TEST_ESP_OK(ret);
+
+    /* Start from the camera sensor defaults */
+    TEST_ESP_OK(nvs_open(TEST_3A_STATE_NVS_NAMESPACE, NVS_READWRITE, &handle));
+    ret = nvs_erase_key(handle, TEST_3A_STATE_NVS_KEY);
+    TEST_ASSERT(ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_OK(nvs_commit(handle));
+    nvs_close(handle);
 
     TEST_ESP_OK(example_video_init());
+    test_capture_frames(TEST_3A_CONVERGE_FRAMES);
+    TEST_ESP_OK(example_video_deinit());
 
-    fd = open(ESP_VIDEO_ISP1_DEVICE_NAME, O_RDWR);
-    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    /* The converged state is saved when the ISP pipeline controller stops */
+    TEST_ESP_OK(test_get_3a_state_size(&saved_size));
+    TEST_ASSERT_GREATER_THAN(0, saved_size);
 
-    /* Set GAMMA_EXT with distinct R/G/B channel points */
-    memset(&gamma_set, 0, sizeof(gamma_set));
-    gamma_set.enable = true;
-    for (int i = 0; i < ISP_GAMMA_CURVE_POINTS_NUM; i++) {
-        gamma_set.red_points[i].x   = (uint8_t)(i * 16);
-        gamma_set.red_points[i].y   = (uint8_t)(i * 2);
-        gamma_set.green_points[i].x = (uint8_t)(i * 16);
-        gamma_set.green_points[i].y = (uint8_t)(i * 4);
-        gamma_set.blue_points[i].x  = (uint8_t)(i * 16);
-        gamma_set.blue_points[i].y  = (uint8_t)(i * 8);
+    /* The next start is seeded by the saved state, and saves a state of the same layout */
+    TEST_ESP_OK(example_video_init());
+    test_capture_frames(TEST_3A_CONVERGE_FRAMES);
+    TEST_ESP_OK(example_video_deinit());
+
+    TEST_ESP_OK(test_get_3a_state_size(&size));
+    TEST_ASSERT_EQUAL(saved_size, size);
+
+    TEST_ESP_OK(nvs_flash_deinit());
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER && CONFIG_ESP_VIDEO_ISP_PIPELINE_PERSIST_3A_STATE */
+
+#if CONFIG_ESP_VIDEO_ENABLE_SENSOR_DETECT_CACHE
+#define TEST_DETECT_NVS_NAMESPACE   "esp_video"
+
+/**
+ * @brief Last-known-good camera sensor record, the same layout as the one saved by esp_video_init
+ */
+typedef struct test_detect_record {
+    uint16_t index;                         /*!< Index of the detect function in the detect function array */
+    uint16_t sccb_addr;                     /*!< Camera sensor SCCB address */
+    char name[16];                          /*!< Camera sensor name */
+} test_detect_record_t;
+
+static const esp_cam_sensor_port_t s_test_detect_ports[] = {
+    ESP_CAM_SENSOR_DVP,
+    ESP_CAM_SENSOR_MIPI_CSI,
+    ESP_CAM_SENSOR_SPI,
+};
+
+static void test_detect_record_key(esp_cam_sensor_port_t port, char *key, size_t size)
+{
+    snprintf(key, size, "detect_port%d", (int)port);
+}
+
+static esp_err_t test_get_detect_record(esp_cam_sensor_port_t port, test_detect_record_t *record)
+{
+    esp_err_t ret;
+    char key[16];
+    nvs_handle_t handle;
+    size_t size = sizeof(test_detect_record_t);
+
+    test_detect_record_key(port, key, sizeof(key));
+    ret = nvs_open(TEST_DETECT_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_get_blob(handle, key, record, &size);
+        nvs_close(handle);
     }
 
-    memset(&ctrls, 0, sizeof(ctrls));
-    ctrls.ctrl_class = V4L2_CID_USER_CLASS;
-    ctrls.count      = 1;
-    ctrls.controls   = ctrl;
-    ctrl[0].id       = V4L2_CID_USER_ESP_ISP_GAMMA_EXT;
-    ctrl[0].size     = sizeof(esp_video_isp_gamma_ext_t);
-    ctrl[0].p_u8     = (uint8_t *)&gamma_set;
+    return ret;
+}
 
-    ret = ioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls);
-    TEST_ESP_OK(ret);
+/**
+ * @brief Save the record of the port, or remove it if "record" is NULL
+ */
+static void test_set_detect_record(esp_cam_sensor_port_t port, const test_detect_record_t *record)
+{
+    esp_err_t ret;
+    char key[16];
+    nvs_handle_t handle;
+
+    test_detect_record_key(port, key, sizeof(key));
+    TEST_ESP_OK(nvs_open(TEST_DETECT_NVS_NAMESPACE, NVS_READWRITE, &handle));
+    if (record) {
+        TEST_ESP_OK(nvs_set_blob(handle, key, record, sizeof(test_detect_record_t)));
+    } else {
+        ret = nvs_erase_key(handle, key);
+        TEST_ASSERT(ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND);
+    }
+    TEST_ESP_OK(nvs_commit(handle));
+    nvs_close(handle);
+}
 
-    /* Get GAMMA_EXT and verify it matches what we set */
-    memset(&gamma_get, 0, sizeof(gamma_get));
-    ctrl[0].p_u8 = (uint8_t *)&gamma_get;
+static void test_detect_sensor(void)
+{
+    int fd;
 
-    ret = ioctl(fd, VIDIOC_G_EXT_CTRLS, &ctrls);
-    TEST_ESP_OK(ret);
+    TEST_ESP_OK(example_video_init());
+    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    TEST_ESP_OK(close(fd));
+    TEST_ESP_OK(example_video_deinit());
+}
 
-    TEST_ASSERT_EQUAL(gamma_set.enable, gamma_get.enable);
-    TEST_ASSERT_EQUAL_INT(0, memcmp(gamma_set.red_points, gamma_get.red_points,
-                                    sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM));
-    TEST_ASSERT_EQUAL_INT(0, memcmp(gamma_set.green_points, gamma_get.green_points,
-                                    sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM));
-    TEST_ASSERT_EQUAL_INT(0, memcmp(gamma_set.blue_points, gamma_get.blue_points,
-                                    sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM));
+TEST_CASE("V4L2 camera sensor detection cache", "[video]")
+{
+    esp_err_t ret;
+    esp_cam_sensor_port_t port;
+    test_detect_record_t record;
+    test_detect_record_t saved;
+    esp_cam_sensor_detect_fn_t *p = NULL;
+    size_t num = &__esp_cam_sensor_detect_fn_array_end - &__esp_cam_sensor_detect_fn_array_start;
+    size_t i;
 
-    /* Set enable = false and verify get */
-    gamma_set.enable = false;
-    ctrl[0].p_u8 = (uint8_t *)&gamma_set;
-    ret = ioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls);
-    TEST_ESP_OK(ret);
+    setUp();
 
-    memset(&gamma_get, 0, sizeof(gamma_get));
-    ctrl[0].p_u8 = (uint8_t *)&gamma_get;
-    ret = ioctl(fd, VIDIOC_G_EXT_CTRLS, &ctrls);
+    ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        TEST_ESP_OK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
     TEST_ESP_OK(ret);
-    TEST_ASSERT_FALSE(gamma_get.enable);
 
-    close(fd);
+    for (i = 0; i < sizeof(s_test_detect_ports) / sizeof(s_test_detect_ports[0]); i++) {
+        test_set_detect_record(s_test_detect_ports[i], NULL);
+    }
 
-    TEST_ESP_OK(example_video_deinit());
+    /* Without a record, all camera sensors of the port are probed, and the detected one is saved */
+    test_detect_sensor();
+    for (i = 0; i < sizeof(s_test_detect_ports) / sizeof(s_test_detect_ports[0]); i++) {
+        if (test_get_detect_record(s_test_detect_ports[i], &saved) == ESP_OK) {
+            break;
+        }
+    }
+    TEST_ASSERT_LESS_THAN(sizeof(s_test_detect_ports) / sizeof(s_test_detect_ports[0]), i);
+    port = s_test_detect_ports[i];
+    TEST_ASSERT_LESS_THAN(num, saved.index);
+
+    /* The saved camera sensor is detected by the first probe, and the record is kept */
+    test_detect_sensor();
+    TEST_ESP_OK(test_get_detect_record(port, &record));
+    TEST_ASSERT_EQUAL_MEMORY(&saved, &record, sizeof(saved));
+
+    /* A record which is not in this firmware is ignored, and replaced by the detected camera sensor */
+    record.index = num;
+    test_set_detect_record(port, &record);
+    test_detect_sensor();
+    TEST_ESP_OK(test_get_detect_record(port, &record));
+    TEST_ASSERT_EQUAL_MEMORY(&saved, &record, sizeof(saved));
+
+    /* A valid record of a camera sensor which is not connected falls back to probing all camera sensors */
+    for (i = 0; i < num; i++) {
+        p = &__esp_cam_sensor_detect_fn_array_start + i;
+        if (p->port == port && i != saved.index) {
+            break;
+        }
+    }
+    if (i < num) {
+        memset(&record, 0, sizeof(record));
+        record.index = i;
+        record.sccb_addr = p->sccb_addr;
+        strncpy(record.name, "not connected", sizeof(record.name));
+        test_set_detect_record(port, &record);
+
+        test_detect_sensor();
+        TEST_ESP_OK(test_get_detect_record(port, &record));
+        TEST_ASSERT_EQUAL_MEMORY(&saved, &record, sizeof(saved));
+    } else {
+        printf("port %d has only one camera sensor driver, skip the fallback check\n", (int)port);
+    }
+
+    TEST_ESP_OK(nvs_flash_deinit());
 }
-#endif /* CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE */
+#endif /* CONFIG_ESP_VIDEO_ENABLE_SENSOR_DETECT_CACHE */
+
+#if CONFIG_ESP_VIDEO_ENABLE_PARALLEL_SENSOR_DETECT
+TEST_CASE("V4L2 parallel camera sensor detection", "[video]")
+{
+    int fd;
+    struct v4l2_capability cap;
+
+    setUp();
+
+    /* Detection tasks and their semaphore are freed before esp_video_init returns, tearDown checks the heap */
+    for (int i = 0; i < 5; i++) {
+        TEST_ESP_OK(example_video_init());
+
+        fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+        TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+        memset(&cap, 0, sizeof(cap));
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QUERYCAP, &cap));
+        TEST_ASSERT_EQUAL_INT(V4L2_CAP_VIDEO_CAPTURE, cap.capabilities & V4L2_CAP_VIDEO_CAPTURE);
+        TEST_ESP_OK(close(fd));
+
+        TEST_ESP_OK(example_video_deinit());
+    }
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_PARALLEL_SENSOR_DETECT */
 
 TEST_CASE("V4L2 set/get timeout", "[video]")
 {
@@ -644,6 +2444,227 @@ TEST_CASE("V4L2 set/get timeout", "[video]")
     TEST_ESP_OK(example_video_deinit());
 }
 
+TEST_CASE("V4L2 non-blocking DQBUF", "[video]")
+{
+    int fd;
+    int ret;
+    int flags;
+    struct v4l2_buffer buf;
+    struct v4l2_requestbuffers req;
+    int buf_count = 3;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR | O_NONBLOCK);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    flags = fcntl(fd, F_GETFL);
+    TEST_ASSERT_EQUAL_INT(O_NONBLOCK, flags & O_NONBLOCK);
+
+    memset(&req, 0, sizeof(req));
+    req.count  = buf_count;
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < buf_count; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory      = V4L2_MEMORY_MMAP;
+        buf.index       = i;
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    /* Stream is not started, so DQBUF returns immediately */
+
+    for (int i = 0; i < 10; i++) {
+        TickType_t start_time = xTaskGetTickCount();
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+        TEST_ASSERT_EQUAL_INT(-1, ret);
+        TEST_ASSERT_EQUAL_INT(EAGAIN, errno);
+
+        TickType_t end_time = xTaskGetTickCount();
+        TEST_ASSERT_LESS_OR_EQUAL_INT(1, end_time - start_time);
+    }
+
+    ret = fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    TEST_ASSERT_EQUAL_INT(0, ret);
+    TEST_ASSERT_EQUAL_INT(0, fcntl(fd, F_GETFL) & O_NONBLOCK);
+
+    close(fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+TEST_CASE("V4L2 non-blocking flag per file description", "[video]")
+{
+    int ret;
+    int nb_fd;
+    int fd;
+    struct v4l2_buffer buf;
+    struct v4l2_requestbuffers req;
+    int buf_count = 3;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    nb_fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR | O_NONBLOCK);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, nb_fd);
+
+    /* A later open() without O_NONBLOCK doesn't change the earlier file description */
+
+    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    TEST_ASSERT_NOT_EQUAL(nb_fd, fd);
+
+    TEST_ASSERT_EQUAL_INT(O_NONBLOCK, fcntl(nb_fd, F_GETFL) & O_NONBLOCK);
+    TEST_ASSERT_EQUAL_INT(0, fcntl(fd, F_GETFL) & O_NONBLOCK);
+
+    memset(&req, 0, sizeof(req));
+    req.count  = buf_count;
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < buf_count; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory      = V4L2_MEMORY_MMAP;
+        buf.index       = i;
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    /* Stream is not started, so DQBUF by the non-blocking file description returns immediately */
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    ret = ioctl(nb_fd, VIDIOC_DQBUF, &buf);
+    TEST_ASSERT_EQUAL_INT(-1, ret);
+    TEST_ASSERT_EQUAL_INT(EAGAIN, errno);
+
+    /* fcntl(F_SETFL) only changes the flags of its own file description */
+
+    ret = fcntl(fd, F_SETFL, O_NONBLOCK);
+    TEST_ASSERT_EQUAL_INT(0, ret);
+    ret = fcntl(nb_fd, F_SETFL, 0);
+    TEST_ASSERT_EQUAL_INT(0, ret);
+    TEST_ASSERT_EQUAL_INT(O_NONBLOCK, fcntl(fd, F_GETFL) & O_NONBLOCK);
+    TEST_ASSERT_EQUAL_INT(0, fcntl(nb_fd, F_GETFL) & O_NONBLOCK);
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+    TEST_ASSERT_EQUAL_INT(-1, ret);
+    TEST_ASSERT_EQUAL_INT(EAGAIN, errno);
+
+    close(nb_fd);
+
+    /* The remaining file description keeps its own flags */
+
+    TEST_ASSERT_EQUAL_INT(O_NONBLOCK, fcntl(fd, F_GETFL) & O_NONBLOCK);
+
+    close(fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+TEST_CASE("V4L2 select", "[video]")
+{
+    int fd;
+    int ret;
+    int val;
+    fd_set rfds;
+    struct timeval tv;
+    struct v4l2_buffer buf;
+    struct v4l2_requestbuffers req;
+    int buf_count = 3;
+    uint32_t last_sequence = 0;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&req, 0, sizeof(req));
+    req.count  = buf_count;
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < buf_count; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory      = V4L2_MEMORY_MMAP;
+        buf.index       = i;
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    /* No frame is ready before the stream starts */
+
+    FD_ZERO(&rfds);
+    FD_SET(fd, &rfds);
+    tv.tv_sec = 0;
+    tv.tv_usec = 100 * 1000;
+    ret = select(fd + 1, &rfds, NULL, NULL, &tv);
+    TEST_ASSERT_EQUAL_INT(0, ret);
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < 10; i++) {
+        FD_ZERO(&rfds);
+        FD_SET(fd, &rfds);
+        tv.tv_sec = 2;
+        tv.tv_usec = 0;
+        ret = select(fd + 1, &rfds, NULL, NULL, &tv);
+        TEST_ASSERT_EQUAL_INT(1, ret);
+        TEST_ASSERT_TRUE(FD_ISSET(fd, &rfds));
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+        TEST_ESP_OK(ret);
+
+        TEST_ASSERT_TRUE(buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC);
+        if (i) {
+            TEST_ASSERT_GREATER_THAN_UINT32(last_sequence, buf.sequence);
+        }
+        last_sequence = buf.sequence;
+
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
+
+    close(fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+#endif
+
 
 #if CONFIG_ESP_VIDEO_ENABLE_SWAP_BYTE_RISCV
 TEST_CASE("RISCV swap byte", "[video]")